@@ -0,0 +1,414 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+// Cache of the basis and the diagonal part on the disk (BasisCache=1 in the CalcMod file)
+//
+// Each process writes
+//   output/<CDataFileHead>_BasisCache_rank_<myrank>.dat    : list_1, list_2_1, list_2_2
+//   output/<CDataFileHead>_DiagonalCache_rank_<myrank>.dat : list_Diagonal
+// after sz and diagonalcalc, and the next run maps them with mmap instead of
+// rebuilding the arrays. A file is used only when its header (magic, version,
+// byte order, sizes of the types) and its key agree with the present run on
+// all processes; otherwise the arrays are rebuilt and the files are replaced.
+// The key of the basis is a hash of the model, the numbers of sites and
+// particles, the local spins and the MPI layout. The key of the diagonal part
+// adds the diagonal terms, so that a sweep of the transfer or the off-diagonal
+// couplings reuses both files, while a sweep of U or V reuses only the basis.
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "BasisCache.h"
+#include "bitcalc.h"
+#include "wrapperMPI.h"
+
+/**
+ * @brief Header of the cache files.
+ */
+struct BasisCacheHeader{
+  char magic[8]; /**< "HPhiBC" */
+  uint32_t version; /**< D_BasisCacheVersion */
+  uint32_t endian; /**< 0x01020304 in the byte order of the writer */
+  uint32_t size_lui; /**< sizeof(long unsigned int) */
+  uint32_t size_d; /**< sizeof(double) */
+  uint64_t key; /**< Hash of the input which determines the arrays */
+  uint64_t n1; /**< Number of elements of list_1 or list_Diagonal */
+  uint64_t n21; /**< Number of elements of list_2_1 */
+  uint64_t n22; /**< Number of elements of list_2_2 */
+};
+
+static const char cBasisCacheMagic[8] = "HPhiBC";
+static int iFlgBasisCache = FALSE; /**< TRUE if the cache is used in this run */
+static uint64_t BasisCacheKey = 0; /**< Key of the basis, fixed before sz changes iCalcModel */
+
+/**
+ * @brief FNV-1a hash.
+ *
+ * @param h hash of the preceding data
+ * @param p data
+ * @param n size of the data in bytes
+ *
+ * @return updated hash
+ */
+static uint64_t BasisCacheHash(uint64_t h, const void *p, size_t n){
+  const unsigned char *c = (const unsigned char *)p;
+  size_t i;
+  for(i=0; i<n; i++){
+    h ^= c[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+static uint64_t BasisCacheHashInt(uint64_t h, int i){
+  return BasisCacheHash(h, &i, sizeof(int));
+}
+
+/**
+ * @brief Key of the basis.
+ *
+ * @param X
+ *
+ * @return key
+ */
+static uint64_t BasisCacheKeyBasis(struct BindStruct *X){
+  uint64_t h = 14695981039346656037ull;
+  int i;
+
+  h = BasisCacheHashInt(h, D_BasisCacheVersion);
+  h = BasisCacheHashInt(h, X->Def.iCalcModel);
+  h = BasisCacheHashInt(h, X->Def.Nsite);
+  h = BasisCacheHashInt(h, X->Def.NsiteMPI);
+  h = BasisCacheHashInt(h, X->Def.Nup);
+  h = BasisCacheHashInt(h, X->Def.Ndown);
+  h = BasisCacheHashInt(h, X->Def.Ne);
+  h = BasisCacheHashInt(h, X->Def.Total2Sz);
+  h = BasisCacheHashInt(h, X->Def.Total2SzMPI);
+  h = BasisCacheHashInt(h, X->Def.iFlgGeneralSpin);
+  h = BasisCacheHashInt(h, nproc);
+  h = BasisCacheHashInt(h, myrank);
+  h = BasisCacheHash(h, &X->Check.idim_max, sizeof(X->Check.idim_max));
+  h = BasisCacheHash(h, &X->Check.sdim, sizeof(X->Check.sdim));
+  switch(X->Def.iCalcModel){
+  case Spin:
+  case SpinGC:
+  case Kondo:
+  case KondoGC:
+    for(i=0; i<X->Def.Nsite; i++) h = BasisCacheHashInt(h, X->Def.LocSpn[i]);
+    break;
+  default:
+    break;
+  }
+  if(X->Def.iFlgGeneralSpin==TRUE){
+    h = BasisCacheHash(h, X->Def.SiteToBit, sizeof(long int)*X->Def.Nsite);
+  }
+  return h;
+}
+
+/**
+ * @brief Key of the diagonal part: the key of the basis and the diagonal terms.
+ *
+ * @param X
+ *
+ * @return key
+ */
+static uint64_t BasisCacheKeyDiagonal(struct BindStruct *X){
+  uint64_t h = BasisCacheKey;
+  int i;
+
+  h = BasisCacheHashInt(h, X->Def.NCoulombIntra);
+  for(i=0; i<X->Def.NCoulombIntra; i++){
+    h = BasisCacheHash(h, X->Def.CoulombIntra[i], sizeof(int));
+    h = BasisCacheHash(h, &X->Def.ParaCoulombIntra[i], sizeof(double));
+  }
+  h = BasisCacheHashInt(h, X->Def.EDNChemi);
+  for(i=0; i<X->Def.EDNChemi; i++){
+    h = BasisCacheHashInt(h, X->Def.EDChemi[i]);
+    h = BasisCacheHashInt(h, X->Def.EDSpinChemi[i]);
+    h = BasisCacheHash(h, &X->Def.EDParaChemi[i], sizeof(double));
+  }
+  h = BasisCacheHashInt(h, X->Def.NCoulombInter);
+  for(i=0; i<X->Def.NCoulombInter; i++){
+    h = BasisCacheHash(h, X->Def.CoulombInter[i], 2*sizeof(int));
+    h = BasisCacheHash(h, &X->Def.ParaCoulombInter[i], sizeof(double));
+  }
+  h = BasisCacheHashInt(h, X->Def.NHundCoupling);
+  for(i=0; i<X->Def.NHundCoupling; i++){
+    h = BasisCacheHash(h, X->Def.HundCoupling[i], 2*sizeof(int));
+    h = BasisCacheHash(h, &X->Def.ParaHundCoupling[i], sizeof(double));
+  }
+  h = BasisCacheHashInt(h, X->Def.NInterAll_Diagonal);
+  for(i=0; i<X->Def.NInterAll_Diagonal; i++){
+    h = BasisCacheHash(h, X->Def.InterAll_Diagonal[i], 4*sizeof(int));
+    h = BasisCacheHash(h, &X->Def.ParaInterAll_Diagonal[i], sizeof(double));
+  }
+  return h;
+}
+
+/**
+ * @brief Path of the cache file of this process.
+ *
+ * @param X
+ * @param cFileHead format of the file name
+ * @param cpath [out] path
+ */
+static void BasisCachePath(struct BindStruct *X, const char *cFileHead, char *cpath){
+  char sdt[D_FileNameMax];
+  sprintf(sdt, cFileHead, X->Def.CDataFileHead, myrank);
+  sprintf(cpath, "%s%s", cParentOutputFolder, sdt);
+}
+
+/**
+ * @brief Header for the arrays of the present run.
+ */
+static void BasisCacheSetHeader(
+  struct BasisCacheHeader *head,
+  uint64_t key,
+  uint64_t n1,
+  uint64_t n21,
+  uint64_t n22
+)
+{
+  memset(head, 0, sizeof(struct BasisCacheHeader));
+  memcpy(head->magic, cBasisCacheMagic, sizeof(head->magic));
+  head->version = D_BasisCacheVersion;
+  head->endian = 0x01020304u;
+  head->size_lui = sizeof(long unsigned int);
+  head->size_d = sizeof(double);
+  head->key = key;
+  head->n1 = n1;
+  head->n21 = n21;
+  head->n22 = n22;
+}
+
+/**
+ * @brief Map the cache file and copy the arrays if the header agrees.
+ * The copy is done by the threads which first touched the arrays in setmem_large.
+ *
+ * @param X
+ * @param cFileHead format of the file name
+ * @param expect header expected for the present run
+ * @param dst arrays to be filled [3]
+ * @param elem size of an element of each array [3]
+ *
+ * @retval TRUE the arrays are read
+ * @retval FALSE the file is absent or does not agree with the present run
+ */
+static int BasisCacheMap(
+  struct BindStruct *X,
+  const char *cFileHead,
+  const struct BasisCacheHeader *expect,
+  void **dst,
+  const size_t *elem
+)
+{
+  char cpath[D_FileNameMax];
+  struct BasisCacheHeader head;
+  struct stat st;
+  uint64_t n[3];
+  size_t size, offset;
+  long unsigned int j, nbyte;
+  int fd, k;
+  char *map, *src, *out;
+
+  BasisCachePath(X, cFileHead, cpath);
+  fd = open(cpath, O_RDONLY);
+  if(fd < 0) return FALSE;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct BasisCacheHeader)){
+    close(fd);
+    return FALSE;
+  }
+  n[0] = expect->n1;
+  n[1] = expect->n21;
+  n[2] = expect->n22;
+  size = sizeof(struct BasisCacheHeader);
+  for(k=0; k<3; k++) size += n[k]*elem[k];
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) return FALSE;
+
+  memcpy(&head, map, sizeof(struct BasisCacheHeader));
+  if(memcmp(&head, expect, sizeof(struct BasisCacheHeader)) != 0 || (size_t)st.st_size != size){
+    munmap(map, (size_t)st.st_size);
+    return FALSE;
+  }
+
+  offset = sizeof(struct BasisCacheHeader);
+  for(k=0; k<3; k++){
+    src = map + offset;
+    out = (char *)dst[k];
+    nbyte = n[k]*elem[k];
+#pragma omp parallel for default(none) schedule(static) private(j) firstprivate(nbyte, src, out)
+    for(j=0; j<nbyte; j+=4096){
+      memcpy(out+j, src+j, (nbyte-j < 4096) ? nbyte-j : 4096);
+    }
+    offset += nbyte;
+  }
+  munmap(map, (size_t)st.st_size);
+  return TRUE;
+}
+
+/**
+ * @brief Write the arrays to a temporary file and rename it to the cache file.
+ *
+ * @param X
+ * @param cFileHead format of the file name
+ * @param head header of the file
+ * @param src arrays to be written [3]
+ * @param elem size of an element of each array [3]
+ *
+ * @retval 0 written
+ * @retval -1 failed (the run continues without the cache)
+ */
+static int BasisCacheWrite(
+  struct BindStruct *X,
+  const char *cFileHead,
+  const struct BasisCacheHeader *head,
+  void **src,
+  const size_t *elem
+)
+{
+  char cpath[D_FileNameMax], ctmp[D_FileNameMax+4];
+  FILE *fp;
+  uint64_t n[3];
+  int k, iret=0;
+
+  BasisCachePath(X, cFileHead, cpath);
+  sprintf(ctmp, "%s.tmp", cpath);
+  n[0] = head->n1;
+  n[1] = head->n21;
+  n[2] = head->n22;
+  fp = fopen(ctmp, "wb");
+  if(fp == NULL) return -1;
+  if(fwrite(head, sizeof(struct BasisCacheHeader), 1, fp) != 1) iret = -1;
+  for(k=0; k<3 && iret==0; k++){
+    if(n[k] > 0 && fwrite(src[k], elem[k], n[k], fp) != n[k]) iret = -1;
+  }
+  if(fclose(fp) != 0) iret = -1;
+  if(iret == 0 && rename(ctmp, cpath) != 0) iret = -1;
+  if(iret != 0) remove(ctmp);
+  return iret;
+}
+
+/**
+ * @brief Read list_1, list_2_1 and list_2_2 from the cache file. Called by all processes
+ * at the beginning of sz.
+ *
+ * @param X
+ *
+ * @retval TRUE the basis is read on all processes and sz does not build it
+ * @retval FALSE the basis must be built
+ */
+int BasisCacheReadBasis(struct BindStruct *X){
+  struct BasisCacheHeader expect;
+  long unsigned int n21, n22;
+  void *dst[3];
+  size_t elem[3] = {sizeof(long unsigned int), sizeof(long unsigned int), sizeof(long unsigned int)};
+  int iret;
+
+  iFlgBasisCache = (X->Def.iBasisCache == BASISCACHE_ON
+                    && X->Large.NTransSymOp == 0 && X->Def.READ == 0) ? TRUE : FALSE;
+  if(iFlgBasisCache == FALSE) return FALSE;
+
+  BasisCacheKey = BasisCacheKeyBasis(X);
+  if(GetSplitTableSize(X, &n21, &n22) == FALSE) return FALSE;
+  BasisCacheSetHeader(&expect, BasisCacheKey, X->Check.idim_max+1, n21, n22);
+  dst[0] = list_1;
+  dst[1] = list_2_1;
+  dst[2] = list_2_2;
+  iret = BasisCacheMap(X, cFileNameBasisCache, &expect, dst, elem);
+  if(SumMPI_i(iret == TRUE ? 1 : 0) != nproc) return FALSE;
+  fprintf(stdoutMPI, cBasisCacheRead, "basis");
+  return TRUE;
+}
+
+/**
+ * @brief Write list_1, list_2_1 and list_2_2 to the cache file after sz builds them.
+ *
+ * @param X
+ *
+ * @return 0
+ */
+int BasisCacheWriteBasis(struct BindStruct *X){
+  struct BasisCacheHeader head;
+  long unsigned int n21, n22;
+  void *src[3];
+  size_t elem[3] = {sizeof(long unsigned int), sizeof(long unsigned int), sizeof(long unsigned int)};
+
+  if(iFlgBasisCache == FALSE) return 0;
+  if(GetSplitTableSize(X, &n21, &n22) == FALSE) return 0;
+  BasisCacheSetHeader(&head, BasisCacheKey, X->Check.idim_max+1, n21, n22);
+  src[0] = list_1;
+  src[1] = list_2_1;
+  src[2] = list_2_2;
+  if(BasisCacheWrite(X, cFileNameBasisCache, &head, src, elem) != 0){
+    fprintf(stdout, cBasisCacheWriteFail, "basis", myrank);
+  }
+  else fprintf(stdoutMPI, cBasisCacheWrite, "basis");
+  return 0;
+}
+
+/**
+ * @brief Read list_Diagonal from the cache file. Called by all processes
+ * at the beginning of diagonalcalc.
+ *
+ * @param X
+ *
+ * @retval TRUE list_Diagonal is read on all processes
+ * @retval FALSE list_Diagonal must be computed
+ */
+int BasisCacheReadDiagonal(struct BindStruct *X){
+  struct BasisCacheHeader expect;
+  void *dst[3];
+  size_t elem[3] = {sizeof(double), 0, 0};
+  int iret;
+
+  /*iFlgBasisCache and BasisCacheKey are set in sz for all models*/
+  if(iFlgBasisCache == FALSE) return FALSE;
+  BasisCacheSetHeader(&expect, BasisCacheKeyDiagonal(X), X->Check.idim_max+1, 0, 0);
+  dst[0] = list_Diagonal;
+  dst[1] = NULL;
+  dst[2] = NULL;
+  iret = BasisCacheMap(X, cFileNameDiagonalCache, &expect, dst, elem);
+  if(SumMPI_i(iret == TRUE ? 1 : 0) != nproc) return FALSE;
+  fprintf(stdoutMPI, cBasisCacheRead, "diagonal part");
+  return TRUE;
+}
+
+/**
+ * @brief Write list_Diagonal to the cache file after diagonalcalc computes it.
+ *
+ * @param X
+ *
+ * @return 0
+ */
+int BasisCacheWriteDiagonal(struct BindStruct *X){
+  struct BasisCacheHeader head;
+  void *src[3];
+  size_t elem[3] = {sizeof(double), 0, 0};
+
+  if(iFlgBasisCache == FALSE) return 0;
+  BasisCacheSetHeader(&head, BasisCacheKeyDiagonal(X), X->Check.idim_max+1, 0, 0);
+  src[0] = list_Diagonal;
+  src[1] = NULL;
+  src[2] = NULL;
+  if(BasisCacheWrite(X, cFileNameDiagonalCache, &head, src, elem) != 0){
+    fprintf(stdout, cBasisCacheWriteFail, "diagonal part", myrank);
+  }
+  else fprintf(stdoutMPI, cBasisCacheWrite, "diagonal part");
+  return 0;
+}
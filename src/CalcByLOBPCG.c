@@ -0,0 +1,669 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+// Block LOBPCG method for the lowest nvec states (CalcEigenVec=2 in the CalcMod file)
+//
+// A block of m >= nvec vectors X (LOBPCGBlock in modpara) is improved by the
+// Rayleigh-Ritz procedure in the space spanned by
+//   [X, P, W],  W = T (H X - X Lambda),  P = previous update of X,
+// where T is the Jacobi preconditioner 1/|H_ii - lambda|. The three blocks are
+// stored side by side as the columns of V (and H V in HV), so that the
+// projected matrices and the update of the block are single zgemm calls over
+// the local part of the vectors. A column whose residual norm is smaller than
+// 10^(-LanczosEps/2) is softly locked: it stays in X and in the Rayleigh-Ritz
+// procedure, but no W and P are made from it, and the number of H*v products
+// in a step is the number of the unconverged columns.
+
+#include <limits.h>
+#include "mfmemory.h"
+#include "matrixlapack.h"
+#include "expec_cisajs.h"
+#include "expec_cisajscktaltdc.h"
+#include "expec_totalspin.h"
+#include "expec_energy.h"
+#include "mltply.h"
+#include "CalcByLOBPCG.h"
+#include "FileIO.h"
+#include "wrapperMPI.h"
+
+void zgemm_(char *TRANSA, char *TRANSB, int *M, int *N, int *K, double complex *ALPHA, double complex *matA, int *LDA, double complex *matB, int *LDB, double complex *BETA, double complex *matC, int *LDC);
+
+#define D_LOBPCGDrop 1.0e-12 /*!< Eigenvalues of the overlap matrix smaller than this (relative to the largest) are dropped.*/
+#define D_LOBPCGShift 1.0e-4 /*!< Smallest |H_ii - lambda| in the preconditioner.*/
+
+/**
+ * @brief Rayleigh-Ritz procedure in the space of @p k vectors.
+ * The vectors are normalized with the diagonal of the overlap matrix, and
+ * the directions with small overlap eigenvalues are dropped before the
+ * projected Hamiltonian is diagonalized.
+ *
+ * @param[in] k Number of the vectors
+ * @param[in] m Number of the Ritz pairs to be returned
+ * @param[in,out] hsub [k][k] Projected Hamiltonian (destroyed)
+ * @param[in,out] ovl [k][k] Overlap matrix (destroyed)
+ * @param[out] eig [m] Ritz values in the ascending order
+ * @param[out] coef [k*m] Coefficients of the Ritz vectors (column major)
+ *
+ * @return Number of the independent directions. The output is valid if it is not smaller than @p m.
+ */
+static int LOBPCG_RayleighRitz(
+  int k,
+  int m,
+  double complex **hsub,
+  double complex **ovl,
+  double *eig,
+  double complex *coef
+)
+{
+  int i, j, a, b, r;
+  int mfint[7];
+  double smax, *dscale;
+  double complex *s, *e, **u, **z, **hr, **y, **tmp;
+
+  d_malloc1(dscale, k);
+  c_malloc1(s, k);
+  c_malloc1(e, k);
+  c_malloc2(u, k, k);
+  c_malloc2(z, k, k);
+  c_malloc2(hr, k, k);
+  c_malloc2(y, k, k);
+  c_malloc2(tmp, k, k);
+
+  for (i = 0; i < k; i++) {
+    dscale[i] = (creal(ovl[i][i]) > 0.0) ? 1.0 / sqrt(creal(ovl[i][i])) : 0.0;
+  }
+  for (i = 0; i < k; i++) {
+    for (j = 0; j < k; j++) {
+      ovl[i][j] *= dscale[i] * dscale[j];
+      hsub[i][j] *= dscale[i] * dscale[j];
+    }
+  }
+  /*
+   Canonical orthogonalization: z[r] = u[i] / sqrt(s[i]) for the large s[i]
+  */
+  r = 0;
+  if (ZHEEVall(k, ovl, s, u) == 1) {
+    smax = creal(s[k - 1]);
+    for (i = 0; i < k; i++) {
+      if (creal(s[i]) <= D_LOBPCGDrop * smax) continue;
+      for (j = 0; j < k; j++) z[r][j] = u[i][j] / sqrt(creal(s[i]));
+      r++;
+    }
+  }
+
+  if (r >= m) {
+    for (b = 0; b < r; b++) {
+      for (i = 0; i < k; i++) {
+        tmp[b][i] = 0.0;
+        for (j = 0; j < k; j++) tmp[b][i] += hsub[i][j] * z[b][j];
+      }
+    }
+    for (a = 0; a < r; a++) {
+      for (b = 0; b < r; b++) {
+        hr[a][b] = 0.0;
+        for (i = 0; i < k; i++) hr[a][b] += conj(z[a][i]) * tmp[b][i];
+      }
+    }
+    for (a = 0; a < r; a++) {
+      for (b = a; b < r; b++) {
+        hr[a][b] = 0.5 * (hr[a][b] + conj(hr[b][a]));
+        hr[b][a] = conj(hr[a][b]);
+      }
+    }
+    if (ZHEEVall(r, hr, e, y) != 1) r = 0;
+  }
+
+  if (r >= m) {
+    for (a = 0; a < m; a++) {
+      eig[a] = creal(e[a]);
+      for (i = 0; i < k; i++) {
+        coef[i + k * a] = 0.0;
+        for (b = 0; b < r; b++) coef[i + k * a] += z[b][i] * y[a][b];
+        coef[i + k * a] *= dscale[i];
+      }
+    }
+  }
+
+  d_free1(dscale, k);
+  c_free1(s, k);
+  c_free1(e, k);
+  c_free2(u, k, k);
+  c_free2(z, k, k);
+  c_free2(hr, k, k);
+  c_free2(y, k, k);
+  c_free2(tmp, k, k);
+  return r;
+}
+
+/**
+ * @brief Projected Hamiltonian and overlap matrix of the first @p k columns
+ * of @p V, reduced over the processes.
+ *
+ * @param[in] k Number of the vectors
+ * @param[in] nrow Local dimension
+ * @param[in] ld Leading dimension of the blocks (idim_max+1)
+ * @param[in] V Block of the vectors
+ * @param[in] HV H*V
+ * @param[out] gram [2*k*k] Work array
+ * @param[out] hsub [k][k] V^dagger H V
+ * @param[out] ovl [k][k] V^dagger V
+ */
+static void LOBPCG_Gram(
+  int k,
+  int nrow,
+  int ld,
+  double complex *V,
+  double complex *HV,
+  double complex *gram,
+  double complex **hsub,
+  double complex **ovl
+)
+{
+  int i, j;
+  char transa = 'C', transb = 'N';
+  double complex one = 1.0, zero = 0.0;
+
+  zgemm_(&transa, &transb, &k, &k, &nrow, &one, V + 1, &ld, HV + 1, &ld, &zero, gram, &k);
+  zgemm_(&transa, &transb, &k, &k, &nrow, &one, V + 1, &ld, V + 1, &ld, &zero, gram + k * k, &k);
+  SumMPI_cv(2 * k * k, gram);
+
+  for (i = 0; i < k; i++) {
+    for (j = i; j < k; j++) {
+      hsub[i][j] = 0.5 * (gram[i + k * j] + conj(gram[j + k * i]));
+      hsub[j][i] = conj(hsub[i][j]);
+      ovl[i][j] = 0.5 * (gram[k * k + i + k * j] + conj(gram[k * k + j + k * i]));
+      ovl[j][i] = conj(ovl[i][j]);
+    }
+  }
+}
+
+/**
+ * @brief X <- [X, P, W] C, P <- [P, W] C_{PW}, and the same for H*X.
+ * The columns m, ..., 2m-1 of @p V hold the new P afterward.
+ *
+ * @param[in] k Number of the vectors in the Rayleigh-Ritz procedure
+ * @param[in] m Block size
+ * @param[in] nrow Local dimension
+ * @param[in] ld Leading dimension of the blocks (idim_max+1)
+ * @param[in] coef [k*m] Coefficients of the Ritz vectors
+ * @param[in,out] V Block of the vectors [3m columns]
+ * @param[out] T Work block [m columns]
+ */
+static void LOBPCG_Update(
+  int k,
+  int m,
+  int nrow,
+  int ld,
+  double complex *coef,
+  double complex *V,
+  double complex *T
+)
+{
+  long int i, j;
+  int kpw;
+  char transa = 'N', transb = 'N';
+  double complex one = 1.0, zero = 0.0;
+  long int i_max = nrow, lld = ld;
+
+  kpw = k - m;
+  if (kpw > 0) {
+    zgemm_(&transa, &transb, &nrow, &m, &kpw, &one, V + lld * m + 1, &ld, coef + m, &k, &zero, T + 1, &ld);
+  }
+  else {
+#pragma omp parallel for default(none) private(i, j) shared(T) firstprivate(i_max, lld, m)
+    for (i = 1; i <= i_max; i++) {
+      for (j = 0; j < m; j++) T[lld * j + i] = 0.0;
+    }
+  }
+  zgemm_(&transa, &transb, &nrow, &m, &m, &one, V + 1, &ld, coef, &k, &zero, V + lld * m + 1, &ld);
+
+#pragma omp parallel for default(none) private(i, j) shared(V, T) firstprivate(i_max, lld, m)
+  for (i = 1; i <= i_max; i++) {
+    for (j = 0; j < m; j++) {
+      V[lld * j + i] = V[lld * (m + j) + i] + T[lld * j + i];
+      V[lld * (m + j) + i] = T[lld * j + i];
+    }
+  }
+}
+
+/**
+ * @brief Lowest m eigenpairs by the LOBPCG method.
+ * On return, the columns 0, ..., m-1 of @p V are the Ritz vectors.
+ *
+ * @param[in,out] X
+ * @param[in] m Block size
+ * @param[in] nvec Number of the states which have to converge
+ * @param[in] ninit Number of the initial guesses in the columns m, ..., m+ninit-1 of @p V (<= 2m).
+ * They are added to the random initial block in the first Rayleigh-Ritz procedure.
+ * @param[in] ld Leading dimension of the blocks (idim_max+1)
+ * @param V [3m columns] Block of the vectors
+ * @param HV [3m columns] H*V
+ * @param T [m columns] Work block
+ * @param[out] eig [m] Ritz values
+ *
+ * @retval 0 converged
+ * @retval 1 not converged within Lanczos_max steps
+ * @retval -1 the basis became linearly dependent
+ */
+static int LOBPCG_Main(
+  struct BindStruct *X,
+  int m,
+  int nvec,
+  int ninit,
+  int ld,
+  double complex *V,
+  double complex *HV,
+  double complex *T,
+  double *eig
+)
+{
+  FILE *fp;
+  char sdt[D_FileNameMax];
+  int mfint[7];
+  int stp, j, jj, k, r, np, nw, nconv, iconv, nrow;
+  int *active;
+  long int i, i_max, lld, iv;
+  long int nmltply;
+  long unsigned int u_long_i;
+  int mythread;
+  dsfmt_t dsfmt;
+  double eps_LOBPCG, dnorm, rmax, dtmp, eigj;
+  double *rnorm;
+  double complex *gram, *coef, **hsub, **ovl;
+  double complex *vj, *hvj, *wj;
+
+  i_max = X->Check.idim_max;
+  nrow = (int)i_max;
+  lld = ld;
+  eps_LOBPCG = pow(10.0, -0.5 * X->Def.LanczosEps);
+
+  sprintf(sdt, cFileNameLOBPCGStep, X->Def.CDataFileHead);
+  if (childfopenMPI(sdt, "w", &fp) != 0) return -1;
+  fclose(fp);
+
+  i_malloc1(active, m);
+  d_malloc1(rnorm, m);
+  c_malloc1(gram, 2 * 9 * m * m);
+  c_malloc1(coef, 3 * m * m);
+  c_malloc2(hsub, 3 * m, 3 * m);
+  c_malloc2(ovl, 3 * m, 3 * m);
+  /*
+   Random initial block. The seed of the column 0 is the same as that of Lanczos_EigenValue.
+  */
+  iv = X->Def.initial_iv;
+#pragma omp parallel default(none) private(i, j, u_long_i, mythread, dsfmt) \
+  shared(V, X, nthreads, myrank, nproc) firstprivate(i_max, lld, m, iv)
+  {
+#ifdef _OPENMP
+    mythread = omp_get_thread_num();
+#else
+    mythread = 0;
+#endif
+    for (j = 0; j < m; j++) {
+      u_long_i = 123432 + labs(iv) + mythread + nthreads * (myrank + nproc * j);
+      dsfmt_init_gen_rand(&dsfmt, u_long_i);
+      if (X->Def.iInitialVecType == 0) {
+#pragma omp for
+        for (i = 1; i <= i_max; i++)
+          V[lld * j + i] = 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5) + 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5)*I;
+      }
+      else {
+#pragma omp for
+        for (i = 1; i <= i_max; i++)
+          V[lld * j + i] = 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5);
+      }
+    }
+  }/*#pragma omp parallel*/
+
+  nmltply = 0;
+  for (j = 0; j < m + ninit; j++) {
+    hvj = HV + lld * j;
+#pragma omp parallel for default(none) private(i) shared(hvj) firstprivate(i_max)
+    for (i = 1; i <= i_max; i++) hvj[i] = 0.0;
+    mltply(X, hvj, V + lld * j);
+    nmltply++;
+  }
+  /*
+   Orthonormal Ritz vectors of the initial block and the guesses.
+   The random vectors keep the basis independent even if the guesses are not.
+  */
+  iconv = 1;
+  np = 0;
+  stp = 0;
+  LOBPCG_Gram(m + ninit, nrow, ld, V, HV, gram, hsub, ovl);
+  if (LOBPCG_RayleighRitz(m + ninit, m, hsub, ovl, eig, coef) < m) {
+    fprintf(stdoutMPI, cErrLOBPCGBasis, 0);
+    iconv = -1;
+  }
+  else {
+    LOBPCG_Update(m + ninit, m, nrow, ld, coef, V, T);
+    LOBPCG_Update(m + ninit, m, nrow, ld, coef, HV, T);
+    stp = 1;
+  }
+
+  for (; iconv == 1 && stp <= X->Def.Lanczos_max; stp++) {
+    /*
+     Residual norms |H x_j - lambda_j x_j|
+    */
+    for (j = 0; j < m; j++) {
+      vj = V + lld * j;
+      hvj = HV + lld * j;
+      eigj = eig[j];
+      dnorm = 0.0;
+#pragma omp parallel for default(none) private(i) shared(vj, hvj) \
+  firstprivate(i_max, eigj) reduction(+:dnorm)
+      for (i = 1; i <= i_max; i++) {
+        dnorm += creal(conj(hvj[i] - eigj * vj[i]) * (hvj[i] - eigj * vj[i]));
+      }
+      rnorm[j] = sqrt(SumMPI_d(dnorm));
+    }
+
+    nconv = 0;
+    rmax = 0.0;
+    for (j = 0; j < nvec; j++) {
+      if (rnorm[j] < eps_LOBPCG) nconv++;
+      if (rnorm[j] > rmax) rmax = rnorm[j];
+    }
+    if (childfopenMPI(sdt, "a", &fp) == 0) {
+      fprintf(fp, "stp=%d %d %.5e", stp, nconv, rmax);
+      for (j = 0; j < nvec; j++) fprintf(fp, " %.10lf", eig[j]);
+      fprintf(fp, "\n");
+      fclose(fp);
+    }
+    fprintf(stdoutMPI, cLogLOBPCGStep, stp, nconv, nvec, rmax, eig[0]);
+    if (nconv == nvec) {
+      iconv = 0;
+      break;
+    }
+    /*
+     Soft locking: only the unconverged columns get P and W.
+     P of the previous step is packed into the columns m, ..., m+np-1.
+    */
+    nw = 0;
+    for (j = 0; j < m; j++) {
+      if (rnorm[j] >= eps_LOBPCG) active[nw++] = j;
+    }
+    if (np > 0) {
+      np = nw;
+      for (jj = 0; jj < nw; jj++) {
+        if (active[jj] == jj) continue;
+        memmove(V + lld * (m + jj), V + lld * (m + active[jj]), sizeof(double complex) * lld);
+        memmove(HV + lld * (m + jj), HV + lld * (m + active[jj]), sizeof(double complex) * lld);
+      }
+    }
+    for (jj = 0; jj < nw; jj++) {
+      j = active[jj];
+      vj = V + lld * j;
+      hvj = HV + lld * j;
+      wj = V + lld * (m + np + jj);
+      eigj = eig[j];
+#pragma omp parallel for default(none) private(i, dtmp) shared(vj, hvj, wj, list_Diagonal) \
+  firstprivate(i_max, eigj)
+      for (i = 1; i <= i_max; i++) {
+        dtmp = fabs(list_Diagonal[i] - eigj);
+        if (dtmp < D_LOBPCGShift) dtmp = D_LOBPCGShift;
+        wj[i] = (hvj[i] - eigj * vj[i]) / dtmp;
+      }
+      hvj = HV + lld * (m + np + jj);
+#pragma omp parallel for default(none) private(i) shared(hvj) firstprivate(i_max)
+      for (i = 1; i <= i_max; i++) hvj[i] = 0.0;
+      mltply(X, hvj, wj);
+      nmltply++;
+    }
+    /*
+     Rayleigh-Ritz in [X, P, W]. P is dropped if the basis is linearly dependent.
+    */
+    k = m + np + nw;
+    LOBPCG_Gram(k, nrow, ld, V, HV, gram, hsub, ovl);
+    r = LOBPCG_RayleighRitz(k, m, hsub, ovl, eig, coef);
+    if (r < m && np > 0) {
+      for (jj = 0; jj < nw; jj++) {
+        memmove(V + lld * (m + jj), V + lld * (m + np + jj), sizeof(double complex) * lld);
+        memmove(HV + lld * (m + jj), HV + lld * (m + np + jj), sizeof(double complex) * lld);
+      }
+      np = 0;
+      k = m + nw;
+      LOBPCG_Gram(k, nrow, ld, V, HV, gram, hsub, ovl);
+      r = LOBPCG_RayleighRitz(k, m, hsub, ovl, eig, coef);
+    }
+    if (r < m) {
+      fprintf(stdoutMPI, cErrLOBPCGBasis, stp);
+      iconv = -1;
+    }
+    if (iconv != 1) break;
+    LOBPCG_Update(k, m, nrow, ld, coef, V, T);
+    LOBPCG_Update(k, m, nrow, ld, coef, HV, T);
+    np = m;
+  }/*for (; iconv == 1 && stp <= X->Def.Lanczos_max; stp++)*/
+
+  fprintf(stdoutMPI, cLogLOBPCGMltply, stp, nmltply);
+
+  i_free1(active, m);
+  d_free1(rnorm, m);
+  c_free1(gram, 2 * 9 * m * m);
+  c_free1(coef, 3 * m * m);
+  c_free2(hsub, 3 * m, 3 * m);
+  c_free2(ovl, 3 * m, 3 * m);
+  return iconv;
+}
+
+/**
+ * @brief Output of the lowest @p nvec states in the columns of @p V.
+ * The energies of all the states are written to the energy file, and the
+ * Green's functions are calculated for the exct-th state.
+ * Also used by the thick-restart Lanczos method (CalcEigenVec=3).
+ *
+ * @param[in,out] X CalcStruct list for getting and pushing calculation information
+ * @param[in] nvec Number of the states
+ * @param[in] lld Leading dimension of @p V (idim_max+1)
+ * @param[in] V Block of the eigenvectors. It is freed here, before the Green's functions are calculated.
+ * @param[in] eig [nvec] Eigenvalues, or NULL to keep Phys.Target_energy
+ * @retval TRUE normally finished
+ */
+int Output_EigenBlock(
+  struct EDMainCalStruct *X,
+  int nvec,
+  long int lld,
+  double complex *V,
+  double *eig
+)
+{
+  char sdt[D_FileNameMax];
+  FILE *fp;
+  int ist, k_exct;
+  long int i, i_max;
+  double *ene, *dbl, *sz, *var;
+  double complex *vj;
+
+  i_max = X->Bind.Check.idim_max;
+  k_exct = X->Bind.Def.k_exct;
+  if (k_exct > nvec) k_exct = nvec;
+  /*
+   Energies of all the states
+  */
+  d_malloc1(ene, nvec);
+  d_malloc1(dbl, nvec);
+  d_malloc1(sz, nvec);
+  d_malloc1(var, nvec);
+  for (ist = 0; ist < nvec; ist++) {
+    vj = V + lld * ist;
+#pragma omp parallel for default(none) private(i) shared(v0, vj) firstprivate(i_max)
+    for (i = 1; i <= i_max; i++) v0[i] = vj[i];
+    expec_energy(&(X->Bind));
+    ene[ist] = X->Bind.Phys.energy;
+    dbl[ist] = X->Bind.Phys.doublon;
+    sz[ist] = X->Bind.Phys.sz;
+    var[ist] = fabs(X->Bind.Phys.var - ene[ist] * ene[ist]) / fabs(X->Bind.Phys.var);
+    fprintf(stdoutMPI, "  i=%5d Energy=%.14e var=%.14e\n", ist, ene[ist], var[ist]);
+
+    if (X->Bind.Def.iOutputEigenVec == TRUE) {
+      sprintf(sdt, cFileNameOutputEigen, X->Bind.Def.CDataFileHead, ist, myrank);
+      if (childfopenALL(sdt, "wb", &fp) != 0) {
+        exitMPI(-1);
+      }
+      fwrite(&X->Bind.Check.idim_max, sizeof(X->Bind.Check.idim_max), 1, fp);
+      fwrite(vj, sizeof(complex double), X->Bind.Check.idim_max + 1, fp);
+      fclose(fp);
+    }
+  }
+  // v1 is the exct-th eigen vector
+  vj = V + lld * (k_exct - 1);
+#pragma omp parallel for default(none) private(i) shared(v1, vj) firstprivate(i_max)
+  for (i = 1; i <= i_max; i++) v1[i] = vj[i];
+  free(V);
+  if (eig != NULL) X->Bind.Phys.Target_energy = eig[k_exct - 1];
+  X->Bind.Phys.energy = ene[k_exct - 1];
+  X->Bind.Phys.doublon = dbl[k_exct - 1];
+  X->Bind.Phys.sz = sz[k_exct - 1];
+
+  if(!expec_cisajs(&(X->Bind), v1)==0){
+    fprintf(stderr, "Error: calc OneBodyG.\n");
+    exitMPI(-1);
+  }
+
+  if(!expec_cisajscktaltdc(&(X->Bind), v1)==0){
+    fprintf(stderr, "Error: calc TwoBodyG.\n");
+    exitMPI(-1);
+  }
+
+  if(!expec_totalSz(&(X->Bind), v1)==0){
+    fprintf(stderr, "Error: calc TotalSz.\n");
+    exitMPI(-1);
+  }
+
+  sprintf(sdt, cFileNameEnergy_Lanczos, X->Bind.Def.CDataFileHead);
+  if(childfopenMPI(sdt, "w", &fp)!=0){
+    exitMPI(-1);
+  }
+  for (ist = 0; ist < nvec; ist++) {
+    fprintf(fp, "State %d\n", ist);
+    fprintf(fp, "  Energy  %.16lf \n", ene[ist]);
+    fprintf(fp, "  Doublon  %.16lf \n", dbl[ist]);
+    fprintf(fp, "  Sz  %.16lf \n", sz[ist]);
+    fprintf(fp, "\n");
+  }
+  fclose(fp);
+
+  d_free1(ene, nvec);
+  d_free1(dbl, nvec);
+  d_free1(sz, nvec);
+  d_free1(var, nvec);
+  return TRUE;
+}
+
+/**
+ * @brief Calculate the lowest nvec eigenvalues and eigenvectors by the LOBPCG
+ * method starting from the random block and @p nguess initial guesses.
+ * The energies of all the states are written to the energy file, and the
+ * Green's functions are calculated for the exct-th state.
+ *
+ * @param[in,out] X CalcStruct list for getting and pushing calculation information
+ * @param[in] nguess Number of the initial guesses
+ * @param[in] lldguess Leading dimension of @p Vguess
+ * @param[in] Vguess [nguess columns] Initial guesses, or NULL. It is freed here, before the iteration.
+ * @retval TRUE normally finished
+ * @retval FALSE not converged or the memory is not enough
+ */
+int CalcByLOBPCG_Guess(
+                       struct EDMainCalStruct *X,
+                       int nguess,
+                       long int lldguess,
+                       double complex *Vguess
+                       )
+{
+  int m, nvec, iret, ld, j;
+  long int i_max, lld;
+  unsigned long int i_max_tmp;
+  double dmem;
+  double *eig;
+  double complex *V, *HV, *T;
+
+  i_max = X->Bind.Check.idim_max;
+  lld = i_max + 1;
+  i_max_tmp = SumMPI_li(i_max);
+  nvec = X->Bind.Def.nvec;
+  if (i_max_tmp < (unsigned long int)nvec) nvec = (int)i_max_tmp;
+  m = (X->Bind.Def.LOBPCGBlock > nvec) ? X->Bind.Def.LOBPCGBlock : nvec;
+  if (i_max_tmp < (unsigned long int)m) m = (int)i_max_tmp;
+
+  TimeKeeper(&(X->Bind), cFileNameTimeKeep, cLOBPCGStart, "a");
+  dmem = 7.0 * m * lld * sizeof(double complex) / pow(10, 9);
+  fprintf(stdoutMPI, cLogLOBPCGStart, nvec, m, 7 * m, dmem);
+  /*
+   V = [X, P, W], HV = H*V, T for the update
+  */
+  ld = (int)lld;
+  iret = 0;
+  if (lld > INT_MAX) iret = 1;
+  V = NULL;
+  HV = NULL;
+  T = NULL;
+  if (iret == 0) {
+    V = (double complex *)malloc(sizeof(double complex) * 3 * m * lld);
+    HV = (double complex *)malloc(sizeof(double complex) * 3 * m * lld);
+    T = (double complex *)malloc(sizeof(double complex) * m * lld);
+    if (V == NULL || HV == NULL || T == NULL) iret = 1;
+  }
+  if (SumMPI_i(iret) != 0) {
+    fprintf(stdoutMPI, cErrLOBPCGMalloc, 7 * m, dmem);
+    free(V);
+    free(HV);
+    free(T);
+    free(Vguess);
+    return FALSE;
+  }
+  /*
+   The guesses go to the columns after the random block
+  */
+  if (nguess > 2 * m) nguess = 2 * m;
+  for (j = 0; j < nguess; j++) {
+    memcpy(V + lld * (m + j), Vguess + lldguess * j, sizeof(double complex) * lld);
+  }
+  free(Vguess);
+
+  d_malloc1(eig, m);
+  iret = LOBPCG_Main(&(X->Bind), m, nvec, nguess, ld, V, HV, T, eig);
+  free(HV);
+  free(T);
+  if (iret != 0) {
+    if (iret == 1) fprintf(stdoutMPI, "%s", cLogLOBPCGNotConverged);
+    free(V);
+    d_free1(eig, m);
+    return FALSE;
+  }
+  TimeKeeper(&(X->Bind), cFileNameTimeKeep, cLOBPCGFinish, "a");
+  fprintf(stdoutMPI, "%s", cLogLOBPCGEnd);
+  Output_EigenBlock(X, nvec, lld, V, eig);
+  d_free1(eig, m);
+  return TRUE;
+}
+
+/**
+ * @brief A main function to calculate the lowest nvec eigenvalues and
+ * eigenvectors by the LOBPCG method (CalcEigenVec=2).
+ * The energies of all the states are written to the energy file, and the
+ * Green's functions are calculated for the exct-th state.
+ *
+ * @param[in,out] X CalcStruct list for getting and pushing calculation information
+ * @retval TRUE normally finished
+ * @retval FALSE not converged or the memory is not enough
+ */
+int CalcByLOBPCG(
+                 struct EDMainCalStruct *X
+                 )
+{
+  return CalcByLOBPCG_Guess(X, 0, 0, NULL);
+}
@@ -18,11 +18,15 @@
 #include "expec_totalspin.h"
 #include "CG_EigenVector.h"
 #include "expec_energy.h"
+#include "mltply.h"
 #include "Lanczos_EigenValue.h"
 #include "Lanczos_EigenVector.h"
 #include "CalcByLanczos.h"
+#include "CalcByLOBPCG.h"
+#include "CalcByTRLanczos.h"
 #include "FileIO.h"
 #include "wrapperMPI.h"
+#include "mfmemory.h"
 
 /**
  * @file   CalcByLanczos.c
@@ -36,6 +40,99 @@
  */
 
 
+/**
+ * @brief Residual |H v - E v| of a normalized vector, with E = <v|H|v>.
+ * v0 and v1 are used as work vectors.
+ *
+ * @param[in,out] X
+ * @param[in] vj the vector
+ * @return the norm of the residual vector
+ */
+static double CalcByLanczos_Residual(
+  struct BindStruct *X,
+  double complex *vj
+)
+{
+  long int i, i_max;
+  double ene, dnorm;
+
+  i_max = X->Check.idim_max;
+#pragma omp parallel for default(none) private(i) shared(v0, v1, vj) firstprivate(i_max)
+  for (i = 1; i <= i_max; i++) {
+    v0[i] = 0.0;
+    v1[i] = vj[i];
+  }
+  mltply(X, v0, v1);
+  ene = creal(X->Large.prdct);
+  dnorm = 0.0;
+#pragma omp parallel for default(none) reduction(+:dnorm) private(i) shared(v0, v1) firstprivate(i_max, ene)
+  for (i = 1; i <= i_max; i++) {
+    dnorm += creal(conj(v0[i] - ene * v1[i]) * (v0[i] - ene * v1[i]));
+  }
+  return sqrt(SumMPI_d(dnorm));
+}
+
+/**
+ * @brief Calculate the lowest @p nstate eigenvectors from the Lanczos vectors
+ * (CalcEigenVec=1 and nvec > 1) and output them as CalcByLOBPCG does.
+ * If one of them is not converged to the criterion of the LOBPCG method, or
+ * @p nstate is smaller than nvec, the nvec states are calculated by the LOBPCG
+ * method starting from them.
+ *
+ * @param[in,out] X CalcStruct list for getting and pushing calculation information
+ * @param[in] nstate Number of the eigenvectors
+ * @retval 0 normally finished
+ * @retval 1 the eigenvectors can not be allocated
+ * @retval -1 the LOBPCG method failed
+ */
+static int CalcByLanczos_Block(
+  struct EDMainCalStruct *X,
+  int nstate
+)
+{
+  int ist, nfail;
+  long int lld;
+  double eps_LOBPCG, rnorm, rmax;
+  double complex *V;
+
+  lld = X->Bind.Check.idim_max + 1;
+  c_malloc1(V, lld * nstate);
+  if (MaxMPI_li(V == NULL) != 0) {
+    fprintf(stdoutMPI, cLogLanczosBlockMalloc, nstate,
+            MaxMPI_li(lld) * nstate * 16.0 / pow(10, 9));
+    if (V != NULL) free(V);
+    return 1;
+  }
+  fprintf(stdoutMPI, cLogLanczosBlock, nstate);
+  Lanczos_EigenVectorBlock(&(X->Bind), nstate, lld, V);
+  fprintf(stdoutMPI, cLogLanczos_EigenVecEnd);
+  /*
+    The Lanczos vectors are not reorthogonalized, so that the excited states
+    can be far from the eigenvectors.
+  */
+  eps_LOBPCG = pow(10.0, -0.5 * X->Bind.Def.LanczosEps);
+  nfail = 0;
+  rmax = 0.0;
+  for (ist = 0; ist < nstate; ist++) {
+    rnorm = CalcByLanczos_Residual(&(X->Bind), V + lld * ist);
+    fprintf(stdoutMPI, cLogLanczosBlockResidual, ist, rnorm);
+    if (rnorm >= eps_LOBPCG) nfail++;
+    if (rnorm > rmax) rmax = rnorm;
+  }
+  if (nstate < X->Bind.Def.nvec) {
+    fprintf(stdoutMPI, cLogLanczosBlockCap, nstate, X->Bind.Def.nvec);
+  }
+  else if (nfail > 0) {
+    fprintf(stdoutMPI, cLogLanczosBlockRefine, nfail, nstate, rmax, eps_LOBPCG);
+  }
+  else {
+    Output_EigenBlock(X, nstate, lld, V, NULL);
+    return 0;
+  }
+  if (CalcByLOBPCG_Guess(X, nstate, lld, V) != TRUE) return -1;
+  return 0;
+}
+
 /** 
  * @brief A main function to calculate eigenvalues and eigenvectors by Lanczos method 
  * 
@@ -58,8 +155,16 @@ int CalcByLanczos(
   double diff_ene,var;
   long int i;
   long int i_max=0;
+  int nstate, iret;
   FILE *fp;
   
+  if(X->Bind.Def.iInputEigenVec==FALSE && X->Bind.Def.iCalcEigenVec==CALCVEC_LOBPCG){
+    return CalcByLOBPCG(X);
+  }
+  if(X->Bind.Def.iInputEigenVec==FALSE && X->Bind.Def.iCalcEigenVec==CALCVEC_TRLANCZOS){
+    return CalcByTRLanczos(X);
+  }
+
   if(X->Bind.Def.iInputEigenVec==FALSE){
     // this part will be modified
     switch(X->Bind.Def.iCalcModel){
@@ -103,6 +208,18 @@ int CalcByLanczos(
     fprintf(stdoutMPI, cLogLanczos_EigenVecStart);
 //    printf("debug: X->Bind.Check.idim_maxMPI=%d\n", X->Bind.Check.idim_maxMPI);
 
+    /*
+      Several eigenvectors; E[1], ..., E[4] are calculated by Lanczos_EigenValue
+    */
+    nstate = X->Bind.Def.nvec;
+    if (nstate > X->Bind.Large.itr) nstate = X->Bind.Large.itr;
+    if (nstate > 4) nstate = 4;
+    if(X->Bind.Check.idim_maxMPI != 1 && X->Bind.Def.iCalcEigenVec==CALCVEC_LANCZOS && nstate > 1){
+      iret = CalcByLanczos_Block(X, nstate);
+      if (iret == 0) return TRUE;
+      else if (iret < 0) return FALSE;
+    }
+
     if(X->Bind.Check.idim_maxMPI != 1){
       Lanczos_EigenVector(&(X->Bind));
       expec_energy(&(X->Bind));
@@ -19,20 +19,527 @@
 #include "expec_cisajs.h"
 #include "expec_cisajscktaltdc.h"
 #include "CalcByTPQ.h"
+#include "bitcalc.h"
+#include "mltply.h"
+#include "mltplyFused.h"
+#include "mfmemory.h"
 #include "FileIO.h"
 #include "wrapperMPI.h"
 
-/** 
- * 
- * 
- * @param NumAve 
- * @param ExpecInterval 
- * @param X 
- * 
+/*
+  The two TPQ vectors are stored in one of the following precisions.
+  The random numbers and the output files are the same for all of them.
+*/
+#define TPQVEC_COMPLEX 0 /*!< double complex: v0 and v1 (FirstMultiply, Multiply, expec_energy)*/
+#define TPQVEC_REAL 1 /*!< double: real couplings and a real initial vector, H*v by mltply_real*/
+#define TPQVEC_SINGLE 2 /*!< float complex (TPQPrecision=1): H*v by mltply_fused_sp, reductions in double*/
+
+/**
+ * @brief Tolerance of |<v|v>-1| for the stored single-precision TPQ vector.
+ * The vector is normalized again if it is exceeded.
+ */
+#define D_TPQSingleNormEps 1.0e-5
+
+/**
+ * @brief TPQ vectors: tmp_v0 is the next TPQ vector (H*tmp_v1 during a step),
+ * tmp_v1 is the current one. Only the pair of iType is allocated;
+ * for TPQVEC_COMPLEX they are v0 and v1.
+ */
+struct TPQVecStruct {
+  int iType; /**< TPQVEC_COMPLEX, TPQVEC_REAL or TPQVEC_SINGLE*/
+  double *r0; /**< tmp_v0 of TPQVEC_REAL*/
+  double *r1; /**< tmp_v1 of TPQVEC_REAL*/
+  float complex *f0; /**< tmp_v0 of TPQVEC_SINGLE*/
+  float complex *f1; /**< tmp_v1 of TPQVEC_SINGLE*/
+};
+
+/**
+ * @brief Select the precision of the TPQ vectors and allocate them.
+ * Vectors are not allocated in setmem_large if they may be real or single precision.
+ * The reason is written when the requested precision can not be used.
+ *
+ * @param X
+ * @param V [out] TPQ vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 the vectors can not be allocated
+ */
+static int tpq_VecInit(struct BindStruct *X, struct TPQVecStruct *V)
+{
+  long unsigned int i_max;
+  const char *cReason;
+
+  i_max = X->Check.idim_max;
+  V->r0 = NULL;
+  V->r1 = NULL;
+  V->f0 = NULL;
+  V->f1 = NULL;
+  if (v0 != NULL) {
+    /*InitialVecType=0 or MPI: complex vectors are allocated in setmem_large*/
+    V->iType = TPQVEC_COMPLEX;
+    cReason = mltply_real_Reason(X);
+    if (cReason != NULL) fprintf(stdoutMPI, cLogTPQComplex, cReason);
+    return 0;
+  }
+
+  if (X->Def.iTPQPrecision == TPQ_MIXED) {
+    if (X->Large.iFlgFused == TRUE && nproc == 1) {
+      V->iType = TPQVEC_SINGLE;
+      V->f0 = (float complex*)malloc((i_max + 1)*sizeof(float complex));
+      V->f1 = (float complex*)malloc((i_max + 1)*sizeof(float complex));
+      if (V->f0 == NULL || V->f1 == NULL) {
+        fprintf(stdoutMPI, "%s", cErrTPQMalloc);
+        return -1;
+      }
+      fprintf(stdoutMPI, "%s", cLogTPQSingle);
+      return 0;
+    }
+    fprintf(stdoutMPI, "%s", cLogTPQSingleOff);
+  }
+
+  cReason = mltply_real_Reason(X);
+  if (cReason == NULL) {
+    V->iType = TPQVEC_REAL;
+    d_malloc1(V->r0, i_max + 1);
+    d_malloc1(V->r1, i_max + 1);
+    if (V->r0 == NULL || V->r1 == NULL) {
+      fprintf(stdoutMPI, "%s", cErrTPQMalloc);
+      return -1;
+    }
+    fprintf(stdoutMPI, "%s", cLogTPQReal);
+    return 0;
+  }
+
+  V->iType = TPQVEC_COMPLEX;
+  fprintf(stdoutMPI, cLogTPQComplex, cReason);
+  c_malloc1(v0, i_max + 1);
+  c_malloc1(v1, i_max + 1);
+  if (v0 == NULL || v1 == NULL) {
+    fprintf(stdoutMPI, "%s", cErrTPQMalloc);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Free the real or single-precision TPQ vectors.
+ *
+ * @param X
+ * @param V [in,out] TPQ vectors
+ */
+static void tpq_VecFree(struct BindStruct *X, struct TPQVecStruct *V)
+{
+  if (V->r0 != NULL) d_free1(V->r0, X->Check.idim_max + 1);
+  if (V->r1 != NULL) d_free1(V->r1, X->Check.idim_max + 1);
+  free(V->f0);
+  free(V->f1);
+}
+
+/**
+ * @brief Norm of tmp_v0 (@p iv = 0) or tmp_v1 (@p iv = 1), accumulated in double.
+ * Only for TPQVEC_REAL and TPQVEC_SINGLE.
+ *
+ * @param X
+ * @param V TPQ vectors
+ * @param iv 0 or 1
+ *
+ * @return norm
+ */
+static double tpq_Norm(struct BindStruct *X, struct TPQVecStruct *V, int iv)
+{
+  long unsigned int i, i_max;
+  double dnorm;
+  double *tmp_r;
+  float complex *tmp_f;
+
+  i_max = X->Check.idim_max;
+  dnorm = 0.0;
+  if (V->iType == TPQVEC_REAL) {
+    tmp_r = (iv == 0) ? V->r0 : V->r1;
+#pragma omp parallel for default(none) private(i) shared(tmp_r) firstprivate(i_max) reduction(+: dnorm)
+    for (i = 1; i <= i_max; i++) {
+      dnorm += tmp_r[i] * tmp_r[i];
+    }
+  }
+  else {
+    tmp_f = (iv == 0) ? V->f0 : V->f1;
+#pragma omp parallel for default(none) private(i) shared(tmp_f) firstprivate(i_max) reduction(+: dnorm)
+    for (i = 1; i <= i_max; i++) {
+      dnorm += creal(conj((double complex)tmp_f[i]) * (double complex)tmp_f[i]);
+    }
+  }
+  return sqrt(dnorm);
+}
+
+/**
+ * @brief Normalize tmp_v0 (@p iv = 0) or tmp_v1 (@p iv = 1).
+ * Only for TPQVEC_REAL and TPQVEC_SINGLE.
+ *
+ * @param X
+ * @param V [in,out] TPQ vectors
+ * @param iv 0 or 1
+ *
+ * @return norm before the normalization
+ */
+static double tpq_Normalize(struct BindStruct *X, struct TPQVecStruct *V, int iv)
+{
+  long unsigned int i, i_max;
+  double dnorm;
+  double *tmp_r;
+  float complex *tmp_f;
+
+  i_max = X->Check.idim_max;
+  dnorm = tpq_Norm(X, V, iv);
+  if (V->iType == TPQVEC_REAL) {
+    tmp_r = (iv == 0) ? V->r0 : V->r1;
+#pragma omp parallel for default(none) private(i) shared(tmp_r) firstprivate(i_max, dnorm)
+    for (i = 1; i <= i_max; i++) {
+      tmp_r[i] = tmp_r[i] / dnorm;
+    }
+  }
+  else {
+    tmp_f = (iv == 0) ? V->f0 : V->f1;
+#pragma omp parallel for default(none) private(i) shared(tmp_f) firstprivate(i_max, dnorm)
+    for (i = 1; i <= i_max; i++) {
+      tmp_f[i] = (float complex)((double complex)tmp_f[i] / dnorm);
+    }
+  }
+  return dnorm;
+}
+
+/**
+ * @brief tmp_v0 += H*tmp_v1 in the precision of the vectors.
+ *
+ * @param X
+ * @param V [in,out] TPQ vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+static int tpq_Mltply(struct BindStruct *X, struct TPQVecStruct *V)
+{
+  long unsigned int irght, ilft, ihfbit;
+
+  switch (V->iType) {
+  case TPQVEC_REAL:
+    return mltply_real(X, 1.0, V->r0, V->r1);
+  case TPQVEC_SINGLE:
+    if (GetSplitBitByModel(X->Def.Nsite, X->Def.iCalcModel, &irght, &ilft, &ihfbit) != 0) {
+      return -1;
+    }
+    X->Large.i_max = X->Check.idim_max;
+    X->Large.irght = irght;
+    X->Large.ilft = ilft;
+    X->Large.ihfbit = ihfbit;
+    X->Large.mode = M_MLTPLY;
+    return mltply_fused_sp(X, V->f0, V->f1);
+  default:
+    return mltply(X, v0, v1);
+  }
+}
+
+/**
+ * @brief One TPQ step: tmp_v0 = (l-H/Ns) tmp_v1 / |...|. On entry tmp_v0 must be H*tmp_v1.
+ * The norm is stored in global_norm.
+ *
+ * @param X
+ * @param V [in,out] TPQ vectors
+ */
+static void tpq_Multiply(struct BindStruct *X, struct TPQVecStruct *V)
+{
+  long unsigned int i, i_max;
+  double Ns;
+  double *tmp_r0, *tmp_r1;
+  float complex *tmp_f0, *tmp_f1;
+
+  if (V->iType == TPQVEC_COMPLEX) {
+    Multiply(X);
+    return;
+  }
+  i_max = X->Check.idim_max;
+  Ns = 1.0*X->Def.NsiteMPI;
+  if (V->iType == TPQVEC_REAL) {
+    tmp_r0 = V->r0;
+    tmp_r1 = V->r1;
+#pragma omp parallel for default(none) private(i) shared(tmp_r0, tmp_r1) firstprivate(i_max, Ns, LargeValue)
+    for (i = 1; i <= i_max; i++) {
+      tmp_r0[i] = LargeValue*tmp_r1[i] - tmp_r0[i] / Ns;
+    }
+  }
+  else {
+    tmp_f0 = V->f0;
+    tmp_f1 = V->f1;
+#pragma omp parallel for default(none) private(i) shared(tmp_f0, tmp_f1) firstprivate(i_max, Ns, LargeValue)
+    for (i = 1; i <= i_max; i++) {
+      tmp_f0[i] = (float complex)(LargeValue*(double complex)tmp_f1[i] - (double complex)tmp_f0[i] / Ns);
+    }
+  }
+  global_norm = tpq_Normalize(X, V, 0);
+}
+
+/**
+ * @brief Random initial vector tmp_v1 and the first TPQ vector tmp_v0.
+ * The random numbers are the same as those of FirstMultiply.
+ *
+ * @param rand_i index of the sample
+ * @param X
+ * @param V [out] TPQ vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+static int tpq_FirstMultiply(int rand_i, struct BindStruct *X, struct TPQVecStruct *V)
+{
+  long unsigned int i, i_max;
+  long unsigned int u_long_i;
+  dsfmt_t dsfmt;
+  int mythread, iType, iInitialVecType;
+  double dre, dim;
+  double *tmp_r0, *tmp_r1;
+  float complex *tmp_f0, *tmp_f1;
+
+  if (V->iType == TPQVEC_COMPLEX) return FirstMultiply(rand_i, X);
+
+  i_max = X->Check.idim_max;
+  iType = V->iType;
+  iInitialVecType = X->Def.iInitialVecType;
+  tmp_r0 = V->r0;
+  tmp_r1 = V->r1;
+  tmp_f0 = V->f0;
+  tmp_f1 = V->f1;
+#pragma omp parallel default(none) private(i, mythread, u_long_i, dsfmt, dre, dim) \
+        shared(tmp_r0, tmp_r1, tmp_f0, tmp_f1, nthreads, myrank, rand_i, X, stdoutMPI, cLogCheckInitComplex, cLogCheckInitReal) \
+        firstprivate(i_max, iType, iInitialVecType)
+  {
+#ifdef _OPENMP
+    mythread = omp_get_thread_num();
+#else
+    mythread = 0;
+#endif
+    u_long_i = 123432 + (rand_i + 1)*labs(X->Def.initial_iv) + mythread + nthreads * myrank;
+    dsfmt_init_gen_rand(&dsfmt, u_long_i);
+
+#pragma omp master
+    fprintf(stdoutMPI, "%s", (iInitialVecType == 0) ? cLogCheckInitComplex : cLogCheckInitReal);
+
+#pragma omp for
+    for (i = 1; i <= i_max; i++) {
+      dre = 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5);
+      dim = (iInitialVecType == 0) ? 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5) : 0.0;
+      if (iType == TPQVEC_REAL) {
+        tmp_r0[i] = 0.0;
+        tmp_r1[i] = dre;
+      }
+      else {
+        tmp_f0[i] = 0.0;
+        tmp_f1[i] = (float complex)(dre + dim*I);
+      }
+    }
+  }
+  global_1st_norm = tpq_Normalize(X, V, 1);
+
+  TimeKeeperWithStep(X, cFileNameTimeKeep, cTPQStep, "a", step_i);
+
+  if (tpq_Mltply(X, V) != 0) return -1;
+  tpq_Multiply(X, V);
+
+  TimeKeeperWithStep(X, cFileNameTimeKeep, cTPQStepEnd, "a", step_i);
+  return 0;
+}
+
+/**
+ * @brief Counterpart of expec_energy: the physical quantities of tmp_v0,
+ * then tmp_v1 = tmp_v0 and tmp_v0 = H*tmp_v1. Energy and variance are reduced in double.
+ * The real and single-precision vectors are used with one process only.
+ *
+ * @param X
+ * @param V [in,out] TPQ vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+static int tpq_Energy(struct BindStruct *X, struct TPQVecStruct *V)
+{
+  long unsigned int i, j, i_max, ibit, upmask, downmask;
+  int isite, iGC, iType, Nsite;
+  double tmp_v02, tmp_doublon, tmp_num_up, tmp_num_down;
+  double complex dam_pr, dam_pr1, dv0;
+  double *tmp_r0, *tmp_r1;
+  float complex *tmp_f0, *tmp_f1;
+
+  if (V->iType == TPQVEC_COMPLEX) return expec_energy(X);
+
+  i_max = X->Check.idim_max;
+  iType = V->iType;
+  Nsite = X->Def.Nsite;
+  tmp_r0 = V->r0;
+  tmp_r1 = V->r1;
+  tmp_f0 = V->f0;
+  tmp_f1 = V->f1;
+
+  /*
+    Doublon and number of electrons from the weights |tmp_v0[j]|^2 of the states
+  */
+  switch (X->Def.iCalcModel) {
+  case HubbardGC:
+  case KondoGC:
+  case Hubbard:
+  case Kondo:
+  case SpinGC:
+    iGC = (X->Def.iCalcModel == HubbardGC || X->Def.iCalcModel == SpinGC);
+    if (X->Def.iCalcModel == SpinGC) {
+      upmask = X->Def.Tpow[Nsite - 1] * 2 - 1;
+      downmask = 0;
+    }
+    else {
+      upmask = 0;
+      for (isite = 1; isite <= Nsite; isite++) upmask += X->Def.Tpow[2 * isite - 2];
+      downmask = upmask << 1;
+    }
+    tmp_doublon = 0.0;
+    tmp_num_up = 0.0;
+    tmp_num_down = 0.0;
+#pragma omp parallel for default(none) reduction(+:tmp_doublon, tmp_num_up, tmp_num_down) private(j, ibit, tmp_v02) \
+  shared(tmp_r0, tmp_f0, list_1) firstprivate(i_max, iGC, iType, Nsite, upmask, downmask)
+    for (j = 1; j <= i_max; j++) {
+      ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+      if (iType == TPQVEC_REAL) tmp_v02 = tmp_r0[j] * tmp_r0[j];
+      else tmp_v02 = creal(conj((double complex)tmp_f0[j]) * (double complex)tmp_f0[j]);
+      if (downmask == 0) {
+        /*SpinGC: up and down spins*/
+        tmp_num_up += tmp_v02 * PopCountBit(ibit & upmask);
+        tmp_num_down += tmp_v02 * (Nsite - PopCountBit(ibit & upmask));
+      }
+      else {
+        tmp_doublon += tmp_v02 * PopCountBit(ibit & upmask & (ibit >> 1));
+        tmp_num_up += tmp_v02 * PopCountBit(ibit & upmask);
+        tmp_num_down += tmp_v02 * PopCountBit(ibit & downmask);
+      }
+    }
+    X->Phys.doublon = tmp_doublon;
+    X->Phys.num_up = tmp_num_up;
+    X->Phys.num_down = tmp_num_down;
+    X->Phys.num = tmp_num_up + tmp_num_down;
+    break;
+
+  case Spin:
+    X->Phys.num_up = X->Def.Nup;
+    X->Phys.num_down = X->Def.Ndown;
+    X->Phys.num = X->Def.Nup + X->Def.Ndown;
+    X->Phys.doublon = 0.0;
+    break;
+
+  default:
+    return -1;
+  }
+
+  /*
+    tmp_v1 = tmp_v0, tmp_v0 = H*tmp_v1
+  */
+  if (iType == TPQVEC_REAL) {
+#pragma omp parallel for default(none) private(i) shared(tmp_r0, tmp_r1) firstprivate(i_max)
+    for (i = 1; i <= i_max; i++) {
+      tmp_r1[i] = tmp_r0[i];
+      tmp_r0[i] = 0.0;
+    }
+  }
+  else {
+#pragma omp parallel for default(none) private(i) shared(tmp_f0, tmp_f1) firstprivate(i_max)
+    for (i = 1; i <= i_max; i++) {
+      tmp_f1[i] = tmp_f0[i];
+      tmp_f0[i] = 0.0;
+    }
+  }
+  if (tpq_Mltply(X, V) != 0) return -1;
+
+  dam_pr = 0.0;
+  dam_pr1 = 0.0;
+  if (iType == TPQVEC_REAL) {
+#pragma omp parallel for default(none) reduction(+:dam_pr, dam_pr1) private(j) shared(tmp_r0, tmp_r1) firstprivate(i_max)
+    for (j = 1; j <= i_max; j++) {
+      dam_pr += tmp_r1[j] * tmp_r0[j];  // E   = <v1|H|v1>=<v1|v0>
+      dam_pr1 += tmp_r0[j] * tmp_r0[j]; // E^2 = <v1|H*H|v1>=<v0|v0>
+    }
+  }
+  else {
+#pragma omp parallel for default(none) reduction(+:dam_pr, dam_pr1) private(j, dv0) shared(tmp_f0, tmp_f1) firstprivate(i_max)
+    for (j = 1; j <= i_max; j++) {
+      dv0 = (double complex)tmp_f0[j];
+      dam_pr += conj((double complex)tmp_f1[j]) * dv0; // E   = <v1|H|v1>=<v1|v0>
+      dam_pr1 += conj(dv0) * dv0;                      // E^2 = <v1|H*H|v1>=<v0|v0>
+    }
+  }
+  X->Phys.energy = dam_pr;
+  X->Phys.var = dam_pr1;
+  return 0;
+}
+
+/**
+ * @brief Correlation functions of tmp_v1. expec_cisajs and expec_cisajscktaltdc need
+ * a double complex vector, which is allocated only during this call for the real and
+ * single-precision vectors. The norm of the single-precision vector is checked and
+ * restored beforehand.
+ *
+ * @param X
+ * @param V [in,out] TPQ vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+static int tpq_Expec(struct BindStruct *X, struct TPQVecStruct *V)
+{
+  long unsigned int i, i_max;
+  int iType;
+  double dnorm;
+  double *tmp_r1;
+  float complex *tmp_f1;
+  double complex *tmp_vc;
+
+  if (V->iType == TPQVEC_COMPLEX) {
+    expec_cisajs(X, v1);
+    expec_cisajscktaltdc(X, v1);
+    return 0;
+  }
+
+  i_max = X->Check.idim_max;
+  if (V->iType == TPQVEC_SINGLE) {
+    dnorm = tpq_Norm(X, V, 1);
+    if (fabs(dnorm * dnorm - 1.0) > D_TPQSingleNormEps) {
+      fprintf(stdoutMPI, cLogTPQSingleNorm, fabs(dnorm * dnorm - 1.0), step_i);
+      tpq_Normalize(X, V, 1);
+    }
+  }
+
+  if (X->Def.NCisAjt == 0 && X->Def.NCisAjtCkuAlvDC == 0) return 0;
+  c_malloc1(tmp_vc, i_max + 1);
+  if (tmp_vc == NULL) {
+    fprintf(stdoutMPI, "%s", cErrTPQMalloc);
+    return -1;
+  }
+  iType = V->iType;
+  tmp_r1 = V->r1;
+  tmp_f1 = V->f1;
+#pragma omp parallel for default(none) private(i) shared(tmp_r1, tmp_f1, tmp_vc) firstprivate(i_max, iType)
+  for (i = 1; i <= i_max; i++) {
+    tmp_vc[i] = (iType == TPQVEC_REAL) ? tmp_r1[i] : (double complex)tmp_f1[i];
+  }
+  expec_cisajs(X, tmp_vc);
+  expec_cisajscktaltdc(X, tmp_vc);
+  c_free1(tmp_vc, i_max + 1);
+  return 0;
+}
+
+/**
+ *
+ *
+ * @param NumAve
+ * @param ExpecInterval
+ * @param X
+ *
  * @author Takahiro Misawa (The University of Tokyo)
  * @author Kazuyoshi Yoshimi (The University of Tokyo)
  *
- * @return 
+ * @return
  */
 int CalcBySSM(
 	    const int NumAve,
@@ -45,34 +552,39 @@ int CalcBySSM(
   int rand_i, rand_max;
   FILE *fp;
   double inv_temp, Ns;
+  struct TPQVecStruct V;
   struct TimeKeepStruct tstruct;
   tstruct.tstart=time(NULL);
-  
-  
+
+  if(tpq_VecInit(&(X->Bind), &V) != 0){
+    tpq_VecFree(&(X->Bind), &V);
+    return -1;
+  }
+
   rand_max = NumAve;
   step_spin = ExpecInterval;
   X->Bind.Def.St=0;
   fprintf(stdoutMPI, cLogTPQ_Start);
   for (rand_i = 0; rand_i<rand_max; rand_i++){
     fprintf(stdoutMPI, cLogTPQRand, rand_i+1, rand_max);
- 
+
     sprintf(sdt_phys, cFileNameSSRand, rand_i);
     if(!childfopenMPI(sdt_phys, "w", &fp)==0){
       return -1;
     }
     fprintf(fp, cLogSSRand);
     fclose(fp);
-    
+
     sprintf(sdt_norm, cFileNameNormRand, rand_i);
     if(!childfopenMPI(sdt_norm, "w", &fp)==0){
       return -1;
     }
     fprintf(fp, cLogNormRand);
     fclose(fp);
-    
-    FirstMultiply(rand_i, &(X->Bind));
-    
-    expec_energy(&(X->Bind)); //v0 = H*v1
+
+    if(tpq_FirstMultiply(rand_i, &(X->Bind), &V) != 0) return -1;
+
+    if(tpq_Energy(&(X->Bind), &V) != 0) return -1; //v0 = H*v1
 
     Ns = 1.0*X->Bind.Def.NsiteMPI;
     inv_temp = (2.0 / Ns) / (LargeValue - X->Bind.Phys.energy / Ns);
@@ -80,9 +592,8 @@ int CalcBySSM(
     X->Bind.Def.istep=step_i;
     X->Bind.Def.irand=rand_i;
 
-    expec_cisajs(&(X->Bind),v1);
-    expec_cisajscktaltdc(&(X->Bind), v1);
-    
+    if(tpq_Expec(&(X->Bind), &V) != 0) return -1;
+
     if(!childfopenMPI(sdt_phys, "a", &fp)==0){
       return -1;
     }
@@ -103,9 +614,9 @@ int CalcBySSM(
       }
       X->Bind.Def.istep=step_i;
       TimeKeeperWithStep(&(X->Bind), cFileNameTPQStep, cTPQStep, "a", step_i);
-      Multiply(&(X->Bind));
+      tpq_Multiply(&(X->Bind), &V);
       //TimeKeeperWithStep(&(X->Bind), cFileNameTimeKeep, cTPQStepEnd, "a", step_i);
-      expec_energy(&(X->Bind));
+      if(tpq_Energy(&(X->Bind), &V) != 0) return -1;
       //expec(&(X->Bind));
       inv_temp = (2.0*step_i / Ns) / (LargeValue - X->Bind.Phys.energy / Ns);
       if(!childfopenMPI(sdt_phys, "a", &fp)==0){
@@ -121,13 +632,13 @@ int CalcBySSM(
       fclose(fp);
 
       if (step_i%step_spin == 0){
-	expec_cisajs(&(X->Bind),v1);
-	expec_cisajscktaltdc(&(X->Bind), v1);
+	if(tpq_Expec(&(X->Bind), &V) != 0) return -1;
       }
     }
   }
   fprintf(stdoutMPI, cLogTPQ_End);
   tstruct.tend=time(NULL);
   fprintf(stdoutMPI, cLogTPQEnd, (int)(tstruct.tend-tstruct.tstart));
+  tpq_VecFree(&(X->Bind), &V);
   return 0;
 }
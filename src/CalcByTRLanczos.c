@@ -0,0 +1,458 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+// Thick-restart Lanczos method for the lowest nvec states (CalcEigenVec=3 in the CalcMod file)
+//
+// The Lanczos vectors q_0, ..., q_{M-1} (M = ThickRestartBasis in modpara) are
+// kept in Q and each new vector is orthogonalized twice against all of them,
+// so that no ghost eigenvalues appear. The projected Hamiltonian T = Q^dagger H Q
+// is diagonalized at every step and the residual norm of the Ritz pair i is
+// |beta_{M-1} y_i(M-1)|. When the basis is full, the lowest K Ritz vectors
+// (K = ThickRestartKeep) replace q_0, ..., q_{K-1}, the last Lanczos vector
+// becomes q_K, and T starts again from diag(theta_0, ..., theta_{K-1}).
+// The Ritz vectors are made in place, a block of rows at a time, so that the
+// memory is always M+1 vectors.
+//
+// One Krylov space holds only one vector of a degenerate eigenspace. When the
+// lowest nvec (> 1) states have converged, only their Ritz vectors are kept and the
+// method is restarted with a random vector orthogonal to them. The result is accepted when the
+// lowest nvec+1 states have converged again and the lowest nvec Ritz values are
+// the same; otherwise a missed state has been found and the check is repeated.
+
+#include <limits.h>
+#include "mfmemory.h"
+#include "matrixlapack.h"
+#include "mltply.h"
+#include "CalcByLOBPCG.h"
+#include "CalcByTRLanczos.h"
+#include "FileIO.h"
+#include "wrapperMPI.h"
+
+void zgemm_(char *TRANSA, char *TRANSB, int *M, int *N, int *K, double complex *ALPHA, double complex *matA, int *LDA, double complex *matB, int *LDB, double complex *BETA, double complex *matC, int *LDC);
+void zgemv_(char *TRANS, int *M, int *N, double complex *ALPHA, double complex *matA, int *LDA, double complex *X, int *INCX, double complex *BETA, double complex *Y, int *INCY);
+
+#define D_TRLanczosRows 1024 /*!< Number of the rows of Q rotated by one zgemm.*/
+#define D_TRLanczosBreak 1.0e-12 /*!< beta smaller than this (relative to |H q_j|) is an invariant subspace.*/
+
+/**
+ * @brief Orthogonalize @p w against the first @p k columns of @p Q twice
+ * (classical Gram-Schmidt with reorthogonalization) and return its norm.
+ *
+ * @param[in] k Number of the columns
+ * @param[in] nrow Local dimension
+ * @param[in] ld Leading dimension of @p Q (idim_max+1)
+ * @param[in] Q Lanczos vectors
+ * @param[in,out] w Vector to be orthogonalized
+ * @param[out] h [k] Q^dagger w before the orthogonalization
+ * @param htmp [k] Work array
+ *
+ * @return Norm of @p w after the orthogonalization
+ */
+static double TRLanczos_Orthogonalize(
+  int k,
+  int nrow,
+  int ld,
+  double complex *Q,
+  double complex *w,
+  double complex *h,
+  double complex *htmp
+)
+{
+  int i, itr, inc = 1;
+  long int j, i_max = nrow;
+  char transc = 'C', transn = 'N';
+  double complex one = 1.0, zero = 0.0, mone = -1.0;
+  double dnorm;
+
+  for (i = 0; i < k; i++) h[i] = 0.0;
+  for (itr = 0; itr < 2; itr++) {
+    zgemv_(&transc, &nrow, &k, &one, Q + 1, &ld, w + 1, &inc, &zero, htmp, &inc);
+    SumMPI_cv(k, htmp);
+    zgemv_(&transn, &nrow, &k, &mone, Q + 1, &ld, htmp, &inc, &one, w + 1, &inc);
+    for (i = 0; i < k; i++) h[i] += htmp[i];
+  }
+
+  dnorm = 0.0;
+#pragma omp parallel for default(none) private(j) shared(w) firstprivate(i_max) reduction(+:dnorm)
+  for (j = 1; j <= i_max; j++) {
+    dnorm += creal(conj(w[j]) * w[j]);
+  }
+  return sqrt(SumMPI_d(dnorm));
+}
+
+/**
+ * @brief Q(:, 0:nkeep-1) <- Q(:, 0:nbasis-1) Y(:, 0:nkeep-1) in place.
+ * Each block of D_TRLanczosRows rows is rotated into a work array of the thread
+ * and copied back.
+ *
+ * @param[in] nbasis Number of the Lanczos vectors
+ * @param[in] nkeep Number of the Ritz vectors
+ * @param[in] nrow Local dimension
+ * @param[in] ld Leading dimension of @p Q (idim_max+1)
+ * @param[in,out] Q Lanczos vectors
+ * @param[in] coef [nbasis*nkeep] Y (column major)
+ */
+static void TRLanczos_Rotate(
+  int nbasis,
+  int nkeep,
+  int nrow,
+  int ld,
+  double complex *Q,
+  double complex *coef
+)
+{
+  long int i, j, irow, lld = ld;
+  int nblk, nrowblk, mythread;
+  char transa = 'N', transb = 'N';
+  double complex one = 1.0, zero = 0.0;
+  double complex *work;
+
+  work = (double complex *)malloc(sizeof(double complex) * nthreads * D_TRLanczosRows * nkeep);
+  nblk = (nrow + D_TRLanczosRows - 1) / D_TRLanczosRows;
+#pragma omp parallel for default(none) private(i, j, irow, nrowblk, mythread) \
+  shared(Q, coef, work) firstprivate(nblk, nrow, nbasis, nkeep, ld, lld, transa, transb, one, zero)
+  for (i = 0; i < nblk; i++) {
+#ifdef _OPENMP
+    mythread = omp_get_thread_num();
+#else
+    mythread = 0;
+#endif
+    irow = 1 + i * D_TRLanczosRows;
+    nrowblk = (nrow - (irow - 1) < D_TRLanczosRows) ? nrow - (int)(irow - 1) : D_TRLanczosRows;
+    zgemm_(&transa, &transb, &nrowblk, &nkeep, &nbasis, &one, Q + irow, &ld, coef, &nbasis,
+           &zero, work + (long int)mythread * D_TRLanczosRows * nkeep, &nrowblk);
+    for (j = 0; j < nkeep; j++) {
+      memcpy(Q + lld * j + irow, work + (long int)mythread * D_TRLanczosRows * nkeep + nrowblk * j,
+             sizeof(double complex) * nrowblk);
+    }
+  }
+  free(work);
+}
+
+/**
+ * @brief Random vector orthogonal to the first @p k columns of @p Q, stored
+ * in the column @p k. Used for the initial vector, when the Krylov space
+ * is invariant, and to check the converged states.
+ *
+ * @param[in] iseed Index of the random sequence (0 for the initial vector)
+ * @return Norm of the vector before the normalization
+ */
+static double TRLanczos_Random(
+  struct BindStruct *X,
+  int k,
+  long int iseed,
+  int nrow,
+  int ld,
+  double complex *Q,
+  double complex *h,
+  double complex *htmp
+)
+{
+  long int i, i_max = nrow, lld = ld;
+  long unsigned int u_long_i;
+  int mythread;
+  dsfmt_t dsfmt;
+  double dnorm;
+  double complex *qk;
+
+  qk = Q + lld * k;
+#pragma omp parallel default(none) private(i, u_long_i, mythread, dsfmt) \
+  shared(qk, X, nthreads, myrank, nproc) firstprivate(i_max, iseed)
+  {
+#ifdef _OPENMP
+    mythread = omp_get_thread_num();
+#else
+    mythread = 0;
+#endif
+    u_long_i = 123432 + labs(X->Def.initial_iv) + mythread + nthreads * (myrank + nproc * iseed);
+    dsfmt_init_gen_rand(&dsfmt, u_long_i);
+    if (X->Def.iInitialVecType == 0) {
+#pragma omp for
+      for (i = 1; i <= i_max; i++)
+        qk[i] = 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5) + 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5)*I;
+    }
+    else {
+#pragma omp for
+      for (i = 1; i <= i_max; i++)
+        qk[i] = 2.0*(dsfmt_genrand_close_open(&dsfmt) - 0.5);
+    }
+  }
+  dnorm = TRLanczos_Orthogonalize(k, nrow, ld, Q, qk, h, htmp);
+  if (dnorm > 0.0) {
+#pragma omp parallel for default(none) private(i) shared(qk) firstprivate(i_max, dnorm)
+    for (i = 1; i <= i_max; i++) qk[i] /= dnorm;
+  }
+  return dnorm;
+}
+
+/**
+ * @brief Lowest @p nvec eigenpairs by the thick-restart Lanczos method.
+ * On return, the columns 0, ..., nvec-1 of @p Q are the Ritz vectors.
+ *
+ * @param[in,out] X
+ * @param[in] nbasis Maximum number of the Lanczos vectors M
+ * @param[in] nkeep Number of the Ritz vectors kept at a restart K
+ * @param[in] nvec Number of the states which have to converge
+ * @param[in] ld Leading dimension of @p Q (idim_max+1)
+ * @param Q [M+1 columns] Lanczos vectors
+ * @param[out] eig [nvec] Ritz values
+ *
+ * @retval 0 converged
+ * @retval 1 not converged within Lanczos_max products
+ */
+static int TRLanczos_Main(
+  struct BindStruct *X,
+  int nbasis,
+  int nkeep,
+  int nvec,
+  int ld,
+  double complex *Q,
+  double *eig
+)
+{
+  FILE *fp;
+  char sdt[D_FileNameMax];
+  int mfint[7];
+  int i, j, jstart, nconv, nwant, iconv, nrow, irestart, nb, nk, iprev, icheck;
+  long int ii, i_max, lld;
+  long int nmltply;
+  double eps_TRLanczos, beta, hnorm, res, rmax, dnorm;
+  double *eprev;
+  double complex *h, *htmp, *e, *coef, **tmat, **y;
+  double complex *qj, *w;
+
+  i_max = X->Check.idim_max;
+  nrow = (int)i_max;
+  lld = ld;
+  eps_TRLanczos = pow(10.0, -0.5 * X->Def.LanczosEps);
+
+  sprintf(sdt, cFileNameTRLanczosStep, X->Def.CDataFileHead);
+  if (childfopenMPI(sdt, "w", &fp) != 0) return 1;
+  fclose(fp);
+
+  c_malloc1(h, nbasis + 1);
+  c_malloc1(htmp, nbasis + 1);
+  c_malloc1(e, nbasis + 1);
+  c_malloc1(coef, nbasis * nbasis);
+  c_malloc2(tmat, nbasis + 1, nbasis + 1);
+  c_malloc2(y, nbasis + 1, nbasis + 1);
+  d_malloc1(eprev, nvec);
+  for (i = 0; i <= nbasis; i++) {
+    for (j = 0; j <= nbasis; j++) tmat[i][j] = 0.0;
+  }
+  /*
+   Initial vector. The seed is the same as that of Lanczos_EigenValue.
+  */
+  TRLanczos_Random(X, 0, 0, nrow, ld, Q, h, htmp);
+
+  iconv = 1;
+  nmltply = 0;
+  irestart = 0;
+  jstart = 0;
+  j = 0;
+  nwant = nvec;
+  iprev = FALSE;
+  while (iconv == 1) {
+    icheck = FALSE;
+    nconv = 0;
+    rmax = 0.0;
+    for (j = jstart; j < nbasis; j++) {
+      qj = Q + lld * j;
+      w = Q + lld * (j + 1);
+#pragma omp parallel for default(none) private(ii) shared(w) firstprivate(i_max)
+      for (ii = 1; ii <= i_max; ii++) w[ii] = 0.0;
+      mltply(X, w, qj);
+      nmltply++;
+      /*
+       Column j of T, including the couplings to the kept Ritz vectors
+      */
+      beta = TRLanczos_Orthogonalize(j + 1, nrow, ld, Q, w, h, htmp);
+      hnorm = beta * beta;
+      for (i = 0; i < j; i++) {
+        tmat[i][j] = h[i];
+        tmat[j][i] = conj(h[i]);
+        hnorm += creal(conj(h[i]) * h[i]);
+      }
+      tmat[j][j] = creal(h[j]);
+      hnorm = sqrt(hnorm + creal(h[j]) * creal(h[j]));
+      if (beta < D_TRLanczosBreak * hnorm) beta = 0.0;
+      tmat[j + 1][j] = beta;
+      tmat[j][j + 1] = beta;
+      /*
+       Ritz values and residual norms |beta_j y_i(j)|
+      */
+      ZHEEVall(j + 1, tmat, e, y);
+      nconv = 0;
+      rmax = 0.0;
+      for (i = 0; i < nwant && i <= j; i++) {
+        res = beta * cabs(y[i][j]);
+        if (res < eps_TRLanczos) nconv++;
+        if (res > rmax) rmax = res;
+      }
+      if (childfopenMPI(sdt, "a", &fp) == 0) {
+        fprintf(fp, "stp=%ld %d %d %.5e", nmltply, irestart, nconv, rmax);
+        for (i = 0; i < nwant && i <= j; i++) fprintf(fp, " %.10lf", creal(e[i]));
+        fprintf(fp, "\n");
+        fclose(fp);
+      }
+      if (nconv == nwant) {
+        if (iprev == TRUE) {
+          for (i = 0; i < nvec; i++) {
+            if (fabs(creal(e[i]) - eprev[i]) > eps_TRLanczos) break;
+          }
+          if (i == nvec) {
+            iconv = 0;
+            break;
+          }
+        }
+        else if (nvec == 1) {
+          iconv = 0;
+          break;
+        }
+        for (i = 0; i < nvec; i++) eprev[i] = creal(e[i]);
+        iprev = TRUE;
+        nwant = (nvec + 1 < nbasis) ? nvec + 1 : nbasis;
+        icheck = TRUE;
+        break;
+      }
+      if (nmltply >= X->Def.Lanczos_max) break;
+
+      if (beta > 0.0) {
+#pragma omp parallel for default(none) private(ii) shared(w) firstprivate(i_max, beta)
+        for (ii = 1; ii <= i_max; ii++) w[ii] /= beta;
+      }
+      else {
+        dnorm = TRLanczos_Random(X, j + 1, nmltply, nrow, ld, Q, h, htmp);
+        if (dnorm <= 0.0) break;
+      }
+    }/*for (j = jstart; j < nbasis; j++)*/
+
+    if (iconv == 0 || nmltply >= X->Def.Lanczos_max) break;
+    if (icheck == FALSE && j < nbasis) break;
+    /*
+     Thick restart: q_i <- Q y_i (i < K), q_K <- q_M, T <- diag(theta) + couplings.
+     To check the converged states, only they are kept (their residuals are
+     below the threshold) and q_nvec is a random vector.
+    */
+    fprintf(stdoutMPI, cLogTRLanczosRestart, irestart, nmltply, nconv, nwant, rmax, creal(e[0]));
+    nb = (icheck == TRUE) ? j + 1 : nbasis;
+    nk = (icheck == TRUE) ? nvec : nkeep;
+    for (i = 0; i < nk; i++) {
+      for (ii = 0; ii < nb; ii++) coef[ii + nb * i] = y[i][ii];
+    }
+    TRLanczos_Rotate(nb, nk, nrow, ld, Q, coef);
+    if (icheck == TRUE) {
+      TRLanczos_Random(X, nk, nmltply, nrow, ld, Q, h, htmp);
+    }
+    else {
+      memcpy(Q + lld * nk, Q + lld * nbasis, sizeof(double complex) * lld);
+    }
+    for (i = 0; i <= nbasis; i++) {
+      for (ii = 0; ii <= nbasis; ii++) tmat[i][ii] = 0.0;
+    }
+    for (i = 0; i < nk; i++) tmat[i][i] = creal(e[i]);
+    jstart = nk;
+    irestart++;
+  }/*while (iconv == 1)*/
+  /*
+   Ritz vectors of the lowest nvec states
+  */
+  if (iconv == 0) {
+    for (i = 0; i < nvec; i++) {
+      eig[i] = creal(e[i]);
+      for (ii = 0; ii <= j; ii++) coef[ii + (j + 1) * i] = y[i][ii];
+    }
+    TRLanczos_Rotate(j + 1, nvec, nrow, ld, Q, coef);
+  }
+  fprintf(stdoutMPI, cLogTRLanczosMltply, irestart, nmltply);
+
+  c_free1(h, nbasis + 1);
+  c_free1(htmp, nbasis + 1);
+  c_free1(e, nbasis + 1);
+  c_free1(coef, nbasis * nbasis);
+  c_free2(tmat, nbasis + 1, nbasis + 1);
+  c_free2(y, nbasis + 1, nbasis + 1);
+  d_free1(eprev, nvec);
+  return iconv;
+}
+
+/**
+ * @brief A main function to calculate the lowest nvec eigenvalues and
+ * eigenvectors by the thick-restart Lanczos method (CalcEigenVec=3).
+ * The energies of all the states are written to the energy file, and the
+ * Green's functions are calculated for the exct-th state.
+ *
+ * @param[in,out] X CalcStruct list for getting and pushing calculation information
+ * @retval TRUE normally finished
+ * @retval FALSE not converged or the memory is not enough
+ */
+int CalcByTRLanczos(
+                    struct EDMainCalStruct *X
+                    )
+{
+  int nvec, nbasis, nkeep, iret, ld;
+  long int i_max, lld;
+  unsigned long int i_max_tmp;
+  double dmem;
+  double *eig;
+  double complex *Q;
+
+  i_max = X->Bind.Check.idim_max;
+  lld = i_max + 1;
+  i_max_tmp = SumMPI_li(i_max);
+  nvec = X->Bind.Def.nvec;
+  if (i_max_tmp < (unsigned long int)nvec) nvec = (int)i_max_tmp;
+  nbasis = X->Bind.Def.ThickRestartBasis;
+  if (nbasis <= 0) nbasis = nvec + 20;
+  if (nbasis < nvec + 2) nbasis = nvec + 2;
+  if (i_max_tmp < (unsigned long int)nbasis) nbasis = (int)i_max_tmp;
+  nkeep = X->Bind.Def.ThickRestartKeep;
+  if (nkeep <= 0) nkeep = (nbasis + nvec) / 2;
+  if (nkeep < nvec) nkeep = nvec;
+  if (nkeep > nbasis - 1) nkeep = nbasis - 1;
+
+  TimeKeeper(&(X->Bind), cFileNameTimeKeep, cTRLanczosStart, "a");
+  dmem = (nbasis + 1.0) * lld * sizeof(double complex) / pow(10, 9);
+  fprintf(stdoutMPI, cLogTRLanczosStart, nvec, nbasis, nkeep, dmem);
+
+  ld = (int)lld;
+  iret = 0;
+  Q = NULL;
+  if (lld > INT_MAX) iret = 1;
+  else {
+    Q = (double complex *)malloc(sizeof(double complex) * (nbasis + 1) * lld);
+    if (Q == NULL) iret = 1;
+  }
+  if (SumMPI_i(iret) != 0) {
+    fprintf(stdoutMPI, cErrTRLanczosMalloc, nbasis + 1, dmem);
+    free(Q);
+    return FALSE;
+  }
+
+  d_malloc1(eig, nvec);
+  iret = TRLanczos_Main(&(X->Bind), nbasis, nkeep, nvec, ld, Q, eig);
+  if (iret != 0) {
+    fprintf(stdoutMPI, "%s", cLogTRLanczosNotConverged);
+    free(Q);
+    d_free1(eig, nvec);
+    return FALSE;
+  }
+  TimeKeeper(&(X->Bind), cFileNameTimeKeep, cTRLanczosFinish, "a");
+  fprintf(stdoutMPI, "%s", cLogTRLanczosEnd);
+  Output_EigenBlock(X, nvec, lld, Q, eig);
+  d_free1(eig, nvec);
+  return TRUE;
+}
@@ -19,6 +19,31 @@
 
 int NsiteMPI;
 
+/**
+ *
+ * Check whether the sector can be split into blocks of rows over any number of processes
+ * when the number of processes does not match the inter-process sites.
+ * The columns of the Hamiltonian on the other processes are exchanged by mltplyMPIRow.c,
+ * which needs the stored Hamiltonian (MltplyMode=2).
+ *
+ * @retval TRUE the rows are distributed, and all sites stay in each process
+ * @retval FALSE the number of processes is wrong
+ */
+static int CheckMPI_RowMode(struct BindStruct *X/**< [inout] */)
+{
+  if (X->Def.iCalcModel != Hubbard && X->Def.iCalcModel != Kondo && X->Def.iCalcModel != Spin) return FALSE;
+  if (X->Def.iFlgGeneralSpin == TRUE || X->Boost.flgBoost == 1) return FALSE;
+  if (X->Def.iCalcType != Lanczos && X->Def.iCalcType != TPQCalc) return FALSE;
+  if (X->Def.READ == 1 || X->Def.WRITE == 1) return FALSE;
+
+  if (X->Def.iMltplyMode != MLTPLY_CSR) {
+    fprintf(stdoutMPI, cLogMPIRowMltply, X->Def.iMltplyMode);
+    X->Def.iMltplyMode = MLTPLY_CSR;
+  }
+  X->Large.iFlgMPIRow = TRUE;
+  return TRUE;
+}/*int CheckMPI_RowMode*/
+
 /**
  *
  * Define the number of sites in each PE.
@@ -32,6 +57,8 @@ int CheckMPI(struct BindStruct *X/**< [inout] */)
 
   NsiteMPI = X->Def.Nsite;
   X->Def.NsiteMPI=NsiteMPI;
+  X->Large.iFlgMPIRow = FALSE;
+  X->Large.RowOffset = 0;
   switch (X->Def.iCalcModel) {
   case HubbardGC: /****************************************************/
   case Hubbard:
@@ -52,6 +79,7 @@ int CheckMPI(struct BindStruct *X/**< [inout] */)
     } /*for (isite = NsiteMPI; isite > 0; isite--)*/
     
     if (isite == 0) {
+      if (CheckMPI_RowMode(X) == TRUE) return TRUE;
       fprintf(stdoutMPI, cErrNProcNumberHubbard);
       fprintf(stdoutMPI, cErrNProcNumber, nproc);
       	NDimInterPE = 1;
@@ -67,6 +95,7 @@ int CheckMPI(struct BindStruct *X/**< [inout] */)
 	  NDimInterPE *= 4;
 	}/*for (isite = X->Def.NsiteMPI; isite > 0; isite--)*/
 	fprintf(stdoutMPI, cErrNProcNumberSet,ismallNproc, ilargeNproc );
+        fprintf(stdoutMPI, "%s", cErrNProcNumberRow);
         return FALSE;
       //return FALSE;
     } /*if (isite == 0)*/
@@ -167,6 +196,7 @@ int CheckMPI(struct BindStruct *X/**< [inout] */)
       }/*for (isite = X->Def.NsiteMPI; isite > 0; isite--)*/
 
       if (isite == 0) {
+        if (CheckMPI_RowMode(X) == TRUE) return TRUE;
         fprintf(stdoutMPI, cErrNProcNumberSpin);
         fprintf(stdoutMPI, cErrNProcNumber, nproc);
 	NDimInterPE = 1;
@@ -182,6 +212,7 @@ int CheckMPI(struct BindStruct *X/**< [inout] */)
 	  NDimInterPE *= 2;
 	}/*for (isite = X->Def.NsiteMPI; isite > 0; isite--)*/
 	fprintf(stdoutMPI, cErrNProcNumberSet,ismallNproc, ilargeNproc );
+        fprintf(stdoutMPI, "%s", cErrNProcNumberRow);
         return FALSE;
       }/*if (isite == 0)*/
 
@@ -286,6 +317,60 @@ int CheckMPI(struct BindStruct *X/**< [inout] */)
   return TRUE;
 }/*void CheckMPI*/
 
+/**
+ *
+ * Split the sector of @p idim states into contiguous blocks of rows.
+ * The first idim%nproc processes have one more row than the others.
+ *
+ * @author Mitsuaki Kawamura (The University of Tokyo)
+ */
+void CheckMPI_Row(
+  struct BindStruct *X/**< [inout] */,
+  long unsigned int idim/**< [in] Dimension of the whole sector*/)
+{
+  long unsigned int nrow, nrem, irank;
+
+  nrow = idim / nproc;
+  nrem = idim % nproc;
+  irank = myrank;
+  X->Check.idim_max = nrow + ((irank < nrem) ? 1 : 0);
+  X->Large.RowOffset = nrow * irank + ((irank < nrem) ? irank : nrem);
+}/*void CheckMPI_Row*/
+
+/**
+ *
+ * Print the blocks of rows of each process
+ *
+ * @author Mitsuaki Kawamura (The University of Tokyo)
+ */
+static void CheckMPI_RowSummary(struct BindStruct *X/**< [inout] */) {
+
+  int iproc;
+  unsigned long int idimMPI, ioffMPI;
+
+  fprintf(stdoutMPI, "\n\n######  MPI row distribution summary  ######\n\n");
+  fprintf(stdoutMPI, "  All sites are in each process, and the rows of the sector are split over %d processes.\n", nproc);
+  fprintf(stdoutMPI, "\n  Process element info\n");
+  fprintf(stdoutMPI, "    Process       Dimension       First row\n");
+
+  for (iproc = 0; iproc < nproc; iproc++) {
+    if (myrank == iproc) {
+      idimMPI = X->Check.idim_max;
+      ioffMPI = X->Large.RowOffset + 1;
+    }
+    else {
+      idimMPI = 0;
+      ioffMPI = 0;
+    }
+    idimMPI = SumMPI_li(idimMPI);
+    ioffMPI = SumMPI_li(ioffMPI);
+    fprintf(stdoutMPI, "    %7d %15ld %15ld\n", iproc, idimMPI, ioffMPI);
+  }/*for (iproc = 0; iproc < nproc; iproc++)*/
+
+  X->Check.idim_maxMPI = SumMPI_li(X->Check.idim_max);
+  fprintf(stdoutMPI, "\n   Total dimension : %ld\n\n",  X->Check.idim_maxMPI);
+}/*void CheckMPI_RowSummary*/
+
 /**
  *
  * Print infomation of MPI parallelization
@@ -298,6 +383,14 @@ void CheckMPI_Summary(struct BindStruct *X/**< [inout] */) {
   int isite, iproc, SmallDim, SpinNum, Nelec;
   unsigned long int idimMPI;
 
+  /*
+    No inter process site when the rows are distributed
+  */
+  if (X->Large.iFlgMPIRow == TRUE) {
+    CheckMPI_RowSummary(X);
+    return;
+  }
+
   fprintf(stdoutMPI, "\n\n######  MPI site separation summary  ######\n\n");
   fprintf(stdoutMPI, "  INTRA process site\n");
   fprintf(stdoutMPI, "    Site    Bit\n");
@@ -42,9 +42,18 @@ char *cErrNLoc ="Error: Ne=Nup+Ndown must be (Ne >= NLocalSpin).\n";
 char *cErrDefFileParam="Error: In %s, wrong parameter name:%s \n";
 char *cErrCalcType="Error in %s\n CalcType: 0: Lanczos Method, 1: Thermal Pure Quantum State Method, 2: Full Diagonalization Method.\n";
 char *cErrOutputMode="Error in %s\n OutputMode: \n 0: calc one body green function and two body green functions,\n 1: calc one body green function and two body green functions and correlatinos for charge and spin.\n";
-char *cErrCalcEigenVec="Error in %s\n CalcEigenVec: \n 0: Lanczos+CG method,\n 1: Lanczos method.\n";
+char *cErrCalcEigenVec="Error in %s\n CalcEigenVec: \n 0: Lanczos+CG method,\n 1: Lanczos method,\n 2: LOBPCG method,\n 3: thick-restart Lanczos method.\n";
 char *cErrOutputHam="Error in %s\n OutputHam: \n 0: not output Hamiltonian,\n 1: output Hamiltonian.\n";
 char *cErrOutputHamForFullDiag="Error in %s\n OutputHam is only defined for FullDiag mode, CalcType=2.\n";
+char *cErrMltplyMode="Error in %s\n MltplyMode: \n 0: termwise sweeps,\n 1: fused sweep,\n 2: stored CSR Hamiltonian,\n 3: automatic choice between 1 and 2,\n 4: dense blocks for spin models.\n";
+char *cErrBasisCache="Error in %s\n BasisCache: \n 0: the basis and the diagonal part are built in every run,\n 1: they are cached on the disk.\n";
+char *cErrLanczosBasis="Error in %s\n LanczosBasis: \n 0: the Lanczos recurrence is run again for the eigenvector,\n 1: the Lanczos vectors are kept in the memory,\n 2: they are kept in the memory and a scratch file.\n";
+char *cErrLOBPCGBasis="Error: the basis of LOBPCG method is linearly dependent at step %d.\n";
+char *cErrLOBPCGMalloc="Error: %d vectors (%lf GB) for LOBPCG method can not be allocated.\n";
+char *cErrTRLanczosMalloc="Error: %d vectors (%lf GB) for thick-restart Lanczos method can not be allocated.\n";
+char *cErrLanczosBasisRead="Error: the scratch file of the Lanczos vectors can not be read on rank %d (step %d).\n";
+char *cErrSpinFlip="Error in %s\n SpinFlip: \n 0: not used,\n 1: even sector,\n -1: odd sector.\n";
+char *cErrTPQPrecision="Error in %s\n TPQPrecision: \n 0: double precision,\n 1: single-precision vectors with double-precision reductions.\n";
 char *cErrCalcModel="Error in %s\n CalcModel: \n 0: Hubbard, 1: Spin, 2: Kondo, 3: HubbardGC, 4: SpinGC, 5:KondoGC.\n";
 char *cErrFiniteTemp="Error in %s\n FlgFiniteTemperature: Finite Temperature, 1: Zero Temperature.\n";
 char *cErrSetIniVec="Error in %s\n InitialVecType: \n 0: complex type,\n 1: real type.\n";
@@ -78,6 +87,7 @@ char *cErrNProcNumberSpin = "Error ! The number of PROCESS should be 2-exponent
 char *cErrNProcNumberGneralSpin = "Error ! The number of PROCESS is wrong !\n";
 char *cErrNProcNumber = "        The number of PROCESS : %d\n";
 char *cErrNProcNumberSet = "        Set the number of PROCESS as %d or %d.\n";
+char *cErrNProcNumberRow = "        Any number of PROCESS is available for Hubbard, Kondo and Spin (2S=1) models with CalcType=0 or 1 without Boost.\n";
 
 
 //! Error Message in diagonal calc.c
@@ -101,3 +111,18 @@ char* cErrSz_NoFile="No file. Please set READ=0.\n";
 char* cErrSz_NoFile_Show=" %s does not exist. \n";
 char* cErrSz_ShowDim="imax = %ld, Check.idim_max=%ld \n";
 char* cErrSz_OutFile="Caution!!  Error in sz !!!! idim_max is not correct \n";
+
+//! Error Message in TransSym.c
+char *cErrTransSymModel="Error: TransSym and SpinFlip are available only for the spin-1/2 Spin model and the Hubbard model with conserved Sz.\n";
+char *cErrTransSymSz="Error: SpinFlip is available only for 2Sz=0.\n";
+char *cErrTransSymCalc="Error: TransSym and SpinFlip can not be used with TPQPrecision=1, READ, WRITE or Boost.\n";
+char *cErrTransSymPerm="Error: Operation %d in TransSym is not a permutation of sites.\n";
+char *cErrTransSymGroup="Error: Operations in TransSym do not form a group (g=%d, h=%d).\n";
+char *cErrTransSymChar="Error: Characters in TransSym are not a one-dimensional representation (g=%d, h=%d).\n";
+char *cErrTransSymMPI="Error: TransSym and SpinFlip are not available with more than one process.\n";
+char *cErrTransSymFused="Error: The symmetrized basis (TransSym, SpinFlip) requires the operator program of the fused sweep, which is not available for these terms.\n";
+char *cErrTransSymMalloc="Error: Buffers of the rows in the symmetrized basis can not be allocated.\n";
+char *cErrMPIRowCSR="Error: The rows of the sector are distributed over the processes, but the Hamiltonian can not be stored (MltplyMode=2).\n";
+char *cErrMPIRowMalloc="Error: Buffers of the rows on the other processes can not be allocated.\n";
+char *cErrBoostMalloc="Error: Dense blocks of the pivots in Boost can not be allocated.\n";
+char *cErrTPQMalloc="Error: TPQ vectors can not be allocated.\n";
@@ -28,6 +28,11 @@
 #include "StdFace_main.h"
 #include "wrapperMPI.h"
 #include "splash.h"
+#include "mltplyFused.h"
+#include "mltplyCSR.h"
+#include "mltplyDense.h"
+#include "TransSym.h"
+#include "bitcalc.h"
 
 /*!
 @mainpage
@@ -141,6 +146,12 @@ int main(int argc, char* argv[]){
     return 0;
   }
   
+  /*Check the symmetry operations for the symmetrized basis*/
+  if(TransSym_Init(&(X.Bind))!=0){
+    FinalizeMPI();
+    return 0;
+  }
+
   fprintf(stdoutMPI, cProFinishDefCheck);
   if(check(&(X.Bind))==MPIFALSE){
     FinalizeMPI();
@@ -173,7 +184,25 @@ int main(int argc, char* argv[]){
     return 0;
   }
 
+  /*Index of a state: 32-bit split tables*/
+  if(GetOffCompInit(&(X.Bind))!=0){
+    exitMPI(-1);
+  }
+
   diagonalcalc(&(X.Bind));
+
+  /*Compile the operator program used in mltply and makeHam*/
+  if(mltply_fused_Init(&(X.Bind))!=0){
+    exitMPI(-1);
+  }
+  /*Store the Hamiltonian if requested or if it fits in the memory*/
+  if(mltply_csr_Init(&(X.Bind))!=0){
+    exitMPI(-1);
+  }
+  /*Tile the spin terms into dense blocks (MltplyMode=4)*/
+  if(mltply_dense_Init(&(X.Bind))!=0){
+    exitMPI(-1);
+  }
   
   //Start Calculation
   switch (X.Bind.Def.iCalcType){
@@ -0,0 +1,284 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+// Lanczos vectors kept during Lanczos_EigenValue (LanczosBasis in the CalcMod file)
+//
+// Lanczos_EigenVector rebuilds the eigenvector as sum_k vec[k_exct][k] v_k.
+// Instead of running the recurrence again from the initial vector, the vectors
+// v_k are kept in the memory while they fit in the budget (MaxMem in modpara,
+// or half of the physical memory) and, with LanczosBasis=2, written to
+//   output/<CDataFileHead>_LanczosBasis_rank_<myrank>.dat
+// beyond that. The recurrence is resumed from the last two kept vectors only
+// for the steps which are not kept. The vectors are kept unnormalized, as they
+// appear in the recurrence (beta[k-1] v_k), so that the eigenvector is the same
+// as the one by the second recurrence. If the recurrence is run with real vectors
+// (Lanczos_RealCheck), the vectors are kept real and twice as many fit.
+
+#include "mfmemory.h"
+#include "FileIO.h"
+#include "mltplyCSR.h"
+#include "Lanczos_Basis.h"
+#include "wrapperMPI.h"
+
+static int BasisMode = LANCZOSBASIS_RECOMPUTE; /**< LanczosBasis of this run*/
+static int NStored = 0; /**< Number of the kept vectors (1, ..., NStored)*/
+static int NMem = 0; /**< Number of the vectors in the memory*/
+static int NMemMax = 0; /**< Number of the vectors which fit in the memory budget*/
+static int BasisReal = FALSE; /**< TRUE if the vectors are real*/
+static double complex **BasisMem = NULL; /**< [Lanczos_max+1] Vectors in the memory*/
+static double **BasisMemR = NULL; /**< [Lanczos_max+1] Vectors in the memory if they are real*/
+static FILE *BasisFp = NULL; /**< Scratch file of the vectors beyond NMem*/
+
+/**
+ * @brief Select how the Lanczos vectors are kept in this run.
+ * Called by all processes before the first Lanczos step.
+ *
+ * @param X
+ * @param iReal TRUE if the Lanczos vectors are real
+ *
+ * @retval 0 normally finished
+ */
+int Lanczos_Basis_Init(struct BindStruct *X, int iReal)
+{
+  int k;
+  double dvec, davail;
+
+  Lanczos_Basis_Free(X);
+  BasisMode = X->Def.iLanczosBasis;
+  if (X->Def.iCalcEigenVec == CALCVEC_NOT) BasisMode = LANCZOSBASIS_RECOMPUTE;
+  if (BasisMode == LANCZOSBASIS_RECOMPUTE) return 0;
+  BasisReal = iReal;
+
+  if (BasisReal == TRUE) dvec = (X->Check.idim_max + 1) * 8.0 / pow(10, 9);
+  else dvec = (X->Check.idim_max + 1) * 16.0 / pow(10, 9);
+  davail = mltply_csr_MemBudget(X) - X->Check.max_mem;
+  if (X->Large.iFlgCSR == TRUE) davail -= X->Large.nnz_CSR * 20.0 / pow(10, 9);
+  davail = -MaxMPI_d(-davail);
+  dvec = MaxMPI_d(dvec);
+  if (davail > 0.0) NMemMax = (int)(davail / dvec);
+  else NMemMax = 0;
+  if (NMemMax > X->Def.Lanczos_max) NMemMax = X->Def.Lanczos_max;
+
+  BasisMem = (double complex **)malloc(sizeof(double complex *) * (X->Def.Lanczos_max + 1));
+  BasisMemR = (double **)malloc(sizeof(double *) * (X->Def.Lanczos_max + 1));
+  for (k = 0; k <= X->Def.Lanczos_max; k++) {
+    BasisMem[k] = NULL;
+    BasisMemR[k] = NULL;
+  }
+  fprintf(stdoutMPI, cLogLanczosBasisInit, NMemMax, dvec);
+  return 0;
+}
+
+/**
+ * @brief Body of Lanczos_Basis_Store and Lanczos_Basis_StoreReal.
+ *
+ * @param X
+ * @param stp index of the Lanczos vector (1, 2, ...)
+ * @param tmp_vc [in] beta[stp-1] times the Lanczos vector (complex), or NULL
+ * @param tmp_vr [in] beta[stp-1] times the Lanczos vector (real), or NULL
+ *
+ * @retval TRUE the vector is kept
+ * @retval FALSE the vector is not kept
+ */
+static int Lanczos_Basis_Keep(struct BindStruct *X, int stp, double complex *tmp_vc, double *tmp_vr)
+{
+  char sdt[D_FileNameMax];
+  long int i, i_max;
+  int iflg;
+  size_t nwrite;
+
+  if (BasisMode == LANCZOSBASIS_RECOMPUTE || stp != NStored + 1 || stp > X->Def.Lanczos_max) return FALSE;
+  if ((BasisReal == TRUE && tmp_vr == NULL) || (BasisReal == FALSE && tmp_vc == NULL)) return FALSE;
+  i_max = X->Check.idim_max;
+
+  iflg = FALSE;
+  if (NMem < NMemMax && NStored == NMem) {
+    if (BasisReal == TRUE) {
+      d_malloc1(BasisMemR[stp], i_max + 1);
+      if (BasisMemR[stp] != NULL) {
+#pragma omp parallel for default(none) private(i) shared(BasisMemR, tmp_vr) firstprivate(i_max, stp)
+        for (i = 1; i <= i_max; i++) BasisMemR[stp][i] = tmp_vr[i];
+        iflg = TRUE;
+      }
+    }
+    else {
+      c_malloc1(BasisMem[stp], i_max + 1);
+      if (BasisMem[stp] != NULL) {
+#pragma omp parallel for default(none) private(i) shared(BasisMem, tmp_vc) firstprivate(i_max, stp)
+        for (i = 1; i <= i_max; i++) BasisMem[stp][i] = tmp_vc[i];
+        iflg = TRUE;
+      }
+    }
+    /*
+      All processes keep the same steps
+    */
+    if (MaxMPI_li(1 - iflg) != 0) {
+      if (BasisMem[stp] != NULL) free(BasisMem[stp]);
+      if (BasisMemR[stp] != NULL) free(BasisMemR[stp]);
+      BasisMem[stp] = NULL;
+      BasisMemR[stp] = NULL;
+      NMemMax = NMem;
+      iflg = FALSE;
+    }
+    else NMem += 1;
+  }
+  if (iflg == FALSE && BasisMode == LANCZOSBASIS_FILE) {
+    if (BasisFp == NULL && NStored == NMem) {
+      sprintf(sdt, cFileNameLanczosBasis, X->Def.CDataFileHead, myrank);
+      if (childfopenALL(sdt, "wb+", &BasisFp) != 0) BasisFp = NULL;
+    }
+    if (BasisFp != NULL) {
+      if (BasisReal == TRUE) nwrite = fwrite(&tmp_vr[1], sizeof(double), i_max, BasisFp);
+      else nwrite = fwrite(&tmp_vc[1], sizeof(double complex), i_max, BasisFp);
+      if (nwrite == (size_t)i_max) iflg = TRUE;
+    }
+    if (MaxMPI_li(1 - iflg) != 0) {
+      if (BasisFp != NULL) fclose(BasisFp);
+      BasisFp = NULL;
+      BasisMode = LANCZOSBASIS_MEMORY;
+      fprintf(stdoutMPI, cLogLanczosBasisFileFail, stp);
+      iflg = FALSE;
+    }
+  }
+  if (iflg == TRUE) NStored = stp;
+  return iflg;
+}
+
+/**
+ * @brief Keep the Lanczos vector of the step @p stp.
+ * The vectors must be given in the order of the steps. Once a vector is not kept,
+ * the following ones are not kept either. Called by all processes.
+ *
+ * @param X
+ * @param stp index of the Lanczos vector (1, 2, ...)
+ * @param tmp_v [in] beta[stp-1] times the Lanczos vector
+ *
+ * @retval TRUE the vector is kept
+ * @retval FALSE the vector is not kept
+ */
+int Lanczos_Basis_Store(struct BindStruct *X, int stp, double complex *tmp_v)
+{
+  return Lanczos_Basis_Keep(X, stp, tmp_v, NULL);
+}
+
+/**
+ * @brief Real version of Lanczos_Basis_Store (Lanczos_Basis_Init with iReal=TRUE).
+ *
+ * @param X
+ * @param stp index of the Lanczos vector (1, 2, ...)
+ * @param tmp_v [in] beta[stp-1] times the Lanczos vector
+ *
+ * @retval TRUE the vector is kept
+ * @retval FALSE the vector is not kept
+ */
+int Lanczos_Basis_StoreReal(struct BindStruct *X, int stp, double *tmp_v)
+{
+  return Lanczos_Basis_Keep(X, stp, NULL, tmp_v);
+}
+
+/**
+ * @brief Number of the kept Lanczos vectors. The vectors 1, ..., return value are kept.
+ *
+ * @return number of the kept vectors
+ */
+int Lanczos_Basis_Count()
+{
+  return NStored;
+}
+
+/**
+ * @brief Get the kept Lanczos vector of the step @p stp.
+ * The vectors in the file must be read in the order of the steps.
+ *
+ * @param X
+ * @param stp index of the Lanczos vector (1, ..., Lanczos_Basis_Count())
+ * @param tmp_buf [out] buffer used if the vector is in the file
+ *
+ * @return the vector (beta[stp-1] times the Lanczos vector), or NULL if it is not kept
+ */
+double complex *Lanczos_Basis_Get(struct BindStruct *X, int stp, double complex *tmp_buf)
+{
+  long int i_max;
+
+  if (stp < 1 || stp > NStored || BasisReal == TRUE) return NULL;
+  if (stp <= NMem) return BasisMem[stp];
+
+  i_max = X->Check.idim_max;
+  if (stp == NMem + 1) rewind(BasisFp);
+  if (fread(&tmp_buf[1], sizeof(double complex), i_max, BasisFp) != (size_t)i_max) {
+    fprintf(stderr, cErrLanczosBasisRead, myrank, stp);
+    exitMPI(-1);
+  }
+  return tmp_buf;
+}
+
+/**
+ * @brief Real version of Lanczos_Basis_Get.
+ *
+ * @param X
+ * @param stp index of the Lanczos vector (1, ..., Lanczos_Basis_Count())
+ * @param tmp_buf [out] buffer used if the vector is in the file
+ *
+ * @return the vector (beta[stp-1] times the Lanczos vector), or NULL if it is not kept
+ */
+double *Lanczos_Basis_GetReal(struct BindStruct *X, int stp, double *tmp_buf)
+{
+  long int i_max;
+
+  if (stp < 1 || stp > NStored || BasisReal == FALSE) return NULL;
+  if (stp <= NMem) return BasisMemR[stp];
+
+  i_max = X->Check.idim_max;
+  if (stp == NMem + 1) rewind(BasisFp);
+  if (fread(&tmp_buf[1], sizeof(double), i_max, BasisFp) != (size_t)i_max) {
+    fprintf(stderr, cErrLanczosBasisRead, myrank, stp);
+    exitMPI(-1);
+  }
+  return tmp_buf;
+}
+
+/**
+ * @brief Free the kept Lanczos vectors and remove the scratch file.
+ *
+ * @param X
+ */
+void Lanczos_Basis_Free(struct BindStruct *X)
+{
+  char sdt[D_FileNameMax];
+  char ctmpPath[D_FileNameMax] = "";
+  int k;
+
+  if (BasisMem != NULL) {
+    for (k = 1; k <= NMem; k++) free(BasisMem[k]);
+    free(BasisMem);
+    BasisMem = NULL;
+  }
+  if (BasisMemR != NULL) {
+    for (k = 1; k <= NMem; k++) free(BasisMemR[k]);
+    free(BasisMemR);
+    BasisMemR = NULL;
+  }
+  if (BasisFp != NULL) {
+    fclose(BasisFp);
+    BasisFp = NULL;
+    sprintf(sdt, cFileNameLanczosBasis, X->Def.CDataFileHead, myrank);
+    strcat(ctmpPath, cParentOutputFolder);
+    strcat(ctmpPath, sdt);
+    remove(ctmpPath);
+  }
+  NStored = 0;
+  NMem = 0;
+}
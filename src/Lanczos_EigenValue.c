@@ -22,8 +22,98 @@
 #include "FileIO.h"
 #include "matrixlapack.h"
 #include "Lanczos_EigenValue.h"
+#include "Lanczos_Basis.h"
 #include "wrapperMPI.h"
 
+/**
+ * @brief Residual of the Lanczos recurrence and its norm in a single pass:
+ * tmp_v0 = (tmp_v0 - alpha*tmp_v1)/dscale.
+ *
+ * @param i_max dimension of the vectors
+ * @param alpha diagonal element of the tridiagonal matrix
+ * @param dscale scale of @p tmp_v1 (and of @p tmp_v0) relative to the normalized Lanczos vector
+ * @param tmp_v0 [in,out] H tmp_v1 minus the previous Lanczos vector / the residual
+ * @param tmp_v1 [in] current Lanczos vector multiplied by @p dscale
+ *
+ * @return norm of the residual (beta)
+ */
+double Lanczos_Residual(
+  long int i_max,
+  double alpha,
+  double dscale,
+  double complex *tmp_v0,
+  double complex *tmp_v1
+)
+{
+  long int i;
+  double dnorm, dscale_inv;
+
+  dscale_inv = 1.0 / dscale;
+  dnorm = 0.0;
+#pragma omp parallel for default(none) reduction(+:dnorm) private(i) shared(tmp_v0, tmp_v1) \
+firstprivate(i_max, alpha, dscale_inv)
+  for (i = 1; i <= i_max; i++) {
+    tmp_v0[i] = (tmp_v0[i] - alpha * tmp_v1[i]) * dscale_inv;
+    dnorm += creal(conj(tmp_v0[i]) * tmp_v0[i]);
+  }
+  dnorm = SumMPI_d(dnorm);
+  return sqrt(dnorm);
+}
+
+/**
+ * @brief Real version of Lanczos_Residual.
+ *
+ * @param i_max dimension of the vectors
+ * @param alpha diagonal element of the tridiagonal matrix
+ * @param dscale scale of @p tmp_v1 (and of @p tmp_v0) relative to the normalized Lanczos vector
+ * @param tmp_v0 [in,out] H tmp_v1 minus the previous Lanczos vector / the residual
+ * @param tmp_v1 [in] current Lanczos vector multiplied by @p dscale
+ *
+ * @return norm of the residual (beta)
+ */
+static double Lanczos_Residual_Real(
+  long int i_max,
+  double alpha,
+  double dscale,
+  double *tmp_v0,
+  double *tmp_v1
+)
+{
+  long int i;
+  double dnorm, dscale_inv;
+
+  dscale_inv = 1.0 / dscale;
+  dnorm = 0.0;
+#pragma omp parallel for default(none) reduction(+:dnorm) private(i) shared(tmp_v0, tmp_v1) \
+firstprivate(i_max, alpha, dscale_inv)
+  for (i = 1; i <= i_max; i++) {
+    tmp_v0[i] = (tmp_v0[i] - alpha * tmp_v1[i]) * dscale_inv;
+    dnorm += tmp_v0[i] * tmp_v0[i];
+  }
+  dnorm = SumMPI_d(dnorm);
+  return sqrt(dnorm);
+}
+
+/**
+ * @brief Store the real parts of a complex vector as a real vector in the same memory.
+ * The real vector takes the first half of @p tmp_v. The loop is not parallelized
+ * because the element i is written over the element i/2 of the complex vector.
+ *
+ * @param i_max dimension of the vector
+ * @param tmp_v [in,out] complex vector / real vector
+ *
+ * @return the real vector
+ */
+double *Lanczos_RealVector(long int i_max, double complex *tmp_v)
+{
+  long int i;
+  double *tmp_r;
+
+  tmp_r = (double *)tmp_v;
+  for (i = 0; i <= i_max; i++) tmp_r[i] = creal(tmp_v[i]);
+  return tmp_r;
+}
+
 /** 
  * 
  * 
@@ -45,8 +135,10 @@ int Lanczos_EigenValue(struct BindStruct *X)
   int k_exct,Target;
   int iconv=-1;
   double beta1,alpha1; //beta,alpha1 should be real
-  double  complex temp1,temp2;
-  double complex cbeta1;
+  double dscale, dscale_prev;
+  double complex *tmp_A, *tmp_B, *tmp_swap;
+  double *tmp_rA, *tmp_rB, *tmp_rswap;
+  int iReal;
   double E[5],ebefor;
   int mythread;
 
@@ -147,26 +239,57 @@ int Lanczos_EigenValue(struct BindStruct *X)
     }
   }/*else if(initial_mode==1)*/
   
+  /*
+    With real couplings and a real initial vector, the Lanczos vectors
+    are kept real in the first half of v0 and v1.
+  */
+  iReal = mltply_real_Check(X);
+  tmp_rA = NULL;
+  tmp_rB = NULL;
+  if (iReal == TRUE) {
+    fprintf(stdoutMPI, "%s", cLogLanczosReal);
+    tmp_rA = Lanczos_RealVector(i_max, v0);
+    tmp_rB = Lanczos_RealVector(i_max, v1);
+  }
+  else fprintf(stdoutMPI, cLogLanczosComplex, mltply_real_Reason(X));
+
   //Eigenvalues by Lanczos method
   TimeKeeper(X, cFileNameTimeKeep, cLanczos_EigenValueStart, "a");
-  mltply(X, v0, v1);
+  Lanczos_Basis_Init(X, iReal);
+  if (iReal == TRUE) {
+    Lanczos_Basis_StoreReal(X, 1, tmp_rB);
+    mltply_real(X, 1.0, tmp_rA, tmp_rB);
+  }
+  else {
+    Lanczos_Basis_Store(X, 1, v1);
+    mltply(X, v0, v1);
+  }
   stp=1;
   TimeKeeperWithStep(X, cFileNameTimeKeep, cLanczos_EigenValueStep, "a", stp);
 
     alpha1=creal(X->Large.prdct) ;// alpha = v^{\dag}*H*v
 
   alpha[1]=alpha1;
-  cbeta1=0.0;
-  
-#pragma omp parallel for reduction(+:cbeta1) default(none) private(i) shared(v0, v1) firstprivate(i_max, alpha1)
-  for(i = 1; i <= i_max; i++){
-    cbeta1+=conj(v0[i]-alpha1*v1[i])*(v0[i]-alpha1*v1[i]);
+  if (iReal == TRUE) {
+    beta1 = Lanczos_Residual_Real(i_max, alpha1, 1.0, tmp_rA, tmp_rB);
+    Lanczos_Basis_StoreReal(X, 2, tmp_rA);
+  }
+  else {
+    beta1 = Lanczos_Residual(i_max, alpha1, 1.0, v0, v1);
+    Lanczos_Basis_Store(X, 2, v0);
   }
-  cbeta1 = SumMPI_dc(cbeta1);
-  beta1=creal(cbeta1);
-  beta1=sqrt(beta1);
   beta[1]=beta1;
   ebefor=0;
+  /*
+    The Lanczos vectors are kept unnormalized: tmp_A = dscale*v_{stp},
+    tmp_B = dscale_prev*v_{stp-1}. The normalization and the subtraction
+    of the previous vector are folded into mltply_scale and Lanczos_Residual,
+    so that each step needs only one extra pass over the vectors.
+  */
+  tmp_A = v0;
+  tmp_B = v1;
+  dscale = beta1;
+  dscale_prev = 1.0;
 
 /*
       Set Maximum number of loop to the dimention of the Wavefunction
@@ -194,28 +317,29 @@ int Lanczos_EigenValue(struct BindStruct *X)
     fprintf(stdoutMPI, "  LanczosStep  E[1] E[2] E[3] E[4] \n");
 #endif
   for(stp = 2; stp <= X->Def.Lanczos_max; stp++){
-#pragma omp parallel for default(none) private(i,temp1, temp2) shared(v0, v1) firstprivate(i_max, alpha1, beta1)
-    for(i=1;i<=i_max;i++){
-      temp1 = v1[i];
-      temp2 = (v0[i]-alpha1*v1[i])/beta1;
-      v0[i] = -beta1*temp1;
-      v1[i] =  temp2;
-    }
-
-      mltply(X, v0, v1);
-      TimeKeeperWithStep(X, cFileNameTimeKeep, cLanczos_EigenValueStep, "a", stp);
-    alpha1=creal(X->Large.prdct);
+    //tmp_B = dscale*(H v_{stp} - beta_{stp-1} v_{stp-1})
+    if (iReal == TRUE) mltply_real(X, -dscale*dscale/dscale_prev, tmp_rB, tmp_rA);
+    else mltply_scale(X, -dscale*dscale/dscale_prev, tmp_B, tmp_A);
+    TimeKeeperWithStep(X, cFileNameTimeKeep, cLanczos_EigenValueStep, "a", stp);
+    alpha1=creal(X->Large.prdct)/(dscale*dscale);
     alpha[stp]=alpha1;
-    cbeta1=0.0;
-
-#pragma omp parallel for reduction(+:cbeta1) default(none) private(i) shared(v0, v1) firstprivate(i_max, alpha1)
-    for(i=1;i<=i_max;i++){
-      cbeta1+=conj(v0[i]-alpha1*v1[i])*(v0[i]-alpha1*v1[i]);
+    if (iReal == TRUE) {
+      beta1 = Lanczos_Residual_Real(i_max, alpha1, dscale, tmp_rB, tmp_rA);
+      Lanczos_Basis_StoreReal(X, stp + 1, tmp_rB);
+    }
+    else {
+      beta1 = Lanczos_Residual(i_max, alpha1, dscale, tmp_B, tmp_A);
+      Lanczos_Basis_Store(X, stp + 1, tmp_B);
     }
-    cbeta1 = SumMPI_dc(cbeta1);
-    beta1=creal(cbeta1);
-    beta1=sqrt(beta1);
     beta[stp]=beta1;
+    dscale_prev = dscale;
+    dscale = beta1;
+    tmp_swap = tmp_A;
+    tmp_A = tmp_B;
+    tmp_B = tmp_swap;
+    tmp_rswap = tmp_rA;
+    tmp_rA = tmp_rB;
+    tmp_rB = tmp_rswap;
 
     Target  = X->Def.LanczosTarget;
         
@@ -351,10 +475,8 @@ int Lanczos_GetTridiagonalMatrixComponents(
  unsigned long int i_max_tmp, sum_i_max;
  int k_exct,Target;
  double beta1,alpha1; //beta,alpha1 should be real
- double  complex temp1,temp2;
- double complex cbeta1;
- double complex *tmp_v0;
- c_malloc1(tmp_v0, i_max);
+ double dscale, dscale_prev;
+ double complex *tmp_A, *tmp_B, *tmp_swap;
  
  sprintf(sdt, cFileNameLanczosStep, X->Def.CDataFileHead);  
   
@@ -379,16 +501,12 @@ int Lanczos_GetTridiagonalMatrixComponents(
   stp=1;
   alpha1=creal(X->Large.prdct) ;// alpha = v^{\dag}*H*v
   alpha[1]=alpha1;
-  cbeta1=0.0;
-  
-#pragma omp parallel for reduction(+:cbeta1) default(none) private(i) shared(v0, v1) firstprivate(i_max, alpha1)
-  for(i = 1; i <= i_max; i++){
-    cbeta1+=conj(v0[i]-alpha1*v1[i])*(v0[i]-alpha1*v1[i]);
-  }
-  cbeta1 = SumMPI_dc(cbeta1);
-  beta1=creal(cbeta1);
-  beta1=sqrt(beta1);
+  beta1 = Lanczos_Residual(i_max, alpha1, 1.0, v0, tmp_v1);
   beta[1]=beta1;
+  tmp_A = v0;
+  tmp_B = tmp_v1;
+  dscale = beta1;
+  dscale_prev = 1.0;
   
   for(stp = 2; stp <= *liLanczos_step; stp++){
       if(fabs(beta[stp-1])<pow(10.0, -14)){
@@ -396,28 +514,16 @@ int Lanczos_GetTridiagonalMatrixComponents(
           break;
       }
 
-#pragma omp parallel for default(none) private(i,temp1, temp2) shared(v0, v1) firstprivate(i_max, alpha1, beta1)
-      for(i=1;i<=i_max;i++){
-	temp1 = v1[i];
-	temp2 = (v0[i]-alpha1*v1[i])/beta1;
-	v0[i] = -beta1*temp1;
-	v1[i] =  temp2;
-      }
-
-      mltply(X, v0, v1);
-      
-      alpha1=creal(X->Large.prdct);
+      mltply_scale(X, -dscale*dscale/dscale_prev, tmp_B, tmp_A);
+      alpha1=creal(X->Large.prdct)/(dscale*dscale);
       alpha[stp]=alpha1;
-      cbeta1=0.0;
-      
-#pragma omp parallel for reduction(+:cbeta1) default(none) private(i) shared(v0, v1) firstprivate(i_max, alpha1)
-      for(i=1;i<=i_max;i++){
-	    cbeta1+=conj(v0[i]-alpha1*v1[i])*(v0[i]-alpha1*v1[i]);
-      }
-      cbeta1 = SumMPI_dc(cbeta1);
-      beta1=creal(cbeta1);
-      beta1=sqrt(beta1);
-      beta[stp]=beta1;                    
+      beta1 = Lanczos_Residual(i_max, alpha1, dscale, tmp_B, tmp_A);
+      beta[stp]=beta1;
+      dscale_prev = dscale;
+      dscale = beta1;
+      tmp_swap = tmp_A;
+      tmp_A = tmp_B;
+      tmp_B = tmp_swap;
   }
   
   for(stp = 1; stp <= *liLanczos_step; stp++) {
@@ -16,8 +16,11 @@
 
 #include "Common.h"
 #include "mltply.h"
+#include "Lanczos_EigenValue.h"
 #include "Lanczos_EigenVector.h"
+#include "Lanczos_Basis.h"
 #include "wrapperMPI.h"
+#include "mfmemory.h"
 
 /**
  *
@@ -30,46 +33,212 @@
  * 
  */
 
+/**
+ * @brief Accumulate the eigenvectors to the columns of @p V from the Lanczos vectors kept by Lanczos_EigenValue,
+ * and set the last two of them for the recurrence of the remaining steps.
+ *
+ * @param X
+ * @param nstored number of the kept vectors used (>= 2)
+ * @param nstate number of the eigenvectors
+ * @param kstate [nstate] index of each eigenvector in vec
+ * @param lld leading dimension of @p V
+ * @param V [out] the eigenvectors (not normalized)
+ * @param tmp_A [out] beta[nstored-1] times the Lanczos vector nstored
+ * @param tmp_B [out] beta[nstored-2] times the Lanczos vector nstored-1
+ */
+static void Lanczos_EigenVector_Stored(
+  struct BindStruct *X,
+  int nstored,
+  int nstate,
+  int *kstate,
+  long int lld,
+  double complex *V,
+  double complex **tmp_A,
+  double complex **tmp_B
+)
+{
+  long int j, i_max;
+  int k, ist;
+  double complex *coef;
+  double complex *cur, *prev, *bufA, *bufB;
+
+  i_max = X->Check.idim_max;
+  coef = (double complex *)malloc(sizeof(double complex) * nstate);
+  /*
+    A vector in the scratch file is read into v0 (even steps) or v1 (odd steps),
+    so that the last two are in different buffers.
+  */
+  bufA = (nstored % 2 == 0) ? v0 : v1;
+  bufB = (nstored % 2 == 0) ? v1 : v0;
+
+  cur = Lanczos_Basis_Get(X, 1, v1);
+  for (ist = 0; ist < nstate; ist++) coef[ist] = vec[kstate[ist]][1];
+#pragma omp parallel for default(none) private(j, ist) shared(V, cur, coef) firstprivate(i_max, lld, nstate)
+  for (j = 1; j <= i_max; j++)
+    for (ist = 0; ist < nstate; ist++) V[lld*ist + j] = conj(cur[j])*coef[ist];
+
+  prev = cur;
+  for (k = 2; k <= nstored; k++) {
+    cur = Lanczos_Basis_Get(X, k, (k % 2 == 0) ? v0 : v1);
+    for (ist = 0; ist < nstate; ist++) coef[ist] = conj(vec[kstate[ist]][k]) / beta[k - 1];
+#pragma omp parallel for default(none) private(j, ist) shared(V, cur, coef) firstprivate(i_max, lld, nstate)
+    for (j = 1; j <= i_max; j++)
+      for (ist = 0; ist < nstate; ist++) V[lld*ist + j] += coef[ist]*cur[j];
+    if (k < nstored) prev = cur;
+  }
+  free(coef);
+
+  if (prev != bufB) {
+#pragma omp parallel for default(none) private(j) shared(bufB, prev) firstprivate(i_max)
+    for (j = 1; j <= i_max; j++) bufB[j] = prev[j];
+  }
+  if (cur != bufA) {
+#pragma omp parallel for default(none) private(j) shared(bufA, cur) firstprivate(i_max)
+    for (j = 1; j <= i_max; j++) bufA[j] = cur[j];
+  }
+  *tmp_A = bufA;
+  *tmp_B = bufB;
+}
+
+/**
+ * @brief Real version of Lanczos_EigenVector_Stored. The last two vectors are set
+ * in the first halves of v0 and v1.
+ *
+ * @param X
+ * @param nstored number of the kept vectors used (>= 2)
+ * @param nstate number of the eigenvectors
+ * @param kstate [nstate] index of each eigenvector in vec
+ * @param lld leading dimension of @p V
+ * @param V [out] the eigenvectors (not normalized)
+ * @param tmp_A [out] beta[nstored-1] times the Lanczos vector nstored
+ * @param tmp_B [out] beta[nstored-2] times the Lanczos vector nstored-1
+ */
+static void Lanczos_EigenVector_StoredReal(
+  struct BindStruct *X,
+  int nstored,
+  int nstate,
+  int *kstate,
+  long int lld,
+  double complex *V,
+  double **tmp_A,
+  double **tmp_B
+)
+{
+  long int j, i_max;
+  int k, ist;
+  double complex *coef;
+  double *cur, *prev, *bufA, *bufB, *rv0, *rv1;
+
+  i_max = X->Check.idim_max;
+  coef = (double complex *)malloc(sizeof(double complex) * nstate);
+  rv0 = (double *)v0;
+  rv1 = (double *)v1;
+  bufA = (nstored % 2 == 0) ? rv0 : rv1;
+  bufB = (nstored % 2 == 0) ? rv1 : rv0;
+
+  cur = Lanczos_Basis_GetReal(X, 1, rv1);
+  for (ist = 0; ist < nstate; ist++) coef[ist] = vec[kstate[ist]][1];
+#pragma omp parallel for default(none) private(j, ist) shared(V, cur, coef) firstprivate(i_max, lld, nstate)
+  for (j = 1; j <= i_max; j++)
+    for (ist = 0; ist < nstate; ist++) V[lld*ist + j] = cur[j]*coef[ist];
+
+  prev = cur;
+  for (k = 2; k <= nstored; k++) {
+    cur = Lanczos_Basis_GetReal(X, k, (k % 2 == 0) ? rv0 : rv1);
+    for (ist = 0; ist < nstate; ist++) coef[ist] = conj(vec[kstate[ist]][k]) / beta[k - 1];
+#pragma omp parallel for default(none) private(j, ist) shared(V, cur, coef) firstprivate(i_max, lld, nstate)
+    for (j = 1; j <= i_max; j++)
+      for (ist = 0; ist < nstate; ist++) V[lld*ist + j] += coef[ist]*cur[j];
+    if (k < nstored) prev = cur;
+  }
+  free(coef);
+
+  if (prev != bufB) {
+#pragma omp parallel for default(none) private(j) shared(bufB, prev) firstprivate(i_max)
+    for (j = 1; j <= i_max; j++) bufB[j] = prev[j];
+  }
+  if (cur != bufA) {
+#pragma omp parallel for default(none) private(j) shared(bufA, cur) firstprivate(i_max)
+    for (j = 1; j <= i_max; j++) bufA[j] = cur[j];
+  }
+  *tmp_A = bufA;
+  *tmp_B = bufB;
+}
+
 /** 
- * @brief Function for calculating eigenvectors by Lanczos method.
+ * @brief Accumulate the eigenvectors vec[kstate[ist]] of the tridiagonal matrix
+ * to the columns of @p V by the second Lanczos recurrence.
  * 
- * @param _X parameter List for getting information to calculate eigenvectors.
+ * @param X parameter List for getting information to calculate eigenvectors.
+ * @param nstate number of the eigenvectors
+ * @param kstate [nstate] index of each eigenvector in vec
+ * @param lld leading dimension of @p V
+ * @param V [out] the eigenvectors (not normalized)
  * @version 0.2
  * @details add an option to choose a type of initial vectors from complex or real types. 
+ * If Lanczos_EigenValue has kept the Lanczos vectors (LanczosBasis),
+ * the recurrence is run only for the steps which are not kept.
+ * All the eigenvectors are accumulated in the same recurrence.
  * @version 0.1
  * @author Takahiro Misawa (The University of Tokyo)
  * @author Kazuyoshi Yoshimi (The University of Tokyo) 
  */
-void Lanczos_EigenVector(struct BindStruct *X){
-
-  fprintf(stdoutMPI, "%s", cLogLanczos_EigenVectorStart);
-  TimeKeeper(X, cFileNameTimeKeep, cLanczos_EigenVectorStart, "a");
+static void Lanczos_EigenVector_Accumulate(
+  struct BindStruct *X,
+  int nstate,
+  int *kstate,
+  long int lld,
+  double complex *V
+){
 
     long int i,j,i_max,iv;
-  int k_exct, iproc;
+  int iproc, nstored, istart, ist;
   double beta1,alpha1,dnorm, dnorm_inv;
-  double complex temp1,temp2,cdnorm;
+  double dscale, dscale_prev;
+  double complex cdnorm;
+  double complex *coef;
+  double complex *tmp_A, *tmp_B, *tmp_swap;
+  double *tmp_rA, *tmp_rB, *tmp_rswap;
+  int iReal;
   int mythread;
 
 // for GC
   long unsigned int u_long_i, sum_i_max, i_max_tmp;
   dsfmt_t dsfmt;
 
-  k_exct = X->Def.k_exct;
+  coef = (double complex *)malloc(sizeof(double complex) * nstate);
 	
   iv=X->Large.iv;
   i_max=X->Check.idim_max;
+
+  nstored = Lanczos_Basis_Count();
+  if (nstored > X->Large.itr) nstored = X->Large.itr;
  
-  if(initial_mode == 0){
+  /*
+    The recurrence is run with real vectors as in Lanczos_EigenValue
+  */
+  iReal = mltply_real_Check(X);
+  tmp_rA = NULL;
+  tmp_rB = NULL;
+
+  if (nstored >= 2) {
+    fprintf(stdoutMPI, cLogLanczosBasisUse, nstored, X->Large.itr);
+    if (iReal == TRUE) Lanczos_EigenVector_StoredReal(X, nstored, nstate, kstate, lld, V, &tmp_rA, &tmp_rB);
+    else Lanczos_EigenVector_Stored(X, nstored, nstate, kstate, lld, V, &tmp_A, &tmp_B);
+    istart = nstored;
+    dscale = beta[nstored - 1];
+    dscale_prev = (nstored > 2) ? beta[nstored - 2] : 1.0;
+  }
+  else if(initial_mode == 0){
 
     sum_i_max = SumMPI_li(X->Check.idim_max);
     X->Large.iv = (sum_i_max / 2 + X->Def.initial_iv) % sum_i_max + 1;
     iv=X->Large.iv;
-#pragma omp parallel for default(none) private(i) shared(v0, v1,vg) firstprivate(i_max)
+#pragma omp parallel for default(none) private(i, ist) shared(v0, v1, V) firstprivate(i_max, lld, nstate)
     for(i = 1; i <= i_max; i++){
       v0[i]=0.0;
       v1[i]=0.0;
-      vg[i]=0.0;
+      for (ist = 0; ist < nstate; ist++) V[lld*ist + i]=0.0;
     }
 
     sum_i_max = 0;
@@ -84,7 +253,8 @@ void Lanczos_EigenVector(struct BindStruct *X){
             v1[iv - sum_i_max+1] += 1.0*I;
             v1[iv - sum_i_max+1] /= sqrt(2.0);
           }
-	  vg[iv - sum_i_max+1]=vec[k_exct][1]*conj(v1[iv - sum_i_max+1]);
+          for (ist = 0; ist < nstate; ist++)
+            V[lld*ist + iv - sum_i_max+1]=vec[kstate[ist]][1]*conj(v1[iv - sum_i_max+1]);
 
         }/*if (myrank == iproc)*/
       }/*if (sum_i_max <= iv && iv < sum_i_max + i_max_tmp)*/
@@ -138,69 +308,169 @@ void Lanczos_EigenVector(struct BindStruct *X){
     cdnorm = SumMPI_dc(cdnorm);
     dnorm=creal(cdnorm);
     dnorm=sqrt(dnorm);
-#pragma omp parallel for default(none) private(i) shared(v1, vec, vg) firstprivate(i_max, dnorm, k_exct)
+    for (ist = 0; ist < nstate; ist++) coef[ist] = vec[kstate[ist]][1];
+#pragma omp parallel for default(none) private(i, ist) shared(v1, V, coef) firstprivate(i_max, dnorm, lld, nstate)
     for(i=1;i<=i_max;i++){
       v1[i] = v1[i]/dnorm;
-      vg[i] = conj(v1[i])*vec[k_exct][1];
+      for (ist = 0; ist < nstate; ist++) V[lld*ist + i] = conj(v1[i])*coef[ist];
     }
   }/*else if(initial_mode==1)*/
   
-  mltply(X, v0, v1);
-  
-  alpha1=alpha[1];
-  beta1=beta[1];
-
-#pragma omp parallel for default(none) private(j) shared(vec, v0, v1, vg) firstprivate(alpha1, beta1, i_max, k_exct)
-  for(j=1;j<=i_max;j++){
-    //    vg[j]+=vec[k_exct][2]*(v0[j]-alpha1*v1[j])/beta1;
-    vg[j]+=conj(vec[k_exct][2])*(v0[j]-alpha1*v1[j])/beta1;
+  if (nstored < 2 && iReal == TRUE) {
+    tmp_rA = Lanczos_RealVector(i_max, v0);
+    tmp_rB = Lanczos_RealVector(i_max, v1);
   }
 
-  //iteration
-  for(i=2;i<=X->Large.itr-1;i++) {
-      /*
-    if (abs(beta[i]) < pow(10.0, -15)) {
-      break;
+  if (nstored < 2) {
+    alpha1=alpha[1];
+    beta1=beta[1];
+    for (ist = 0; ist < nstate; ist++) coef[ist] = conj(vec[kstate[ist]][2]) / beta1;
+
+    if (iReal == TRUE) {
+      mltply_real(X, 1.0, tmp_rA, tmp_rB);
+#pragma omp parallel for default(none) private(j, ist) shared(tmp_rA, tmp_rB, V, coef) firstprivate(alpha1, i_max, lld, nstate)
+      for(j=1;j<=i_max;j++){
+        tmp_rA[j] -= alpha1*tmp_rB[j];
+        for (ist = 0; ist < nstate; ist++) V[lld*ist + j] += coef[ist]*tmp_rA[j];
+      }
     }
-*/
-#pragma omp parallel for default(none) private(j, temp1, temp2) shared(v0, v1) firstprivate(i_max, alpha1, beta1)
-    for (j = 1; j <= i_max; j++) {
-      temp1 = v1[j];
-      temp2 = (v0[j] - alpha1 * v1[j]) / beta1;
-      v0[j] = -beta1 * temp1;
-      v1[j] = temp2;
+    else {
+      mltply(X, v0, v1);
+#pragma omp parallel for default(none) private(j, ist) shared(v0, v1, V, coef) firstprivate(alpha1, i_max, lld, nstate)
+      for(j=1;j<=i_max;j++){
+        v0[j] -= alpha1*v1[j];
+        for (ist = 0; ist < nstate; ist++) V[lld*ist + j] += coef[ist]*v0[j];
+      }
     }
-    mltply(X, v0, v1);
+    /*
+      As in Lanczos_EigenValue, tmp_A = dscale*v_{i} and tmp_B = dscale_prev*v_{i-1}
+      are kept unnormalized, and the residual is accumulated to V in the same pass.
+    */
+    tmp_A = v0;
+    tmp_B = v1;
+    dscale = beta1;
+    dscale_prev = 1.0;
+    istart = 2;
+  }
 
+  //iteration
+  for(i=istart;i<=X->Large.itr-1;i++) {
     alpha1 = alpha[i];
     beta1 = beta[i];
-#pragma omp parallel for default(none) private(j) shared(vec, v0, v1, vg) firstprivate(alpha1, beta1, i_max, k_exct, i)
-    for (j = 1; j <= i_max; j++) {
-      //      vg[j] += vec[k_exct][i+1]*(v0[j]-alpha1*v1[j])/beta1;
-      vg[j] += conj(vec[k_exct][i + 1]) * (v0[j] - alpha1 * v1[j]) / beta1;
+    dnorm_inv = 1.0/dscale;
+    for (ist = 0; ist < nstate; ist++) coef[ist] = conj(vec[kstate[ist]][i + 1]) / beta1;
+
+    if (iReal == TRUE) {
+      mltply_real(X, -dscale*dscale/dscale_prev, tmp_rB, tmp_rA);
+#pragma omp parallel for default(none) private(j, ist) shared(tmp_rA, tmp_rB, V, coef) firstprivate(alpha1, dnorm_inv, i_max, lld, nstate)
+      for (j = 1; j <= i_max; j++) {
+        tmp_rB[j] = (tmp_rB[j] - alpha1 * tmp_rA[j]) * dnorm_inv;
+        for (ist = 0; ist < nstate; ist++) V[lld*ist + j] += coef[ist] * tmp_rB[j];
+      }
     }
+    else {
+      mltply_scale(X, -dscale*dscale/dscale_prev, tmp_B, tmp_A);
+#pragma omp parallel for default(none) private(j, ist) shared(tmp_A, tmp_B, V, coef) firstprivate(alpha1, dnorm_inv, i_max, lld, nstate)
+      for (j = 1; j <= i_max; j++) {
+        tmp_B[j] = (tmp_B[j] - alpha1 * tmp_A[j]) * dnorm_inv;
+        for (ist = 0; ist < nstate; ist++) V[lld*ist + j] += coef[ist] * tmp_B[j];
+      }
+    }
+    dscale_prev = dscale;
+    dscale = beta1;
+    tmp_swap = tmp_A;
+    tmp_A = tmp_B;
+    tmp_B = tmp_swap;
+    tmp_rswap = tmp_rA;
+    tmp_rA = tmp_rB;
+    tmp_rB = tmp_rswap;
   }
 
-#pragma omp parallel for default(none) private(j) shared(v0, vg) firstprivate(i_max)
-    for(j=1;j<=i_max;j++){
-      v0[j] = vg[j];
-    } 
-      
+  free(coef);
+}
+
+/** 
+ * @brief Function for calculating eigenvectors by Lanczos method.
+ * The exct-th eigenvector is stored in v0.
+ * 
+ * @param _X parameter List for getting information to calculate eigenvectors.
+ * @details The eigenvector is not refined here, so that it is as accurate as the convergence
+ * of the Lanczos vectors (diff_ene in the output) allows. Beyond that accuracy, its energy
+ * depends on the rounding errors of the recurrence (MltplyMode, the number of the threads).
+ * @version 0.1
+ * @author Takahiro Misawa (The University of Tokyo)
+ * @author Kazuyoshi Yoshimi (The University of Tokyo) 
+ */
+void Lanczos_EigenVector(struct BindStruct *X){
+
+  long int j, i_max;
+  int k_exct;
+  double dnorm, dnorm_inv;
+
+  fprintf(stdoutMPI, "%s", cLogLanczos_EigenVectorStart);
+  TimeKeeper(X, cFileNameTimeKeep, cLanczos_EigenVectorStart, "a");
+
+  k_exct = X->Def.k_exct;
+  i_max = X->Check.idim_max;
+  Lanczos_EigenVector_Accumulate(X, 1, &k_exct, i_max + 1, vg);
+
   //normalization
   dnorm=0.0;
-#pragma omp parallel for default(none) reduction(+:dnorm) private(j) shared(v0) firstprivate(i_max)
+#pragma omp parallel for default(none) reduction(+:dnorm) private(j) shared(vg) firstprivate(i_max)
   for(j=1;j<=i_max;j++){
-    dnorm += conj(v0[j])*v0[j];
+    dnorm += conj(vg[j])*vg[j];
   }
   dnorm = SumMPI_d(dnorm);
   dnorm=sqrt(dnorm);
   dnorm_inv=1.0/dnorm;
-#pragma omp parallel for default(none) private(j) shared(v0) firstprivate(i_max, dnorm_inv)
+#pragma omp parallel for default(none) private(j) shared(v0, vg) firstprivate(i_max, dnorm_inv)
   for(j=1;j<=i_max;j++){
-    v0[j] = v0[j]*dnorm_inv;
-    //printf("debug: v0[%ld]=(%lf, %lf)\n", j, creal(v0[j]), cimag(v0[j]));
+    v0[j] = vg[j]*dnorm_inv;
   }
+  Lanczos_Basis_Free(X);
   
   TimeKeeper(X, cFileNameTimeKeep, cLanczos_EigenVectorFinish, "a");
   fprintf(stdoutMPI, "%s", cLogLanczos_EigenVectorEnd);
 }
+
+/**
+ * @brief Calculate the lowest @p nstate eigenvectors by Lanczos method
+ * in a single pass over the kept Lanczos vectors, or in a single recurrence.
+ *
+ * @param X parameter List for getting information to calculate eigenvectors.
+ * @param nstate number of the eigenvectors (<= nvec)
+ * @param lld leading dimension of @p V
+ * @param V [out] the normalized eigenvectors in the columns (V[lld*ist + j], j = 1, ..., idim_max)
+ */
+void Lanczos_EigenVectorBlock(struct BindStruct *X, int nstate, long int lld, double complex *V){
+
+  long int j, i_max;
+  int ist;
+  int *kstate;
+  double dnorm, dnorm_inv;
+  double complex *vj;
+
+  fprintf(stdoutMPI, "%s", cLogLanczos_EigenVectorStart);
+  TimeKeeper(X, cFileNameTimeKeep, cLanczos_EigenVectorStart, "a");
+
+  i_max = X->Check.idim_max;
+  i_malloc1(kstate, nstate);
+  for (ist = 0; ist < nstate; ist++) kstate[ist] = ist + 1;
+  Lanczos_EigenVector_Accumulate(X, nstate, kstate, lld, V);
+  i_free1(kstate, nstate);
+
+  for (ist = 0; ist < nstate; ist++) {
+    vj = V + lld * ist;
+    dnorm = 0.0;
+#pragma omp parallel for default(none) reduction(+:dnorm) private(j) shared(vj) firstprivate(i_max)
+    for (j = 1; j <= i_max; j++) dnorm += conj(vj[j])*vj[j];
+    dnorm = SumMPI_d(dnorm);
+    dnorm_inv = 1.0 / sqrt(dnorm);
+#pragma omp parallel for default(none) private(j) shared(vj) firstprivate(i_max, dnorm_inv)
+    for (j = 1; j <= i_max; j++) vj[j] *= dnorm_inv;
+  }
+  Lanczos_Basis_Free(X);
+
+  TimeKeeper(X, cFileNameTimeKeep, cLanczos_EigenVectorFinish, "a");
+  fprintf(stdoutMPI, "%s", cLogLanczos_EigenVectorEnd);
+}
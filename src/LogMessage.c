@@ -30,6 +30,28 @@ const char* cOMPSzFinish=  "omp parallel sz finishes: %s";
 const char* cSingleSzStart="single sz starts: %s";
 const char* cSingleSzFinish= "single sz finishes: %s";
 const char* cReadSzStart ="READ=1: read starts: %s";
+const char* cBasisCacheRead= "  BasisCache: the %s is read from the cache files.\n";
+const char* cBasisCacheWrite= "  BasisCache: the %s is written to the cache files.\n";
+const char* cBasisCacheWriteFail= "  BasisCache: the cache file of the %s can not be written on rank %d.\n";
+const char* cLogLanczosBasisInit= "  LanczosBasis: up to %d Lanczos vectors (%lf GB each) are kept in the memory.\n";
+const char* cLogLanczosBasisFileFail= "  LanczosBasis: the scratch file can not be written at step %d; the rest is recomputed.\n";
+const char* cLogLanczosBasisUse= "  LanczosBasis: %d of %d Lanczos vectors are kept.\n";
+const char* cLogTPQReal= "  TPQ vectors are real (real couplings and InitialVecType=1).\n";
+const char* cLogTPQComplex= "  TPQ vectors are complex (%s).\n";
+const char* cLogTPQSingle= "  TPQPrecision: TPQ vectors are stored in single precision.\n";
+const char* cLogTPQSingleOff= "  TPQPrecision: single precision needs the fused sweep (MltplyMode=1, 2 or 3) and one process. Double precision is used.\n";
+const char* cLogTPQSingleNorm= "  TPQPrecision: |<v|v>-1| = %e at step %d. The vector is normalized again.\n";
+const char* cLogTransSymMltply= "  Warning: MltplyMode=%d is not available in the symmetrized basis (TransSym, SpinFlip). MltplyMode=1 is used.\n";
+const char* cLogMPIRowMltply= "  Warning: MltplyMode=%d is not available when the rows are distributed over the processes. MltplyMode=2 is used.\n";
+const char* cLogMPIRowCSR= "  MltplyMode: %ld of %ld stored elements refer to the rows of the other processes (%ld components received per H*v).\n";
+const char* cLogLanczosReal= "  Lanczos vectors are real (real couplings and InitialVecType=1).\n";
+const char* cLogLanczosComplex= "  Lanczos vectors are complex (%s).\n";
+const char* cLogLanczosBlock= "  %d eigenvectors are calculated in one Lanczos recurrence.\n";
+const char* cLogLanczosBlockMalloc= "  %d eigenvectors (%lf GB) can not be allocated; only the exct-th one is calculated.\n";
+const char* cLogLanczosBlockResidual= "  i=%5d residual=%.5e\n";
+const char* cLogLanczosBlockCap= "  Only %d of nvec=%d eigenvectors are built from the Lanczos vectors; all of them are calculated by LOBPCG method starting from these.\n";
+const char* cLogLanczosBlockRefine= "  %d of %d eigenvectors are not converged (max residual %.5e >= %.5e); they are refined by LOBPCG method.\n";
+const char* cStateSzTime= "  sz: %s basis of %ld states built in %.3f s (%d threads).\n";
 const char* cReadSzEnd  ="READ=1: read finishes: %s";
 
 //CG_EigenVector.c
@@ -38,6 +60,24 @@ const char* cLogCG_EigenVecEnd="  End  : Calculate EigenVector by CG method.\n";
 const char* cCG_EigenVecStart= "CG Eigenvector starts:        %s";
 const char* cCG_EigenVecFinish="CG Eigenvector finishes:      %s";
 
+//CalcByLOBPCG.c
+const char* cLogLOBPCGStart="  Start: Calculate %d eigenvectors by LOBPCG method (block size %d, %d vectors, %lf GB).\n";
+const char* cLogLOBPCGStep="  LOBPCG step %d: %d of %d converged, max residual %.5e, E[0] = %.10lf\n";
+const char* cLogLOBPCGMltply="  LOBPCG: %d steps, %ld H*v products.\n";
+const char* cLogLOBPCGNotConverged="  LOBPCG is not converged within Lanczos_max steps.\n";
+const char* cLogLOBPCGEnd="  End  : Calculate eigenvectors by LOBPCG method.\n";
+const char* cLOBPCGStart= "LOBPCG starts:                %s";
+const char* cLOBPCGFinish="LOBPCG finishes:              %s";
+
+//CalcByTRLanczos.c
+const char* cLogTRLanczosStart="  Start: Calculate %d eigenvectors by thick-restart Lanczos method (%d Lanczos vectors, %d kept at a restart, %lf GB).\n";
+const char* cLogTRLanczosRestart="  restart %d: %ld H*v products, %d of %d converged, max residual %.5e, E[0] = %.10lf\n";
+const char* cLogTRLanczosMltply="  Thick-restart Lanczos: %d restarts, %ld H*v products.\n";
+const char* cLogTRLanczosNotConverged="  Thick-restart Lanczos is not converged within Lanczos_max H*v products.\n";
+const char* cLogTRLanczosEnd="  End  : Calculate eigenvectors by thick-restart Lanczos method.\n";
+const char* cTRLanczosStart= "Thick-restart Lanczos starts:   %s";
+const char* cTRLanczosFinish="Thick-restart Lanczos finishes: %s";
+
 //diagonalcalc.c
 const char* cDiagonalCalcFinish="diagonal calculation finishes: %s";
 
@@ -48,6 +48,8 @@ void StdFace_InputSpin(struct StdIntList *StdI, double Jp[3][3],
 void StdFace_InputCoulombV(struct StdIntList *StdI, double *V0, char *V0name);
 void StdFace_InputHopp(struct StdIntList *StdI, double complex *t0, char *t0name);
 
+void StdFace_FoldSite2D(struct StdIntList *StdI,
+  int iW, int iL, int *iCell0, int *iCell1, int *iWfold, int *iLfold);
 void StdFace_InitSite2D(struct StdIntList *StdI, FILE *fp,
   double Wx0, double Wy0, double Lx0, double Ly0);
 void StdFace_SetLabel(struct StdIntList *StdI, FILE *fp,
@@ -120,6 +120,9 @@ static void StdFace_ResetVals(struct StdIntList *StdI) {
   StdI->LanczosTarget = 9999;
   StdI->NumAve = 9999;
   StdI->ExpecInterval = 9999;
+  StdI->k0 = 9999;
+  StdI->k1 = 9999;
+  StdI->SpinFlip = 9999;
 
 }
 
@@ -537,11 +540,89 @@ static void PrintNamelist(struct StdIntList *StdI){
 
   if (StdI->lBoost == 1) 
     fprintf(fp, "Boost boost.def\n");
+  if (StdI->lTransSym == 1)
+    fprintf(fp, "TransSym qptransidx.def\n");
 
   fclose(fp);
   fprintf(stdout, "    namelist.def is written.\n");
 }
 
+/**
+ *
+ * Print qptransidx.def: translations of the lattice and
+ * the phase exp(i 2pi (k0 x0 + k1 x1)) for the translation (x0, x1) in the fractional coordinate
+ *
+ */
+static void PrintTransSym(struct StdIntList *StdI)
+{
+  FILE *fp;
+  int iCell, jCell, kCell, isiteUC, iW, iL;
+  int jCell0, jCell1, jWfold, jLfold;
+  double x0, x1;
+  double complex phase;
+
+  if (strcmp(StdI->lattice, "chain") == 0
+    || strcmp(StdI->lattice, "chainlattice") == 0) {
+    StdFace_NotUsed_i("k1", StdI->k1);
+  }
+  else if (strcmp(StdI->lattice, "ladder") == 0
+    || strcmp(StdI->lattice, "ladderlattice") == 0) {
+    fprintf(stdout, "\n ERROR ! k0 and k1 are not supported for the ladder lattice.\n");
+    exitMPI(-1);
+  }
+  else StdFace_PrintVal_i("k1", &StdI->k1, 0);
+  StdFace_PrintVal_i("k0", &StdI->k0, 0);
+
+  fp = fopen("qptransidx.def", "w");
+  if (strcmp(StdI->lattice, "chain") == 0
+    || strcmp(StdI->lattice, "chainlattice") == 0) {
+    fprintf(fp, "=============================================\n");
+    fprintf(fp, "NTransSym %10d\n", StdI->L);
+    fprintf(fp, "=============================================\n");
+    fprintf(fp, "======== TrIdx_TrWeight_and_TrIdx_i_xi ======\n");
+    fprintf(fp, "=============================================\n");
+    for (iL = 0; iL < StdI->L; iL++) {
+      phase = cexp(2.0 * M_PI * I * (double)(StdI->k0 * iL) / (double)StdI->L);
+      fprintf(fp, "%5d %25.15f %25.15f\n", iL, creal(phase), cimag(phase));
+    }
+    for (iL = 0; iL < StdI->L; iL++) {
+      for (kCell = 0; kCell < StdI->L; kCell++) {
+        fprintf(fp, "%5d %5d %5d\n", iL, kCell, (kCell + iL) % StdI->L);
+      }
+    }
+  }
+  else {
+    fprintf(fp, "=============================================\n");
+    fprintf(fp, "NTransSym %10d\n", StdI->NCell);
+    fprintf(fp, "=============================================\n");
+    fprintf(fp, "======== TrIdx_TrWeight_and_TrIdx_i_xi ======\n");
+    fprintf(fp, "=============================================\n");
+    for (iCell = 0; iCell < StdI->NCell; iCell++) {
+      iW = StdI->Cell[iCell][0];
+      iL = StdI->Cell[iCell][1];
+      x0 = StdI->bW0 * (double)iW + StdI->bL0 * (double)iL;
+      x1 = StdI->bW1 * (double)iW + StdI->bL1 * (double)iL;
+      phase = cexp(2.0 * M_PI * I * ((double)StdI->k0 * x0 + (double)StdI->k1 * x1));
+      fprintf(fp, "%5d %25.15f %25.15f\n", iCell, creal(phase), cimag(phase));
+    }
+    for (iCell = 0; iCell < StdI->NCell; iCell++) {
+      for (kCell = 0; kCell < StdI->NCell; kCell++) {
+        StdFace_FoldSite2D(StdI, StdI->Cell[kCell][0] + StdI->Cell[iCell][0],
+          StdI->Cell[kCell][1] + StdI->Cell[iCell][1], &jCell0, &jCell1, &jWfold, &jLfold);
+        for (jCell = 0; jCell < StdI->NCell; jCell++) {
+          if (jWfold == StdI->Cell[jCell][0] && jLfold == StdI->Cell[jCell][1]) break;
+        }
+        for (isiteUC = 0; isiteUC < StdI->NsiteUC; isiteUC++) {
+          fprintf(fp, "%5d %5d %5d\n", iCell,
+            StdI->NsiteUC * kCell + isiteUC, StdI->NsiteUC * jCell + isiteUC);
+        }
+      }
+    }
+  }
+  fclose(fp);
+  fprintf(stdout, "    qptransidx.def is written.\n");
+}
+
 /**
  *
  * Print calcmod.def
@@ -591,6 +672,7 @@ static void PrintCalcMod(struct StdIntList *StdI)
   fprintf(fp, "FlgFiniteTemperature %3d\n", StdI->FlgTemp);
   fprintf(fp, "CalcModel %3d\n", iCalcModel);
   fprintf(fp, "OutputMode %3d\n", ioutputmode2);
+  if (StdI->SpinFlip != 0) fprintf(fp, "SpinFlip %3d\n", StdI->SpinFlip);
   fclose(fp);
   fprintf(stdout, "     calcmod.def is written.\n");
 }
@@ -1101,6 +1183,8 @@ void StdFace_main(char *fname  /**< [in] Input file name for the standard mode *
     else if (strcmp(keyword, "j'zx") == 0) StoreWithCheckDup_d(keyword, value, &StdI.Jp[2][0]);
     else if (strcmp(keyword, "j'zy") == 0) StoreWithCheckDup_d(keyword, value, &StdI.Jp[2][1]);
     else if (strcmp(keyword, "k") == 0) StoreWithCheckDup_d(keyword, value, &StdI.K);
+    else if (strcmp(keyword, "k0") == 0) StoreWithCheckDup_i(keyword, value, &StdI.k0);
+    else if (strcmp(keyword, "k1") == 0) StoreWithCheckDup_i(keyword, value, &StdI.k1);
     else if (strcmp(keyword, "l") == 0) StoreWithCheckDup_i(keyword, value, &StdI.L);
     else if (strcmp(keyword, "lanczoseps") == 0) StoreWithCheckDup_i(keyword, value, &StdI.LanczosEps);
     else if (strcmp(keyword, "lanczostarget") == 0) StoreWithCheckDup_i(keyword, value, &StdI.LanczosTarget);
@@ -1118,6 +1202,7 @@ void StdFace_main(char *fname  /**< [in] Input file name for the standard mode *
     else if (strcmp(keyword, "nvec") == 0) StoreWithCheckDup_i(keyword, value, &StdI.nvec);
     else if (strcmp(keyword, "2sz") == 0) StoreWithCheckDup_i(keyword, value, &StdI.Sz2);
     else if (strcmp(keyword, "2s") == 0) StoreWithCheckDup_i(keyword, value, &StdI.S2);
+    else if (strcmp(keyword, "spinflip") == 0) StoreWithCheckDup_i(keyword, value, &StdI.SpinFlip);
     else if (strcmp(keyword, "t") == 0) StoreWithCheckDup_c(keyword, value, &StdI.t);
     else if (strcmp(keyword, "t0") == 0) StoreWithCheckDup_c(keyword, value, &StdI.t0);
     else if (strcmp(keyword, "t1") == 0) StoreWithCheckDup_c(keyword, value, &StdI.t1);
@@ -1213,6 +1298,32 @@ void StdFace_main(char *fname  /**< [in] Input file name for the standard mode *
   /**/
   CheckModPara(&StdI);
   CheckOutputMode(&StdI);
+  /*
+  Momentum-resolved basis
+  */
+  StdI.lTransSym = 0;
+  if (StdI.k0 != 9999 || StdI.k1 != 9999) {
+    if (StdI.lGC == 1
+      || ((strcmp(StdI.model, "spin") != 0 || StdI.lBoost == 1 || StdI.S2 != 1)
+          && (strcmp(StdI.model, "hubbard") != 0 || StdI.Sz2 == 9999))) {
+      fprintf(stdout, "\n ERROR ! k0 and k1 are available only for the spin-1/2 Spin model and the Hubbard model with 2Sz.\n");
+      exitMPI(-1);
+    }
+    StdI.lTransSym = 1;
+  }
+  if (StdI.SpinFlip != 9999) {
+    if (StdI.lGC == 1 || StdI.Sz2 != 0
+      || ((strcmp(StdI.model, "spin") != 0 || StdI.lBoost == 1 || StdI.S2 != 1)
+          && strcmp(StdI.model, "hubbard") != 0)) {
+      fprintf(stdout, "\n ERROR ! SpinFlip is available only for the spin-1/2 Spin model and the Hubbard model with 2Sz=0.\n");
+      exitMPI(-1);
+    }
+    if (StdI.SpinFlip != 1 && StdI.SpinFlip != -1 && StdI.SpinFlip != 0) {
+      fprintf(stdout, "\n ERROR ! SpinFlip must be 1 (even), -1 (odd), or 0.\n");
+      exitMPI(-1);
+    }
+  }
+  else StdI.SpinFlip = 0;
   /**/
   fprintf(stdout, "\n");
   fprintf(stdout, "######  Print Expert input files  ######\n");
@@ -1225,6 +1336,7 @@ void StdFace_main(char *fname  /**< [in] Input file name for the standard mode *
   PrintModPara(&StdI);
   Print1Green(&StdI);
   Print2Green(&StdI);
+  if (StdI.lTransSym == 1) PrintTransSym(&StdI);
   /*
   Finalize All
   */
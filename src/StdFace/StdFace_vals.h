@@ -119,6 +119,13 @@ struct StdIntList {
   int nintr;
   int **intrindx;
   double complex *intr;
+  /*
+   Momentum of the symmetrized basis
+  */
+  int k0;
+  int k1;
+  int lTransSym;
+  int SpinFlip;/**<Sector of the global spin flip (1: even, -1: odd) for 2Sz=0.*/
   /*
    Boost
   */
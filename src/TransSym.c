@@ -0,0 +1,839 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+// Symmetrized basis for the spin-1/2 Spin model and the Hubbard model
+//
+// The group {T_g} of site permutations (e.g. translations) and its
+// one-dimensional representation chi(g) are read from the TransSym file.
+// With SpinFlip in the CalcMod file (only for 2Sz=0), the group is doubled
+// by the global spin flip F (up and down are exchanged), chi(F T_g) = +-chi(g).
+// Without the TransSym file the group is {1, F}.
+// For the Hubbard model, T_g maps c_{i sigma} to c_{T_g(i) sigma} and F maps
+// c_{i sigma} to c_{i -sigma}, so that T_g|b> = s_g(b)|b'> with the fermion
+// sign s_g(b) of reordering the creation operators; s_g(b) = 1 for the Spin model.
+// The basis state of the representative |r> (the smallest bit pattern in
+// its orbit) is
+//   |r~> = sqrt(|G|/n_r) P|r>,  P = (1/|G|) sum_g conj(chi(g)) T_g,
+//   n_r  = sum_{g: T_g r = r} conj(chi(g)) s_g(r),
+// and satisfies T_g|r~> = chi(g)|r~>. States with n_r = 0 do not appear.
+// list_1 holds the representatives in the ascending order and list_jb[ib]
+// is the number of representatives whose upper half bits are smaller than ib.
+// The Hamiltonian is multiplied row by row from the operator program
+// (TransSym_Mltply), or stored from the same rows (MltplyMode=2, 3).
+
+#include <bitcalc.h>
+#include "mfmemory.h"
+#include "mltplyFused.h"
+#include "TransSym.h"
+#include "wrapperMPI.h"
+
+/**
+ * @brief Number of bits of a state: a bit per site for the Spin model,
+ * and bits 2i (up) and 2i+1 (down) for the site i of the Hubbard model.
+ *
+ * @param X
+ *
+ * @return number of bits
+ */
+static inline int TransSym_NBit(struct BindStruct *X)
+{
+  return (X->Def.iCalcModel == Spin) ? X->Def.Nsite : 2 * X->Def.Nsite;
+}
+
+/**
+ * @brief Image of the state @p ibit by the operation @p g.
+ *
+ * @param X
+ * @param g index of the operation
+ * @param ibit bit pattern
+ * @param sgn [out] fermion sign s_g(ibit) (always 1 for the Spin model)
+ *
+ * @return bit pattern of T_g|ibit>
+ */
+static inline long unsigned int TransSym_Apply(
+  struct BindStruct *X,
+  int g,
+  long unsigned int ibit,
+  int *sgn
+  )
+{
+  int ibyte, nbyte, gperm, tmp_sgn;
+  long unsigned int jbit, kbit, mbit, v;
+  const long unsigned int *table;
+
+  nbyte = X->Large.NTransSymByte;
+  gperm = g % X->Large.NTransSymPerm;
+  table = X->Large.TransSymTable + (long unsigned int)gperm * nbyte * 256;
+  jbit = 0;
+  *sgn = 1;
+  if (X->Def.iCalcModel == Spin) {
+    for (ibyte = 0; ibyte < nbyte; ibyte++) {
+      jbit |= table[ibyte * 256 + ((ibit >> (8 * ibyte)) & 0xff)];
+    }
+    if (g >= X->Large.NTransSymPerm) jbit ^= X->Large.TransSymFlipMask;
+    return jbit;
+  }
+  /*The sign is the parity of the pairs of occupied orbitals whose order is reversed*/
+  for (ibyte = 0; ibyte < nbyte; ibyte++) {
+    for (v = (ibit >> (8 * ibyte)) & 0xff; v != 0; v &= v - 1) {
+      kbit = table[ibyte * 256 + (v & (~v + 1))];
+      mbit = jbit & ~((kbit << 1) - 1);
+      SgnBit(mbit, &tmp_sgn);
+      *sgn *= tmp_sgn;
+      jbit |= kbit;
+    }
+  }
+  if (g >= X->Large.NTransSymPerm) {
+    /*c^+_{i up} c^+_{i down} is reordered at the doubly occupied sites*/
+    mbit = X->Large.TransSymFlipMask;
+    SgnBit(jbit & (jbit >> 1) & mbit, &tmp_sgn);
+    *sgn *= tmp_sgn;
+    jbit = ((jbit & mbit) << 1) | ((jbit >> 1) & mbit);
+  }
+  return jbit;
+}
+
+/**
+ * @brief Check whether the state is a representative in the basis.
+ *
+ * @param X
+ * @param ibit bit pattern
+ * @param norm [out] n_r of the representative
+ *
+ * @retval TRUE @p ibit is the smallest in its orbit and n_r is not zero.
+ * @retval FALSE otherwise
+ */
+static int TransSym_IsRep(
+  struct BindStruct *X,
+  long unsigned int ibit,
+  double *norm
+  )
+{
+  int g, sgn;
+  long unsigned int jbit;
+  double complex dnorm;
+
+  dnorm = 0.0;
+  for (g = 0; g < X->Large.NTransSymOp; g++) {
+    jbit = TransSym_Apply(X, g, ibit, &sgn);
+    if (jbit < ibit) return FALSE;
+    if (jbit == ibit) dnorm += conj(X->Large.TransSymChar[g]) * sgn;
+  }
+  *norm = creal(dnorm);
+  return (*norm > 0.5) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Find the representative of the state.
+ *
+ * @param X
+ * @param ibit bit pattern
+ * @param rbit [out] representative r, T_h|ibit> = s_h(ibit)|r>
+ * @param phase [out] chi(h) s_h(ibit)
+ * @param norm [out] n_r (0 if the orbit does not appear in the basis)
+ */
+static void TransSym_Canonical(
+  struct BindStruct *X,
+  long unsigned int ibit,
+  long unsigned int *rbit,
+  double complex *phase,
+  double *norm
+  )
+{
+  int g, h, sgn, hsgn;
+  long unsigned int jbit, kbit;
+  double complex dnorm;
+
+  /*The stabilizers of the states in an orbit are conjugate, so n_r is obtained from ibit.*/
+  dnorm = 0.0;
+  kbit = ibit;
+  h = 0;
+  hsgn = 1;
+  for (g = 0; g < X->Large.NTransSymOp; g++) {
+    jbit = TransSym_Apply(X, g, ibit, &sgn);
+    if (jbit < kbit) {
+      kbit = jbit;
+      h = g;
+      hsgn = sgn;
+    }
+    if (jbit == ibit) dnorm += conj(X->Large.TransSymChar[g]) * sgn;
+  }
+  *rbit = kbit;
+  *phase = X->Large.TransSymChar[h] * hsgn;
+  *norm = creal(dnorm);
+}
+
+/**
+ * @brief Index of the representative by the binary search in its block.
+ *
+ * @param rbit representative
+ * @param ihfbit a half bit to split the state into the upper and lower halves
+ *
+ * @return index (1 origin), 0 if not found
+ */
+static long unsigned int TransSym_Index(
+  long unsigned int rbit,
+  long unsigned int ihfbit
+  )
+{
+  long unsigned int ib, ilow, ihigh, imid;
+
+  ib = rbit / ihfbit;
+  ilow = list_jb[ib] + 1;
+  ihigh = list_jb[ib + 1];
+  while (ilow <= ihigh) {
+    imid = (ilow + ihigh) / 2;
+    if (list_1[imid] == rbit) return imid;
+    else if (list_1[imid] < rbit) ilow = imid + 1;
+    else ihigh = imid - 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Count (and store) the representatives whose upper half bits are @p ib.
+ *
+ * @param X
+ * @param ib upper half bits
+ * @param ihfbit a half bit to split the state into the upper and lower halves
+ * @param list [out] representatives in the ascending order (not stored if NULL)
+ *
+ * @return number of representatives
+ */
+static long unsigned int TransSym_Block(
+  struct BindStruct *X,
+  long unsigned int ib,
+  long unsigned int ihfbit,
+  long unsigned int *list
+  )
+{
+  int nlow;
+  long unsigned int ia, ibit, icnt;
+  double norm;
+
+  nlow = X->Def.Ne - PopCountBit(ib);
+  if (nlow < 0 || (1ul << nlow) > ihfbit) return 0;
+
+  icnt = 0;
+  for (ia = (1ul << nlow) - 1; ia < ihfbit; ia = snoob(ia)) {
+    ibit = ib * ihfbit + ia;
+    /*For the Hubbard model, the number of up electrons (even bits) is also fixed*/
+    if ((X->Def.iCalcModel == Spin || PopCountBit(ibit & 0x5555555555555555ul) == X->Def.Nup)
+        && TransSym_IsRep(X, ibit, &norm) == TRUE) {
+      if (list != NULL) list[icnt] = ibit;
+      icnt++;
+    }
+    if (ia == 0) break;
+  }
+  return icnt;
+}
+
+/**
+ * @brief Check the symmetry operations and the characters in the TransSym file
+ * and make the lookup table of the bit permutations and the characters of the group
+ * including the spin flip.
+ * Must be called after ReadDefFileIdxPara.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished (or neither TransSym nor SpinFlip is used)
+ * @retval -1 unnormally finished
+ */
+int TransSym_Init(struct BindStruct *X)
+{
+  int g, h, k, i, nsym, nperm, nop, nsite, nbit, nbyte, ibyte, v, iorb, isite, jsite;
+  int *icheck, *iprod;
+  long unsigned int *table, jbit;
+  double complex *chi;
+
+  X->Large.NTransSymOp = 0;
+  X->Large.NTransSymPerm = 0;
+  X->Large.NTransSymByte = 0;
+  X->Large.TransSymTable = NULL;
+  X->Large.TransSymFlipMask = 0;
+  X->Large.TransSymChar = NULL;
+  X->Large.iFlgTransSymReal = TRUE;
+  nsym = X->Def.NTransSym;
+  nsite = X->Def.Nsite;
+  nbit = TransSym_NBit(X);
+  if (nsym <= 0 && X->Def.iSpinFlip == SPINFLIP_NONE) return 0;
+
+  if ((X->Def.iCalcModel != Spin && X->Def.iCalcModel != Hubbard) || X->Def.iFlgGeneralSpin == TRUE
+      || nbit > 8 * (int)sizeof(long unsigned int) - 1) {
+    fprintf(stdoutMPI, "%s", cErrTransSymModel);
+    return -1;
+  }
+  /*The orbits are not split over the processes*/
+  if (nproc != 1) {
+    fprintf(stdoutMPI, "%s", cErrTransSymMPI);
+    return -1;
+  }
+  if (X->Def.iSpinFlip != SPINFLIP_NONE && X->Def.Nup != X->Def.Ndown) {
+    fprintf(stdoutMPI, "%s", cErrTransSymSz);
+    return -1;
+  }
+  if ((X->Def.iCalcType == TPQCalc && X->Def.iTPQPrecision == TPQ_MIXED)
+      || X->Def.READ == 1 || X->Def.WRITE == 1 || X->Boost.flgBoost == TRUE) {
+    fprintf(stdoutMPI, "%s", cErrTransSymCalc);
+    return -1;
+  }
+  /*
+    Each operation is a permutation of sites and |chi(g)| = 1
+  */
+  i_malloc1(icheck, nsite);
+  for (g = 0; g < nsym; g++) {
+    for (i = 0; i < nsite; i++) icheck[i] = 0;
+    for (i = 0; i < nsite; i++) {
+      if (X->Def.TransSymSite[g][i] < 0 || X->Def.TransSymSite[g][i] >= nsite
+          || icheck[X->Def.TransSymSite[g][i]] != 0) {
+        fprintf(stdoutMPI, cErrTransSymPerm, g);
+        free(icheck);
+        return -1;
+      }
+      icheck[X->Def.TransSymSite[g][i]] = 1;
+    }
+    if (fabs(cabs(X->Def.ParaTransSym[g]) - 1.0) > D_TransSymEps) {
+      fprintf(stdoutMPI, cErrTransSymChar, g, g);
+      free(icheck);
+      return -1;
+    }
+    if (fabs(cimag(X->Def.ParaTransSym[g])) > D_TransSymEps) X->Large.iFlgTransSymReal = FALSE;
+  }
+  free(icheck);
+  /*
+    The operations form a group and chi(gh) = chi(g)chi(h)
+  */
+  i_malloc1(iprod, nsite);
+  for (g = 0; g < nsym; g++) {
+    for (h = 0; h < nsym; h++) {
+      for (i = 0; i < nsite; i++) iprod[i] = X->Def.TransSymSite[g][X->Def.TransSymSite[h][i]];
+      for (k = 0; k < nsym; k++) {
+        for (i = 0; i < nsite; i++) {
+          if (X->Def.TransSymSite[k][i] != iprod[i]) break;
+        }
+        if (i == nsite) break;
+      }
+      if (k == nsym || (h < g && memcmp(X->Def.TransSymSite[g], X->Def.TransSymSite[h], sizeof(int) * nsite) == 0)) {
+        fprintf(stdoutMPI, cErrTransSymGroup, g, h);
+        free(iprod);
+        return -1;
+      }
+      if (cabs(X->Def.ParaTransSym[k] - X->Def.ParaTransSym[g] * X->Def.ParaTransSym[h]) > D_TransSymEps) {
+        fprintf(stdoutMPI, cErrTransSymChar, g, h);
+        free(iprod);
+        return -1;
+      }
+    }
+  }
+  free(iprod);
+  /*
+    Lookup table of the bit permutation for each byte.
+    Without the TransSym file, the identity is the only permutation.
+  */
+  nperm = (nsym > 0) ? nsym : 1;
+  nop = (X->Def.iSpinFlip == SPINFLIP_NONE) ? nperm : 2 * nperm;
+  nbyte = (nbit + 7) / 8;
+  lui_malloc1(table, (long unsigned int)nperm * nbyte * 256);
+  c_malloc1(chi, nop);
+  if (table == NULL || chi == NULL) return -1;
+  for (g = 0; g < nperm; g++) {
+    for (ibyte = 0; ibyte < nbyte; ibyte++) {
+      for (v = 0; v < 256; v++) {
+        jbit = 0;
+        for (i = 0; i < 8 && 8 * ibyte + i < nbit; i++) {
+          /*The orbital 2i+sigma of the Hubbard model is moved with the site i*/
+          iorb = 8 * ibyte + i;
+          isite = (X->Def.iCalcModel == Spin) ? iorb : iorb / 2;
+          jsite = (nsym > 0) ? X->Def.TransSymSite[g][isite] : isite;
+          if ((v >> i) & 1) jbit |= (X->Def.iCalcModel == Spin) ? 1ul << jsite : 1ul << (2 * jsite + iorb % 2);
+        }
+        table[((long unsigned int)g * nbyte + ibyte) * 256 + v] = jbit;
+      }
+    }
+  }
+  /*F commutes with the permutations, so the product of the two groups is a group.*/
+  for (g = 0; g < nperm; g++) {
+    chi[g] = (nsym > 0) ? X->Def.ParaTransSym[g] : 1.0;
+    if (nop > nperm) chi[nperm + g] = (double)X->Def.iSpinFlip * chi[g];
+  }
+  X->Large.NTransSymOp = nop;
+  X->Large.NTransSymPerm = nperm;
+  X->Large.NTransSymByte = nbyte;
+  X->Large.TransSymTable = table;
+  /*All bits for the Spin model and the up orbitals for the Hubbard model*/
+  if (nop == nperm) X->Large.TransSymFlipMask = 0;
+  else if (X->Def.iCalcModel == Spin) X->Large.TransSymFlipMask = (1ul << nbit) - 1;
+  else X->Large.TransSymFlipMask = 0x5555555555555555ul & ((1ul << nbit) - 1);
+  X->Large.TransSymChar = chi;
+
+  /*The matrix elements are given by the operator program, on the fly or stored*/
+  if (X->Def.iMltplyMode != MLTPLY_FUSED && X->Def.iMltplyMode != MLTPLY_CSR && X->Def.iMltplyMode != MLTPLY_AUTO) {
+    fprintf(stdoutMPI, cLogTransSymMltply, X->Def.iMltplyMode);
+    X->Def.iMltplyMode = MLTPLY_FUSED;
+  }
+  if (nsym > 0)
+    fprintf(stdoutMPI, "  TransSym: symmetrized basis with %d operations.\n", nsym);
+  if (X->Def.iSpinFlip != SPINFLIP_NONE)
+    fprintf(stdoutMPI, "  SpinFlip: %s sector of the global spin flip.\n",
+            (X->Def.iSpinFlip == SPINFLIP_EVEN) ? "even" : "odd");
+  return 0;
+}
+
+/**
+ * @brief Dimension of the symmetrized basis. Used in check instead of the binomial coefficient.
+ *
+ * @param X
+ *
+ * @return number of representatives
+ */
+long unsigned int TransSym_Count(struct BindStruct *X)
+{
+  long unsigned int ib, nib, ihfbit, icnt;
+
+  ihfbit = 1ul << ((TransSym_NBit(X) + 1) / 2);
+  nib = 1ul << (TransSym_NBit(X) / 2);
+  icnt = 0;
+#pragma omp parallel for default(none) reduction(+:icnt) schedule(dynamic) private(ib) firstprivate(nib, ihfbit, X)
+  for (ib = 0; ib < nib; ib++) {
+    icnt += TransSym_Block(X, ib, ihfbit, NULL);
+  }
+  return icnt;
+}
+
+/**
+ * @brief Store the representatives in list_1 and the offsets of the blocks in list_jb.
+ * Called from sz instead of the enumeration of all states.
+ *
+ * @param X
+ *
+ * @return number of representatives
+ */
+long unsigned int TransSym_sz(struct BindStruct *X)
+{
+  long unsigned int ib, nib, ihfbit;
+
+  ihfbit = 1ul << ((TransSym_NBit(X) + 1) / 2);
+  nib = 1ul << (TransSym_NBit(X) / 2);
+
+  list_jb[0] = 0;
+#pragma omp parallel for default(none) schedule(dynamic) private(ib) firstprivate(nib, ihfbit, X) shared(list_jb)
+  for (ib = 0; ib < nib; ib++) {
+    list_jb[ib + 1] = TransSym_Block(X, ib, ihfbit, NULL);
+  }
+  for (ib = 0; ib < nib; ib++) list_jb[ib + 1] += list_jb[ib];
+
+#pragma omp parallel for default(none) schedule(dynamic) private(ib) firstprivate(nib, ihfbit, X) shared(list_1, list_jb)
+  for (ib = 0; ib < nib; ib++) {
+    TransSym_Block(X, ib, ihfbit, &list_1[list_jb[ib] + 1]);
+  }
+  return list_jb[nib];
+}
+
+/**
+ * @brief Get the off-diagonal elements in the row @p j of the Hamiltonian in the symmetrized basis:
+ * <s~|H|r~> = sum_{b in orbit of r} <s|H|b> chi(h_b) sqrt(n_r/n_s), where T_{h_b}|b> = |r>.
+ * Elements in the same column are not merged. The column can be @p j itself.
+ *
+ * @param X
+ * @param j row index (1 origin)
+ * @param ihfbit a half bit to split the state into the upper and lower halves
+ * @param off [out] column indices (length X->Large.NFusedTerm)
+ * @param val [out] matrix elements (length X->Large.NFusedTerm)
+ *
+ * @return number of elements
+ */
+static long unsigned int TransSym_Row(
+  struct BindStruct *X,
+  long unsigned int j,
+  long unsigned int ihfbit,
+  long unsigned int *off,
+  double complex *val
+  )
+{
+  long unsigned int nbit, ibitelem, nelem, rbit;
+  double norm_j, norm;
+  double complex phase;
+
+  TransSym_IsRep(X, list_1[j], &norm_j);
+
+  /*Column states are converted into indices in place*/
+  nbit = mltply_fused_GetRowBit(X, list_1[j], off, val);
+  nelem = 0;
+  for (ibitelem = 0; ibitelem < nbit; ibitelem++) {
+    TransSym_Canonical(X, off[ibitelem], &rbit, &phase, &norm);
+    if (norm < 0.5) continue;
+    off[nelem] = TransSym_Index(rbit, ihfbit);
+    val[nelem] = val[ibitelem] * phase * sqrt(norm / norm_j);
+    nelem++;
+  }
+  return nelem;
+}
+
+/**
+ * @brief Get the off-diagonal elements in the row @p j of the Hamiltonian in the symmetrized basis
+ * (see TransSym_Row). Elements in the same column are summed up. Used to store the Hamiltonian.
+ *
+ * @param X
+ * @param j row index (1 origin)
+ * @param off [out] column indices (length X->Large.NFusedTerm)
+ * @param val [out] matrix elements (length X->Large.NFusedTerm)
+ *
+ * @return number of elements
+ */
+long unsigned int TransSym_GetRow(
+  struct BindStruct *X,
+  long unsigned int j,
+  long unsigned int *off,
+  double complex *val
+  )
+{
+  long unsigned int nbit, ibitelem, nelem, ielem, joff;
+  double complex coef;
+
+  nbit = TransSym_Row(X, j, 1ul << ((TransSym_NBit(X) + 1) / 2), off, val);
+  nelem = 0;
+  for (ibitelem = 0; ibitelem < nbit; ibitelem++) {
+    joff = off[ibitelem];
+    coef = val[ibitelem];
+    for (ielem = 0; ielem < nelem; ielem++) {
+      if (off[ielem] == joff) break;
+    }
+    if (ielem == nelem) {
+      off[nelem] = joff;
+      val[nelem] = 0.0;
+      nelem++;
+    }
+    val[ielem] += coef;
+  }
+  return nelem;
+}
+
+/**
+ * @brief Symmetrized version of mltply_fused and mltply_fused_block:
+ * tmp_v0 = dscale*tmp_v0 + H tmp_v1 for @p nvec vectors stored interleaved
+ * (the component j of the vector l is at [j*nvec+l]). The elements of each row are computed
+ * on the fly by TransSym_Row, so that the Hamiltonian is not stored.
+ * X->Large.prdct is incremented by <tmp_v1|H|tmp_v1>.
+ *
+ * @param X
+ * @param nvec number of vectors
+ * @param dscale factor applied to @p tmp_v0 before the product is added
+ * @param tmp_v0 [in,out] result vectors
+ * @param tmp_v1 [in] input vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int TransSym_Mltply(
+  struct BindStruct *X,
+  int nvec,
+  double dscale,
+  double complex *tmp_v0,
+  double complex *tmp_v1
+  )
+{
+  long unsigned int i_max, nterm, ihfbit, j, jk, offk, nelem, ielem, k;
+  int ivec, iflg;
+  long unsigned int *off;
+  double complex *val;
+  double complex dam_pr, dmv;
+
+  i_max = X->Check.idim_max;
+  nterm = X->Large.NFusedTerm;
+  ihfbit = 1ul << ((TransSym_NBit(X) + 1) / 2);
+  k = nvec;
+  dam_pr = 0.0;
+  iflg = TRUE;
+
+#pragma omp parallel default(none) reduction(+:dam_pr) private(j, jk, offk, nelem, ielem, ivec, off, val, dmv) \
+  firstprivate(i_max, nterm, ihfbit, k, nvec, dscale, X) shared(tmp_v0, tmp_v1, list_Diagonal, iflg)
+  {
+    lui_malloc1(off, nterm + 1);
+    c_malloc1(val, nterm + 1);
+    if (off == NULL || val == NULL) {
+#pragma omp atomic write
+      iflg = FALSE;
+    }
+#pragma omp barrier
+    if (iflg == TRUE) {
+#pragma omp for schedule(dynamic, 64)
+      for (j = 1; j <= i_max; j++) {
+        nelem = TransSym_Row(X, j, ihfbit, off, val);
+        jk = j * k;
+        for (ivec = 0; ivec < nvec; ivec++) {
+          dmv = list_Diagonal[j] * tmp_v1[jk + ivec];
+          for (ielem = 0; ielem < nelem; ielem++) {
+            offk = off[ielem] * k;
+            dmv += val[ielem] * tmp_v1[offk + ivec];
+          }
+          tmp_v0[jk + ivec] = dscale * tmp_v0[jk + ivec] + dmv;
+          dam_pr += conj(tmp_v1[jk + ivec]) * dmv;
+        }
+      }
+    }
+    free(off);
+    free(val);
+  }
+  if (iflg == FALSE) {
+    fprintf(stdoutMPI, "%s", cErrTransSymMalloc);
+    return -1;
+  }
+  X->Large.prdct += dam_pr;
+  return 0;
+}
+
+/*
+  Expectation values of the operators already calculated for the current state.
+  For a state in a one-dimensional representation, <T_g A T_g^-1> = |chi(g)|^2 <A> = <A>,
+  so that the operators in the same orbit of the group share one entry.
+*/
+static long unsigned int *TransSym_ExpecKey = NULL; /*!< Packed operators (0 for the empty slot)*/
+static double complex *TransSym_ExpecVal = NULL;    /*!< Expectation values*/
+static long unsigned int TransSym_NExpec = 0;       /*!< Number of the entries*/
+static long unsigned int TransSym_NExpecSlot = 0;   /*!< Size of the hash table (power of 2)*/
+
+/**
+ * @brief Forget the expectation values of the previous state.
+ * Must be called before the Green's functions of a new state are calculated by TransSym_Expec.
+ */
+void TransSym_ExpecReset(void)
+{
+  free(TransSym_ExpecKey);
+  free(TransSym_ExpecVal);
+  TransSym_ExpecKey = NULL;
+  TransSym_ExpecVal = NULL;
+  TransSym_NExpec = 0;
+  TransSym_NExpecSlot = 0;
+}
+
+/**
+ * @brief Key of the orbit of the operator: the smallest of the packed images
+ * (site*2+spin+1 for each operator, 8 bits each) by the operations of the group.
+ *
+ * @param X
+ * @param nop number of operators (2 or 4)
+ * @param site site indices (0 origin)
+ * @param spin spin indices
+ *
+ * @return key (not 0)
+ */
+static long unsigned int TransSym_ExpecOrbit(
+  struct BindStruct *X,
+  int nop,
+  const long unsigned int *site,
+  const long unsigned int *spin
+  )
+{
+  int g, iop;
+  long unsigned int key, gkey, gsite, gspin;
+
+  key = 0;
+  for (g = 0; g < X->Large.NTransSymOp; g++) {
+    gkey = 0;
+    for (iop = 0; iop < nop; iop++) {
+      gsite = (X->Def.NTransSym > 0) ? X->Def.TransSymSite[g % X->Large.NTransSymPerm][site[iop]] : site[iop];
+      gspin = (g >= X->Large.NTransSymPerm) ? 1 - spin[iop] : spin[iop];
+      gkey |= (gsite * 2 + gspin + 1) << (8 * iop);
+    }
+    if (key == 0 || gkey < key) key = gkey;
+  }
+  return key;
+}
+
+/**
+ * @brief Find the slot of the key in the hash table (linear probing).
+ *
+ * @param key key of the orbit
+ *
+ * @return slot holding @p key, or the empty slot where it is stored
+ */
+static long unsigned int TransSym_ExpecSlot(long unsigned int key)
+{
+  long unsigned int islot, mask;
+
+  mask = TransSym_NExpecSlot - 1;
+  for (islot = (key * 0x9E3779B97F4A7C15ul) & mask;
+       TransSym_ExpecKey[islot] != 0 && TransSym_ExpecKey[islot] != key;
+       islot = (islot + 1) & mask);
+  return islot;
+}
+
+/**
+ * @brief Store the expectation value of the orbit. The table is doubled when it is half filled.
+ * Nothing is stored if the table can not be allocated.
+ *
+ * @param key key of the orbit
+ * @param val expectation value
+ */
+static void TransSym_ExpecStore(long unsigned int key, double complex val)
+{
+  long unsigned int islot, nslot, *key_old;
+  double complex *val_old;
+
+  if (2 * (TransSym_NExpec + 1) > TransSym_NExpecSlot) {
+    key_old = TransSym_ExpecKey;
+    val_old = TransSym_ExpecVal;
+    nslot = TransSym_NExpecSlot;
+    TransSym_NExpecSlot = (nslot == 0) ? 256 : 2 * nslot;
+    TransSym_ExpecKey = (long unsigned int *)calloc(TransSym_NExpecSlot, sizeof(long unsigned int));
+    TransSym_ExpecVal = (double complex *)malloc(sizeof(double complex) * TransSym_NExpecSlot);
+    if (TransSym_ExpecKey == NULL || TransSym_ExpecVal == NULL) {
+      free(key_old);
+      free(val_old);
+      TransSym_ExpecReset();
+      return;
+    }
+    for (islot = 0; islot < nslot; islot++) {
+      if (key_old[islot] == 0) continue;
+      TransSym_ExpecKey[TransSym_ExpecSlot(key_old[islot])] = key_old[islot];
+      TransSym_ExpecVal[TransSym_ExpecSlot(key_old[islot])] = val_old[islot];
+    }
+    free(key_old);
+    free(val_old);
+  }
+  islot = TransSym_ExpecSlot(key);
+  TransSym_ExpecKey[islot] = key;
+  TransSym_ExpecVal[islot] = val;
+  TransSym_NExpec++;
+}
+
+/**
+ * @brief Expectation value of c^+_{1} c_{2} c^+_{3} c_{4} in a state of the symmetrized basis.
+ * When isite3 == 0, that of c^+_{1} c_{2} is calculated.
+ * The operator need not be invariant under the group: each representative is expanded
+ * into the states b = T_g r of its orbit, <b|r~> = s_g(r) conj(chi(g)) sqrt(n_r/|G|)
+ * (each b appears n_r times), and the image of b is projected back onto the basis.
+ * The value is reused for the operators T_g A T_g^-1 until TransSym_ExpecReset is called.
+ *
+ * @param X
+ * @param isite1 site indices (1 origin) and spins of the four operators
+ * @param vec state in the symmetrized basis
+ *
+ * @return expectation value
+ */
+double complex TransSym_Expec(
+  struct BindStruct *X,
+  long unsigned int isite1, long unsigned int sigma1,
+  long unsigned int isite2, long unsigned int sigma2,
+  long unsigned int isite3, long unsigned int sigma3,
+  long unsigned int isite4, long unsigned int sigma4,
+  double complex *vec
+  )
+{
+  long unsigned int j, i_max, ihfbit, ibit, rbit, joff, key, islot;
+  long unsigned int site[4], spin[4];
+  int g, nop, sgn, sgn_op;
+  double norm_j, norm, dgroup;
+  double complex phase, dam_pr;
+
+  site[0] = isite1 - 1;
+  site[1] = isite2 - 1;
+  site[2] = isite3 - 1;
+  site[3] = isite4 - 1;
+  spin[0] = sigma1;
+  spin[1] = sigma2;
+  spin[2] = sigma3;
+  spin[3] = sigma4;
+  nop = (isite3 == 0) ? 2 : 4;
+  key = TransSym_ExpecOrbit(X, nop, site, spin);
+  if (TransSym_NExpecSlot > 0) {
+    islot = TransSym_ExpecSlot(key);
+    if (TransSym_ExpecKey[islot] == key) return TransSym_ExpecVal[islot];
+  }
+  i_max = X->Check.idim_max;
+  ihfbit = 1ul << ((TransSym_NBit(X) + 1) / 2);
+  dgroup = (double)X->Large.NTransSymOp;
+
+  dam_pr = 0.0;
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(dynamic) \
+  private(j, g, ibit, sgn, sgn_op, rbit, phase, norm, norm_j, joff) \
+  firstprivate(i_max, ihfbit, dgroup, nop, site, spin, X) shared(vec, list_1)
+  for (j = 1; j <= i_max; j++) {
+    TransSym_IsRep(X, list_1[j], &norm_j);
+    for (g = 0; g < X->Large.NTransSymOp; g++) {
+      ibit = TransSym_Apply(X, g, list_1[j], &sgn);
+      sgn_op = OperatorBit(X, nop, site, spin, &ibit);
+      if (sgn_op == 0) continue;
+      TransSym_Canonical(X, ibit, &rbit, &phase, &norm);
+      if (norm < 0.5) continue;
+      joff = TransSym_Index(rbit, ihfbit);
+      if (joff == 0) continue;
+      dam_pr += conj(vec[joff] * phase) * (double)(sgn_op * sgn) * vec[j] * conj(X->Large.TransSymChar[g])
+                * sqrt(norm * norm_j) / (dgroup * norm_j);
+    }
+  }
+  TransSym_ExpecStore(key, dam_pr);
+  return dam_pr;
+}
+
+/**
+ * @brief Calculate S^2 and S_z in the symmetrized basis. S^2 is invariant under the group, so
+ * <s~|S^2|psi> is obtained from S^2|s> as in TransSym_GetRow.
+ *
+ * @param X [out] X->Phys.s2 and X->Phys.sz
+ * @param vec state in the symmetrized basis
+ */
+void TransSym_TotalSpin(
+  struct BindStruct *X,
+  double complex *vec
+  )
+{
+  long unsigned int j, i_max, ihfbit, ibit, rbit, joff, isite1, isite2;
+  long unsigned int site[4], spin[4];
+  int sgn, nsingle;
+  double norm_j, norm, dsz;
+  double complex phase, spn;
+
+  i_max = X->Check.idim_max;
+  ihfbit = 1ul << ((TransSym_NBit(X) + 1) / 2);
+  dsz = 0.5 * (double)(X->Def.Nup - X->Def.Ndown);
+  /*S^+_{i} S^-_{j} = c^+_{i up} c_{i down} c^+_{j down} c_{j up}*/
+  spin[0] = 0;
+  spin[1] = 1;
+  spin[2] = 1;
+  spin[3] = 0;
+
+  spn = 0.0;
+#pragma omp parallel for default(none) reduction(+:spn) schedule(dynamic) \
+  private(j, isite1, isite2, ibit, sgn, rbit, phase, norm, norm_j, joff, nsingle) \
+  firstprivate(i_max, ihfbit, dsz, site, spin, X) shared(vec, list_1)
+  for (j = 1; j <= i_max; j++) {
+    /*S_z^2 + sum_i (S^+_i S^-_i + S^-_i S^+_i)/2, the latter is 1/2 for each singly occupied site*/
+    if (X->Def.iCalcModel == Spin) nsingle = X->Def.Nsite;
+    else nsingle = PopCountBit((list_1[j] ^ (list_1[j] >> 1)) & 0x5555555555555555ul);
+    spn += conj(vec[j]) * vec[j] * (dsz * dsz + 0.5 * nsingle);
+    TransSym_IsRep(X, list_1[j], &norm_j);
+    for (isite1 = 0; isite1 < X->Def.Nsite; isite1++) {
+      for (isite2 = 0; isite2 < X->Def.Nsite; isite2++) {
+        if (isite1 == isite2) continue;
+        site[0] = isite1;
+        site[1] = isite1;
+        site[2] = isite2;
+        site[3] = isite2;
+        ibit = list_1[j];
+        sgn = OperatorBit(X, 4, site, spin, &ibit);
+        if (sgn == 0) continue;
+        TransSym_Canonical(X, ibit, &rbit, &phase, &norm);
+        if (norm < 0.5) continue;
+        joff = TransSym_Index(rbit, ihfbit);
+        if (joff == 0) continue;
+        spn += conj(vec[j]) * (double)sgn * vec[joff] * phase * sqrt(norm / norm_j);
+      }
+    }
+  }
+  X->Phys.s2 = creal(spn);
+  X->Phys.sz = dsz;
+}
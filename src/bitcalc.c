@@ -15,6 +15,8 @@
 /* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
 #include "bitcalc.h"
 #include "wrapperMPI.h"
+#include "mfmemory.h"
+#include <limits.h>
 
 /**
  * @file   bitcalc.c
@@ -27,6 +29,8 @@
  * 
  */
 
+static int iFlgIndex32 = FALSE; /**< TRUE if GetOffComp reads list_2_1_32 and list_2_2_32.*/
+
 
 /** 
  * 
@@ -202,6 +206,10 @@ int GetOffComp(
 {
   long unsigned int ia, ib;
   SplitBit(_ibit, _irght, _ilft, _ihfbit, &ia, &ib);
+  if (iFlgIndex32 == TRUE) {
+    *_ioffComp = (long unsigned int)list_2_1_32[ia] + list_2_2_32[ib];
+    return (*_ioffComp != 0) ? TRUE : FALSE;
+  }
   *_ioffComp =_list_2_1[ia];
   *_ioffComp+=_list_2_2[ib];
   if(*_ioffComp !=0) return TRUE;
@@ -277,7 +285,12 @@ void ConvertToList1GeneralSpin(
   long unsigned int ia, ib;
   ia=org_ibit%ihlfbit;
   ib=org_ibit/ihlfbit;
-  *_ilist1Comp=list_2_1[ia]+list_2_2[ib];
+  if(iFlgIndex32==TRUE){
+    *_ilist1Comp=(long unsigned int)list_2_1_32[ia]+list_2_2_32[ib];
+  }
+  else{
+    *_ilist1Comp=list_2_1[ia]+list_2_2[ib];
+  }
 }
 
 /** 
@@ -449,3 +462,255 @@ unsigned long int snoob(unsigned long int x){
   ones     = (ones>>2)/smallest;
   return   ripple|ones;
 }
+
+/**
+ * @brief The n lowest 1s of the mask.
+ *
+ * @param mask bit mask
+ * @param n number of 1s to be kept
+ *
+ * @return bit pattern
+ */
+static long unsigned int LowestBits(long unsigned int mask, int n){
+  long unsigned int x=0;
+  for(; n>0; n--){
+    x |= mask & (~mask+1);
+    mask &= mask-1;
+  }
+  return x;
+}
+
+/**
+ * @brief The smallest bit pattern which has num[c] 1s in mask[c] for every class c
+ * and no 1 outside the masks.
+ *
+ * @param mask disjoint bit masks of the classes
+ * @param num number of 1s in each class
+ * @param nclass number of classes
+ * @param x [out] bit pattern
+ *
+ * @retval 0 found
+ * @retval -1 no such pattern
+ */
+int SectorWalkFirst(
+  const long unsigned int *mask,
+  const int *num,
+  const int nclass,
+  long unsigned int *x
+)
+{
+  int c;
+  *x = 0;
+  for(c=0; c<nclass; c++){
+    if(num[c]<0 || num[c]>PopCountBit(mask[c])) return -1;
+    *x |= LowestBits(mask[c], num[c]);
+  }
+  return 0;
+}
+
+/**
+ * @brief The next larger bit pattern with the same numbers of 1s in every class.
+ * The step is snoob for a single class covering all nbit bits,
+ * otherwise the lowest position which can be raised is searched.
+ *
+ * @param mask disjoint bit masks of the classes
+ * @param num number of 1s in each class
+ * @param nclass number of classes
+ * @param nbit the patterns are smaller than 2^nbit
+ * @param x [in,out] bit pattern
+ *
+ * @retval 0 found
+ * @retval -1 x was the last pattern
+ */
+int SectorWalkNext(
+  const long unsigned int *mask,
+  const int *num,
+  const int nclass,
+  const int nbit,
+  long unsigned int *x
+)
+{
+  int c, p, need, ok;
+  long unsigned int y, below, low;
+
+  if(nclass==1 && mask[0]==(1ul<<nbit)-1){
+    if(*x==0) return -1;
+    y = snoob(*x);
+    if(y >= (1ul<<nbit)) return -1;
+    *x = y;
+    return 0;
+  }
+
+  for(p=0; p<nbit; p++){
+    if((*x>>p)&1) continue;
+    for(c=0; c<nclass; c++){
+      if((mask[c]>>p)&1) break;
+    }
+    if(c==nclass) continue;
+    y = ((*x>>p)|1ul)<<p;
+    below = (1ul<<p)-1;
+    low = 0;
+    ok = TRUE;
+    for(c=0; c<nclass; c++){
+      need = num[c]-PopCountBit(y & mask[c]);
+      if(need<0 || need>PopCountBit(mask[c] & below)){
+        ok = FALSE;
+        break;
+      }
+      low |= LowestBits(mask[c], need);
+    }
+    if(ok==TRUE){
+      *x = y | low;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+
+/**
+ * @brief Number of elements of list_2_1 and list_2_2 allocated in setmem_large.
+ *
+ * @param X
+ * @param n21 [out] number of elements of list_2_1
+ * @param n22 [out] number of elements of list_2_2
+ *
+ * @retval TRUE the model uses list_2_1 and list_2_2
+ * @retval FALSE otherwise
+ */
+int GetSplitTableSize(
+  struct BindStruct *X,
+  long unsigned int *n21,
+  long unsigned int *n22
+  )
+{
+  *n21 = 0;
+  *n22 = 0;
+  switch (X->Def.iCalcModel) {
+  case Spin:
+  case Hubbard:
+  case HubbardNConserved:
+  case Kondo:
+  case KondoGC:
+    break;
+  default:
+    return FALSE;
+  }
+  if (X->Def.iFlgGeneralSpin == FALSE) {
+    if (X->Def.iCalcModel == Spin && X->Def.Nsite % 2 == 1) *n21 = X->Check.sdim * 2 + 2;
+    else *n21 = X->Check.sdim + 2;
+    *n22 = X->Check.sdim + 2;
+  }
+  else {
+    *n21 = X->Check.sdim + 2;
+    *n22 = (X->Def.Tpow[X->Def.Nsite - 1] * X->Def.SiteToBit[X->Def.Nsite - 1] / X->Check.sdim) + 2;
+  }
+  return TRUE;
+}
+
+/**
+ * @brief Apply c^+_{0} c_{1} c^+_{2} c_{3} ... (the last operator acts first) to a state.
+ * For the Spin model, each pair c^+_{i sigma1} c_{i sigma2} changes the spin at the site i
+ * from sigma2 to sigma1, and the pairs on different sites give zero.
+ *
+ * @param X
+ * @param nop number of operators (2 or 4)
+ * @param site site indices (0 origin)
+ * @param spin spin indices
+ * @param ibit [in,out] bit pattern
+ *
+ * @return matrix element (0 or +-1)
+ */
+int OperatorBit(
+  struct BindStruct *X,
+  int nop,
+  const long unsigned int *site,
+  const long unsigned int *spin,
+  long unsigned int *ibit
+  )
+{
+  int iop, sgn, tmp_sgn;
+  long unsigned int kbit, is_cr, is_an;
+
+  kbit = *ibit;
+  sgn = 1;
+  for (iop = nop - 2; iop >= 0; iop -= 2) {
+    if (X->Def.iCalcModel == Spin) {
+      if (site[iop] != site[iop + 1]) return 0;
+      is_cr = 1ul << site[iop];
+      if (((kbit & is_cr) / is_cr) != spin[iop + 1]) return 0;
+      kbit = (kbit & ~is_cr) | (spin[iop] * is_cr);
+    }
+    else {
+      is_cr = 1ul << (2 * site[iop] + spin[iop]);
+      is_an = 1ul << (2 * site[iop + 1] + spin[iop + 1]);
+      if ((kbit & is_an) == 0) return 0;
+      SgnBit(kbit & (is_an - 1), &tmp_sgn);
+      sgn *= tmp_sgn;
+      kbit ^= is_an;
+      if ((kbit & is_cr) != 0) return 0;
+      SgnBit(kbit & (is_cr - 1), &tmp_sgn);
+      sgn *= tmp_sgn;
+      kbit ^= is_cr;
+    }
+  }
+  *ibit = kbit;
+  return sgn;
+}
+
+/**
+ * @brief Replace list_2_1 and list_2_2 by 32-bit copies when all indices fit in 32 bits.
+ *
+ * @param X
+ */
+static void Index32Init(struct BindStruct *X)
+{
+  long unsigned int j, n21, n22;
+
+  iFlgIndex32 = FALSE;
+  list_2_1_32 = NULL;
+  list_2_2_32 = NULL;
+  if (GetSplitTableSize(X, &n21, &n22) == FALSE || X->Large.NTransSymOp > 0) return;
+  if (MaxMPI_li(X->Check.idim_max) >= UINT_MAX) return;
+  /*Indices in the whole sector when the rows are distributed*/
+  if (X->Large.iFlgMPIRow == TRUE && X->Check.idim_maxMPI >= UINT_MAX) return;
+
+  ui_malloc1(list_2_1_32, n21);
+  ui_malloc1(list_2_2_32, n22);
+  if (MaxMPI_li(list_2_1_32 == NULL || list_2_2_32 == NULL) != 0) {
+    free(list_2_1_32);
+    free(list_2_2_32);
+    list_2_1_32 = NULL;
+    list_2_2_32 = NULL;
+    return;
+  }
+#pragma omp parallel default(none) private(j) firstprivate(n21, n22) shared(list_2_1, list_2_2, list_2_1_32, list_2_2_32)
+  {
+#pragma omp for schedule(static)
+    for (j = 0; j < n21; j++) list_2_1_32[j] = (unsigned int)list_2_1[j];
+#pragma omp for schedule(static)
+    for (j = 0; j < n22; j++) list_2_2_32[j] = (unsigned int)list_2_2[j];
+  }
+  free(list_2_1);
+  free(list_2_2);
+  list_2_1 = NULL;
+  list_2_2 = NULL;
+  iFlgIndex32 = TRUE;
+  fprintf(stdoutMPI, "  Index: list_2_1 and list_2_2 are stored in 32 bits (%ld bytes).\n",
+          (n21 + n22) * sizeof(unsigned int));
+}
+
+/**
+ * @brief Select how GetOffComp converts a state into its index. Must be called after sz.
+ * list_2_1 and list_2_2 are shrunk to 32 bits when idim_max < 2^32.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int GetOffCompInit(struct BindStruct *X)
+{
+  Index32Init(X);
+  return 0;
+}
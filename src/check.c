@@ -21,6 +21,8 @@
 #include "check.h"
 #include "wrapperMPI.h"
 #include "CheckMPI.h"
+#include "TransSym.h"
+#include <limits.h>
 
 /**
  * @file   check.c
@@ -55,6 +57,8 @@ int check(struct BindStruct *X){
   int NLocSpn,NCond,Nup,Ndown;
   long unsigned int u_tmp;
   long unsigned int tmp;
+  long unsigned int n21, n22;
+  double dmem_index;
   long unsigned int Ns,comb_1,comb_2,comb_3,comb_sum, comb_up, comb_down;
   int u_loc;
   int mfint[7];
@@ -76,6 +80,7 @@ int check(struct BindStruct *X){
   Ns = X->Def.Nsite;
 
   li_malloc2(comb, Ns+1,Ns+1);
+  Binomial(Ns, 0, comb, Ns);
 
   //idim_max
   switch(X->Def.iCalcModel){
@@ -102,8 +107,8 @@ int check(struct BindStruct *X){
     break;
 
   case Hubbard:
-    comb_up= Binomial(Ns, X->Def.Nup, comb, Ns);
-    comb_down= Binomial(Ns, X->Def.Ndown, comb, Ns);
+    comb_up= BinomialTable(Ns, X->Def.Nup, comb);
+    comb_down= BinomialTable(Ns, X->Def.Ndown, comb);
     comb_sum=comb_up*comb_down;
     break;
 
@@ -115,8 +120,8 @@ int check(struct BindStruct *X){
     }
 
     for(i=iMinup; i<= iAllup; i++){
-      comb_up= Binomial(Ns, i, comb, Ns);
-      comb_down= Binomial(Ns, X->Def.Ne-i, comb, Ns);
+      comb_up= BinomialTable(Ns, i, comb);
+      comb_down= BinomialTable(Ns, X->Def.Ne-i, comb);
       comb_sum +=comb_up*comb_down;
     }
     break;
@@ -141,9 +146,9 @@ int check(struct BindStruct *X){
     NLocSpn = X->Def.NLocSpn;
     comb_sum = 0;
     for(u_loc=0;u_loc<=X->Def.Nup;u_loc++){
-      comb_1     = Binomial(NLocSpn,u_loc,comb,Ns);
-      comb_2     = Binomial(NCond,Nup-u_loc,comb,Ns);
-      comb_3     = Binomial(NCond,Ndown+u_loc-NLocSpn,comb,Ns);
+      comb_1     = BinomialTable(NLocSpn,u_loc,comb);
+      comb_2     = BinomialTable(NCond,Nup-u_loc,comb);
+      comb_3     = BinomialTable(NCond,Ndown+u_loc-NLocSpn,comb);
       comb_sum  += comb_1*comb_2*comb_3;
     }
     break;
@@ -163,7 +168,7 @@ int check(struct BindStruct *X){
 	fprintf(stderr, " 2Sz is incorrect.\n");
 	return FALSE;
       }
-      comb_sum= Binomial(Ns, X->Def.Ne, comb, Ns);
+      comb_sum= BinomialTable(Ns, X->Def.Ne, comb);
     }
     else{
       idimmax = 1;
@@ -193,6 +198,11 @@ int check(struct BindStruct *X){
     return FALSE;
   }  
 
+  /*Dimension of the symmetrized basis*/
+  if(X->Large.NTransSymOp>0){
+    comb_sum=TransSym_Count(X);
+  }
+
   if(comb_sum==0){
     fprintf(stderr, cErrNoHilbertSpace);
     //    return FALSE;
@@ -201,10 +211,21 @@ int check(struct BindStruct *X){
   //fprintf(stdoutMPI, "comb_sum= %ld \n",comb_sum);
 
   X->Check.idim_max = comb_sum;
+  /*Each process keeps a block of rows of the whole sector*/
+  if(X->Large.iFlgMPIRow==TRUE) CheckMPI_Row(X, comb_sum);
+  X->Check.max_mem_csr = 0.0;
   switch(X->Def.iCalcType){
   case Lanczos:
   case TPQCalc:
     X->Check.max_mem=(3+2+1)*X->Check.idim_max*16.0/(pow(10,9));
+    if(X->Def.iCalcType==TPQCalc && X->Def.iTPQPrecision==TPQ_MIXED){
+      /*Two single-precision vectors instead of v0, v1 and vg*/
+      X->Check.max_mem=(2*8.0+(2+1)*16.0)*X->Check.idim_max/(pow(10,9));
+    }
+    /*Upper bound of the stored Hamiltonian: one element per off-diagonal term and row*/
+    X->Check.max_mem_csr=X->Check.idim_max*(8.0
+                                            +(2*(X->Def.EDNTransfer+X->Def.NExchangeCoupling+X->Def.NPairLiftCoupling)
+                                              +X->Def.NInterAll_OffDiagonal+X->Def.NPairHopping)*(16.0+4.0))/(pow(10,9));
     break;
   case FullDiag:
     X->Check.max_mem=X->Check.idim_max*16.0*X->Check.idim_max*16.0/(pow(10,9));
@@ -220,12 +241,19 @@ int check(struct BindStruct *X){
   fprintf(stdoutMPI, "  MAX DIMENSION idim_max=%ld \n",li_dim_max);
   double dmax_mem=MaxMPI_d(X->Check.max_mem);
   fprintf(stdoutMPI, "  APPROXIMATE REQUIRED MEMORY  max_mem=%lf GB \n",dmax_mem);
+  double dmax_mem_csr=MaxMPI_d(X->Check.max_mem_csr);
+  if(dmax_mem_csr > 0.0){
+    fprintf(stdoutMPI, "  STORED HAMILTONIAN (MltplyMode=2) max_mem_csr<=%lf GB \n",dmax_mem_csr);
+  }
   if(childfopenMPI(cFileNameCheckMemory,"w", &fp)!=0){
     i_free2(comb, Ns+1, Ns+1);
     return FALSE;
   }
   fprintf(fp,"  MAX DIMENSION idim_max=%ld \n", li_dim_max);
   fprintf(fp,"  APPROXIMATE REQUIRED MEMORY  max_mem=%lf GB \n", dmax_mem);
+  if(dmax_mem_csr > 0.0){
+    fprintf(fp,"  STORED HAMILTONIAN (MltplyMode=2) max_mem_csr<=%lf GB \n", dmax_mem_csr);
+  }
 
   
   /*
@@ -358,6 +386,32 @@ int check(struct BindStruct *X){
     in the inter process region.
   */
   CheckMPI_Summary(X);
+
+  /*
+    Split tables list_2_1 and list_2_2 are shrunk to 32 bits after sz if idim_max < 2^32
+  */
+  if(GetSplitTableSize(X, &n21, &n22)==TRUE && X->Large.NTransSymOp==0){
+    dmem_index=MaxMPI_d((n21+n22)*8.0/pow(10,9));
+    /*The tables give the index in the whole sector when the rows are distributed*/
+    if(X->Large.iFlgMPIRow==TRUE) li_dim_max=X->Check.idim_maxMPI;
+    else li_dim_max=MaxMPI_li(X->Check.idim_max);
+    if(li_dim_max < UINT_MAX){
+      fprintf(stdoutMPI, "  INDEX TABLES (32 bit)  mem_index=%lf GB (64 bit: %lf GB)\n", dmem_index/2.0, dmem_index);
+    }
+    else{
+      fprintf(stdoutMPI, "  INDEX TABLES (64 bit)  mem_index=%lf GB \n", dmem_index);
+    }
+    if(childfopenMPI(cFileNameCheckMemory,"a", &fp)!=0){
+      return FALSE;
+    }
+    if(li_dim_max < UINT_MAX){
+      fprintf(fp, "  INDEX TABLES (32 bit)  mem_index=%lf GB (64 bit: %lf GB)\n", dmem_index/2.0, dmem_index);
+    }
+    else{
+      fprintf(fp, "  INDEX TABLES (64 bit)  mem_index=%lf GB \n", dmem_index);
+    }
+    fclose(fp);
+  }
   
   return TRUE;
 }    
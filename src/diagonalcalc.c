@@ -33,6 +33,7 @@
 #include "diagonalcalc.h"
 #include "FileIO.h"
 #include "mltply.h" 
+#include "BasisCache.h"
 #include "wrapperMPI.h" 
 
 
@@ -60,12 +61,35 @@ int diagonalcalc
   long unsigned int A_spin,B_spin;
   /*[e] For InterAll*/
   long unsigned int i_max=X->Check.idim_max;
+  /*[s] For the block evaluator*/
+  long unsigned int nterm;
+  struct DiagonalTerm *term;
+  /*[e] For the block evaluator*/
 
   fprintf(stdoutMPI, "%s", cProStartCalcDiag);
+
+  if(BasisCacheReadDiagonal(X)==TRUE){
+    TimeKeeper(X, cFileNameTimeKeep, cDiagonalCalcFinish, "w");
+    fprintf(stdoutMPI, "%s", cProEndCalcDiag);
+    return 0;
+  }
   
+  /*
+   General spin is computed term by term. Otherwise the terms are collected
+   and evaluated for each block of states at once by SetDiagonalBlock.
+  */
+  nterm = 0;
+  term = NULL;
+  if(X->Def.iFlgGeneralSpin==TRUE){
 #pragma omp parallel for default(none) private(j) shared(list_Diagonal) firstprivate(i_max)
-  for(j = 1;j <= i_max; j++){
-    list_Diagonal[j]=0.0;
+    for(j = 1;j <= i_max; j++){
+      list_Diagonal[j]=0.0;
+    }
+  }
+  else{
+    term = (struct DiagonalTerm *)malloc(sizeof(struct DiagonalTerm)
+      * (X->Def.NCoulombIntra + X->Def.EDNChemi + X->Def.NCoulombInter
+         + X->Def.NHundCoupling + X->Def.NInterAll_Diagonal + 1));
   }
   
   if(X->Def.NCoulombIntra>0){
@@ -76,7 +100,10 @@ int diagonalcalc
       isite1 = X->Def.CoulombIntra[i][0]+1;
       tmp_V  = X->Def.ParaCoulombIntra[i];     
       fprintf(fp,"i=%ld isite1=%ld tmp_V=%lf \n",i,isite1,tmp_V);    
-      SetDiagonalCoulombIntra(isite1, tmp_V, X);
+      if(term==NULL) SetDiagonalCoulombIntra(isite1, tmp_V, X);
+      else if(SetDiagonalTermCoulombIntra(isite1, tmp_V, X, term, &nterm)!=0){
+        return -1;
+      }
     }
     fclose(fp);
   }
@@ -90,8 +117,13 @@ int diagonalcalc
       spin   = X->Def.EDSpinChemi[i];
       tmp_V  = -X->Def.EDParaChemi[i];
       fprintf(fp,"i=%ld spin=%ld isite1=%ld tmp_V=%lf \n",i,spin,isite1,tmp_V);
-      if(SetDiagonalChemi(isite1, tmp_V,spin,  X) !=0){
-	return -1;
+      if(term==NULL){
+        if(SetDiagonalChemi(isite1, tmp_V,spin,  X) !=0){
+          return -1;
+        }
+      }
+      else if(SetDiagonalTermChemi(isite1, tmp_V, spin, X, term, &nterm)!=0){
+        return -1;
       }
     }
     fclose(fp);	
@@ -106,8 +138,13 @@ int diagonalcalc
       isite2 = X->Def.CoulombInter[i][1]+1;
       tmp_V  = X->Def.ParaCoulombInter[i];
       fprintf(fp,"i=%ld isite1=%ld isite2=%ld tmp_V=%lf \n",i,isite1,isite2,tmp_V);
-      if(SetDiagonalCoulombInter(isite1, isite2, tmp_V,  X) !=0){
-	return -1;
+      if(term==NULL){
+        if(SetDiagonalCoulombInter(isite1, isite2, tmp_V,  X) !=0){
+          return -1;
+        }
+      }
+      else if(SetDiagonalTermCoulombInter(isite1, isite2, tmp_V, X, term, &nterm)!=0){
+        return -1;
       }
     }
     fclose(fp);   
@@ -120,8 +157,13 @@ int diagonalcalc
       isite1 = X->Def.HundCoupling[i][0]+1;
       isite2 = X->Def.HundCoupling[i][1]+1;
       tmp_V  = -X->Def.ParaHundCoupling[i];
-      if(SetDiagonalHund(isite1, isite2, tmp_V,  X) !=0){
-	return -1;
+      if(term==NULL){
+        if(SetDiagonalHund(isite1, isite2, tmp_V,  X) !=0){
+          return -1;
+        }
+      }
+      else if(SetDiagonalTermHund(isite1, isite2, tmp_V, X, term, &nterm)!=0){
+        return -1;
       }
       fprintf(fp,"i=%ld isite1=%ld isite2=%ld tmp_V=%lf \n",i,isite1,isite2,tmp_V);    
     }
@@ -139,10 +181,20 @@ int diagonalcalc
       B_spin=X->Def.InterAll_Diagonal[i][3];
       tmp_V =  X->Def.ParaInterAll_Diagonal[i];
       fprintf(fp,"i=%ld isite1=%ld A_spin=%ld isite2=%ld B_spin=%ld tmp_V=%lf \n", i, isite1, A_spin, isite2, B_spin, tmp_V);
-      SetDiagonalInterAll(isite1, isite2, A_spin, B_spin, tmp_V, X);
+      if(term==NULL) SetDiagonalInterAll(isite1, isite2, A_spin, B_spin, tmp_V, X);
+      else if(SetDiagonalTermInterAll(isite1, isite2, A_spin, B_spin, tmp_V, X, term, &nterm)!=0){
+        return -1;
+      }
     }      
      fclose(fp);   
     }
+
+  if(term!=NULL){
+    SetDiagonalBlock(X, term, nterm);
+    free(term);
+  }
+
+  BasisCacheWriteDiagonal(X);
   
   TimeKeeper(X, cFileNameTimeKeep, cDiagonalCalcFinish, "w");
   fprintf(stdoutMPI, "%s", cProEndCalcDiag);
@@ -1305,3 +1357,464 @@ firstprivate(i_max, dtmp_V, isite1, isigma1, X) private(j, num1)
   return 0;
 
 }
+
+/**
+ * @brief Diagonal term in the product form (n[0]*n[1]+n[2]*n[3])*V.
+ * n[k] is the number of bits counted by the k-th factor plus a constant part
+ * given by the bits in the inter process region.
+ * It is converted to a DiagonalTerm by SetDiagonalTermPush.
+ */
+struct DiagonalProduct{
+  int nbit[4]; /**< Number of bits counted by each factor (0,1,2).*/
+  long unsigned int shift[4][2]; /**< Positions of these bits.*/
+  long unsigned int flip[4][2]; /**< 1 if the bit is counted when it is 0 (spin down).*/
+  long unsigned int bias[4]; /**< Constant part of each factor.*/
+  double V; /**< Coefficient of the term.*/
+};
+
+/**
+ * @brief Clear a term in the product form.
+ *
+ * @param tmp_term [out] term to be cleared
+ * @param dtmp_V coefficient of the term
+ */
+static void SetDiagonalTermInit
+(
+ struct DiagonalProduct *tmp_term,
+ double dtmp_V
+ ){
+  int k;
+  for(k = 0; k < 4; k++){
+    tmp_term->nbit[k] = 0;
+    tmp_term->bias[k] = 0;
+  }
+  tmp_term->V = dtmp_V;
+}
+
+/**
+ * @brief Add a bit to the k-th factor of a term.
+ * A bit in the inter process region is taken from myrank and added to the constant part.
+ *
+ * @param X Define list to get Nsite
+ * @param tmp_term [in,out] term in the product form
+ * @param k index of the factor (0,...,3)
+ * @param isite site index of the bit (1 origin)
+ * @param is bit (power of 2)
+ * @param flip 1 if the bit is counted when it is 0
+ */
+static void SetDiagonalTermBit
+(
+ struct BindStruct *X,
+ struct DiagonalProduct *tmp_term,
+ int k,
+ long unsigned int isite,
+ long unsigned int is,
+ long unsigned int flip
+ ){
+  long unsigned int ishift;
+
+  if(isite > X->Def.Nsite){
+    tmp_term->bias[k] += (((unsigned long int)myrank & is) / is) ^ flip;
+    return;
+  }
+  for(ishift = 0; (is >> ishift) > 1; ishift++);
+  tmp_term->shift[k][tmp_term->nbit[k]] = ishift;
+  tmp_term->flip[k][tmp_term->nbit[k]] = flip;
+  tmp_term->nbit[k] += 1;
+}
+
+/**
+ * @brief Tabulate a term in the product form for all values of the bits it depends on,
+ * and append it to the list unless it vanishes for all states.
+ * Each entry is computed as (double)(n[0]*n[1]+n[2]*n[3])*V, which is the
+ * same floating point operation as in the termwise SetDiagonal* functions.
+ *
+ * @param tmp_term term in the product form
+ * @param term [in,out] list of terms
+ * @param nterm [in,out] number of terms in the list
+ */
+static void SetDiagonalTermPush
+(
+ struct DiagonalProduct *tmp_term,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ ){
+  struct DiagonalTerm *t;
+  long unsigned int idx, num[4], ibit;
+  int k, l, m, inonzero;
+
+  t = &term[*nterm];
+  t->nbit = 0;
+  for(m = 0; m < 4; m++) t->shift[m] = 0;
+  for(k = 0; k < 4; k++){
+    for(l = 0; l < tmp_term->nbit[k]; l++){
+      for(m = 0; m < t->nbit; m++){
+        if(t->shift[m] == tmp_term->shift[k][l]) break;
+      }
+      if(m == t->nbit){
+        t->shift[m] = tmp_term->shift[k][l];
+        t->nbit += 1;
+      }
+    }
+  }
+
+  inonzero = FALSE;
+  for(idx = 0; idx < (1ul << t->nbit); idx++){
+    for(k = 0; k < 4; k++){
+      num[k] = tmp_term->bias[k];
+      for(l = 0; l < tmp_term->nbit[k]; l++){
+        for(m = 0; t->shift[m] != tmp_term->shift[k][l]; m++);
+        ibit = (idx >> m) & 1;
+        num[k] += ibit ^ tmp_term->flip[k][l];
+      }
+    }
+    t->value[idx] = (num[0] * num[1] + num[2] * num[3]) * tmp_term->V;
+    if(num[0] * num[1] + num[2] * num[3] != 0) inonzero = TRUE;
+  }
+  if(inonzero == TRUE) *nterm += 1;
+}
+
+/**
+ * @brief Same as SetDiagonalCoulombIntra, but the term is appended to the list of the block evaluator.
+ *
+ * @param isite1  a site number
+ * @param dtmp_V A value of coulombintra interaction \f$ U_i \f$
+ * @param X Define list to get dimesnion number
+ * @param term [in,out] list of terms
+ * @param nterm [in,out] number of terms in the list
+ * @retval 0 normally finished
+ * @retval -1 unsupported model
+ */
+int SetDiagonalTermCoulombIntra
+(
+ long unsigned int isite1,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ ){
+  struct DiagonalProduct tmp_term;
+
+  switch (X->Def.iCalcModel){
+  case HubbardGC:
+  case KondoGC:
+  case Hubbard:
+  case Kondo:
+    SetDiagonalTermInit(&tmp_term, dtmp_V);
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[2*isite1-2], 0);
+    SetDiagonalTermBit(X, &tmp_term, 1, isite1, X->Def.Tpow[2*isite1-1], 0);
+    SetDiagonalTermPush(&tmp_term, term, nterm);
+    break;
+
+  case Spin:
+  case SpinGC:
+    /*
+     They do not have the Coulomb term
+    */
+    break;
+
+  default:
+    fprintf(stdoutMPI, cErrNoModel, X->Def.iCalcModel);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Same as SetDiagonalChemi, but the term is appended to the list of the block evaluator.
+ *
+ * @param isite1 a site number
+ * @param dtmp_V a value of the chemical potential
+ * @param spin spin index
+ * @param X Define list to get dimesnion number
+ * @param term [in,out] list of terms
+ * @param nterm [in,out] number of terms in the list
+ * @retval 0 normally finished
+ * @retval -1 unsupported model
+ */
+int SetDiagonalTermChemi
+(
+ long unsigned int isite1,
+ double dtmp_V,
+ long unsigned int spin,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ ){
+  struct DiagonalProduct tmp_term;
+
+  SetDiagonalTermInit(&tmp_term, dtmp_V);
+  tmp_term.bias[1] = 1;
+
+  switch (X->Def.iCalcModel){
+  case HubbardGC:
+  case KondoGC:
+  case Hubbard:
+  case Kondo:
+    if(spin==0){
+      SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[2*isite1-2], 0);
+    }else{
+      SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[2*isite1-1], 0);
+    }
+    break;
+
+  case SpinGC:
+  case Spin:
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[isite1-1], 1-spin);
+    break;
+
+  default:
+    fprintf(stdoutMPI, cErrNoModel, X->Def.iCalcModel);
+    return -1;
+  }
+  SetDiagonalTermPush(&tmp_term, term, nterm);
+  return 0;
+}
+
+/**
+ * @brief Same as SetDiagonalCoulombInter, but the term is appended to the list of the block evaluator.
+ *
+ * @param isite1 a site number
+ * @param isite2 a site number
+ * @param dtmp_V a value of the coulombinter interaction
+ * @param X Define list to get dimesnion number
+ * @param term [in,out] list of terms
+ * @param nterm [in,out] number of terms in the list
+ * @retval 0 normally finished
+ * @retval -1 unsupported model
+ */
+int SetDiagonalTermCoulombInter
+(
+ long unsigned int isite1,
+ long unsigned int isite2,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ ){
+  struct DiagonalProduct tmp_term;
+
+  SetDiagonalTermInit(&tmp_term, dtmp_V);
+
+  switch (X->Def.iCalcModel){
+  case HubbardGC:
+  case KondoGC:
+  case Hubbard:
+  case Kondo:
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[2*isite1-2], 0);
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[2*isite1-1], 0);
+    SetDiagonalTermBit(X, &tmp_term, 1, isite2, X->Def.Tpow[2*isite2-2], 0);
+    SetDiagonalTermBit(X, &tmp_term, 1, isite2, X->Def.Tpow[2*isite2-1], 0);
+    break;
+
+  case Spin:
+  case SpinGC:
+    tmp_term.bias[0] = 1;
+    tmp_term.bias[1] = 1;
+    break;
+
+  default:
+    fprintf(stdoutMPI, cErrNoModel, X->Def.iCalcModel);
+    return -1;
+  }
+  SetDiagonalTermPush(&tmp_term, term, nterm);
+  return 0;
+}
+
+/**
+ * @brief Same as SetDiagonalHund, but the term is appended to the list of the block evaluator.
+ *
+ * @param isite1 a site number
+ * @param isite2 a site number
+ * @param dtmp_V a value of the Hund coupling
+ * @param X Define list to get dimesnion number
+ * @param term [in,out] list of terms
+ * @param nterm [in,out] number of terms in the list
+ * @retval 0 normally finished
+ * @retval -1 unsupported model
+ */
+int SetDiagonalTermHund
+(
+ long unsigned int isite1,
+ long unsigned int isite2,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ ){
+  struct DiagonalProduct tmp_term;
+
+  SetDiagonalTermInit(&tmp_term, dtmp_V);
+
+  switch (X->Def.iCalcModel){
+  case HubbardGC:
+  case KondoGC:
+  case Hubbard:
+  case Kondo:
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[2*isite1-2], 0);
+    SetDiagonalTermBit(X, &tmp_term, 1, isite2, X->Def.Tpow[2*isite2-2], 0);
+    SetDiagonalTermBit(X, &tmp_term, 2, isite1, X->Def.Tpow[2*isite1-1], 0);
+    SetDiagonalTermBit(X, &tmp_term, 3, isite2, X->Def.Tpow[2*isite2-1], 0);
+    break;
+
+  case SpinGC:
+  case Spin:
+    /*
+     Both up or both down
+    */
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[isite1-1], 0);
+    SetDiagonalTermBit(X, &tmp_term, 1, isite2, X->Def.Tpow[isite2-1], 0);
+    SetDiagonalTermBit(X, &tmp_term, 2, isite1, X->Def.Tpow[isite1-1], 1);
+    SetDiagonalTermBit(X, &tmp_term, 3, isite2, X->Def.Tpow[isite2-1], 1);
+    break;
+
+  default:
+    fprintf(stdoutMPI, cErrNoModel, X->Def.iCalcModel);
+    return -1;
+  }
+  SetDiagonalTermPush(&tmp_term, term, nterm);
+  return 0;
+}
+
+/**
+ * @brief Same as SetDiagonalInterAll, but the term is appended to the list of the block evaluator.
+ *
+ * @param isite1 a site number
+ * @param isite2 a site number
+ * @param isigma1 spin index at isite1
+ * @param isigma2 spin index at isite2
+ * @param dtmp_V a value of the interaction
+ * @param X Define list to get dimesnion number
+ * @param term [in,out] list of terms
+ * @param nterm [in,out] number of terms in the list
+ * @retval 0 normally finished
+ * @retval -1 unsupported model
+ */
+int SetDiagonalTermInterAll
+(
+ long unsigned int isite1,
+ long unsigned int isite2,
+ long unsigned int isigma1,
+ long unsigned int isigma2,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ ){
+  struct DiagonalProduct tmp_term;
+
+  SetDiagonalTermInit(&tmp_term, dtmp_V);
+
+  switch (X->Def.iCalcModel){
+  case HubbardGC:
+  case KondoGC:
+  case Hubbard:
+  case Kondo:
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[2*isite1-2+isigma1], 0);
+    SetDiagonalTermBit(X, &tmp_term, 1, isite2, X->Def.Tpow[2*isite2-2+isigma2], 0);
+    break;
+
+  case Spin:
+  case SpinGC:
+    SetDiagonalTermBit(X, &tmp_term, 0, isite1, X->Def.Tpow[isite1-1], 1-isigma1);
+    SetDiagonalTermBit(X, &tmp_term, 1, isite2, X->Def.Tpow[isite2-1], 1-isigma2);
+    break;
+
+  default:
+    fprintf(stdoutMPI, cErrNoModel, X->Def.iCalcModel);
+    return -1;
+  }
+  SetDiagonalTermPush(&tmp_term, term, nterm);
+  return 0;
+}
+
+/**
+ * @brief Evaluate all diagonal terms for one block of states at once and
+ * store the result to list_Diagonal. The terms are added to each state in the order
+ * of the list, i.e. in the same order as the termwise SetDiagonal* functions,
+ * so that list_Diagonal is identical to the termwise result.
+ * The loops over the states in a block have no branch.
+ *
+ * @param X Define list to get dimesnion number
+ * @param term list of terms
+ * @param nterm number of terms
+ * @retval 0 normally finished
+ */
+int SetDiagonalBlock
+(
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int nterm
+ ){
+  long unsigned int i_max, nblock, iblock, jstart, jend, k, nk, iterm, s;
+  long unsigned int sh0, sh1, sh2, sh3;
+  int iGC;
+  const double *value;
+  long unsigned int sblk[D_DiagonalBlockSize];
+  double dblk[D_DiagonalBlockSize];
+
+  i_max = X->Check.idim_max;
+  iGC = (X->Def.iCalcModel == HubbardGC || X->Def.iCalcModel == SpinGC);
+  nblock = (i_max + D_DiagonalBlockSize - 1) / D_DiagonalBlockSize;
+
+#pragma omp parallel for default(none) schedule(static) \
+private(iblock, jstart, jend, k, nk, iterm, s, sh0, sh1, sh2, sh3, value, sblk, dblk) \
+firstprivate(i_max, nblock, nterm, iGC) shared(term, list_1, list_Diagonal)
+  for (iblock = 0; iblock < nblock; iblock++) {
+    jstart = iblock * D_DiagonalBlockSize + 1;
+    jend = jstart + D_DiagonalBlockSize - 1;
+    if (jend > i_max) jend = i_max;
+    nk = jend - jstart + 1;
+
+    if (iGC == TRUE) {
+      for (k = 0; k < nk; k++) sblk[k] = jstart + k - 1;
+    }
+    else {
+      for (k = 0; k < nk; k++) sblk[k] = list_1[jstart + k];
+    }
+    for (k = 0; k < nk; k++) dblk[k] = 0.0;
+
+    for (iterm = 0; iterm < nterm; iterm++) {
+      value = term[iterm].value;
+      sh0 = term[iterm].shift[0];
+      sh1 = term[iterm].shift[1];
+      sh2 = term[iterm].shift[2];
+      sh3 = term[iterm].shift[3];
+      switch (term[iterm].nbit) {
+      case 0:
+        for (k = 0; k < nk; k++) dblk[k] += value[0];
+        break;
+      case 1:
+        for (k = 0; k < nk; k++) {
+          s = sblk[k];
+          dblk[k] += value[(s >> sh0) & 1];
+        }
+        break;
+      case 2:
+        for (k = 0; k < nk; k++) {
+          s = sblk[k];
+          dblk[k] += value[((s >> sh0) & 1) | (((s >> sh1) & 1) << 1)];
+        }
+        break;
+      case 3:
+        for (k = 0; k < nk; k++) {
+          s = sblk[k];
+          dblk[k] += value[((s >> sh0) & 1) | (((s >> sh1) & 1) << 1)
+                           | (((s >> sh2) & 1) << 2)];
+        }
+        break;
+      default:
+        for (k = 0; k < nk; k++) {
+          s = sblk[k];
+          dblk[k] += value[((s >> sh0) & 1) | (((s >> sh1) & 1) << 1)
+                           | (((s >> sh2) & 1) << 2) | (((s >> sh3) & 1) << 3)];
+        }
+        break;
+      }
+    }
+
+    for (k = 0; k < nk; k++) list_Diagonal[jstart + k] = dblk[k];
+  }
+
+  return 0;
+}
@@ -20,6 +20,8 @@
 #include "expec_cisajs.h"
 #include "wrapperMPI.h"
 #include "mltplyMPI.h"
+#include "TransSym.h"
+#include "mltplyMPIRow.h"
 
 /**
  * @file   expec_cisajs.c
@@ -110,6 +112,8 @@ int expec_cisajs(struct BindStruct *X,double complex *vec){
   if(!childfopenMPI(sdt, "w", &fp)==0){
     return -1;
   } 
+  //Green's functions of the new state in the symmetrized basis
+  if(X->Large.NTransSymOp>0) TransSym_ExpecReset();
   switch(X->Def.iCalcModel){
   case HubbardGC:    
     for(i=0;i<X->Def.NCisAjt;i++){
@@ -169,6 +173,13 @@ int expec_cisajs(struct BindStruct *X,double complex *vec){
       org_sigma2 = X->Def.CisAjt[i][3];
       dam_pr=0.0;
 
+      //Symmetrized basis (TransSym, SpinFlip)
+      if(X->Large.NTransSymOp>0){
+        dam_pr = TransSym_Expec(X, org_isite1, org_sigma1, org_isite2, org_sigma2, 0, 0, 0, 0, vec);
+        fprintf(fp," %4ld %4ld %4ld %4ld %.10lf %.10lf\n",org_isite1-1,org_sigma1,org_isite2-1,org_sigma2,creal(dam_pr),cimag(dam_pr));
+        continue;
+      }
+
       if(X->Def.iFlgSzConserved ==TRUE){
         if(org_sigma1 != org_sigma2){
           dam_pr =0.0;
@@ -178,7 +189,11 @@ int expec_cisajs(struct BindStruct *X,double complex *vec){
         }
       }
 
-      if (org_isite1  > X->Def.Nsite &&
+      //Rows distributed over the processes
+      if(X->Large.iFlgMPIRow==TRUE){
+        dam_pr = mltply_row_Expec(X, org_isite1, org_sigma1, org_isite2, org_sigma2, 0, 0, 0, 0, vec);
+      }
+      else if (org_isite1  > X->Def.Nsite &&
           org_isite2  > X->Def.Nsite) {
         if(org_isite1==org_isite2 && org_sigma1==org_sigma2){//diagonal
 	  
@@ -236,6 +251,13 @@ int expec_cisajs(struct BindStruct *X,double complex *vec){
         org_isite2 = X->Def.CisAjt[i][2]+1;
         org_sigma1 = X->Def.CisAjt[i][1];
         org_sigma2 = X->Def.CisAjt[i][3];
+
+        //Symmetrized basis (TransSym, SpinFlip)
+        if(X->Large.NTransSymOp>0){
+          dam_pr = TransSym_Expec(X, org_isite1, org_sigma1, org_isite2, org_sigma2, 0, 0, 0, 0, vec);
+          fprintf(fp," %4ld %4ld %4ld %4ld %.10lf %.10lf\n",org_isite1-1, org_sigma1, org_isite2-1, org_sigma2, creal(dam_pr), cimag(dam_pr));
+          continue;
+        }
       
         if(org_sigma1 == org_sigma2){
           if(org_isite1==org_isite2){
@@ -20,6 +20,8 @@
 #include "expec_cisajscktaltdc.h"
 #include "wrapperMPI.h"
 #include "mltplyMPI.h"
+#include "TransSym.h"
+#include "mltplyMPIRow.h"
 
 /**
  * @file   expec_cisajscktaltdc.c
@@ -86,7 +88,6 @@ int expec_cisajscktaltdc
   //For Kond
   double complex dmv;
 
-  
   i_max=X->Check.idim_max;
   X->Large.mode=M_CORR;
   tmp_V    = 1.0+0.0*I;
@@ -128,6 +129,8 @@ int expec_cisajscktaltdc
   }
 
 
+  //Green's functions of the new state in the symmetrized basis
+  if(X->Large.NTransSymOp>0) TransSym_ExpecReset();
   switch(X->Def.iCalcModel){
   case HubbardGC:
     for(i=0;i<X->Def.NCisAjtCkuAlvDC;i++){
@@ -252,6 +255,13 @@ int expec_cisajscktaltdc
       tmp_V    = 1.0;
 
       dam_pr=0.0;
+      //Symmetrized basis (TransSym, SpinFlip)
+      if(X->Large.NTransSymOp>0){
+        dam_pr = TransSym_Expec(X, org_isite1, org_sigma1, org_isite2, org_sigma2,
+                                org_isite3, org_sigma3, org_isite4, org_sigma4, vec);
+        fprintf(fp," %4ld %4ld %4ld %4ld %4ld %4ld %4ld %4ld %.10lf %.10lf \n",org_isite1-1, org_sigma1, org_isite2-1, org_sigma2, org_isite3-1, org_sigma3, org_isite4-1, org_sigma4, creal(dam_pr), cimag(dam_pr));
+        continue;
+      }
       if(X->Def.iFlgSzConserved ==TRUE){
         if(org_sigma1+org_sigma3 != org_sigma2+org_sigma4){
           dam_pr=SumMPI_dc(dam_pr);
@@ -260,7 +270,12 @@ int expec_cisajscktaltdc
         }
       }
 
-      if(CheckPE(org_isite1-1, X)==TRUE || CheckPE(org_isite2-1, X)==TRUE ||
+      //Rows distributed over the processes
+      if(X->Large.iFlgMPIRow==TRUE){
+        dam_pr = mltply_row_Expec(X, org_isite1, org_sigma1, org_isite2, org_sigma2,
+                                  org_isite3, org_sigma3, org_isite4, org_sigma4, vec);
+      }
+      else if(CheckPE(org_isite1-1, X)==TRUE || CheckPE(org_isite2-1, X)==TRUE ||
          CheckPE(org_isite3-1, X)==TRUE || CheckPE(org_isite4-1, X)==TRUE){
         isite1 = X->Def.OrgTpow[2*org_isite1-2+org_sigma1] ;
         isite2 = X->Def.OrgTpow[2*org_isite2-2+org_sigma2] ;
@@ -370,7 +385,14 @@ int expec_cisajscktaltdc
         }
 
         dam_pr = 0.0;
-        if(org_isite1 >X->Def.Nsite && org_isite3>X->Def.Nsite){
+        //Symmetrized basis (TransSym, SpinFlip)
+        if(X->Large.NTransSymOp>0){
+          dam_pr = TransSym_Expec(X, org_isite1, org_sigma1, org_isite2, org_sigma2,
+                                  org_isite3, org_sigma3, org_isite4, org_sigma4, vec);
+          //tmp_V is applied as below, i.e. not to the exchange term
+          if((org_sigma1==org_sigma2 && org_sigma3==org_sigma4) || org_isite1==org_isite3) dam_pr *= tmp_V;
+        }
+        else if(org_isite1 >X->Def.Nsite && org_isite3>X->Def.Nsite){
           if(org_sigma1==org_sigma2 && org_sigma3==org_sigma4 ){ //diagonal
             is1_up = X->Def.Tpow[org_isite1 - 1];
             is2_up = X->Def.Tpow[org_isite3 - 1];
@@ -436,6 +458,10 @@ int expec_cisajscktaltdc
               dam_pr += vec[j]*tmp_V*dmv*conj(vec[j]);
             }	    
           }
+          else if(X->Large.iFlgMPIRow==TRUE && org_sigma1==org_sigma4 && org_sigma2==org_sigma3){ // exchange over the rows of all processes
+            dam_pr = mltply_row_Expec(X, org_isite1, org_sigma1, org_isite2, org_sigma2,
+                                      org_isite3, org_sigma3, org_isite4, org_sigma4, vec);
+          }
           else if(org_sigma1==org_sigma4 && org_sigma2==org_sigma3){ // exchange
             dam_pr = 0.0;
 #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, tmp_sgn, dmv) firstprivate(i_max,X,isA_up,isB_up,org_sigma2,org_sigma4,tmp_off,tmp_off_2,tmp_V) shared(vec)
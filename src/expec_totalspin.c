@@ -17,6 +17,7 @@
 #include "mltply.h"
 #include "wrapperMPI.h"
 #include "mltplyMPI.h"
+#include "TransSym.h"
 
 #include "expec_totalspin.h"
 
@@ -51,6 +52,11 @@ int expec_totalspin
  double complex *vec
  )
 {
+  //Symmetrized basis (TransSym, SpinFlip)
+  if(X->Large.NTransSymOp>0){
+    TransSym_TotalSpin(X,vec);
+    return 0;
+  }
   X->Large.mode = M_TOTALS;
   switch(X->Def.iCalcModel){
   case Spin:
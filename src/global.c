@@ -45,10 +45,15 @@ const char* cFileName1BGreen_CG="%s_cisajs.dat";
 const char* cFileName2BGreen_Lanczos="%s_cisajscktalt.dat";
 const char* cFileName2BGreen_CG="%s_cisajscktalt.dat";
 const char* cFileNameTimeEV_CG="Time_EigenVector.dat";
+const char* cFileNameLOBPCGStep="%s_LOBPCG_Step.dat";
+const char* cFileNameTRLanczosStep="%s_TRLanczos_Step.dat";
 const char* cFileNameListModel="ListForModel_Ns%d_Nup%dNdown%d.dat";
 const char* cFileNameListKondo="ListForKondo_Ns%d_Ncond%d.dat";
 const char* cFileNameOutputEigen="%s_eigenvec_%d_rank_%d.dat";
 const char* cFileNameInputEigen="./output/%s_eigenvec_%d_rank_%d.dat";
+const char* cFileNameBasisCache="%s_BasisCache_rank_%d.dat";
+const char* cFileNameDiagonalCache="%s_DiagonalCache_rank_%d.dat";
+const char* cFileNameLanczosBasis="%s_LanczosBasis_rank_%d.dat";
 
 //For TPQ
 const char* cFileNameSSRand="SS_rand%d.dat";
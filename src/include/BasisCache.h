@@ -0,0 +1,32 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef HPHI_BASISCACHE_H
+#define HPHI_BASISCACHE_H
+
+#include "Common.h"
+
+#define D_BasisCacheVersion 1 /*!< Version of the cache files. Increase it when the layout of the basis changes.*/
+
+int BasisCacheReadBasis(struct BindStruct *X);
+
+int BasisCacheWriteBasis(struct BindStruct *X);
+
+int BasisCacheReadDiagonal(struct BindStruct *X);
+
+int BasisCacheWriteDiagonal(struct BindStruct *X);
+
+#endif /* HPHI_BASISCACHE_H */
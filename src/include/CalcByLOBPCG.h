@@ -0,0 +1,36 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+#pragma once
+#include "Common.h"
+
+int Output_EigenBlock(
+                      struct EDMainCalStruct *X,
+                      int nvec,
+                      long int lld,
+                      double complex *V,
+                      double *eig
+);
+
+int CalcByLOBPCG(
+                 struct EDMainCalStruct *X
+);
+
+int CalcByLOBPCG_Guess(
+                       struct EDMainCalStruct *X,
+                       int nguess,
+                       long int lldguess,
+                       double complex *Vguess
+);
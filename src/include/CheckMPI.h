@@ -18,4 +18,5 @@
 #include "struct.h"
 int CheckMPI(struct BindStruct *X);
 void CheckMPI_Summary(struct BindStruct *X);
+void CheckMPI_Row(struct BindStruct *X, long unsigned int idim);
 
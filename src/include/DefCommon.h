@@ -46,9 +46,40 @@
 
 /*!< CalcEigenVector */
 #define NUM_SETINITAILVEC 2 /*!< Number of setting type of initial vectors.*/
-#define NUM_CALCEIGENVEC 2 /*!< Number of calculating eigenvector mode.*/
+#define NUM_CALCEIGENVEC 4 /*!< Number of calculating eigenvector mode.*/
 #define CALCVEC_LANCZOSCG  0 /*!< Lanczos + CG method*/
 #define CALCVEC_LANCZOS 1 /*!< Lanczos method*/
+#define CALCVEC_LOBPCG 2 /*!< Block LOBPCG method for the lowest nvec states*/
+#define CALCVEC_TRLANCZOS 3 /*!< Thick-restart Lanczos method for the lowest nvec states*/
 #define CALCVEC_NOT -1 /*!< eigenvector is not calculated*/
 
+/*!< MltplyMode */
+#define NUM_MLTPLYMODE 5 /*!< Number of modes for the Hamiltonian-vector product.*/
+#define MLTPLY_TERMWISE 0 /*!< One sweep over the vector for each Hamiltonian term.*/
+#define MLTPLY_FUSED 1 /*!< Intra-process terms are compiled into an operator program and applied block by block in a single sweep.*/
+#define MLTPLY_CSR 2 /*!< Intra-process part of the Hamiltonian is stored in the CSR format.*/
+#define MLTPLY_AUTO 3 /*!< MLTPLY_CSR if the stored Hamiltonian fits in the memory, MLTPLY_FUSED otherwise.*/
+#define MLTPLY_DENSE 4 /*!< Intra-process spin terms are tiled into clusters and applied by zgemm with dense blocks.*/
+
+/*!< TPQPrecision */
+#define NUM_TPQPRECISION 2 /*!< Number of precision modes of the TPQ vectors.*/
+#define TPQ_DOUBLE 0 /*!< TPQ vectors in double complex.*/
+#define TPQ_MIXED 1 /*!< TPQ vectors in float complex, reductions in double.*/
+
+/*!< SpinFlip */
+#define SPINFLIP_ODD -1 /*!< Odd sector of the global spin flip.*/
+#define SPINFLIP_NONE 0 /*!< Global spin flip is not used.*/
+#define SPINFLIP_EVEN 1 /*!< Even sector of the global spin flip.*/
+
+/*!< BasisCache */
+#define NUM_BASISCACHE 2 /*!< Number of modes for the cache of the basis and the diagonal part.*/
+#define BASISCACHE_OFF 0 /*!< The basis and the diagonal part are always built.*/
+#define BASISCACHE_ON 1 /*!< They are read from the cache files if valid, otherwise built and written.*/
+
+/*!< LanczosBasis */
+#define NUM_LANCZOSBASIS 3 /*!< Number of modes for the Lanczos vectors in the eigenvector calculation.*/
+#define LANCZOSBASIS_RECOMPUTE 0 /*!< The Lanczos recurrence is run again to build the eigenvector.*/
+#define LANCZOSBASIS_MEMORY 1 /*!< The Lanczos vectors are kept in the memory as far as they fit; the rest is recomputed.*/
+#define LANCZOSBASIS_FILE 2 /*!< The Lanczos vectors which do not fit in the memory are written to a scratch file.*/
+
 #endif /* HPHI_DEFCOMMON_H */
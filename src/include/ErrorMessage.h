@@ -48,6 +48,15 @@ char *cErrCalcEigenVec;
 char *cErrSetIniVec;
 char *cErrOutputHam;
 char *cErrOutputHamForFullDiag;
+char *cErrMltplyMode;
+char *cErrTPQPrecision;
+char *cErrSpinFlip;
+char *cErrBasisCache;
+char *cErrLanczosBasis;
+char *cErrLanczosBasisRead;
+char *cErrLOBPCGBasis;
+char *cErrLOBPCGMalloc;
+char *cErrTRLanczosMalloc;
 char *cErrFiniteTemp;
 char *cErrKW;
 char *cErrKW_ShowList;
@@ -78,6 +87,7 @@ char *cErrNProcNumberSpin;
 char *cErrNProcNumberGneralSpin;
 char *cErrNProcNumber;
 char *cErrNProcNumberSet;
+char *cErrNProcNumberRow;
 
 //! Error Message in diagonal calc.c
 char *cErrNoModel;
@@ -100,4 +110,19 @@ char* cErrSz_NoFile_Show;
 char* cErrSz_ShowDim;
 char* cErrSz_OutFile;
 
+//! Error Message in TransSym.c
+char *cErrTransSymModel;
+char *cErrTransSymSz;
+char *cErrTransSymCalc;
+char *cErrTransSymPerm;
+char *cErrTransSymGroup;
+char *cErrTransSymChar;
+char *cErrTransSymMPI;
+char *cErrTransSymFused;
+char *cErrTransSymMalloc;
+char *cErrMPIRowCSR;
+char *cErrMPIRowMalloc;
+char *cErrBoostMalloc;
+char *cErrTPQMalloc;
+
 #endif /* HPHI_ERRORMESSAGE_H */
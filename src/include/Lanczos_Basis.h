@@ -0,0 +1,36 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef HPHI_LANCZOS_BASIS_H
+#define HPHI_LANCZOS_BASIS_H
+
+#include "Common.h"
+
+int Lanczos_Basis_Init(struct BindStruct *X, int iReal);
+
+int Lanczos_Basis_Store(struct BindStruct *X, int stp, double complex *tmp_v);
+
+int Lanczos_Basis_StoreReal(struct BindStruct *X, int stp, double *tmp_v);
+
+int Lanczos_Basis_Count();
+
+double complex *Lanczos_Basis_Get(struct BindStruct *X, int stp, double complex *tmp_buf);
+
+double *Lanczos_Basis_GetReal(struct BindStruct *X, int stp, double *tmp_buf);
+
+void Lanczos_Basis_Free(struct BindStruct *X);
+
+#endif /* HPHI_LANCZOS_BASIS_H */
@@ -15,3 +15,6 @@
 /* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
 #pragma once
 int Lanczos_EigenValue(struct BindStruct *X);
+double Lanczos_Residual(long int i_max, double alpha, double dscale,
+                        double complex *tmp_v0, double complex *tmp_v1);
+double *Lanczos_RealVector(long int i_max, double complex *tmp_v);
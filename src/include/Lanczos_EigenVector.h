@@ -15,3 +15,5 @@
 /* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
 #pragma once
 void Lanczos_EigenVector(struct BindStruct *X);
+
+void Lanczos_EigenVectorBlock(struct BindStruct *X, int nstate, long int lld, double complex *V);
@@ -31,6 +31,28 @@ const char* cOMPSzFinish;
 const char* cSingleSzStart;
 const char* cSingleSzFinish;
 const char* cReadSzStart;
+const char* cBasisCacheRead;
+const char* cBasisCacheWrite;
+const char* cBasisCacheWriteFail;
+const char* cLogLanczosBasisInit;
+const char* cLogLanczosBasisFileFail;
+const char* cLogLanczosBasisUse;
+const char* cLogTPQReal;
+const char* cLogTPQComplex;
+const char* cLogTPQSingle;
+const char* cLogTPQSingleOff;
+const char* cLogTPQSingleNorm;
+const char* cLogTransSymMltply;
+const char* cLogMPIRowMltply;
+const char* cLogMPIRowCSR;
+const char* cLogLanczosReal;
+const char* cLogLanczosComplex;
+const char* cLogLanczosBlock;
+const char* cLogLanczosBlockMalloc;
+const char* cLogLanczosBlockResidual;
+const char* cLogLanczosBlockCap;
+const char* cLogLanczosBlockRefine;
+const char* cStateSzTime;
 const char* cReadSzEnd;
 
 //CG_EigenVector.c
@@ -39,6 +61,24 @@ const char* cLogCG_EigenVecEnd;
 const char* cCG_EigenVecStart;
 const char* cCG_EigenVecFinish;
 
+//CalcByLOBPCG.c
+const char* cLogLOBPCGStart;
+const char* cLogLOBPCGStep;
+const char* cLogLOBPCGMltply;
+const char* cLogLOBPCGNotConverged;
+const char* cLogLOBPCGEnd;
+const char* cLOBPCGStart;
+const char* cLOBPCGFinish;
+
+//CalcByTRLanczos.c
+const char* cLogTRLanczosStart;
+const char* cLogTRLanczosRestart;
+const char* cLogTRLanczosMltply;
+const char* cLogTRLanczosNotConverged;
+const char* cLogTRLanczosEnd;
+const char* cTRLanczosStart;
+const char* cTRLanczosFinish;
+
 //diagonalcalc.c
 const char* cDiagonalCalcFinish;
 
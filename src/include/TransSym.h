@@ -0,0 +1,47 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef HPHI_TRANSSYM_H
+#define HPHI_TRANSSYM_H
+
+#include "Common.h"
+
+#define D_TransSymEps 1.0e-8 /*!< Tolerance for the characters read from the TransSym file.*/
+
+int TransSym_Init(struct BindStruct *X);
+
+long unsigned int TransSym_Count(struct BindStruct *X);
+
+long unsigned int TransSym_sz(struct BindStruct *X);
+
+long unsigned int TransSym_GetRow(struct BindStruct *X, long unsigned int j,
+                                  long unsigned int *off, double complex *val);
+
+int TransSym_Mltply(struct BindStruct *X, int nvec, double dscale,
+                    double complex *tmp_v0, double complex *tmp_v1);
+
+void TransSym_ExpecReset(void);
+
+double complex TransSym_Expec(struct BindStruct *X,
+                              long unsigned int isite1, long unsigned int sigma1,
+                              long unsigned int isite2, long unsigned int sigma2,
+                              long unsigned int isite3, long unsigned int sigma3,
+                              long unsigned int isite4, long unsigned int sigma4,
+                              double complex *vec);
+
+void TransSym_TotalSpin(struct BindStruct *X, double complex *vec);
+
+#endif /* HPHI_TRANSSYM_H */
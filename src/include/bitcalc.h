@@ -16,6 +16,20 @@
 #pragma once
 #include "Common.h"
 
+/**
+ * @brief Number of 1s in the bit pattern (SWAR).
+ *
+ * @param x bit pattern
+ *
+ * @return number of 1s
+ */
+static inline int PopCountBit(long unsigned int x){
+  x = x - ((x >> 1) & 0x5555555555555555ul);
+  x = (x & 0x3333333333333333ul) + ((x >> 2) & 0x3333333333333333ul);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0ful;
+  return (int)((x * 0x0101010101010101ul) >> 56);
+}
+
 //inline int GetSplitBit(
 int GetSplitBit(
 		const int Nsite,
@@ -117,3 +131,30 @@ void ConvertToList1GeneralSpin(
 
 
 unsigned long int snoob(unsigned long int x);
+
+int SectorWalkFirst(
+  const long unsigned int *mask,
+  const int *num,
+  const int nclass,
+  long unsigned int *x
+);
+
+int SectorWalkNext(
+  const long unsigned int *mask,
+  const int *num,
+  const int nclass,
+  const int nbit,
+  long unsigned int *x
+);
+
+int GetSplitTableSize(struct BindStruct *X, long unsigned int *n21, long unsigned int *n22);
+
+int OperatorBit(
+  struct BindStruct *X,
+  int nop,
+  const long unsigned int *site,
+  const long unsigned int *spin,
+  long unsigned int *ibit
+);
+
+int GetOffCompInit(struct BindStruct *X);
@@ -16,6 +16,8 @@
 #pragma once
 #include "Common.h"
 
+#define D_DiagonalBlockSize 1024 /*!< Number of states treated by a thread at once in the diagonal evaluator.*/
+
 int diagonalcalc
 (
  struct BindStruct *X
@@ -61,3 +63,61 @@ int SetDiagonalInterAll
  double dtmp_V,
  struct BindStruct *X
  );
+
+int SetDiagonalTermCoulombIntra
+(
+ long unsigned int isite1,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ );
+
+int SetDiagonalTermChemi
+(
+ long unsigned int isite1,
+ double dtmp_V,
+ long unsigned int spin,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ );
+
+int SetDiagonalTermCoulombInter
+(
+ long unsigned int isite1,
+ long unsigned int isite2,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ );
+
+int SetDiagonalTermHund
+(
+ long unsigned int isite1,
+ long unsigned int isite2,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ );
+
+int SetDiagonalTermInterAll
+(
+ long unsigned int isite1,
+ long unsigned int isite2,
+ long unsigned int isigma1,
+ long unsigned int isigma2,
+ double dtmp_V,
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int *nterm
+ );
+
+int SetDiagonalBlock
+(
+ struct BindStruct *X,
+ struct DiagonalTerm *term,
+ long unsigned int nterm
+ );
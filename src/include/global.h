@@ -44,12 +44,21 @@ long unsigned int *list_1;
 long unsigned int *list_1buf;
 long unsigned  int *list_2_1;
 long unsigned  int *list_2_2;
+unsigned int *list_2_1_32; /**< 32-bit list_2_1 used by GetOffComp when idim_max < 2^32. list_2_1 is freed.*/
+unsigned int *list_2_2_32; /**< 32-bit list_2_2 used by GetOffComp when idim_max < 2^32. list_2_2 is freed.*/
 long unsigned  int *list_jb;
 int *list_3;
 long unsigned int *HilbertNumToSz;
 int *list_2_1_Sz;
 int *list_2_2_Sz;
 
+/*[s] stored Hamiltonian (mltplyCSR.c): intra-process off-diagonal part in the CSR format*/
+long unsigned int *list_CSR_ptr; /**< Row j occupies [list_CSR_ptr[j], list_CSR_ptr[j+1]).*/
+unsigned int *list_CSR_idx; /**< Column indices.*/
+double complex *list_CSR_val; /**< Matrix elements.*/
+double *list_CSR_val_r; /**< Matrix elements if all of them are real (iFlgRealCoef=TRUE). list_CSR_val is not allocated.*/
+/*[e] stored Hamiltonian*/
+
 
 /*[s] For Lanczos */
 //double *eigen_vec;
@@ -102,10 +111,15 @@ const char* cFileName1BGreen_CG;
 const char* cFileName2BGreen_Lanczos;
 const char* cFileName2BGreen_CG;
 const char* cFileNameTimeEV_CG;
+const char* cFileNameLOBPCGStep;
+const char* cFileNameTRLanczosStep;
 const char* cFileNameListModel;
 const char* cFileNameListKondo;
 const char* cFileNameOutputEigen;
 const char* cFileNameInputEigen;
+const char* cFileNameBasisCache;
+const char* cFileNameDiagonalCache;
+const char* cFileNameLanczosBasis;
 
 //For TPQ
 const char* cFileNameSSRand;
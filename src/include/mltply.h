@@ -27,6 +27,16 @@
 
 int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1);
 
+int mltply_scale(struct BindStruct *X, double dscale, double complex *tmp_v0,double complex *tmp_v1);
+
+int mltply_block(struct BindStruct *X, int nvec, double complex *tmp_V0, double complex *tmp_V1);
+
+const char *mltply_real_Reason(struct BindStruct *X);
+
+int mltply_real_Check(struct BindStruct *X);
+
+int mltply_real(struct BindStruct *X, double dscale, double *tmp_v0, double *tmp_v1);
+
 double complex child_general_hopp_element
 (
  const long unsigned int j,
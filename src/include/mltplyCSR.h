@@ -0,0 +1,35 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+
+#ifndef HPHI_MLTPLYCSR_H
+#define HPHI_MLTPLYCSR_H
+
+#include "Common.h"
+
+double mltply_csr_MemBudget(struct BindStruct *X);
+
+int mltply_csr_Init(struct BindStruct *X);
+
+int mltply_csr(struct BindStruct *X, double dscale, double complex *tmp_v0, double complex *tmp_v1);
+
+int mltply_csr_real(struct BindStruct *X, double dscale, double *tmp_v0, double *tmp_v1);
+
+int mltply_csr_block(struct BindStruct *X, int nvec, double complex *tmp_v0, double complex *tmp_v1);
+
+#endif /* HPHI_MLTPLYCSR_H */
@@ -0,0 +1,38 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+
+#ifndef HPHI_MLTPLYDENSE_H
+#define HPHI_MLTPLYDENSE_H
+
+#include "Common.h"
+
+#define D_DenseNsite 6 /*!< Maximum number of sites in a cluster (64x64 blocks as in the Boost mode).*/
+#define D_DenseBlockSize 8192 /*!< Number of elements of the vector gathered by a thread for one zgemm.*/
+#define D_DenseChunk 4096 /*!< Number of states scanned by a thread at once.*/
+
+int mltply_dense_Init(struct BindStruct *X);
+
+int mltply_dense(struct BindStruct *X, double complex *tmp_v0, double complex *tmp_v1);
+
+int mltply_dense_SetBlock(long unsigned int mask, struct DenseBlock *blk);
+
+double complex mltply_dense_Apply(struct BindStruct *X, struct DenseBlock *blk,
+                                  double complex *tmp_v0, double complex *tmp_v1);
+
+#endif /* HPHI_MLTPLYDENSE_H */
@@ -0,0 +1,48 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+
+#ifndef HPHI_MLTPLYFUSED_H
+#define HPHI_MLTPLYFUSED_H
+
+#include "Common.h"
+
+#define D_FusedBlockSize 2048 /*!< Number of states treated by a thread at once in the fused sweep.*/
+
+#define FUSED_PATTERN 0 /*!< Bit flip applied only when the masked bits match a pattern. No sign.*/
+#define FUSED_FERMION 1 /*!< Product of two fermion hoppings (or number operators) with a fermion sign.*/
+
+int mltply_fused_Init(struct BindStruct *X);
+
+int mltply_fused(struct BindStruct *X, double dscale, double complex *tmp_v0, double complex *tmp_v1);
+
+int mltply_fused_sp(struct BindStruct *X, float complex *tmp_v0, float complex *tmp_v1);
+
+int mltply_fused_real(struct BindStruct *X, double dscale, double *tmp_v0, double *tmp_v1);
+
+int mltply_fused_block(struct BindStruct *X, int nvec, double complex *tmp_v0, double complex *tmp_v1);
+
+long unsigned int mltply_fused_GetRowBit(struct BindStruct *X, long unsigned int ibit,
+                                         long unsigned int *jbit, double complex *val);
+
+long unsigned int mltply_fused_GetRow(struct BindStruct *X, long unsigned int j,
+                                      long unsigned int *off, double complex *val);
+
+int mltply_fused_MakeHam(struct BindStruct *X);
+
+#endif /* HPHI_MLTPLYFUSED_H */
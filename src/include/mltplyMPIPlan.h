@@ -0,0 +1,56 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+
+#ifndef HPHI_MLTPLYMPIPLAN_H
+#define HPHI_MLTPLYMPIPLAN_H
+
+#include "Common.h"
+
+#define MPIPLAN_RECORD 0 /*!< The partners of the inter-process terms are recorded in the next H*v.*/
+#define MPIPLAN_READY 1 /*!< The vector is sent to the buffered partners at the beginning of H*v.*/
+
+#define MPIPLAN_LIST_UNKNOWN 0 /*!< list_1 of the partner has not been received yet.*/
+#define MPIPLAN_LIST_CACHED 1 /*!< list_1 of the partner is kept.*/
+#define MPIPLAN_LIST_NOCACHE 2 /*!< list_1 of the partner is received at every call.*/
+
+#define MPIPLAN_SHM_UNKNOWN 0 /*!< The shared memory window has not been tried yet.*/
+#define MPIPLAN_SHM_ON 1 /*!< v1 is in the shared memory window and the partners on the same node read it in place.*/
+#define MPIPLAN_SHM_OFF 2 /*!< The shared memory window is not used.*/
+
+#define D_MPIPlanTag 1 /*!< Tag of the messages of the exchange plan.*/
+#define D_MPIStreamTag 2 /*!< Tag of the chunks of the pipelined exchange.*/
+#define D_MPIShmTag 3 /*!< Tag of the handshake before and after v1 of the partner is read in place.*/
+#define D_MPIShmChunk 65536 /*!< Elements of a chunk when all processes are on one node and ExchangeChunk is not given.*/
+
+double complex *mltply_plan_ShmAlloc(struct BindStruct *X);
+
+int mltply_plan_Start(struct BindStruct *X, double complex *tmp_v1);
+
+long unsigned int mltply_plan_ChunkSize(struct BindStruct *X);
+
+int mltply_plan_Open(struct BindStruct *X, int origin,
+                     double complex *tmp_v1, long unsigned int *idim_max_buf);
+
+long unsigned int mltply_plan_Recv(struct BindStruct *X, double complex **v1buf_p, long unsigned int *ichunk);
+
+long unsigned int *mltply_plan_List(struct BindStruct *X, int origin, long unsigned int idim_max_buf);
+
+int mltply_plan_Finish(struct BindStruct *X);
+
+#endif /* HPHI_MLTPLYMPIPLAN_H */
@@ -0,0 +1,40 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+
+#ifndef HPHI_MLTPLYMPIROW_H
+#define HPHI_MLTPLYMPIROW_H
+
+#include "Common.h"
+
+int mltply_row_Init(struct BindStruct *X);
+
+int mltply_row_Start(struct BindStruct *X, double complex *tmp_v1);
+
+int mltply_row_Finish(struct BindStruct *X, double complex *tmp_v0, double complex *tmp_v1);
+
+double complex mltply_row_Expec(
+  struct BindStruct *X,
+  long unsigned int isite1, long unsigned int sigma1,
+  long unsigned int isite2, long unsigned int sigma2,
+  long unsigned int isite3, long unsigned int sigma3,
+  long unsigned int isite4, long unsigned int sigma4,
+  double complex *vec
+  );
+
+#endif /* HPHI_MLTPLYMPIROW_H */
@@ -47,6 +47,7 @@
 #define KWBoost 14
 #define KWSingleExcitation 15
 #define KWPairExcitation 16
+#define KWTransSym 17
 
 int CheckSite(
 	      const int iListToSite,
@@ -138,12 +138,16 @@ struct DefineList{
 
   int   **CisAjtCkuAlvDC; /**< */
   int NCisAjtCkuAlvDC; /**< */
+
+  int NTransSym; /**< Number of symmetry operations in the TransSym file (0: no symmetrized basis).*/
+  int **TransSymSite; /**< [NTransSym][Nsite] Site i is moved to TransSymSite[g][i] by the operation g.*/
+  double complex *ParaTransSym; /**< [NTransSym] Character of the operation g in the target sector.*/
 	
   int iCalcType;
   /**< An integer for selecting calculation type. 0:Lanczos, 1:TPQCalc, 2:FullDiag.*/
 
   int iCalcEigenVec;
-  /**< An integer for selecting method to calculate eigenvectors. 0:Lanczos+CG, 1: Lanczos. default value is set as 0 in readdef.c*/  
+  /**< An integer for selecting method to calculate eigenvectors. 0:Lanczos+CG, 1: Lanczos, 2: LOBPCG, 3: thick-restart Lanczos. default value is set as 0 in readdef.c*/  
 
   int iInitialVecType;
   /**< An integer for setting a type of inital vectors. 0:complex type, 1: real type. default value is set as 0 in readdef.c*/  
@@ -163,6 +167,28 @@ struct DefineList{
     /**< An integer for selecting output a Hamiltonian. 0: no output, 1:output*/
     int iOutputHam;
 
+    /**< An integer for selecting the algorithm of the Hamiltonian-vector product. 0: termwise, 1: fused sweep (default), 2: stored CSR, 3: automatic, 4: dense blocks*/
+    int iMltplyMode;
+
+    /**< An integer for selecting the precision of the TPQ vectors. 0: double (default), 1: single precision with double reductions*/
+    int iTPQPrecision;
+
+    /**< An integer for selecting the sector of the global spin flip (only for Total2Sz=0). 0: not used (default), 1: even, -1: odd*/
+    int iSpinFlip;
+
+    /**< An integer for selecting the cache of the basis and the diagonal part on the disk. 0: not used (default), 1: read if valid, otherwise build and write*/
+    int iBasisCache;
+
+    /**< An integer for selecting how the eigenvector is built by the Lanczos method. 0: second recurrence (default), 1: Lanczos vectors kept in the memory, 2: in the memory and a scratch file*/
+    int iLanczosBasis;
+
+    double MaxMem; /**< Memory [GB] per process available for MltplyMode=3 and LanczosBasis. Read from modpara; 0 means half of the physical memory.*/
+    int LOBPCGBlock; /**< Number of the vectors in the block of the LOBPCG method. Read from modpara; 0 means nvec.*/
+    int ThickRestartBasis; /**< Maximum number of the Lanczos vectors in the thick-restart Lanczos method. Read from modpara; 0 means nvec+20.*/
+    int ThickRestartKeep; /**< Number of the Ritz vectors kept at a thick restart. Read from modpara; 0 means (ThickRestartBasis+nvec)/2.*/
+    double ExchangeChunk; /**< Size [MB] of a chunk of the pipelined MPI exchange. Read from modpara; 0 means the whole vector at once.*/
+    int NUMAReport; /**< 1: report the NUMA placement of the large arrays. Read from modpara; 0 (default) means no report.*/
+
 };
 
 struct CheckList{
@@ -170,9 +196,55 @@ struct CheckList{
   unsigned long int  idim_maxMPI; /**< */
   unsigned long int     sdim;    /**< */
   double   max_mem;  /**< */
+  double   max_mem_csr;  /**< Upper bound of the memory [GB] for the stored Hamiltonian (MltplyMode=2,3).*/
 
 };
 
+/**
+ * @brief One off-diagonal term of the operator program used by the fused sweep (mltplyFused.c).
+ * The term is stored in the adjoint (row-oriented) form: for a row state |j>,
+ * it gives the column state |k> and (Hv)[j] += sgn*coef*v[k].
+ */
+struct FusedTerm{
+  int itype; /**< FUSED_FERMION or FUSED_PATTERN (mltplyFused.h)*/
+  long unsigned int isA_cr; /**< Bit created by the first fermion operator pair.*/
+  long unsigned int isA_an; /**< Bit annihilated by the first fermion operator pair.*/
+  long unsigned int A_diff; /**< Bits between isA_cr and isA_an for the fermion sign.*/
+  long unsigned int isB_cr; /**< Bit created by the second fermion operator pair.*/
+  long unsigned int isB_an; /**< Bit annihilated by the second fermion operator pair. 0 if absent.*/
+  long unsigned int B_diff; /**< Bits between isB_cr and isB_an for the fermion sign.*/
+  long unsigned int mask; /**< Bits checked by a pattern term.*/
+  long unsigned int pattern; /**< Required value of the masked bits.*/
+  long unsigned int flip; /**< Bits flipped by a pattern term.*/
+  double complex coef; /**< Matrix element of the term.*/
+};
+
+/**
+ * @brief One dense block of the intra-process terms (mltplyDense.c).
+ * It holds the terms acting on a cluster of at most D_DenseNsite sites,
+ * restricted to one sector of the magnetization of the cluster in the canonical Spin model.
+ * The bits of the other sites label the columns of zgemm.
+ */
+struct DenseBlock{
+  long unsigned int mask; /**< Bits of the sites in the cluster.*/
+  long unsigned int first; /**< Bits of the first configuration of the sector. A state with these bits starts a column.*/
+  long unsigned int dim; /**< Number of configurations in the sector.*/
+  long unsigned int *bit; /**< [dim] Bits of each configuration.*/
+  double complex *mat; /**< [dim*dim] Matrix in the column-major order: (Hv)[row] += mat[row+dim*col]*v[col].*/
+};
+
+/**
+ * @brief One diagonal term of the block evaluator (diagonalcalc.c).
+ * The term depends only on a few bits of the configuration s of a state
+ * and adds value[idx] to the diagonal element, where the l-th bit of idx is
+ * the bit of s at the position shift[l].
+ */
+struct DiagonalTerm{
+  int nbit; /**< Number of bits of the configuration used by the term (0,...,4).*/
+  long unsigned int shift[4]; /**< Positions of these bits.*/
+  double value[16]; /**< Contribution of the term for each value of these bits.*/
+};
+
 struct LargeList{
   double complex prdct;  /**< */
   int itr;  /**< */
@@ -206,6 +278,40 @@ struct LargeList{
   long unsigned int isA_spin;
   long unsigned int  isB_spin;
   double complex      tmp_V;
+
+  /*[s] operator program for the fused sweep*/
+  int iFlgFused; /**< TRUE if mltply and makeHam execute the operator program.*/
+  long unsigned int NFusedTerm; /**< Number of terms in the operator program.*/
+  long unsigned int NFusedPattern; /**< Terms [0, NFusedPattern) are pattern terms, the others are fermion terms.*/
+  int iFlgRealCoef; /**< TRUE if all coefficients of the operator program are real.*/
+  struct FusedTerm *FusedTerm; /**< Operator program: intra-process off-diagonal terms.*/
+  /*[e] operator program for the fused sweep*/
+
+  /*[s] dense blocks (mltplyDense.c)*/
+  int iFlgDense; /**< TRUE if mltply applies the intra-process terms by the dense blocks.*/
+  long unsigned int NDenseBlock; /**< Number of dense blocks.*/
+  struct DenseBlock *DenseBlock; /**< [NDenseBlock] Dense blocks of all clusters.*/
+  /*[e] dense blocks (mltplyDense.c)*/
+
+  /*[s] symmetrized basis (TransSym.c)*/
+  int NTransSymOp; /**< Number of operations in the group: NTransSymPerm (x 2 with the spin flip). 0: symmetrized basis is not used.*/
+  int NTransSymPerm; /**< Number of site permutations: NTransSym, or 1 (identity) without the TransSym file.*/
+  int NTransSymByte; /**< Number of bytes of a state in the lookup table of TransSymTable.*/
+  long unsigned int *TransSymTable; /**< [NTransSymPerm][NTransSymByte][256] Image of each byte of a state by each permutation.*/
+  long unsigned int TransSymFlipMask; /**< Spin flip after the permutation g - NTransSymPerm for g >= NTransSymPerm: bits flipped (Spin), or up orbitals exchanged with the down ones (Hubbard).*/
+  double complex *TransSymChar; /**< [NTransSymOp] Character of each operation in the target sector.*/
+  int iFlgTransSymReal; /**< TRUE if all characters are real.*/
+  /*[e] symmetrized basis (TransSym.c)*/
+
+  /*[s] stored Hamiltonian*/
+  int iFlgCSR; /**< TRUE if mltply uses the stored Hamiltonian (list_CSR_ptr, list_CSR_idx, list_CSR_val or list_CSR_val_r).*/
+  long unsigned int nnz_CSR; /**< Number of stored off-diagonal elements.*/
+  /*[e] stored Hamiltonian*/
+
+  /*[s] rows distributed over the processes (mltplyMPIRow.c)*/
+  int iFlgMPIRow; /**< TRUE if the sector is split into contiguous blocks of rows instead of the inter-process sites.*/
+  long unsigned int RowOffset; /**< list_1[j] of this process is the state j+RowOffset of the whole sector.*/
+  /*[e] rows distributed over the processes (mltplyMPIRow.c)*/
 };
 
 struct PhysList{
@@ -81,6 +81,12 @@ long int Binomial(
 	     int Nsite
 	     );
 
+long int BinomialTable(
+	     int n,
+	     int k,
+	     long int **comb
+	     );
+
 int sz(
 
        );
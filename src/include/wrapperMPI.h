@@ -31,6 +31,7 @@ void BarrierMPI();
 unsigned long int MaxMPI_li(unsigned long int idim);
 double MaxMPI_d(double dvalue);
 double complex SumMPI_dc(double complex norm);
+void SumMPI_cv(int n, double complex *norm);
 double SumMPI_d(double norm);
 unsigned long int SumMPI_li(unsigned long int idim);
 int SumMPI_i(int idim);
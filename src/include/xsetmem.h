@@ -17,6 +17,8 @@
 
 static int mfint[7];/*for malloc*/
 
+#define D_NUMASample 1024 /*!< Max number of pages per array checked in the NUMA placement report.*/
+
 void setmem_HEAD
 (
  struct BindStruct *X
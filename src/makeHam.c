@@ -16,6 +16,7 @@
 
 #include <bitcalc.h>
 #include "mltply.h"
+#include "mltplyFused.h"
 #include "makeHam.h"
 #include "wrapperMPI.h"
 
@@ -94,6 +95,12 @@ int makeHam(struct BindStruct *X){
     v1[j]     = 1.0;
     //printf("%ld, %f\n", j, list_Diagonal[j]);
   }
+
+  if(X->Large.iFlgFused == TRUE){
+    //Off-diagonal terms by the operator program
+    return mltply_fused_MakeHam(X);
+  }
+
   switch(X->Def.iCalcModel){
   case HubbardGC:
     //Transfer
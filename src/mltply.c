@@ -20,6 +20,11 @@
 #include "xsetmem.h"
 #include "mltply.h"
 #include "mltplyMPI.h"
+#include "mltplyFused.h"
+#include "mltplyCSR.h"
+#include "mltplyDense.h"
+#include "mltplyMPIPlan.h"
+#include "mltplyMPIRow.h"
 #include "wrapperMPI.h"
 
 /**
@@ -34,6 +39,24 @@
  * @author Kazuyoshi Yoshimi (The University of Tokyo)
  */
 int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1) {
+  return mltply_scale(X, 1.0, tmp_v0, tmp_v1);
+}
+
+/**
+ * @brief tmp_v0 = dscale*tmp_v0 + H tmp_v1.
+ * The scaling is applied in the pass over the diagonal part,
+ * so that the Lanczos recurrence needs no separate pass for it.
+ * X->Large.prdct is <tmp_v1|H|tmp_v1>.
+ *
+ * @param X
+ * @param dscale factor applied to @p tmp_v0 before the product is added
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_scale(struct BindStruct *X, double dscale, double complex *tmp_v0,double complex *tmp_v1) {
 
   long unsigned int j;
   long unsigned int i;
@@ -47,11 +70,8 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
   long unsigned int isite1, isite2, sigma1, sigma2;
   long unsigned int isite3, isite4, sigma3, sigma4;
   long unsigned int ibitsite1, ibitsite2, ibitsite3, ibitsite4;
-  long unsigned int countm;
-  long unsigned int sitenum;
 
   double complex dam_pr;
-  double complex dam_prm;
   double complex tmp_trans;
   long int tmp_sgn;
   double num1 = 0;
@@ -60,14 +80,10 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
   double complex dmv=0;
   /*[e] For InterAll */
 
-  /* SpinGCBoost */
-  double complex* tmp_v2;
-  double complex* tmp_v3;
-  /* SpinGCBoost */
-  
   long unsigned int i_max;
   int ihermite=0;
   int idx=0;
+  int iFused=FALSE;
   i_max = X->Check.idim_max;
   X->Large.prdct = 0.0;
   dam_pr = 0.0;
@@ -96,13 +112,34 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
   X->Large.ilft = ilft;
   X->Large.ihfbit = ihfbit;
   X->Large.mode = M_MLTPLY;
-
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(i_max) shared(tmp_v0, tmp_v1, list_Diagonal)
-  for (j = 1; j <= i_max; j++) {
-    tmp_v0[j] += (list_Diagonal[j]) * tmp_v1[j];
-    dam_pr += (list_Diagonal[j]) * conj(tmp_v1[j]) * tmp_v1[j];
+  //Post the exchanges of tmp_v1 with the other processes
+  mltply_plan_Start(X, tmp_v1);
+
+  iFused = X->Large.iFlgFused;
+  if (X->Large.iFlgCSR == TRUE) {
+    //Columns on the other processes are exchanged during the local part
+    if (X->Large.iFlgMPIRow == TRUE) mltply_row_Start(X, tmp_v1);
+    //Diagonal and intra-process terms by the stored Hamiltonian
+    mltply_csr(X, dscale, tmp_v0, tmp_v1);
+    if (X->Large.iFlgMPIRow == TRUE) mltply_row_Finish(X, tmp_v0, tmp_v1);
+  }
+  else if (iFused == TRUE) {
+    //Diagonal and intra-process terms by the operator program
+    if (mltply_fused(X, dscale, tmp_v0, tmp_v1) != 0) return -1;
+  }
+  else {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(i_max, dscale) shared(tmp_v0, tmp_v1, list_Diagonal)
+    for (j = 1; j <= i_max; j++) {
+      tmp_v0[j] = dscale * tmp_v0[j] + (list_Diagonal[j]) * tmp_v1[j];
+      dam_pr += (list_Diagonal[j]) * conj(tmp_v1[j]) * tmp_v1[j];
+    }
+    X->Large.prdct += dam_pr;
+  }
+  if (X->Large.iFlgDense == TRUE) {
+    //Intra-process terms by the dense blocks; they are skipped below as in the fused sweep
+    mltply_dense(X, tmp_v0, tmp_v1);
+    iFused = TRUE;
   }
-  X->Large.prdct += dam_pr;
   
   switch (X->Def.iCalcModel) {
     case HubbardGC:
@@ -119,7 +156,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
         else if (X->Def.EDGeneralTransfer[i][0] + 1 > X->Def.Nsite) {
           GC_child_general_hopp_MPIsingle(i+1, X, tmp_v0, tmp_v1);
         }
-        else {
+        else if (iFused == FALSE) {
           for (ihermite = 0; ihermite<2; ihermite++) {
             idx = i + ihermite;
             isite1 = X->Def.EDGeneralTransfer[idx][0] + 1;
@@ -137,6 +174,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
       }
 
       for (i = 0; i < X->Def.NInterAll_OffDiagonal; i+=2) {
+	  dam_pr=0.0;
 	  isite1 = X->Def.InterAll_OffDiagonal[i][0] + 1;
 	  isite2 = X->Def.InterAll_OffDiagonal[i][2] + 1;
 	  isite3 = X->Def.InterAll_OffDiagonal[i][4] + 1;
@@ -179,7 +217,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
 							 tmp_V, X, tmp_v0, tmp_v1);
 	  }
       }//InterPE
-      else{
+      else if(iFused == FALSE){
 	dam_pr=0.0;
 	for(ihermite=0; ihermite<2; ihermite++){
 	  idx=i+ihermite;
@@ -228,7 +266,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
 	     X->Def.ParaPairHopping[i], X, tmp_v0, tmp_v1
 	     );
         }
-        else {
+        else if (iFused == FALSE) {
           for (ihermite = 0; ihermite<2; ihermite++) {
             idx = i + ihermite;
 	    child_pairhopp_GetInfo(idx, X);
@@ -253,7 +291,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
 	     X->Def.ParaExchangeCoupling[i], X, tmp_v0, tmp_v1
 	     );        
         }        
-        else {
+        else if (iFused == FALSE) {
 	  child_exchange_GetInfo(i, X);
 	  dam_pr = GC_child_exchange(tmp_v0, tmp_v1, X);
         }
@@ -277,7 +315,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
         else if (X->Def.EDGeneralTransfer[i][0] + 1 > X->Def.Nsite) {
           child_general_hopp_MPIsingle(i + 1, X, tmp_v0, tmp_v1);
         }
-        else {
+        else if (iFused == FALSE) {
           for (ihermite = 0; ihermite<2; ihermite++) {
             idx = i + ihermite;
             isite1 = X->Def.EDGeneralTransfer[idx][0] + 1;
@@ -336,7 +374,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
 						      tmp_V, X, tmp_v0, tmp_v1);
 	  }	 
 	}
-	else{
+	else if(iFused == FALSE){
 	  for(ihermite=0; ihermite<2; ihermite++){
 	    idx=i+ihermite;
 	    isite1 = X->Def.InterAll_OffDiagonal[idx][0] + 1;
@@ -390,7 +428,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
 	     X->Def.ParaPairHopping[i], X, tmp_v0, tmp_v1
 	     );
 	  }
-        else {
+        else if (iFused == FALSE) {
           for (ihermite = 0; ihermite<2; ihermite++) {
             idx = i + ihermite;
             child_pairhopp_GetInfo(idx, X);
@@ -415,7 +453,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
 	     X->Def.ParaExchangeCoupling[i], X, tmp_v0, tmp_v1
 	     );        
         }
-        else {
+        else if (iFused == FALSE) {
 	  child_exchange_GetInfo(i, X);
 	  dam_pr = child_exchange(tmp_v0, tmp_v1, X);
         }
@@ -440,7 +478,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
           else if (X->Def.InterAll_OffDiagonal[i][0] + 1 > X->Def.Nsite) {
             child_general_int_spin_MPIsingle(i + 1, X, tmp_v0, tmp_v1);
           }
-          else {
+          else if (iFused == FALSE) {
             for (ihermite = 0; ihermite<2; ihermite++) {
               idx = i + ihermite;
               isite1 = X->Def.InterAll_OffDiagonal[idx][0] + 1;
@@ -460,6 +498,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
 	//Exchange	
         for (i = 0; i < X->Def.NExchangeCoupling; i++) {
 	  sigma1=0; sigma2=1;
+	  dam_pr=0.0;
           if (X->Def.ExchangeCoupling[i][0] + 1 > X->Def.Nsite &&
 	      X->Def.ExchangeCoupling[i][1] + 1 > X->Def.Nsite) {
 	    dam_pr = X_child_general_int_spin_MPIdouble(X->Def.ExchangeCoupling[i][0], sigma1, sigma2, X->Def.ExchangeCoupling[i][1], sigma2, sigma1, X->Def.ParaExchangeCoupling[i], X, tmp_v0, tmp_v1);
@@ -470,7 +509,7 @@ int mltply(struct BindStruct *X, double complex *tmp_v0,double complex *tmp_v1)
           else if (X->Def.ExchangeCoupling[i][0] + 1 > X->Def.Nsite) {
 	    dam_pr = X_child_general_int_spin_MPIsingle(X->Def.ExchangeCoupling[i][1], sigma2, sigma1, X->Def.ExchangeCoupling[i][0], sigma1, sigma2, conj(X->Def.ParaExchangeCoupling[i]), X, tmp_v0, tmp_v1);
           }
-          else {
+          else if (iFused == FALSE) {
 	    child_exchange_spin_GetInfo(i, X);
 	    dam_pr = child_exchange_spin(tmp_v0, tmp_v1, X);
 	  }
@@ -533,6 +572,7 @@ shared(tmp_v0, tmp_v1, list_1, list_2_1, list_2_2)
 
       if (X->Def.iFlgGeneralSpin == FALSE) {
         for (i = 0; i < X->Def.EDNTransfer; i+=2 ) {
+         dam_pr=0;
          if(X->Def.EDGeneralTransfer[i][0]+1 > X->Def.Nsite){
            dam_pr=0;
            if(X->Def.EDGeneralTransfer[i][1]==X->Def.EDGeneralTransfer[i][3]){
@@ -542,7 +582,7 @@ shared(tmp_v0, tmp_v1, list_1, list_2_1, list_2_2)
              dam_pr += X_GC_child_CisAit_spin_MPIdouble(X->Def.EDGeneralTransfer[i][0], X->Def.EDGeneralTransfer[i][1], X->Def.EDGeneralTransfer[i][3], -X->Def.EDParaGeneralTransfer[i], X, tmp_v0, tmp_v1);
            }
          }
-         else{
+         else if(iFused == FALSE){
            dam_pr=0;
            for(ihermite=0; ihermite<2; ihermite++){
 	      idx=i+ihermite;
@@ -588,7 +628,7 @@ shared(tmp_v0, tmp_v1, list_1, list_2_1, list_2_2)
           else if (X->Def.InterAll_OffDiagonal[i][0] + 1 > X->Def.Nsite) {
             GC_child_general_int_spin_MPIsingle(i + 1, X, tmp_v0, tmp_v1);
           }
-          else {
+          else if (iFused == FALSE) {
             for (ihermite = 0; ihermite < 2; ihermite++) {
               idx = i + ihermite;
               isite1 = X->Def.InterAll_OffDiagonal[idx][0] + 1;
@@ -608,6 +648,7 @@ shared(tmp_v0, tmp_v1, list_1, list_2_1, list_2_2)
         //Exchange
         for (i = 0; i < X->Def.NExchangeCoupling; i++) {
 	  sigma1=0; sigma2=1;
+	  dam_pr=0.0;
           if (X->Def.ExchangeCoupling[i][0] + 1 > X->Def.Nsite &&
 	      X->Def.ExchangeCoupling[i][1] + 1 > X->Def.Nsite){
 	    dam_pr = X_GC_child_CisAitCiuAiv_spin_MPIdouble(X->Def.ExchangeCoupling[i][0], sigma1, sigma2, X->Def.ExchangeCoupling[i][1], sigma2, sigma1, X->Def.ParaExchangeCoupling[i], X, tmp_v0, tmp_v1);
@@ -618,7 +659,7 @@ shared(tmp_v0, tmp_v1, list_1, list_2_1, list_2_2)
           else if (X->Def.ExchangeCoupling[i][0] + 1 > X->Def.Nsite) {
 	    dam_pr=X_GC_child_CisAitCiuAiv_spin_MPIsingle(X->Def.ExchangeCoupling[i][1], sigma2, sigma1, X->Def.ExchangeCoupling[i][0], sigma1, sigma2, conj(X->Def.ParaExchangeCoupling[i]), X, tmp_v0, tmp_v1);    
           }
-          else {
+          else if (iFused == FALSE) {
 	    child_exchange_spin_GetInfo(i, X);
 	    dam_pr = GC_child_exchange_spin(tmp_v0, tmp_v1, X);
           }
@@ -628,6 +669,7 @@ shared(tmp_v0, tmp_v1, list_1, list_2_1, list_2_2)
         //PairLift
         for (i = 0; i < X->Def.NPairLiftCoupling; i++) {
 	  sigma1 =0; sigma2=1;
+	  dam_pr=0.0;
           if (X->Def.PairLiftCoupling[i][0] + 1 > X->Def.Nsite &&
             X->Def.PairLiftCoupling[i][1] + 1 > X->Def.Nsite) {
 	    dam_pr = X_GC_child_CisAitCiuAiv_spin_MPIdouble(X->Def.PairLiftCoupling[i][0], sigma1, sigma2, X->Def.PairLiftCoupling[i][1], sigma1, sigma2, X->Def.ParaPairLiftCoupling[i], X, tmp_v0, tmp_v1);
@@ -638,7 +680,7 @@ shared(tmp_v0, tmp_v1, list_1, list_2_1, list_2_2)
           else if (X->Def.PairLiftCoupling[i][0] + 1 > X->Def.Nsite) {
 	    dam_pr = X_GC_child_CisAitCiuAiv_spin_MPIsingle(X->Def.PairLiftCoupling[i][1], sigma1, sigma2, X->Def.PairLiftCoupling[i][0], sigma1, sigma2, conj(X->Def.ParaPairLiftCoupling[i]), X, tmp_v0, tmp_v1);
           }
-          else {
+          else if (iFused == FALSE) {
               child_pairlift_spin_GetInfo(i, X);
               dam_pr = GC_child_pairlift_spin(tmp_v0, tmp_v1, X);
           }
@@ -791,32 +833,8 @@ shared(tmp_v0, tmp_v1)
       }  //end:generalspin
 	
   if(X->Boost.flgBoost == 1){
-	 
-    c_malloc1(tmp_v2, i_max+1);
-    c_malloc1(tmp_v3, i_max+1);
-     
-    child_general_int_spin_MPIBoost(X, tmp_v0, tmp_v1, tmp_v2, tmp_v3);
-    dam_pr  = 0.0;
-    dam_prm = 0.0;
-    sitenum = X->Def.Nsite;
-    #pragma omp parallel for default(none) reduction(+:dam_pr,dam_prm) private(i,j,countm) shared(tmp_v1,myrank,nproc) firstprivate(i_max,sitenum) 
-    for(j=1;j<=i_max;j++){
-      // count mag  X->Def.Nsite
-      countm = 0;
-      for(i=0;i<(int)log2(nproc);i++){
-        countm += (myrank>>i)&1;
-      }
-      for(i=0;i<sitenum;i++){
-        countm += ((j-1)>>i)&1;
-      }  
-      dam_pr   += conj(tmp_v1[j])*tmp_v1[j]; // norm=<v1|v1>
-      dam_prm  += countm*conj(tmp_v1[j])*tmp_v1[j]; // mag=<v1|(Mz+1/2)|v1>
-    }
-    //X->Large.prdct += dam_pr;  
-    dam_pr  = SumMPI_dc(dam_pr);
-    dam_prm = SumMPI_dc(dam_prm);
 
-    /*fprintf(stdoutMPI, "###Boost### SpinGC Boost mode f norm %lf and mag %lf\n",creal(dam_pr),creal(dam_prm));*/
+    child_general_int_spin_MPIBoost(X, tmp_v0, tmp_v1);
 
     dam_pr = 0.0;
     #pragma omp parallel for default(none) reduction(+:dam_pr) private(j) shared(tmp_v1,tmp_v0) firstprivate(i_max) 
@@ -824,11 +842,6 @@ shared(tmp_v0, tmp_v1)
       dam_pr   += conj(tmp_v1[j])*tmp_v0[j]; // <H>=<v1|H|v1>
     }
     X->Large.prdct += dam_pr;  
-    
-
-    /* SpinGCBoost */
-    c_free1(tmp_v2, i_max+1);  
-    c_free1(tmp_v3, i_max+1);  
 
   }/* SpinGCBoost */
 
@@ -838,6 +851,7 @@ shared(tmp_v0, tmp_v1)
     return -1;
   }
   
+  mltply_plan_Finish(X);
   X->Large.prdct = SumMPI_dc(X->Large.prdct);
   //  fprintf(stdoutMPI, "debug: prdct=%lf, %lf\n",creal( X->Large.prdct), cimag( X->Large.prdct ) );
   //FinalizeMPI();
@@ -846,6 +860,146 @@ shared(tmp_v0, tmp_v1)
   return 0;
 }
 
+/**
+ * @brief Multiply the Hamiltonian to @p nvec vectors at once: V0 += H V1.
+ * The vectors are stored interleaved, i.e. the component j of the vector l
+ * is at [j*nvec+l] (j=1,...,i_max, l=0,...,nvec-1).
+ * With the operator program or the stored Hamiltonian in a single process,
+ * each index lookup and fermion sign is shared by all vectors.
+ * Otherwise mltply is called for each vector.
+ *
+ * @param X
+ * @param nvec number of vectors
+ * @param tmp_V0 [in,out] result vectors
+ * @param tmp_V1 [in] input vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ * @note X->Large.prdct becomes the sum of <v1_l|H|v1_l> over the vectors.
+ */
+int mltply_block(struct BindStruct *X, int nvec, double complex *tmp_V0, double complex *tmp_V1) {
+
+  long unsigned int i_max, j, k;
+  long unsigned int irght = 0, ilft = 0, ihfbit = 0;
+  int ivec;
+  double complex dam_pr;
+  double complex *tmp_v0;
+  double complex *tmp_v1;
+
+  i_max = X->Check.idim_max;
+  k = nvec;
+
+  if (X->Large.iFlgFused == TRUE && nproc == 1) {
+    if (i_max != 0) {
+      if (GetSplitBitByModel(X->Def.Nsite, X->Def.iCalcModel, &irght, &ilft, &ihfbit) != 0) {
+        return -1;
+      }
+    }
+    X->Large.i_max = i_max;
+    X->Large.irght = irght;
+    X->Large.ilft = ilft;
+    X->Large.ihfbit = ihfbit;
+    X->Large.mode = M_MLTPLY;
+    X->Large.prdct = 0.0;
+    if (X->Large.iFlgCSR == TRUE) mltply_csr_block(X, nvec, tmp_V0, tmp_V1);
+    else if (mltply_fused_block(X, nvec, tmp_V0, tmp_V1) != 0) return -1;
+    return 0;
+  }
+
+  /* Fall back to one vector at a time */
+  c_malloc1(tmp_v0, i_max + 1);
+  c_malloc1(tmp_v1, i_max + 1);
+  dam_pr = 0.0;
+  for (ivec = 0; ivec < nvec; ivec++) {
+#pragma omp parallel for default(none) private(j) firstprivate(i_max, k, ivec) shared(tmp_v0, tmp_v1, tmp_V1)
+    for (j = 1; j <= i_max; j++) {
+      tmp_v0[j] = 0.0;
+      tmp_v1[j] = tmp_V1[j * k + ivec];
+    }
+    if (mltply(X, tmp_v0, tmp_v1) != 0) {
+      c_free1(tmp_v0, i_max + 1);
+      c_free1(tmp_v1, i_max + 1);
+      return -1;
+    }
+    dam_pr += X->Large.prdct;
+#pragma omp parallel for default(none) private(j) firstprivate(i_max, k, ivec) shared(tmp_v0, tmp_V0)
+    for (j = 1; j <= i_max; j++) {
+      tmp_V0[j * k + ivec] += tmp_v0[j];
+    }
+  }
+  c_free1(tmp_v0, i_max + 1);
+  c_free1(tmp_v1, i_max + 1);
+  X->Large.prdct = dam_pr;
+  return 0;
+}
+
+/**
+ * @brief Check whether the Lanczos and TPQ vectors can be kept real and multiplied by mltply_real.
+ * All the terms must be in the operator program or the stored Hamiltonian of a single process,
+ * their coefficients must be real, and the initial vector must be real (InitialVecType=1).
+ * Must be called after mltply_fused_Init and mltply_csr_Init.
+ *
+ * @param X
+ *
+ * @retval NULL real vectors can be used
+ * @return otherwise the reason why complex vectors are needed, for the standard output
+ */
+const char *mltply_real_Reason(struct BindStruct *X) {
+  if (X->Def.iInitialVecType == 0) return "InitialVecType=0";
+  if (nproc != 1) return "more than one process";
+  if (X->Large.iFlgFused == FALSE) return "MltplyMode=0 or terms outside the operator program";
+  if (X->Large.iFlgCSR == TRUE) return (list_CSR_val_r != NULL) ? NULL : "complex matrix elements";
+  if (X->Large.NTransSymOp > 0) return "phase factors of TransSym";
+  if (X->Large.iFlgRealCoef == FALSE) return "complex couplings";
+  return NULL;
+}
+
+/**
+ * @brief Check whether the Lanczos and TPQ vectors can be kept real (see mltply_real_Reason).
+ *
+ * @param X
+ *
+ * @retval TRUE real vectors can be used
+ * @retval FALSE complex vectors are needed
+ */
+int mltply_real_Check(struct BindStruct *X) {
+  return (mltply_real_Reason(X) == NULL) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Real version of mltply_scale: tmp_v0 = dscale*tmp_v0 + H tmp_v1 for real vectors.
+ * Only available if mltply_real_Check(X) is TRUE.
+ * X->Large.prdct is <tmp_v1|H|tmp_v1>.
+ *
+ * @param X
+ * @param dscale factor applied to @p tmp_v0 before the product is added
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_real(struct BindStruct *X, double dscale, double *tmp_v0, double *tmp_v1) {
+
+  long unsigned int i_max;
+  long unsigned int irght = 0, ilft = 0, ihfbit = 0;
+
+  i_max = X->Check.idim_max;
+  if (i_max != 0) {
+    if (GetSplitBitByModel(X->Def.Nsite, X->Def.iCalcModel, &irght, &ilft, &ihfbit) != 0) {
+      return -1;
+    }
+  }
+  X->Large.i_max = i_max;
+  X->Large.irght = irght;
+  X->Large.ilft = ilft;
+  X->Large.ihfbit = ihfbit;
+  X->Large.mode = M_MLTPLY;
+  X->Large.prdct = 0.0;
+  if (X->Large.iFlgCSR == TRUE) return mltply_csr_real(X, dscale, tmp_v0, tmp_v1);
+  return mltply_fused_real(X, dscale, tmp_v0, tmp_v1);
+}
+
 
 /******************************************************************************/
 //[s] child functions
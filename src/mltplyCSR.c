@@ -0,0 +1,321 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+//
+// Stored Hamiltonian: the intra-process off-diagonal part is generated once
+// from the operator program (mltplyFused.c) and kept in the CSR format.
+// The diagonal part stays in list_Diagonal and inter-process terms are
+// still applied by mltplyMPI.c. When the rows are distributed over the
+// processes, the columns on the other processes are split off by
+// mltplyMPIRow.c.
+
+#include <limits.h>
+#include <unistd.h>
+#include <bitcalc.h>
+#include "mfmemory.h"
+#include "mltply.h"
+#include "mltplyFused.h"
+#include "mltplyCSR.h"
+#include "mltplyMPIRow.h"
+#include "wrapperMPI.h"
+
+/**
+ * @brief Memory [GB] per process which the stored Hamiltonian (MltplyMode=3)
+ * and the buffers of the exchange plan (mltplyMPIPlan.c) may use.
+ *
+ * @param X
+ *
+ * @return MaxMem in modpara, or half of the physical memory shared by all processes
+ */
+double mltply_csr_MemBudget(struct BindStruct *X)
+{
+  long int npage, pagesize;
+
+  if (X->Def.MaxMem > 0.0) return X->Def.MaxMem;
+  npage = sysconf(_SC_PHYS_PAGES);
+  pagesize = sysconf(_SC_PAGESIZE);
+  if (npage <= 0 || pagesize <= 0) return 0.0;
+  return 0.5 * (double)npage * (double)pagesize / (double)nproc / pow(10, 9);
+}
+
+/**
+ * @brief Build the stored Hamiltonian if it is requested (MltplyMode=2)
+ * or if it fits in the memory (MltplyMode=3).
+ * Must be called after mltply_fused_Init.
+ * When the rows are distributed over the processes, the stored Hamiltonian is required.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_csr_Init(struct BindStruct *X)
+{
+  long unsigned int i_max, nterm, j, nelem, ielem, nnz, irght, ilft, ihfbit;
+  long unsigned int *off;
+  double complex *val;
+  double dmem, dbudget;
+  int iflg, iReal;
+
+  X->Large.iFlgCSR = FALSE;
+  X->Large.nnz_CSR = 0;
+  if (X->Def.iMltplyMode != MLTPLY_CSR && X->Def.iMltplyMode != MLTPLY_AUTO) return 0;
+  if (X->Def.iCalcType != Lanczos && X->Def.iCalcType != TPQCalc) return 0;
+  /*Single-precision TPQ uses the operator program*/
+  if (X->Def.iCalcType == TPQCalc && X->Def.iTPQPrecision == TPQ_MIXED && nproc == 1) return 0;
+
+  i_max = X->Check.idim_max;
+  nterm = X->Large.NFusedTerm;
+  /*Columns are indexed in the whole sector when the rows are distributed*/
+  iflg = (X->Large.iFlgFused == TRUE && nterm > 0
+          && ((X->Large.iFlgMPIRow == TRUE) ? X->Check.idim_maxMPI : i_max) < UINT_MAX);
+  if (MaxMPI_li(1 - iflg) != 0) {
+    if (X->Large.iFlgMPIRow == TRUE) {
+      fprintf(stdoutMPI, "%s", cErrMPIRowCSR);
+      return -1;
+    }
+    if (X->Def.iMltplyMode == MLTPLY_CSR) {
+      fprintf(stdoutMPI, "  MltplyMode: stored Hamiltonian is not available. On-the-fly sweep is used.\n");
+    }
+    return 0;
+  }
+
+  if (GetSplitBitByModel(X->Def.Nsite, X->Def.iCalcModel, &irght, &ilft, &ihfbit) != 0) {
+    return -1;
+  }
+  X->Large.i_max = i_max;
+  X->Large.irght = irght;
+  X->Large.ilft = ilft;
+  X->Large.ihfbit = ihfbit;
+
+  lui_malloc1(list_CSR_ptr, i_max + 2);
+  if (list_CSR_ptr == NULL) return -1;
+  /*
+    Count the elements in each row
+  */
+  list_CSR_ptr[0] = 0;
+  list_CSR_ptr[1] = 0;
+#pragma omp parallel default(none) private(j, nelem, off, val) firstprivate(i_max, nterm, X) shared(list_CSR_ptr)
+  {
+    lui_malloc1(off, nterm + 1);
+    c_malloc1(val, nterm + 1);
+#pragma omp for
+    for (j = 1; j <= i_max; j++) {
+      list_CSR_ptr[j + 1] = mltply_fused_GetRow(X, j, off, val);
+    }
+    free(off);
+    free(val);
+  }
+  for (j = 1; j <= i_max; j++) list_CSR_ptr[j + 1] += list_CSR_ptr[j];
+  nnz = list_CSR_ptr[i_max + 1];
+
+  /*Characters of the symmetrized basis may be complex*/
+  iReal = (X->Large.iFlgRealCoef == TRUE && (X->Large.NTransSymOp == 0 || X->Large.iFlgTransSymReal == TRUE));
+  if (iReal == TRUE) dmem = (nnz * (8.0 + 4.0) + (i_max + 2) * 8.0) / pow(10, 9);
+  else dmem = (nnz * (16.0 + 4.0) + (i_max + 2) * 8.0) / pow(10, 9);
+  dbudget = mltply_csr_MemBudget(X);
+  fprintf(stdoutMPI, "  MltplyMode: stored Hamiltonian needs %lf GB (max_mem=%lf GB, available %lf GB).\n",
+          MaxMPI_d(dmem), MaxMPI_d(X->Check.max_mem), dbudget);
+  if (X->Def.iMltplyMode == MLTPLY_AUTO
+      && MaxMPI_d(X->Check.max_mem + dmem) > dbudget) {
+    fprintf(stdoutMPI, "  MltplyMode: on-the-fly sweep is used.\n");
+    free(list_CSR_ptr);
+    list_CSR_ptr = NULL;
+    return 0;
+  }
+
+  ui_malloc1(list_CSR_idx, nnz + 1);
+  list_CSR_val = NULL;
+  list_CSR_val_r = NULL;
+  if (iReal == TRUE) {
+    d_malloc1(list_CSR_val_r, nnz + 1);
+    iflg = (list_CSR_idx != NULL && list_CSR_val_r != NULL);
+  }
+  else {
+    c_malloc1(list_CSR_val, nnz + 1);
+    iflg = (list_CSR_idx != NULL && list_CSR_val != NULL);
+  }
+  if (MaxMPI_li(1 - iflg) != 0) {
+    if (X->Large.iFlgMPIRow == TRUE) {
+      fprintf(stdoutMPI, "%s", cErrMPIRowCSR);
+      return -1;
+    }
+    fprintf(stdoutMPI, "  MltplyMode: stored Hamiltonian can not be allocated. On-the-fly sweep is used.\n");
+    free(list_CSR_ptr);
+    free(list_CSR_idx);
+    free(list_CSR_val);
+    free(list_CSR_val_r);
+    list_CSR_ptr = NULL;
+    list_CSR_idx = NULL;
+    list_CSR_val = NULL;
+    list_CSR_val_r = NULL;
+    return 0;
+  }
+  /*
+    Fill the elements
+  */
+#pragma omp parallel default(none) private(j, nelem, ielem, off, val) firstprivate(i_max, nterm, X) \
+shared(list_CSR_ptr, list_CSR_idx, list_CSR_val, list_CSR_val_r)
+  {
+    lui_malloc1(off, nterm + 1);
+    c_malloc1(val, nterm + 1);
+#pragma omp for
+    for (j = 1; j <= i_max; j++) {
+      nelem = mltply_fused_GetRow(X, j, off, val);
+      for (ielem = 0; ielem < nelem; ielem++) {
+        list_CSR_idx[list_CSR_ptr[j] + ielem] = (unsigned int)off[ielem];
+        if (list_CSR_val_r != NULL) list_CSR_val_r[list_CSR_ptr[j] + ielem] = creal(val[ielem]);
+        else list_CSR_val[list_CSR_ptr[j] + ielem] = val[ielem];
+      }
+    }
+    free(off);
+    free(val);
+  }
+
+  X->Large.nnz_CSR = nnz;
+  X->Large.iFlgCSR = TRUE;
+  fprintf(stdoutMPI, "  MltplyMode: stored Hamiltonian is used (%ld elements).\n", SumMPI_li(nnz));
+  if (X->Large.iFlgMPIRow == TRUE) return mltply_row_Init(X);
+  return 0;
+}
+
+/**
+ * @brief Multiply the diagonal and the stored intra-process part of the Hamiltonian:
+ * tmp_v0 = dscale*tmp_v0 + H_intra tmp_v1.
+ * Each thread owns a set of rows, so no atomic update is needed.
+ *
+ * @param X
+ * @param dscale factor applied to @p tmp_v0 before the product is added
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ */
+int mltply_csr(struct BindStruct *X, double dscale, double complex *tmp_v0, double complex *tmp_v1)
+{
+  long unsigned int i_max, j, ielem;
+  int iReal;
+  double complex dam_pr, dmv;
+
+  i_max = X->Large.i_max;
+  iReal = (list_CSR_val_r != NULL);
+  dam_pr = 0.0;
+
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(static) private(j, ielem, dmv) \
+firstprivate(i_max, iReal, dscale) shared(tmp_v0, tmp_v1, list_Diagonal, list_CSR_ptr, list_CSR_idx, list_CSR_val, list_CSR_val_r)
+  for (j = 1; j <= i_max; j++) {
+    dmv = list_Diagonal[j] * tmp_v1[j];
+    if (iReal == TRUE) {
+      for (ielem = list_CSR_ptr[j]; ielem < list_CSR_ptr[j + 1]; ielem++) {
+        dmv += list_CSR_val_r[ielem] * tmp_v1[list_CSR_idx[ielem]];
+      }
+    }
+    else {
+      for (ielem = list_CSR_ptr[j]; ielem < list_CSR_ptr[j + 1]; ielem++) {
+        dmv += list_CSR_val[ielem] * tmp_v1[list_CSR_idx[ielem]];
+      }
+    }
+    tmp_v0[j] = dscale * tmp_v0[j] + dmv;
+    dam_pr += conj(tmp_v1[j]) * dmv;
+  }
+
+  X->Large.prdct += dam_pr;
+  return 0;
+}
+
+/**
+ * @brief Real version of mltply_csr for real vectors.
+ * Only available when the elements are stored in list_CSR_val_r.
+ *
+ * @param X
+ * @param dscale factor applied to @p tmp_v0 before the product is added
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ * @retval -1 the elements are not real
+ */
+int mltply_csr_real(struct BindStruct *X, double dscale, double *tmp_v0, double *tmp_v1)
+{
+  long unsigned int i_max, j, ielem;
+  double dam_pr, dmv;
+
+  if (list_CSR_val_r == NULL) return -1;
+  i_max = X->Large.i_max;
+  dam_pr = 0.0;
+
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(static) private(j, ielem, dmv) \
+firstprivate(i_max, dscale) shared(tmp_v0, tmp_v1, list_Diagonal, list_CSR_ptr, list_CSR_idx, list_CSR_val_r)
+  for (j = 1; j <= i_max; j++) {
+    dmv = list_Diagonal[j] * tmp_v1[j];
+    for (ielem = list_CSR_ptr[j]; ielem < list_CSR_ptr[j + 1]; ielem++) {
+      dmv += list_CSR_val_r[ielem] * tmp_v1[list_CSR_idx[ielem]];
+    }
+    tmp_v0[j] = dscale * tmp_v0[j] + dmv;
+    dam_pr += tmp_v1[j] * dmv;
+  }
+
+  X->Large.prdct += dam_pr;
+  return 0;
+}
+
+/**
+ * @brief Block version of mltply_csr for @p nvec vectors stored interleaved,
+ * i.e. the component j of the vector l is at [j*nvec+l] (j=1,...,i_max).
+ *
+ * @param X
+ * @param nvec number of vectors
+ * @param tmp_v0 [in,out] result vectors
+ * @param tmp_v1 [in] input vectors
+ *
+ * @retval 0 normally finished
+ */
+int mltply_csr_block(struct BindStruct *X, int nvec, double complex *tmp_v0, double complex *tmp_v1)
+{
+  long unsigned int i_max, j, ielem, k, jk, offk;
+  int ivec, iReal;
+  double complex dam_pr, dmv;
+
+  i_max = X->Large.i_max;
+  iReal = (list_CSR_val_r != NULL);
+  k = nvec;
+  dam_pr = 0.0;
+
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(static) private(j, ielem, jk, offk, ivec, dmv) \
+firstprivate(i_max, k, nvec, iReal) shared(tmp_v0, tmp_v1, list_Diagonal, list_CSR_ptr, list_CSR_idx, list_CSR_val, list_CSR_val_r)
+  for (j = 1; j <= i_max; j++) {
+    jk = j * k;
+    for (ivec = 0; ivec < nvec; ivec++) {
+      dmv = list_Diagonal[j] * tmp_v1[jk + ivec];
+      tmp_v0[jk + ivec] += dmv;
+      dam_pr += conj(tmp_v1[jk + ivec]) * dmv;
+    }
+    for (ielem = list_CSR_ptr[j]; ielem < list_CSR_ptr[j + 1]; ielem++) {
+      offk = list_CSR_idx[ielem] * k;
+      for (ivec = 0; ivec < nvec; ivec++) {
+        if (iReal == TRUE) dmv = list_CSR_val_r[ielem] * tmp_v1[offk + ivec];
+        else dmv = list_CSR_val[ielem] * tmp_v1[offk + ivec];
+        tmp_v0[jk + ivec] += dmv;
+        dam_pr += conj(tmp_v1[jk + ivec]) * dmv;
+      }
+    }
+  }
+
+  X->Large.prdct += dam_pr;
+  return 0;
+}
@@ -0,0 +1,499 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+//
+// Dense blocks: the generalization of the Boost mode to any bond list of the
+// spin-1/2 Spin and SpinGC models. The intra-process terms of the operator
+// program (mltplyFused.c) are tiled into clusters of at most D_DenseNsite sites,
+// and the terms of each cluster are summed into a dense block.
+// The vector is multiplied by gathering the components of a cluster into columns
+// and calling zgemm for many columns at once (mltply_dense_Apply). In the
+// canonical Spin model each cluster is split into the sectors of its magnetization.
+// The diagonal part and inter-process terms are treated as in the termwise sweep.
+// The 64x64 blocks of the pivots of the Boost mode (mltplyMPIBoost.c) are
+// multiplied by the same mltply_dense_Apply.
+
+#include <bitcalc.h>
+#include "mfmemory.h"
+#include "mltply.h"
+#include "mltplyFused.h"
+#include "mltplyDense.h"
+#include "wrapperMPI.h"
+
+void zgemm_(char *TRANSA, char *TRANSB, int *M, int *N, int *K, double complex *ALPHA, double complex *matJL, int *LDA, double complex *arrayz, int *LDB, double complex *BETA, double complex *arrayx, int *LDC);
+
+static double complex **DenseArrayx = NULL; /**< [nthreads][D_DenseBlockSize] Gathered columns of a thread*/
+static double complex **DenseArrayy = NULL; /**< [nthreads][D_DenseBlockSize] Product of the block and the columns*/
+static long unsigned int **DenseIndex = NULL; /**< [nthreads][D_DenseBlockSize] Index of each gathered component*/
+
+/**
+ * @brief Local configuration of the cluster @p mask contained in the bits @p ibit.
+ *
+ * @param mask bits of the sites in the cluster
+ * @param ibit bit pattern
+ *
+ * @return local configuration: the k-th bit is the k-th lowest site of the cluster
+ */
+static long unsigned int mltply_dense_Extract(long unsigned int mask, long unsigned int ibit)
+{
+  long unsigned int iloc = 0, k = 0;
+  while (mask != 0) {
+    if ((ibit & mask & (~mask + 1)) != 0) iloc |= 1ul << k;
+    mask &= mask - 1;
+    k++;
+  }
+  return iloc;
+}
+
+/**
+ * @brief Bits of the local configuration @p iloc of the cluster @p mask (inverse of mltply_dense_Extract).
+ */
+static long unsigned int mltply_dense_Deposit(long unsigned int mask, long unsigned int iloc)
+{
+  long unsigned int ibit = 0, k = 0;
+  while (mask != 0) {
+    if (((iloc >> k) & 1) != 0) ibit |= mask & (~mask + 1);
+    mask &= mask - 1;
+    k++;
+  }
+  return ibit;
+}
+
+/**
+ * @brief Get the index of the state from its bit pattern.
+ *
+ * @param ibit bit pattern
+ * @param iGC TRUE for SpinGC (index = bit pattern + 1)
+ *
+ * @return index of the state (1 origin)
+ */
+static inline long unsigned int mltply_dense_Index(
+  long unsigned int ibit,
+  int iGC,
+  long unsigned int irght,
+  long unsigned int ilft,
+  long unsigned int ihfbit
+  )
+{
+  long unsigned int off;
+  if (iGC == TRUE) return ibit + 1;
+  GetOffComp(list_2_1, list_2_2, ibit, irght, ilft, ihfbit, &off);
+  return off;
+}
+
+/**
+ * @brief Free the dense blocks.
+ *
+ * @param blk dense blocks
+ * @param nblk number of the blocks
+ */
+static void mltply_dense_Free(struct DenseBlock *blk, long unsigned int nblk)
+{
+  long unsigned int iblk;
+  for (iblk = 0; iblk < nblk; iblk++) {
+    free(blk[iblk].bit);
+    free(blk[iblk].mat);
+  }
+  free(blk);
+}
+
+/**
+ * @brief Allocate the work arrays of the threads for the whole run (only at the first call).
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+static int mltply_dense_Alloc(void)
+{
+  int ithread, iflg;
+
+  if (DenseArrayx != NULL) return 0;
+  DenseArrayx = (double complex **)malloc(sizeof(double complex *) * nthreads);
+  DenseArrayy = (double complex **)malloc(sizeof(double complex *) * nthreads);
+  DenseIndex = (long unsigned int **)malloc(sizeof(long unsigned int *) * nthreads);
+  if (DenseArrayx == NULL || DenseArrayy == NULL || DenseIndex == NULL) return -1;
+  iflg = TRUE;
+  for (ithread = 0; ithread < nthreads; ithread++) {
+    c_malloc1(DenseArrayx[ithread], D_DenseBlockSize);
+    c_malloc1(DenseArrayy[ithread], D_DenseBlockSize);
+    lui_malloc1(DenseIndex[ithread], D_DenseBlockSize);
+    if (DenseArrayx[ithread] == NULL || DenseArrayy[ithread] == NULL || DenseIndex[ithread] == NULL) iflg = FALSE;
+  }
+  return (iflg == TRUE) ? 0 : -1;
+}
+
+/**
+ * @brief Make a block over all the local configurations of the sites @p mask,
+ * ordered as mltply_dense_Extract, and allocate its matrix (filled by the caller).
+ * The work arrays are allocated at the first call.
+ *
+ * @param mask bits of the sites (at most D_DenseNsite)
+ * @param blk [out] block
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_dense_SetBlock(long unsigned int mask, struct DenseBlock *blk)
+{
+  long unsigned int iloc;
+
+  blk->mask = mask;
+  blk->dim = 1ul << PopCountBit(mask);
+  blk->bit = (long unsigned int *)malloc(sizeof(long unsigned int) * blk->dim);
+  blk->mat = (double complex *)malloc(sizeof(double complex) * blk->dim * blk->dim);
+  if (blk->bit == NULL || blk->mat == NULL) return -1;
+  for (iloc = 0; iloc < blk->dim; iloc++) blk->bit[iloc] = mltply_dense_Deposit(mask, iloc);
+  blk->first = blk->bit[0];
+  return mltply_dense_Alloc();
+}
+
+/**
+ * @brief Tile the pattern terms of the operator program into clusters of at most
+ * D_DenseNsite sites. A term joins the cluster sharing the most sites with it
+ * among those which have room for it, or starts a new cluster.
+ *
+ * @param term terms of the operator program
+ * @param nterm number of the terms
+ * @param clmask [out] bits of the sites of each cluster
+ * @param icluster [out] cluster of each term
+ *
+ * @return number of the clusters
+ */
+static long unsigned int mltply_dense_Tile(
+  struct FusedTerm *term,
+  long unsigned int nterm,
+  long unsigned int *clmask,
+  long unsigned int *icluster
+  )
+{
+  long unsigned int iterm, icl, jcl, ncl, isite;
+  int iscore, jscore;
+
+  ncl = 0;
+  for (iterm = 0; iterm < nterm; iterm++) {
+    isite = term[iterm].mask | term[iterm].flip;
+    jcl = ncl;
+    jscore = -1;
+    for (icl = 0; icl < ncl; icl++) {
+      if (PopCountBit(clmask[icl] | isite) > D_DenseNsite) continue;
+      iscore = PopCountBit(clmask[icl] & isite);
+      if (iscore > jscore) {
+        jscore = iscore;
+        jcl = icl;
+      }
+    }
+    if (jcl == ncl) {
+      clmask[ncl] = 0;
+      ncl++;
+    }
+    clmask[jcl] |= isite;
+    icluster[iterm] = jcl;
+  }
+  return ncl;
+}
+
+/**
+ * @brief Sum the terms of the cluster @p icl into the dense block of one sector.
+ *
+ * @param term terms of the operator program
+ * @param nterm number of the terms
+ * @param icluster cluster of each term
+ * @param icl index of the cluster
+ * @param ipos [in] position of each local configuration in the sector (nconf if outside)
+ * @param nconf number of the local configurations of the cluster
+ * @param blk [in,out] block; mask, dim and bit are given, mat is filled
+ *
+ * @retval TRUE normally finished
+ * @retval FALSE a term connects the sector with another one
+ */
+static int mltply_dense_Block(
+  struct FusedTerm *term,
+  long unsigned int nterm,
+  long unsigned int *icluster,
+  long unsigned int icl,
+  long unsigned int *ipos,
+  long unsigned int nconf,
+  struct DenseBlock *blk
+  )
+{
+  long unsigned int iterm, idim, iloc, jloc, flip;
+
+  for (idim = 0; idim < blk->dim * blk->dim; idim++) blk->mat[idim] = 0.0;
+  for (iterm = 0; iterm < nterm; iterm++) {
+    if (icluster[iterm] != icl) continue;
+    flip = mltply_dense_Extract(blk->mask, term[iterm].flip);
+    for (idim = 0; idim < blk->dim; idim++) {
+      if ((blk->bit[idim] & term[iterm].mask) != term[iterm].pattern) continue;
+      iloc = mltply_dense_Extract(blk->mask, blk->bit[idim]);
+      jloc = iloc ^ flip;
+      if (ipos[jloc] == nconf) return FALSE;
+      blk->mat[idim + blk->dim * ipos[jloc]] += term[iterm].coef;
+    }
+  }
+  return TRUE;
+}
+
+/**
+ * @brief Tile the intra-process terms into dense blocks (MltplyMode=4)
+ * and allocate the work arrays for the whole run.
+ * Must be called after mltply_fused_Init. The operator program is replaced by the blocks.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished (X->Large.iFlgDense is FALSE when the blocks are not used)
+ * @retval -1 unnormally finished
+ */
+int mltply_dense_Init(struct BindStruct *X)
+{
+  long unsigned int nterm, ncl, icl, nsite, nconf, iloc, nblk, idim, dim;
+  long unsigned int *clmask, *icluster, *ipos;
+  int q, qmax, iGC, iflg;
+  struct DenseBlock *blk;
+
+  X->Large.iFlgDense = FALSE;
+  X->Large.NDenseBlock = 0;
+  X->Large.DenseBlock = NULL;
+  if (X->Def.iMltplyMode != MLTPLY_DENSE) return 0;
+  if (X->Large.iFlgFused == FALSE ||
+      (X->Def.iCalcModel != Spin && X->Def.iCalcModel != SpinGC) ||
+      X->Large.NFusedPattern != X->Large.NFusedTerm) {
+    fprintf(stdoutMPI, "  MltplyMode: dense blocks are not available for this model. %s sweep is used.\n",
+            (X->Large.iFlgFused == TRUE) ? "Fused" : "Termwise");
+    return 0;
+  }
+  iGC = (X->Def.iCalcModel == SpinGC);
+  nterm = X->Large.NFusedTerm;
+
+  clmask = (long unsigned int *)malloc(sizeof(long unsigned int) * (nterm + 1));
+  icluster = (long unsigned int *)malloc(sizeof(long unsigned int) * (nterm + 1));
+  lui_malloc1(ipos, 1ul << D_DenseNsite);
+  ncl = mltply_dense_Tile(X->Large.FusedTerm, nterm, clmask, icluster);
+  /*
+    One block per cluster in SpinGC, one block per magnetization of the cluster in Spin
+  */
+  blk = (struct DenseBlock *)malloc(sizeof(struct DenseBlock) * (ncl * (D_DenseNsite + 1) + 1));
+  nblk = 0;
+  iflg = TRUE;
+  for (icl = 0; icl < ncl && iflg == TRUE; icl++) {
+    nsite = PopCountBit(clmask[icl]);
+    nconf = 1ul << nsite;
+    qmax = (iGC == TRUE) ? 0 : (int)nsite;
+    for (q = 0; q <= qmax && iflg == TRUE; q++) {
+      dim = 0;
+      for (iloc = 0; iloc < nconf; iloc++) {
+        if (iGC == TRUE || PopCountBit(iloc) == q) ipos[iloc] = dim++;
+        else ipos[iloc] = nconf;
+      }
+      blk[nblk].mask = clmask[icl];
+      blk[nblk].dim = dim;
+      blk[nblk].bit = (long unsigned int *)malloc(sizeof(long unsigned int) * dim);
+      blk[nblk].mat = (double complex *)malloc(sizeof(double complex) * dim * dim);
+      for (iloc = 0; iloc < nconf; iloc++) {
+        if (ipos[iloc] != nconf) blk[nblk].bit[ipos[iloc]] = mltply_dense_Deposit(clmask[icl], iloc);
+      }
+      blk[nblk].first = blk[nblk].bit[0];
+      iflg = mltply_dense_Block(X->Large.FusedTerm, nterm, icluster, icl, ipos, nconf, &blk[nblk]);
+      nblk++;
+      /*Drop the sectors without any off-diagonal element*/
+      for (idim = 0; idim < dim * dim; idim++) {
+        if (blk[nblk - 1].mat[idim] != 0.0) break;
+      }
+      if (idim == dim * dim && iflg == TRUE) {
+        nblk--;
+        free(blk[nblk].bit);
+        free(blk[nblk].mat);
+      }
+    }
+  }
+  free(clmask);
+  free(icluster);
+  free(ipos);
+  if (iflg == FALSE) {
+    fprintf(stdoutMPI, "  MltplyMode: dense blocks are not available for these terms. Fused sweep is used.\n");
+    mltply_dense_Free(blk, nblk);
+    return 0;
+  }
+
+  if (mltply_dense_Alloc() != 0) {
+    mltply_dense_Free(blk, nblk);
+    return -1;
+  }
+
+  /*The blocks replace the operator program*/
+  free(X->Large.FusedTerm);
+  X->Large.FusedTerm = NULL;
+  X->Large.NFusedTerm = 0;
+  X->Large.NFusedPattern = 0;
+  X->Large.iFlgFused = FALSE;
+  X->Large.DenseBlock = blk;
+  X->Large.NDenseBlock = nblk;
+  X->Large.iFlgDense = TRUE;
+  fprintf(stdoutMPI, "  MltplyMode: %ld terms are tiled into %ld clusters of at most %d sites (%ld dense blocks).\n",
+          nterm, ncl, D_DenseNsite, nblk);
+  return 0;
+}
+
+/**
+ * @brief Multiply the block to the gathered columns and add the result to @p tmp_v0.
+ *
+ * @param dim dimension of the block
+ * @param ncol number of the columns
+ * @param mat block
+ * @param arrayx [in] gathered columns
+ * @param arrayy [out] work array for the product
+ * @param index index of each gathered component
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @return contribution to <tmp_v1|H|tmp_v1>
+ */
+static double complex mltply_dense_Flush(
+  long unsigned int dim,
+  long unsigned int ncol,
+  double complex *mat,
+  double complex *arrayx,
+  double complex *arrayy,
+  long unsigned int *index,
+  double complex *tmp_v0,
+  double complex *tmp_v1
+  )
+{
+  char TRANSA, TRANSB;
+  int M, N, K, LDA, LDB, LDC;
+  double complex ALPHA, BETA, dam_pr;
+  long unsigned int ielem, off;
+
+  TRANSA = 'N';
+  TRANSB = 'N';
+  M = (int)dim;
+  N = (int)ncol;
+  K = (int)dim;
+  ALPHA = 1.0;
+  LDA = (int)dim;
+  LDB = (int)dim;
+  BETA = 0.0;
+  LDC = (int)dim;
+  zgemm_(&TRANSA, &TRANSB, &M, &N, &K, &ALPHA, mat, &LDA, arrayx, &LDB, &BETA, arrayy, &LDC);
+
+  dam_pr = 0.0;
+  for (ielem = 0; ielem < dim * ncol; ielem++) {
+    off = index[ielem];
+    tmp_v0[off] += arrayy[ielem];
+    dam_pr += conj(tmp_v1[off]) * arrayy[ielem];
+  }
+  return dam_pr;
+}
+
+/**
+ * @brief Multiply a dense block: tmp_v0 += B tmp_v1, where B acts on the sites of the block
+ * and the other sites are unchanged. Every state belongs to exactly one column of the block,
+ * so that the threads write to different components and no atomic update is needed.
+ *
+ * @param X
+ * @param blk block
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @return <tmp_v1|B|tmp_v1>
+ */
+double complex mltply_dense_Apply(
+  struct BindStruct *X,
+  struct DenseBlock *blk,
+  double complex *tmp_v0,
+  double complex *tmp_v1
+  )
+{
+  long unsigned int i_max, irght, ilft, ihfbit, nchunk, ichunk, j, jend, ibit;
+  long unsigned int mask, first, dim, ncol, icol, idim, off;
+  long unsigned int *bit, *index;
+  int iGC;
+  double complex dam_pr;
+  double complex *mat, *arrayx, *arrayy;
+
+  i_max = X->Large.i_max;
+  irght = X->Large.irght;
+  ilft = X->Large.ilft;
+  ihfbit = X->Large.ihfbit;
+  iGC = (X->Def.iCalcModel == SpinGC);
+  nchunk = (i_max + D_DenseChunk - 1) / D_DenseChunk;
+  mask = blk->mask;
+  first = blk->first;
+  dim = blk->dim;
+  bit = blk->bit;
+  mat = blk->mat;
+  ncol = D_DenseBlockSize / dim;
+  dam_pr = 0.0;
+
+#pragma omp parallel default(none) reduction(+:dam_pr) \
+private(ichunk, j, jend, ibit, icol, idim, off, arrayx, arrayy, index) \
+firstprivate(i_max, nchunk, mask, first, dim, ncol, bit, mat, iGC, irght, ilft, ihfbit) \
+shared(tmp_v0, tmp_v1, list_1, DenseArrayx, DenseArrayy, DenseIndex)
+  {
+    arrayx = DenseArrayx[omp_get_thread_num()];
+    arrayy = DenseArrayy[omp_get_thread_num()];
+    index = DenseIndex[omp_get_thread_num()];
+    icol = 0;
+#pragma omp for schedule(static)
+    for (ichunk = 0; ichunk < nchunk; ichunk++) {
+      jend = (ichunk + 1) * D_DenseChunk;
+      if (jend > i_max) jend = i_max;
+      for (j = ichunk * D_DenseChunk + 1; j <= jend; j++) {
+        ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+        if ((ibit & mask) != first) continue;
+        /*Gather the column made of the configurations of the cluster with the other bits of ibit*/
+        ibit ^= first;
+        for (idim = 0; idim < dim; idim++) {
+          off = mltply_dense_Index(ibit | bit[idim], iGC, irght, ilft, ihfbit);
+          index[icol * dim + idim] = off;
+          arrayx[icol * dim + idim] = tmp_v1[off];
+        }
+        icol++;
+        if (icol == ncol) {
+          dam_pr += mltply_dense_Flush(dim, icol, mat, arrayx, arrayy, index, tmp_v0, tmp_v1);
+          icol = 0;
+        }
+      }
+    }
+    if (icol > 0) dam_pr += mltply_dense_Flush(dim, icol, mat, arrayx, arrayy, index, tmp_v0, tmp_v1);
+  }
+  return dam_pr;
+}
+
+/**
+ * @brief Multiply the intra-process off-diagonal terms by the dense blocks:
+ * tmp_v0 += H_intra tmp_v1.
+ * X->Large.prdct is incremented by <tmp_v1|H_intra|tmp_v1>.
+ *
+ * @param X
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ */
+int mltply_dense(struct BindStruct *X, double complex *tmp_v0, double complex *tmp_v1)
+{
+  long unsigned int iblk;
+  double complex dam_pr;
+
+  dam_pr = 0.0;
+  for (iblk = 0; iblk < X->Large.NDenseBlock; iblk++) {
+    dam_pr += mltply_dense_Apply(X, &X->Large.DenseBlock[iblk], tmp_v0, tmp_v1);
+  }
+  X->Large.prdct += dam_pr;
+  return 0;
+}
@@ -0,0 +1,932 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+//
+// Fused sweep: all intra-process terms (and the diagonal part) are applied
+// to one block of the output vector before the next block is touched.
+// Each term is stored in its adjoint (row-oriented) form, so that a thread
+// only writes to the rows of its own block and no atomic update is needed.
+// Inter-process terms are left to the termwise routines in mltplyMPI.c.
+
+#include <bitcalc.h>
+#include "mfmemory.h"
+#include "mltply.h"
+#include "mltplyMPI.h"
+#include "mltplyFused.h"
+#include "TransSym.h"
+#include "wrapperMPI.h"
+
+/**
+ * @brief Get the bits between two fermion operators for the fermion sign.
+ * Same convention as child_general_hopp_GetInfo.
+ *
+ * @param X
+ * @param isite1 site index of the creation operator (1 origin)
+ * @param isite2 site index of the annihilation operator (1 origin)
+ * @param sigma1 spin index of the creation operator
+ * @param sigma2 spin index of the annihilation operator
+ *
+ * @return bits between two operators
+ */
+long unsigned int mltply_fused_GetDiff(
+  struct BindStruct *X,
+  long unsigned int isite1,
+  long unsigned int isite2,
+  long unsigned int sigma1,
+  long unsigned int sigma2
+  )
+{
+  if (isite1 > isite2 || (isite1 == isite2 && sigma1 > sigma2)) {
+    return X->Def.Tpow[2 * isite1 - 2 + sigma1] - X->Def.Tpow[2 * isite2 - 1 + sigma2];
+  }
+  else if (isite1 < isite2 || sigma1 < sigma2) {
+    return X->Def.Tpow[2 * isite2 - 2 + sigma2] - X->Def.Tpow[2 * isite1 - 1 + sigma1];
+  }
+  return 0;
+}
+
+/**
+ * @brief Store c^+_{1} c_{2} c^+_{3} c_{4} (c_{4} acts first) in the adjoint form.
+ * When isite3 == 0, only c^+_{1} c_{2} is stored.
+ *
+ * @param X
+ * @param term [out] term in the adjoint form
+ * @param isite1 site indices (1 origin) and spins of the four operators
+ * @param coef matrix element of the term
+ */
+void mltply_fused_SetFermion(
+  struct BindStruct *X,
+  struct FusedTerm *term,
+  long unsigned int isite1, long unsigned int sigma1,
+  long unsigned int isite2, long unsigned int sigma2,
+  long unsigned int isite3, long unsigned int sigma3,
+  long unsigned int isite4, long unsigned int sigma4,
+  double complex coef
+  )
+{
+  /* (c^+_1 c_2 c^+_3 c_4)^+ = c^+_4 c_3 c^+_2 c_1: c^+_2 c_1 acts first.*/
+  term->itype = FUSED_FERMION;
+  term->isA_cr = X->Def.Tpow[2 * isite2 - 2 + sigma2];
+  term->isA_an = X->Def.Tpow[2 * isite1 - 2 + sigma1];
+  term->A_diff = mltply_fused_GetDiff(X, isite1, isite2, sigma1, sigma2);
+  if (isite3 == 0) {
+    term->isB_cr = 0;
+    term->isB_an = 0;
+    term->B_diff = 0;
+  }
+  else {
+    term->isB_cr = X->Def.Tpow[2 * isite4 - 2 + sigma4];
+    term->isB_an = X->Def.Tpow[2 * isite3 - 2 + sigma3];
+    term->B_diff = mltply_fused_GetDiff(X, isite3, isite4, sigma3, sigma4);
+  }
+  term->mask = 0;
+  term->pattern = 0;
+  term->flip = 0;
+  term->coef = coef;
+}
+
+/**
+ * @brief Store the term flipping @p flip when the bits in @p mask are @p pattern,
+ * in the adjoint form.
+ *
+ * @param term [out] term in the adjoint form
+ * @param mask bits to be checked
+ * @param pattern required value of the masked bits
+ * @param flip bits to be flipped
+ * @param coef matrix element of the term
+ */
+void mltply_fused_SetPattern(
+  struct FusedTerm *term,
+  long unsigned int mask,
+  long unsigned int pattern,
+  long unsigned int flip,
+  double complex coef
+  )
+{
+  term->itype = FUSED_PATTERN;
+  term->isA_cr = 0;
+  term->isA_an = 0;
+  term->A_diff = 0;
+  term->isB_cr = 0;
+  term->isB_an = 0;
+  term->B_diff = 0;
+  term->mask = mask;
+  term->pattern = pattern ^ flip;
+  term->flip = flip;
+  term->coef = coef;
+}
+
+/**
+ * @brief Make the list of intra-process off-diagonal terms for the fused sweep.
+ *
+ * @param X
+ * @param term [out] list of terms
+ * @param nterm [out] number of terms
+ *
+ * @retval TRUE all intra-process terms are stored.
+ * @retval FALSE the fused sweep is not available for this Hamiltonian.
+ */
+int mltply_fused_SetTerm(
+  struct BindStruct *X,
+  struct FusedTerm *term,
+  long unsigned int *nterm
+  )
+{
+  long unsigned int i, idx, n;
+  long unsigned int isite1, isite2, isite3, isite4;
+  long unsigned int sigma1, sigma2, sigma3, sigma4;
+  long unsigned int is1_up, is1_down, is2_up, is2_down, isA_up, isB_up;
+  int ihermite;
+
+  n = 0;
+  switch (X->Def.iCalcModel) {
+  case HubbardGC:
+  case KondoGC:
+  case Hubbard:
+  case Kondo:
+    //Transfer
+    for (i = 0; i < X->Def.EDNTransfer; i += 2) {
+      if (X->Def.EDGeneralTransfer[i][0] + 1 > X->Def.Nsite ||
+          X->Def.EDGeneralTransfer[i][2] + 1 > X->Def.Nsite) continue;
+      for (ihermite = 0; ihermite < 2; ihermite++) {
+        idx = i + ihermite;
+        isite1 = X->Def.EDGeneralTransfer[idx][0] + 1;
+        isite2 = X->Def.EDGeneralTransfer[idx][2] + 1;
+        sigma1 = X->Def.EDGeneralTransfer[idx][1];
+        sigma2 = X->Def.EDGeneralTransfer[idx][3];
+        if (X->Def.iCalcModel != HubbardGC && isite1 == isite2 && sigma1 == sigma2) continue;
+        mltply_fused_SetFermion(X, &term[n], isite1, sigma1, isite2, sigma2, 0, 0, 0, 0,
+                                -X->Def.EDParaGeneralTransfer[idx]);
+        n++;
+      }
+    }
+    //InterAll
+    for (i = 0; i < X->Def.NInterAll_OffDiagonal; i += 2) {
+      if (CheckPE(X->Def.InterAll_OffDiagonal[i][0], X) == TRUE ||
+          CheckPE(X->Def.InterAll_OffDiagonal[i][2], X) == TRUE ||
+          CheckPE(X->Def.InterAll_OffDiagonal[i][4], X) == TRUE ||
+          CheckPE(X->Def.InterAll_OffDiagonal[i][6], X) == TRUE) continue;
+      for (ihermite = 0; ihermite < 2; ihermite++) {
+        idx = i + ihermite;
+        isite1 = X->Def.InterAll_OffDiagonal[idx][0] + 1;
+        isite2 = X->Def.InterAll_OffDiagonal[idx][2] + 1;
+        isite3 = X->Def.InterAll_OffDiagonal[idx][4] + 1;
+        isite4 = X->Def.InterAll_OffDiagonal[idx][6] + 1;
+        sigma1 = X->Def.InterAll_OffDiagonal[idx][1];
+        sigma2 = X->Def.InterAll_OffDiagonal[idx][3];
+        sigma3 = X->Def.InterAll_OffDiagonal[idx][5];
+        sigma4 = X->Def.InterAll_OffDiagonal[idx][7];
+        mltply_fused_SetFermion(X, &term[n], isite1, sigma1, isite2, sigma2,
+                                isite3, sigma3, isite4, sigma4,
+                                X->Def.ParaInterAll_OffDiagonal[idx]);
+        n++;
+      }
+    }
+    //Pair hopping
+    for (i = 0; i < X->Def.NPairHopping; i += 2) {
+      if (X->Def.PairHopping[i][0] + 1 > X->Def.Nsite ||
+          X->Def.PairHopping[i][1] + 1 > X->Def.Nsite) continue;
+      for (ihermite = 0; ihermite < 2; ihermite++) {
+        idx = i + ihermite;
+        isite1 = X->Def.PairHopping[idx][0] + 1;
+        isite2 = X->Def.PairHopping[idx][1] + 1;
+        is1_up = X->Def.Tpow[2 * isite1 - 2];
+        is1_down = X->Def.Tpow[2 * isite1 - 1];
+        is2_up = X->Def.Tpow[2 * isite2 - 2];
+        is2_down = X->Def.Tpow[2 * isite2 - 1];
+        mltply_fused_SetPattern(&term[n], is1_up + is1_down + is2_up + is2_down,
+                                is2_up + is2_down, is1_up + is1_down + is2_up + is2_down,
+                                X->Def.ParaPairHopping[idx]);
+        n++;
+      }
+    }
+    //Exchange
+    for (i = 0; i < X->Def.NExchangeCoupling; i++) {
+      if (X->Def.ExchangeCoupling[i][0] + 1 > X->Def.Nsite ||
+          X->Def.ExchangeCoupling[i][1] + 1 > X->Def.Nsite) continue;
+      isite1 = X->Def.ExchangeCoupling[i][0] + 1;
+      isite2 = X->Def.ExchangeCoupling[i][1] + 1;
+      is1_up = X->Def.Tpow[2 * isite1 - 2];
+      is1_down = X->Def.Tpow[2 * isite1 - 1];
+      is2_up = X->Def.Tpow[2 * isite2 - 2];
+      is2_down = X->Def.Tpow[2 * isite2 - 1];
+      mltply_fused_SetPattern(&term[n], is1_up + is1_down + is2_up + is2_down,
+                              is1_down + is2_up, is1_up + is1_down + is2_up + is2_down,
+                              -X->Def.ParaExchangeCoupling[i]);
+      n++;
+      mltply_fused_SetPattern(&term[n], is1_up + is1_down + is2_up + is2_down,
+                              is1_up + is2_down, is1_up + is1_down + is2_up + is2_down,
+                              -X->Def.ParaExchangeCoupling[i]);
+      n++;
+    }
+    break;
+
+  case Spin:
+  case SpinGC:
+    //Transfer (only the transverse magnetic field in SpinGC)
+    for (i = 0; i < X->Def.EDNTransfer && X->Def.iCalcModel == SpinGC; i += 2) {
+      if (X->Def.EDGeneralTransfer[i][0] + 1 > X->Def.Nsite) continue;
+      for (ihermite = 0; ihermite < 2; ihermite++) {
+        idx = i + ihermite;
+        isite1 = X->Def.EDGeneralTransfer[idx][0] + 1;
+        sigma1 = X->Def.EDGeneralTransfer[idx][1];
+        sigma2 = X->Def.EDGeneralTransfer[idx][3];
+        if (sigma1 == sigma2) return FALSE;
+        isA_up = X->Def.Tpow[isite1 - 1];
+        mltply_fused_SetPattern(&term[n], isA_up, isA_up * sigma2, isA_up,
+                                -X->Def.EDParaGeneralTransfer[idx]);
+        n++;
+      }
+    }
+    //InterAll
+    for (i = 0; i < X->Def.NInterAll_OffDiagonal; i += 2) {
+      if (X->Def.InterAll_OffDiagonal[i][0] + 1 > X->Def.Nsite ||
+          X->Def.InterAll_OffDiagonal[i][4] + 1 > X->Def.Nsite) continue;
+      for (ihermite = 0; ihermite < 2; ihermite++) {
+        idx = i + ihermite;
+        isite1 = X->Def.InterAll_OffDiagonal[idx][0] + 1;
+        isite2 = X->Def.InterAll_OffDiagonal[idx][4] + 1;
+        sigma1 = X->Def.InterAll_OffDiagonal[idx][1];
+        sigma2 = X->Def.InterAll_OffDiagonal[idx][3];
+        sigma3 = X->Def.InterAll_OffDiagonal[idx][5];
+        sigma4 = X->Def.InterAll_OffDiagonal[idx][7];
+        if (isite1 == isite2) return FALSE;
+        isA_up = X->Def.Tpow[isite1 - 1];
+        isB_up = X->Def.Tpow[isite2 - 1];
+        if (X->Def.iCalcModel == Spin) {
+          mltply_fused_SetPattern(&term[n], isA_up + isB_up, isA_up * sigma2 + isB_up * sigma4,
+                                  isA_up + isB_up, X->Def.ParaInterAll_OffDiagonal[idx]);
+        }
+        else {
+          mltply_fused_SetPattern(&term[n], isA_up + isB_up, isA_up * sigma2 + isB_up * sigma4,
+                                  isA_up * (sigma1 != sigma2) + isB_up * (sigma3 != sigma4),
+                                  X->Def.ParaInterAll_OffDiagonal[idx]);
+        }
+        n++;
+      }
+    }
+    //Exchange
+    for (i = 0; i < X->Def.NExchangeCoupling; i++) {
+      if (X->Def.ExchangeCoupling[i][0] + 1 > X->Def.Nsite ||
+          X->Def.ExchangeCoupling[i][1] + 1 > X->Def.Nsite) continue;
+      isA_up = X->Def.Tpow[X->Def.ExchangeCoupling[i][0]];
+      isB_up = X->Def.Tpow[X->Def.ExchangeCoupling[i][1]];
+      if (isA_up == isB_up) return FALSE;
+      mltply_fused_SetPattern(&term[n], isA_up + isB_up, isA_up, isA_up + isB_up,
+                              X->Def.ParaExchangeCoupling[i]);
+      n++;
+      mltply_fused_SetPattern(&term[n], isA_up + isB_up, isB_up, isA_up + isB_up,
+                              X->Def.ParaExchangeCoupling[i]);
+      n++;
+    }
+    //PairLift
+    for (i = 0; i < X->Def.NPairLiftCoupling && X->Def.iCalcModel == SpinGC; i++) {
+      if (X->Def.PairLiftCoupling[i][0] + 1 > X->Def.Nsite ||
+          X->Def.PairLiftCoupling[i][1] + 1 > X->Def.Nsite) continue;
+      isA_up = X->Def.Tpow[X->Def.PairLiftCoupling[i][0]];
+      isB_up = X->Def.Tpow[X->Def.PairLiftCoupling[i][1]];
+      if (isA_up == isB_up) return FALSE;
+      mltply_fused_SetPattern(&term[n], isA_up + isB_up, 0, isA_up + isB_up,
+                              X->Def.ParaPairLiftCoupling[i]);
+      n++;
+      mltply_fused_SetPattern(&term[n], isA_up + isB_up, isA_up + isB_up, isA_up + isB_up,
+                              X->Def.ParaPairLiftCoupling[i]);
+      n++;
+    }
+    break;
+
+  default:
+    return FALSE;
+  }
+
+  *nterm = n;
+  return TRUE;
+}
+
+/**
+ * @brief Compile the intra-process off-diagonal terms into the operator program
+ * X->Large.FusedTerm. Pattern terms are placed before fermion terms so that
+ * each kernel loop has a single code path.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished (X->Large.iFlgFused is FALSE when the termwise sweep is used)
+ * @retval -1 unnormally finished
+ */
+int mltply_fused_Init(struct BindStruct *X)
+{
+  long unsigned int nterm, iterm, npattern;
+  struct FusedTerm *term, tmp_term;
+
+  X->Large.iFlgFused = FALSE;
+  X->Large.NFusedTerm = 0;
+  X->Large.NFusedPattern = 0;
+  X->Large.iFlgRealCoef = FALSE;
+  X->Large.FusedTerm = NULL;
+  if (X->Def.iMltplyMode == MLTPLY_TERMWISE) return 0;
+  if (X->Def.iFlgGeneralSpin == TRUE || X->Boost.flgBoost == 1) {
+    fprintf(stdoutMPI, "  MltplyMode: fused sweep is not available for this model. Termwise sweep is used.\n");
+    return 0;
+  }
+
+  nterm = 2 * (X->Def.EDNTransfer + X->Def.NExchangeCoupling + X->Def.NPairLiftCoupling)
+    + X->Def.NInterAll_OffDiagonal + X->Def.NPairHopping;
+  term = (struct FusedTerm *)malloc(sizeof(struct FusedTerm) * (nterm + 1));
+  if (term == NULL) return -1;
+  if (mltply_fused_SetTerm(X, term, &nterm) == FALSE) {
+    free(term);
+    /*The symmetrized basis has no termwise sweep*/
+    if (X->Large.NTransSymOp > 0) {
+      fprintf(stdoutMPI, "%s", cErrTransSymFused);
+      return -1;
+    }
+    fprintf(stdoutMPI, "  MltplyMode: fused sweep is not available for these terms. Termwise sweep is used.\n");
+    return 0;
+  }
+
+  npattern = 0;
+  for (iterm = 0; iterm < nterm; iterm++) {
+    if (term[iterm].itype != FUSED_PATTERN) continue;
+    tmp_term = term[iterm];
+    term[iterm] = term[npattern];
+    term[npattern] = tmp_term;
+    npattern++;
+  }
+
+  /*Real coefficients are multiplied without complex arithmetic*/
+  X->Large.iFlgRealCoef = TRUE;
+  for (iterm = 0; iterm < nterm; iterm++) {
+    if (cimag(term[iterm].coef) != 0.0) X->Large.iFlgRealCoef = FALSE;
+  }
+
+  X->Large.FusedTerm = term;
+  X->Large.NFusedTerm = nterm;
+  X->Large.NFusedPattern = npattern;
+  X->Large.iFlgFused = TRUE;
+  return 0;
+}
+
+/**
+ * @brief Apply a fermion term in the adjoint form to a bit pattern.
+ *
+ * @param term term in the adjoint form
+ * @param ibit [in,out] bit pattern of the row state / the column state
+ *
+ * @return fermion sign of the matrix element (0 if the term vanishes)
+ */
+static inline int mltply_fused_Fermion(
+  const struct FusedTerm *term,
+  long unsigned int *ibit
+  )
+{
+  int sgn, tmp_sgn;
+  long unsigned int jbit;
+
+  jbit = *ibit;
+  sgn = 1;
+  if (term->isA_cr == term->isA_an) {
+    if ((jbit & term->isA_an) == 0) return 0;
+  }
+  else {
+    if ((jbit & term->isA_cr) != 0 || (jbit & term->isA_an) == 0) return 0;
+    SgnBit(jbit & term->A_diff, &tmp_sgn);
+    sgn *= tmp_sgn;
+    jbit ^= term->isA_cr + term->isA_an;
+  }
+  if (term->isB_an != 0) {
+    if (term->isB_cr == term->isB_an) {
+      if ((jbit & term->isB_an) == 0) return 0;
+    }
+    else {
+      if ((jbit & term->isB_cr) != 0 || (jbit & term->isB_an) == 0) return 0;
+      SgnBit(jbit & term->B_diff, &tmp_sgn);
+      sgn *= tmp_sgn;
+      jbit ^= term->isB_cr + term->isB_an;
+    }
+  }
+  *ibit = jbit;
+  return sgn;
+}
+
+/**
+ * @brief Get the index of the state from its bit pattern.
+ *
+ * @param ibit bit pattern
+ * @param iGC TRUE for grand canonical models (index = bit pattern + 1)
+ *
+ * @return index of the state (1 origin)
+ */
+static inline long unsigned int mltply_fused_Index(
+  long unsigned int ibit,
+  int iGC,
+  long unsigned int irght,
+  long unsigned int ilft,
+  long unsigned int ihfbit
+  )
+{
+  long unsigned int off;
+  if (iGC == TRUE) return ibit + 1;
+  GetOffComp(list_2_1, list_2_2, ibit, irght, ilft, ihfbit, &off);
+  return off;
+}
+
+/**
+ * @brief Multiply the diagonal part and all intra-process off-diagonal terms
+ * in a single cache-blocked sweep by executing the operator program:
+ * tmp_v0 = dscale*tmp_v0 + H_intra tmp_v1.
+ * X->Large.prdct is incremented by <tmp_v1|H_intra|tmp_v1>.
+ * In the symmetrized basis (TransSym), the rows are given by TransSym_Mltply.
+ *
+ * @param X
+ * @param dscale factor applied to @p tmp_v0 before the product is added
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_fused(struct BindStruct *X, double dscale, double complex *tmp_v0, double complex *tmp_v1)
+{
+  long unsigned int i_max, nterm, npattern, iterm, nblock, iblock, j, jstart, jend, ibit, off;
+  long unsigned int irght, ilft, ihfbit, mask, pattern, flip;
+  int tmp_sgn, iGC, iReal;
+  double complex dam_pr, dmv, coef;
+  double dcoef;
+  struct FusedTerm *term;
+
+  if (X->Large.NTransSymOp > 0) return TransSym_Mltply(X, 1, dscale, tmp_v0, tmp_v1);
+
+  i_max = X->Large.i_max;
+  irght = X->Large.irght;
+  ilft = X->Large.ilft;
+  ihfbit = X->Large.ihfbit;
+  term = X->Large.FusedTerm;
+  nterm = X->Large.NFusedTerm;
+  npattern = X->Large.NFusedPattern;
+  iGC = (X->Def.iCalcModel == HubbardGC || X->Def.iCalcModel == SpinGC);
+  iReal = X->Large.iFlgRealCoef;
+  nblock = (i_max + D_FusedBlockSize - 1) / D_FusedBlockSize;
+  dam_pr = 0.0;
+
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(static) \
+private(iblock, jstart, jend, j, iterm, ibit, off, tmp_sgn, dmv, coef, dcoef, mask, pattern, flip) \
+firstprivate(i_max, nblock, nterm, npattern, iGC, iReal, irght, ilft, ihfbit, dscale) \
+shared(tmp_v0, tmp_v1, term, list_1, list_Diagonal)
+  for (iblock = 0; iblock < nblock; iblock++) {
+    jstart = iblock * D_FusedBlockSize + 1;
+    jend = jstart + D_FusedBlockSize - 1;
+    if (jend > i_max) jend = i_max;
+
+    for (j = jstart; j <= jend; j++) {
+      tmp_v0[j] = dscale * tmp_v0[j] + list_Diagonal[j] * tmp_v1[j];
+      dam_pr += list_Diagonal[j] * conj(tmp_v1[j]) * tmp_v1[j];
+    }
+
+    for (iterm = 0; iterm < npattern; iterm++) {
+      mask = term[iterm].mask;
+      pattern = term[iterm].pattern;
+      flip = term[iterm].flip;
+      coef = term[iterm].coef;
+      dcoef = creal(coef);
+      for (j = jstart; j <= jend; j++) {
+        ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+        if ((ibit & mask) != pattern) continue;
+        off = mltply_fused_Index(ibit ^ flip, iGC, irght, ilft, ihfbit);
+        if (iReal == TRUE) dmv = dcoef * tmp_v1[off];
+        else dmv = coef * tmp_v1[off];
+        tmp_v0[j] += dmv;
+        dam_pr += conj(tmp_v1[j]) * dmv;
+      }
+    }
+
+    for (iterm = npattern; iterm < nterm; iterm++) {
+      coef = term[iterm].coef;
+      dcoef = creal(coef);
+      for (j = jstart; j <= jend; j++) {
+        ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+        tmp_sgn = mltply_fused_Fermion(&term[iterm], &ibit);
+        if (tmp_sgn == 0) continue;
+        off = mltply_fused_Index(ibit, iGC, irght, ilft, ihfbit);
+        if (iReal == TRUE) dmv = (dcoef * tmp_sgn) * tmp_v1[off];
+        else dmv = coef * tmp_sgn * tmp_v1[off];
+        tmp_v0[j] += dmv;
+        dam_pr += conj(tmp_v1[j]) * dmv;
+      }
+    }
+  }
+
+  X->Large.prdct += dam_pr;
+  return 0;
+}
+
+/**
+ * @brief Block version of mltply_fused for @p nvec vectors stored interleaved,
+ * i.e. the component j of the vector l is at [j*nvec+l] (j=1,...,i_max).
+ * The bit pattern, the index and the sign of each term are computed once for all vectors.
+ * In the symmetrized basis (TransSym), the rows are given by TransSym_Mltply.
+ *
+ * @param X
+ * @param nvec number of vectors
+ * @param tmp_v0 [in,out] result vectors
+ * @param tmp_v1 [in] input vectors
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_fused_block(struct BindStruct *X, int nvec, double complex *tmp_v0, double complex *tmp_v1)
+{
+  long unsigned int i_max, nterm, npattern, iterm, nblock, iblock, j, jstart, jend, ibit, off;
+  long unsigned int irght, ilft, ihfbit, mask, pattern, flip, k, jk, offk;
+  int tmp_sgn, iGC, iReal, ivec;
+  double complex dam_pr, coef, dmv;
+  double dcoef;
+  struct FusedTerm *term;
+
+  if (X->Large.NTransSymOp > 0) return TransSym_Mltply(X, nvec, 1.0, tmp_v0, tmp_v1);
+
+  i_max = X->Large.i_max;
+  irght = X->Large.irght;
+  ilft = X->Large.ilft;
+  ihfbit = X->Large.ihfbit;
+  term = X->Large.FusedTerm;
+  nterm = X->Large.NFusedTerm;
+  npattern = X->Large.NFusedPattern;
+  iGC = (X->Def.iCalcModel == HubbardGC || X->Def.iCalcModel == SpinGC);
+  iReal = X->Large.iFlgRealCoef;
+  k = nvec;
+  nblock = (i_max + D_FusedBlockSize - 1) / D_FusedBlockSize;
+  dam_pr = 0.0;
+
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(static) \
+private(iblock, jstart, jend, j, jk, iterm, ibit, off, offk, tmp_sgn, coef, dcoef, dmv, mask, pattern, flip, ivec) \
+firstprivate(i_max, nblock, nterm, npattern, iGC, iReal, irght, ilft, ihfbit, k, nvec) \
+shared(tmp_v0, tmp_v1, term, list_1, list_Diagonal)
+  for (iblock = 0; iblock < nblock; iblock++) {
+    jstart = iblock * D_FusedBlockSize + 1;
+    jend = jstart + D_FusedBlockSize - 1;
+    if (jend > i_max) jend = i_max;
+
+    for (j = jstart; j <= jend; j++) {
+      jk = j * k;
+      for (ivec = 0; ivec < nvec; ivec++) {
+        tmp_v0[jk + ivec] += list_Diagonal[j] * tmp_v1[jk + ivec];
+        dam_pr += list_Diagonal[j] * conj(tmp_v1[jk + ivec]) * tmp_v1[jk + ivec];
+      }
+    }
+
+    for (iterm = 0; iterm < npattern; iterm++) {
+      mask = term[iterm].mask;
+      pattern = term[iterm].pattern;
+      flip = term[iterm].flip;
+      coef = term[iterm].coef;
+      dcoef = creal(coef);
+      for (j = jstart; j <= jend; j++) {
+        ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+        if ((ibit & mask) != pattern) continue;
+        off = mltply_fused_Index(ibit ^ flip, iGC, irght, ilft, ihfbit);
+        jk = j * k;
+        offk = off * k;
+        for (ivec = 0; ivec < nvec; ivec++) {
+          if (iReal == TRUE) dmv = dcoef * tmp_v1[offk + ivec];
+          else dmv = coef * tmp_v1[offk + ivec];
+          tmp_v0[jk + ivec] += dmv;
+          dam_pr += conj(tmp_v1[jk + ivec]) * dmv;
+        }
+      }
+    }
+
+    for (iterm = npattern; iterm < nterm; iterm++) {
+      for (j = jstart; j <= jend; j++) {
+        ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+        tmp_sgn = mltply_fused_Fermion(&term[iterm], &ibit);
+        if (tmp_sgn == 0) continue;
+        off = mltply_fused_Index(ibit, iGC, irght, ilft, ihfbit);
+        coef = term[iterm].coef * tmp_sgn;
+        dcoef = creal(coef);
+        jk = j * k;
+        offk = off * k;
+        for (ivec = 0; ivec < nvec; ivec++) {
+          if (iReal == TRUE) dmv = dcoef * tmp_v1[offk + ivec];
+          else dmv = coef * tmp_v1[offk + ivec];
+          tmp_v0[jk + ivec] += dmv;
+          dam_pr += conj(tmp_v1[jk + ivec]) * dmv;
+        }
+      }
+    }
+  }
+
+  X->Large.prdct += dam_pr;
+  return 0;
+}
+
+/**
+ * @brief Single-precision version of mltply_fused used by the mixed-precision TPQ.
+ * The vectors are stored in float complex, but each row of a block is
+ * accumulated in double complex and rounded only once.
+ *
+ * @param X
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_fused_sp(struct BindStruct *X, float complex *tmp_v0, float complex *tmp_v1)
+{
+  long unsigned int i_max, nterm, npattern, iterm, nblock, iblock, j, jstart, jend, ibit, off;
+  long unsigned int irght, ilft, ihfbit, mask, pattern, flip;
+  int tmp_sgn, iGC, iReal, iErr;
+  double complex coef;
+  double complex *acc;
+  double dcoef;
+  struct FusedTerm *term;
+
+  i_max = X->Large.i_max;
+  irght = X->Large.irght;
+  ilft = X->Large.ilft;
+  ihfbit = X->Large.ihfbit;
+  term = X->Large.FusedTerm;
+  nterm = X->Large.NFusedTerm;
+  npattern = X->Large.NFusedPattern;
+  iGC = (X->Def.iCalcModel == HubbardGC || X->Def.iCalcModel == SpinGC);
+  iReal = X->Large.iFlgRealCoef;
+  nblock = (i_max + D_FusedBlockSize - 1) / D_FusedBlockSize;
+  iErr = FALSE;
+
+#pragma omp parallel default(none) reduction(||:iErr) \
+private(iblock, jstart, jend, j, iterm, ibit, off, tmp_sgn, coef, dcoef, mask, pattern, flip, acc) \
+firstprivate(i_max, nblock, nterm, npattern, iGC, iReal, irght, ilft, ihfbit) \
+shared(tmp_v0, tmp_v1, term, list_1, list_Diagonal)
+  {
+    c_malloc1(acc, D_FusedBlockSize);
+    if (acc == NULL) iErr = TRUE;
+#pragma omp for schedule(static)
+    for (iblock = 0; iblock < nblock; iblock++) {
+      if (acc == NULL) continue;
+      jstart = iblock * D_FusedBlockSize + 1;
+      jend = jstart + D_FusedBlockSize - 1;
+      if (jend > i_max) jend = i_max;
+
+      for (j = jstart; j <= jend; j++) {
+        acc[j - jstart] = tmp_v0[j] + list_Diagonal[j] * (double complex)tmp_v1[j];
+      }
+
+      for (iterm = 0; iterm < npattern; iterm++) {
+        mask = term[iterm].mask;
+        pattern = term[iterm].pattern;
+        flip = term[iterm].flip;
+        coef = term[iterm].coef;
+        dcoef = creal(coef);
+        for (j = jstart; j <= jend; j++) {
+          ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+          if ((ibit & mask) != pattern) continue;
+          off = mltply_fused_Index(ibit ^ flip, iGC, irght, ilft, ihfbit);
+          if (iReal == TRUE) acc[j - jstart] += dcoef * (double complex)tmp_v1[off];
+          else acc[j - jstart] += coef * (double complex)tmp_v1[off];
+        }
+      }
+
+      for (iterm = npattern; iterm < nterm; iterm++) {
+        coef = term[iterm].coef;
+        dcoef = creal(coef);
+        for (j = jstart; j <= jend; j++) {
+          ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+          tmp_sgn = mltply_fused_Fermion(&term[iterm], &ibit);
+          if (tmp_sgn == 0) continue;
+          off = mltply_fused_Index(ibit, iGC, irght, ilft, ihfbit);
+          if (iReal == TRUE) acc[j - jstart] += (dcoef * tmp_sgn) * (double complex)tmp_v1[off];
+          else acc[j - jstart] += coef * tmp_sgn * (double complex)tmp_v1[off];
+        }
+      }
+
+      for (j = jstart; j <= jend; j++) {
+        tmp_v0[j] = (float complex)acc[j - jstart];
+      }
+    }
+    free(acc);
+  }
+
+  if (iErr == TRUE) return -1;
+  return 0;
+}
+
+/**
+ * @brief Real version of mltply_fused for real coefficients (iFlgRealCoef)
+ * and real vectors: tmp_v0 = dscale*tmp_v0 + H_intra tmp_v1.
+ * The vectors take half of the memory traffic of the complex ones.
+ *
+ * @param X
+ * @param dscale factor applied to @p tmp_v0 before the product is added
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ * @retval -1 the coefficients are not real
+ */
+int mltply_fused_real(struct BindStruct *X, double dscale, double *tmp_v0, double *tmp_v1)
+{
+  long unsigned int i_max, nterm, npattern, iterm, nblock, iblock, j, jstart, jend, ibit, off;
+  long unsigned int irght, ilft, ihfbit, mask, pattern, flip;
+  int tmp_sgn, iGC;
+  double dam_pr, dmv, dcoef;
+  struct FusedTerm *term;
+
+  if (X->Large.iFlgRealCoef == FALSE) return -1;
+  i_max = X->Large.i_max;
+  irght = X->Large.irght;
+  ilft = X->Large.ilft;
+  ihfbit = X->Large.ihfbit;
+  term = X->Large.FusedTerm;
+  nterm = X->Large.NFusedTerm;
+  npattern = X->Large.NFusedPattern;
+  iGC = (X->Def.iCalcModel == HubbardGC || X->Def.iCalcModel == SpinGC);
+  nblock = (i_max + D_FusedBlockSize - 1) / D_FusedBlockSize;
+  dam_pr = 0.0;
+
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(static) \
+private(iblock, jstart, jend, j, iterm, ibit, off, tmp_sgn, dmv, dcoef, mask, pattern, flip) \
+firstprivate(i_max, nblock, nterm, npattern, iGC, irght, ilft, ihfbit, dscale) \
+shared(tmp_v0, tmp_v1, term, list_1, list_Diagonal)
+  for (iblock = 0; iblock < nblock; iblock++) {
+    jstart = iblock * D_FusedBlockSize + 1;
+    jend = jstart + D_FusedBlockSize - 1;
+    if (jend > i_max) jend = i_max;
+
+    for (j = jstart; j <= jend; j++) {
+      tmp_v0[j] = dscale * tmp_v0[j] + list_Diagonal[j] * tmp_v1[j];
+      dam_pr += list_Diagonal[j] * tmp_v1[j] * tmp_v1[j];
+    }
+
+    for (iterm = 0; iterm < npattern; iterm++) {
+      mask = term[iterm].mask;
+      pattern = term[iterm].pattern;
+      flip = term[iterm].flip;
+      dcoef = creal(term[iterm].coef);
+      for (j = jstart; j <= jend; j++) {
+        ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+        if ((ibit & mask) != pattern) continue;
+        off = mltply_fused_Index(ibit ^ flip, iGC, irght, ilft, ihfbit);
+        dmv = dcoef * tmp_v1[off];
+        tmp_v0[j] += dmv;
+        dam_pr += tmp_v1[j] * dmv;
+      }
+    }
+
+    for (iterm = npattern; iterm < nterm; iterm++) {
+      dcoef = creal(term[iterm].coef);
+      for (j = jstart; j <= jend; j++) {
+        ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+        tmp_sgn = mltply_fused_Fermion(&term[iterm], &ibit);
+        if (tmp_sgn == 0) continue;
+        off = mltply_fused_Index(ibit, iGC, irght, ilft, ihfbit);
+        dmv = (dcoef * tmp_sgn) * tmp_v1[off];
+        tmp_v0[j] += dmv;
+        dam_pr += tmp_v1[j] * dmv;
+      }
+    }
+  }
+
+  X->Large.prdct += dam_pr;
+  return 0;
+}
+
+/**
+ * @brief Get the intra-process off-diagonal elements in the row of the state @p ibit
+ * by executing the operator program. Elements are not merged.
+ *
+ * @param X
+ * @param ibit bit pattern of the row state
+ * @param jbit [out] bit patterns of the column states (length X->Large.NFusedTerm)
+ * @param val [out] matrix elements (length X->Large.NFusedTerm)
+ *
+ * @return number of elements
+ */
+long unsigned int mltply_fused_GetRowBit(
+  struct BindStruct *X,
+  long unsigned int ibit,
+  long unsigned int *jbit,
+  double complex *val
+  )
+{
+  long unsigned int nterm, iterm, kbit, nelem;
+  int tmp_sgn;
+  struct FusedTerm *term;
+
+  term = X->Large.FusedTerm;
+  nterm = X->Large.NFusedTerm;
+
+  nelem = 0;
+  for (iterm = 0; iterm < nterm; iterm++) {
+    kbit = ibit;
+    if (term[iterm].itype == FUSED_PATTERN) {
+      if ((kbit & term[iterm].mask) != term[iterm].pattern) continue;
+      kbit ^= term[iterm].flip;
+      tmp_sgn = 1;
+    }
+    else {
+      tmp_sgn = mltply_fused_Fermion(&term[iterm], &kbit);
+      if (tmp_sgn == 0) continue;
+    }
+    jbit[nelem] = kbit;
+    val[nelem] = term[iterm].coef * tmp_sgn;
+    nelem++;
+  }
+  return nelem;
+}
+
+/**
+ * @brief Get the intra-process off-diagonal elements in the row @p j
+ * by executing the operator program. Elements in the same column are summed up.
+ * In the symmetrized basis (TransSym), the elements are given by TransSym_GetRow.
+ *
+ * @param X
+ * @param j row index (1 origin)
+ * @param off [out] column indices (length X->Large.NFusedTerm)
+ * @param val [out] matrix elements (length X->Large.NFusedTerm)
+ *
+ * @return number of elements
+ */
+long unsigned int mltply_fused_GetRow(
+  struct BindStruct *X,
+  long unsigned int j,
+  long unsigned int *off,
+  double complex *val
+  )
+{
+  long unsigned int ibit, joff, nbit, ibitelem, nelem, ielem;
+  int iGC;
+  double complex coef;
+
+  if (X->Large.NTransSymOp > 0) return TransSym_GetRow(X, j, off, val);
+
+  iGC = (X->Def.iCalcModel == HubbardGC || X->Def.iCalcModel == SpinGC);
+  ibit = (iGC == TRUE) ? j - 1 : list_1[j];
+
+  /*Column states are converted into indices in place*/
+  nbit = mltply_fused_GetRowBit(X, ibit, off, val);
+  nelem = 0;
+  for (ibitelem = 0; ibitelem < nbit; ibitelem++) {
+    joff = mltply_fused_Index(off[ibitelem], iGC, X->Large.irght, X->Large.ilft, X->Large.ihfbit);
+    coef = val[ibitelem];
+    for (ielem = 0; ielem < nelem; ielem++) {
+      if (off[ielem] == joff) break;
+    }
+    if (ielem == nelem) {
+      off[nelem] = joff;
+      val[nelem] = 0.0;
+      nelem++;
+    }
+    val[ielem] += coef;
+  }
+  return nelem;
+}
+
+/**
+ * @brief Add the off-diagonal elements of the operator program to Ham.
+ * The diagonal part is set by makeHam.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_fused_MakeHam(struct BindStruct *X)
+{
+  long unsigned int i_max, nterm, j, nelem, ielem;
+  long unsigned int *off;
+  double complex *val;
+
+  i_max = X->Large.i_max;
+  nterm = X->Large.NFusedTerm;
+
+#pragma omp parallel default(none) private(j, nelem, ielem, off, val) firstprivate(i_max, nterm, X) shared(Ham)
+  {
+    lui_malloc1(off, nterm + 1);
+    c_malloc1(val, nterm + 1);
+#pragma omp for
+    for (j = 1; j <= i_max; j++) {
+      nelem = mltply_fused_GetRow(X, j, off, val);
+      for (ielem = 0; ielem < nelem; ielem++) {
+        Ham[j][off[ielem]] += val[ielem];
+      }
+    }
+    free(off);
+    free(val);
+  }
+  return 0;
+}
@@ -25,6 +25,7 @@
 #include "bitcalc.h"
 #include "wrapperMPI.h"
 #include "mltplyMPI.h"
+#include "mltplyMPIPlan.h"
 
 
 /**
@@ -76,9 +77,10 @@ double complex X_GC_child_general_hopp_MPIdouble(
 				       double complex *tmp_v1 /**< [in] v0 = H v1*/)
 {
 #ifdef MPI
-  int mask1, mask2, state1, state2, ierr, origin, bitdiff, Fsgn;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, mask2, state1, state2, origin, bitdiff, Fsgn;
   unsigned long int idim_max_buf, j;
-  MPI_Status statusMPI;
   double complex trans, dmv, dam_pr;
     
   mask1 = (int)X->Def.Tpow[2 * org_isite1 + org_ispin1];
@@ -103,22 +105,15 @@ double complex X_GC_child_general_hopp_MPIdouble(
   }
   else return 0;
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0){
-        exitMPI(-1);
-    }
-  ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0){
-        exitMPI(-1);
-    }
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
   dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(idim_max_buf, trans, X) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
-    dmv = trans * v1buf[j];
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(ichunk, nchunk, idim_max_buf, trans, X) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = trans * v1buf_p[j - ichunk];
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
   return (dam_pr);
   
@@ -174,9 +169,10 @@ double complex X_GC_child_general_hopp_MPIsingle(
   double complex *tmp_v1 /**< [in] v0 = H v1*/)
 {
 #ifdef MPI
-  int mask2, state1, state2, ierr, origin, bit2diff, Fsgn;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask2, state1, state2, origin, bit2diff, Fsgn;
   unsigned long int idim_max_buf, j, mask1, state1check, bit1diff, ioff;
-  MPI_Status statusMPI;
   double complex trans, dmv, dam_pr;
   /*
    Prepare index in the inter PE
@@ -188,13 +184,7 @@ double complex X_GC_child_general_hopp_MPIsingle(
 
   SgnBit((unsigned long int)(origin & bit2diff), &Fsgn); // Fermion sign
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
 
   /*
    Index in the intra PE
@@ -218,20 +208,22 @@ double complex X_GC_child_general_hopp_MPIsingle(
   bit1diff = X->Def.Tpow[2 * X->Def.Nsite - 1] * 2 - mask1 * 2;
 
   dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
 #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, state1, Fsgn, ioff) \
-  firstprivate(idim_max_buf, trans, X, mask1, state1check, bit1diff) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 0; j < idim_max_buf; j++) {
+  firstprivate(ichunk, nchunk, idim_max_buf, trans, X, mask1, state1check, bit1diff) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk - 1; j < ichunk - 1 + nchunk; j++) {
 
-    state1 = j & mask1;
+      state1 = j & mask1;
 
-    if (state1 == state1check) {
+      if (state1 == state1check) {
 
-      SgnBit(j & bit1diff, &Fsgn);
-      ioff = j ^ mask1;
+        SgnBit(j & bit1diff, &Fsgn);
+        ioff = j ^ mask1;
 
-      dmv = (double)Fsgn * trans * v1buf[j + 1];
-      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff + 1] += dmv;
-      dam_pr += conj(tmp_v1[ioff + 1]) * dmv;
+        dmv = (double)Fsgn * trans * v1buf_p[j + 1 - ichunk];
+        if (X->Large.mode == M_MLTPLY) tmp_v0[ioff + 1] += dmv;
+        dam_pr += conj(tmp_v1[ioff + 1]) * dmv;
+      }
     }
   }
   return (dam_pr);
@@ -284,9 +276,11 @@ double complex X_child_general_hopp_MPIdouble(
   double complex *tmp_v1 /**< [in] v0 = H v1*/)
 {
 #ifdef MPI
-  int mask1, mask2, state1, state2, ierr, origin, bitdiff, Fsgn;
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, mask2, state1, state2, origin, bitdiff, Fsgn;
   unsigned long int idim_max_buf, j, ioff;
-  MPI_Status statusMPI;
   double complex trans, dmv, dam_pr;
 
   mask1 = (int)X->Def.Tpow[2 * org_isite1+org_ispin1];
@@ -312,25 +306,20 @@ double complex X_child_general_hopp_MPIdouble(
   }
   else return 0;
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+  list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
 
   dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
 #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, Fsgn, ioff) \
-  firstprivate(idim_max_buf, trans, X) shared(list_2_1, list_2_2, list_1buf, v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
-    GetOffComp(list_2_1, list_2_2, list_1buf[j], 
-      X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
-    dmv = trans * v1buf[j];
-    if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-    dam_pr += conj(tmp_v1[ioff]) * dmv;
+  firstprivate(ichunk, nchunk, idim_max_buf, trans, X) shared(list_2_1, list_2_2, list_1buf_p, v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      GetOffComp(list_2_1, list_2_2, list_1buf_p[j], 
+        X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+      dmv = trans * v1buf_p[j - ichunk];
+      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+      dam_pr += conj(tmp_v1[ioff]) * dmv;
+    }
   }
   return (dam_pr);
 
@@ -384,9 +373,11 @@ double complex X_child_general_hopp_MPIsingle(
   double complex *tmp_v1 /**< [in] v0 = H v1*/)
 {
 #ifdef MPI
-  int mask2, state2, ierr, origin, bit2diff, Fsgn;
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask2, state2, origin, bit2diff, Fsgn;
   unsigned long int mask1, state1, idim_max_buf, j, state1check, bit1diff, ioff, jreal;
-  MPI_Status statusMPI;
   double complex trans, dmv, dam_pr;
   /*
   Prepare index in the inter PE
@@ -399,15 +390,8 @@ double complex X_child_general_hopp_MPIsingle(
 
   SgnBit((unsigned long int)(origin & bit2diff), &Fsgn); // Fermion sign
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+  list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
 
   /*
   Index in the intra PE
@@ -429,22 +413,24 @@ double complex X_child_general_hopp_MPIsingle(
   bit1diff = X->Def.Tpow[2 * X->Def.Nsite - 1] * 2 - mask1 * 2;
 
   dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
 #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, Fsgn, ioff, jreal, state1) \
-  firstprivate(idim_max_buf, trans, X, mask1, state1check, bit1diff) shared(list_2_1, list_2_2, list_1buf, v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
+  firstprivate(ichunk, nchunk, idim_max_buf, trans, X, mask1, state1check, bit1diff) shared(list_2_1, list_2_2, list_1buf_p, v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
 
-    jreal = list_1buf[j];
-    state1 = jreal & mask1;
+      jreal = list_1buf_p[j];
+      state1 = jreal & mask1;
 
-    if (state1 == state1check) {
+      if (state1 == state1check) {
 
-      SgnBit(jreal & bit1diff, &Fsgn);
-      GetOffComp(list_2_1, list_2_2, jreal ^ mask1,
-        X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+        SgnBit(jreal & bit1diff, &Fsgn);
+        GetOffComp(list_2_1, list_2_2, jreal ^ mask1,
+          X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
 
-      dmv = (double)Fsgn * trans * v1buf[j];
-      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-      dam_pr += conj(tmp_v1[ioff]) * dmv;
+        dmv = (double)Fsgn * trans * v1buf_p[j - ichunk];
+        if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+        dam_pr += conj(tmp_v1[ioff]) * dmv;
+      }
     }
   }
   return (dam_pr);
@@ -499,9 +485,11 @@ double complex X_child_general_int_spin_MPIdouble(
 						  )
 {
 #ifdef MPI
-  int mask1, mask2, state1, state2, ierr, origin;
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, mask2, state1, state2, origin;
   unsigned long int idim_max_buf, j, ioff;
-  MPI_Status statusMPI;
   double complex Jint, dmv, dam_pr;
 
   mask1 = (int)X->Def.Tpow[org_isite1];
@@ -522,25 +510,20 @@ double complex X_child_general_int_spin_MPIdouble(
   }
   else return 0;
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+  list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
 
     dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
   #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, ioff) \
-  firstprivate(idim_max_buf, Jint, X) shared(list_2_1, list_2_2, list_1buf, v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
-    GetOffComp(list_2_1, list_2_2, list_1buf[j],
-	       X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
-    dmv = Jint * v1buf[j];
-    if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-    dam_pr += conj(tmp_v1[ioff]) * dmv;
+  firstprivate(ichunk, nchunk, idim_max_buf, Jint, X) shared(list_2_1, list_2_2, list_1buf_p, v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      GetOffComp(list_2_1, list_2_2, list_1buf_p[j],
+		 X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+      dmv = Jint * v1buf_p[j - ichunk];
+      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+      dam_pr += conj(tmp_v1[ioff]) * dmv;
+    }
   }
   return dam_pr;  
 #endif
@@ -563,9 +546,11 @@ double complex X_child_general_int_spin_TotalS_MPIdouble(
 						  )
 {
 #ifdef MPI
-  int mask1, mask2, num1_up, num2_up, ierr, origin;
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, mask2, num1_up, num2_up, origin;
   unsigned long int idim_max_buf, j, ioff, ibit_tmp;
-  MPI_Status statusMPI;
   double complex dmv, dam_pr;
 
   mask1 = (int)X->Def.Tpow[org_isite1];
@@ -582,24 +567,19 @@ double complex X_child_general_int_spin_TotalS_MPIdouble(
   ibit_tmp=(num1_up)^(num2_up);
   if(ibit_tmp ==0) return 0;
   
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+  list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
 
     dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
   #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, ioff) \
-    firstprivate(idim_max_buf,  X) shared(list_2_1, list_2_2, list_1buf, v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {    
-    GetOffComp(list_2_1, list_2_2, list_1buf[j],
-	       X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
-    dmv = 0.5 * v1buf[j];
-    dam_pr += conj(tmp_v1[ioff]) * dmv;
+    firstprivate(ichunk, nchunk, idim_max_buf,  X) shared(list_2_1, list_2_2, list_1buf_p, v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      GetOffComp(list_2_1, list_2_2, list_1buf_p[j],
+		 X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+      dmv = 0.5 * v1buf_p[j - ichunk];
+      dam_pr += conj(tmp_v1[ioff]) * dmv;
+    }
   }
   return dam_pr;  
 #endif
@@ -647,9 +627,11 @@ double complex X_child_general_int_spin_MPIsingle(
 						  )
 {
 #ifdef MPI
-  int mask2, state2, ierr, origin;
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask2, state2, origin;
   unsigned long int mask1, idim_max_buf, j, ioff, state1, jreal, state1check;
-  MPI_Status statusMPI;
   double complex Jint, dmv, dam_pr;
   /*
   Prepare index in the inter PE
@@ -671,38 +653,33 @@ double complex X_child_general_int_spin_MPIsingle(
   }
   else return 0;
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+  list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
     /*
     Index in the intra PE
     */
   mask1 = X->Def.Tpow[org_isite1];
 
   dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
 #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, ioff, jreal, state1) \
-  firstprivate(idim_max_buf, Jint, X, mask1, state1check, org_isite1) shared(list_2_1, list_2_2, list_1buf, v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
-
-    jreal = list_1buf[j];
-
-    state1 = (jreal & mask1) / mask1;
-    if (state1 == state1check) {
-      GetOffComp(list_2_1, list_2_2, jreal ^ mask1,
-		 X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
-
-      dmv = Jint * v1buf[j];
-      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-      else if(X->Large.mode==M_TOTALS){
-	dmv=0.5*v1buf[j];
+  firstprivate(ichunk, nchunk, idim_max_buf, Jint, X, mask1, state1check, org_isite1) shared(list_2_1, list_2_2, list_1buf_p, v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+
+      jreal = list_1buf_p[j];
+
+      state1 = (jreal & mask1) / mask1;
+      if (state1 == state1check) {
+        GetOffComp(list_2_1, list_2_2, jreal ^ mask1,
+		   X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+
+        dmv = Jint * v1buf_p[j - ichunk];
+        if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+        else if(X->Large.mode==M_TOTALS){
+	  dmv=0.5*v1buf_p[j - ichunk];
+        }
+        dam_pr += conj(tmp_v1[ioff]) * dmv;
       }
-      dam_pr += conj(tmp_v1[ioff]) * dmv;
     }
   }
 
@@ -747,9 +724,10 @@ double complex X_GC_child_CisAitCiuAiv_spin_MPIdouble(
   double complex *tmp_v0, double complex *tmp_v1)
 {
 #ifdef MPI
-  int mask1, mask2, state1, state2, ierr, origin;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, mask2, state1, state2, origin;
   unsigned long int idim_max_buf, j;
-  MPI_Status statusMPI;
   double complex Jint, dmv, dam_pr;
 
   mask1 = (int)X->Def.Tpow[org_isite1];
@@ -784,20 +762,17 @@ double complex X_GC_child_CisAitCiuAiv_spin_MPIdouble(
     return 0;
   }
  
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
 
     dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
   #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) \
-  firstprivate(idim_max_buf, Jint, X) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
-    dmv = Jint * v1buf[j];
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  firstprivate(ichunk, nchunk, idim_max_buf, Jint, X) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = Jint * v1buf_p[j - ichunk];
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
   return dam_pr;
 
@@ -848,10 +823,11 @@ double complex X_GC_child_CisAisCjuAjv_spin_MPIdouble(
 					    double complex *tmp_v1)
 {
 #ifdef MPI
-  int mask1, mask2, state2, ierr;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, mask2, state2;
   long int origin, num1;
   unsigned long int idim_max_buf, j;
-  MPI_Status statusMPI;
   double complex Jint, dmv, dam_pr;
 
   if(org_isite1== org_isite3 && org_ispin1 == org_ispin4){//CisAisCitAis
@@ -874,20 +850,17 @@ double complex X_GC_child_CisAisCjuAjv_spin_MPIdouble(
     return 0.0;
   }
   
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
 
     dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
   #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) \
-  firstprivate(idim_max_buf, Jint, X) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
-    dmv = Jint * v1buf[j];
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  firstprivate(ichunk, nchunk, idim_max_buf, Jint, X) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = Jint * v1buf_p[j - ichunk];
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
   return(dam_pr);
 #endif
@@ -937,10 +910,11 @@ double complex X_GC_child_CisAitCjuAju_spin_MPIdouble(
 					    double complex *tmp_v1)
 {
 #ifdef MPI
-  int mask1, mask2, state1, ierr, num1;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, mask2, state1, num1;
   long int origin;
   unsigned long int idim_max_buf, j;
-  MPI_Status statusMPI;
   double complex Jint, dmv, dam_pr;
 
   if(org_isite1 ==org_isite3 && org_ispin1==org_ispin3){//cisaitcisais
@@ -970,20 +944,17 @@ double complex X_GC_child_CisAitCjuAju_spin_MPIdouble(
   else{
     return 0.0;
   }
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
 
     dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
   #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) \
-  firstprivate(idim_max_buf, Jint, X) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= idim_max_buf; j++) {
-    dmv = Jint * v1buf[j];
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  firstprivate(ichunk, nchunk, idim_max_buf, Jint, X) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = Jint * v1buf_p[j - ichunk];
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
   return(dam_pr);
 #endif
@@ -1132,9 +1103,10 @@ double complex X_GC_child_CisAitCiuAiv_spin_MPIsingle(
 					    double complex tmp_J, struct BindStruct *X, double complex *tmp_v0, double complex *tmp_v1)
 {
 #ifdef MPI
-  int mask2, state2, ierr, origin;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask2, state2, origin;
   unsigned long int mask1, idim_max_buf, j, ioff, state1, state1check;
-  MPI_Status statusMPI;
   double complex Jint, dmv, dam_pr;
   /*
   Prepare index in the inter PE
@@ -1156,26 +1128,23 @@ double complex X_GC_child_CisAitCiuAiv_spin_MPIsingle(
   }
   else return 0.0;
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
     /*
     Index in the intra PE
     */
   mask1 = X->Def.Tpow[org_isite1];
 
   dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
 #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, state1, ioff) \
-    firstprivate(idim_max_buf, Jint, X, state1check, mask1) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 0; j < idim_max_buf; j++) {
-    state1 = X_SpinGC_CisAit(j+1, X, mask1, state1check, &ioff);
-    if(state1 != 0){
-      dmv = Jint * v1buf[j + 1];
-      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff + 1] += dmv;
-      dam_pr += conj(tmp_v1[ioff + 1]) * dmv;
+    firstprivate(ichunk, nchunk, idim_max_buf, Jint, X, state1check, mask1) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk - 1; j < ichunk - 1 + nchunk; j++) {
+      state1 = X_SpinGC_CisAit(j+1, X, mask1, state1check, &ioff);
+      if(state1 != 0){
+        dmv = Jint * v1buf_p[j + 1 - ichunk];
+        if (X->Large.mode == M_MLTPLY) tmp_v0[ioff + 1] += dmv;
+        dam_pr += conj(tmp_v1[ioff + 1]) * dmv;
+      }
     }
   }
   return (dam_pr);
@@ -1215,9 +1184,10 @@ void GC_child_CisAisCjuAjv_spin_MPIsingle(
 double complex X_GC_child_CisAisCjuAjv_spin_MPIsingle( int org_isite1, int org_ispin1,  int org_isite3, int org_ispin3, int org_ispin4, double complex tmp_J, struct BindStruct *X, double complex *tmp_v0, double complex *tmp_v1)
 {
 #ifdef MPI
-  int mask2, state2, ierr, origin;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask2, state2, origin;
   unsigned long int mask1, idim_max_buf, j, state1, state1check;
-  MPI_Status statusMPI;
   double complex Jint, dmv, dam_pr;
   /*
   Prepare index in the inter PE
@@ -1238,26 +1208,23 @@ double complex X_GC_child_CisAisCjuAjv_spin_MPIsingle( int org_isite1, int org_i
   }
   else return 0.0;
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
     /*
     Index in the intra PE
     */
   mask1 = X->Def.Tpow[org_isite1];
 
   dam_pr = 0.0;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
 #pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, state1) \
-    firstprivate(idim_max_buf, Jint, X, state1check, mask1) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 0; j < idim_max_buf; j++) {
-    state1 =  (j & mask1) / mask1 ;
-    if (state1 == state1check) {
-      dmv = Jint * v1buf[j + 1];
-      if (X->Large.mode == M_MLTPLY) tmp_v0[j + 1] += dmv;
-      dam_pr += conj(tmp_v1[j + 1]) * dmv;
+    firstprivate(ichunk, nchunk, idim_max_buf, Jint, X, state1check, mask1) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk - 1; j < ichunk - 1 + nchunk; j++) {
+      state1 =  (j & mask1) / mask1 ;
+      if (state1 == state1check) {
+        dmv = Jint * v1buf_p[j + 1 - ichunk];
+        if (X->Large.mode == M_MLTPLY) tmp_v0[j + 1] += dmv;
+        dam_pr += conj(tmp_v1[j + 1]) * dmv;
+      }
     }
   }
   return (dam_pr);
@@ -1425,10 +1392,11 @@ double complex X_GC_child_CisAisCjuAjv_GeneralSpin_MPIdouble(
 							  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int off, j;
-  int origin, ierr;
+  int origin;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
   int ihermite =TRUE;
   if(org_isite1==org_isite3 && org_ispin1 == org_ispin4){//cisaisciuais=0 && cisaiucisais=0
     return 0.0;
@@ -1460,17 +1428,16 @@ double complex X_GC_child_CisAisCjuAjv_GeneralSpin_MPIdouble(
   }
   
   origin = (int)off;
-  ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-		      v1buf, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0, 
-		      MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, NULL);
 
     dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf) 
-  for (j = 1; j <= X->Check.idim_max; j++) {
-    dmv = v1buf[j] * tmp_V;
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf_p) 
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = v1buf_p[j - ichunk] * tmp_V;
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
 
   return dam_pr;
@@ -1490,10 +1457,11 @@ double complex X_GC_child_CisAitCjuAju_GeneralSpin_MPIdouble(
 							  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int j, off;
-  int origin, ierr;
+  int origin;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
 
   if(org_isite1==org_isite3 && org_ispin1 == org_ispin3){//cisaitcisais=0 && cisaiscitais=0
     return 0.0;
@@ -1517,17 +1485,16 @@ double complex X_GC_child_CisAitCjuAju_GeneralSpin_MPIdouble(
 
   origin = (int)off;
 
-  ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-		      v1buf, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0, 
-		      MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, NULL);
 
     dam_pr = 0.0;
-#pragma omp parallel  for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf) 
-  for (j = 1; j <= X->Check.idim_max; j++) {
-    dmv = v1buf[j] * tmp_V;
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel  for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf_p) 
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = v1buf_p[j - ichunk] * tmp_V;
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
   
   return dam_pr;
@@ -1548,10 +1515,11 @@ double complex X_GC_child_CisAitCjuAjv_GeneralSpin_MPIdouble(
 							  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int tmp_off, off, j;
-  int origin, ierr, ihermite;
+  int origin, ihermite;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
 
   ihermite =TRUE;
 
@@ -1591,17 +1559,16 @@ double complex X_GC_child_CisAitCjuAjv_GeneralSpin_MPIdouble(
   
     origin = (int)off;
 
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-      v1buf, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0, 
-      MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, NULL);
 
     dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf) 
-    for (j = 1; j <= X->Check.idim_max; j++) {
-      dmv = v1buf[j] * tmp_V;
-      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-      dam_pr += conj(tmp_v1[j]) * dmv;
+    while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf_p) 
+      for (j = ichunk; j < ichunk + nchunk; j++) {
+        dmv = v1buf_p[j - ichunk] * tmp_V;
+        if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+        dam_pr += conj(tmp_v1[j]) * dmv;
+      }
     }
     
     return dam_pr;
@@ -1658,10 +1625,11 @@ double complex X_GC_child_CisAit_GeneralSpin_MPIdouble(
 						       double complex *tmp_v1)
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int off, j;
-  int origin, ierr;
+  int origin;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
   
   if(GetOffCompGeneralSpin((unsigned long int)myrank, org_isite1 + 1, org_ispin1, org_ispin2,
 			   &off, X->Def.SiteToBit, X->Def.Tpow) == TRUE)
@@ -1679,17 +1647,16 @@ double complex X_GC_child_CisAit_GeneralSpin_MPIdouble(
   
   origin = (int)off;
   
-  ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-		      v1buf, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0, 
-		      MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, NULL);
 
     dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf) 
-  for (j = 1; j <= X->Check.idim_max; j++) {
-    dmv = v1buf[j] * tmp_V;
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V) private(j, dmv) shared (tmp_v0, tmp_v1, v1buf_p) 
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = v1buf_p[j - ichunk] * tmp_V;
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
   
   return dam_pr;
@@ -1788,10 +1755,11 @@ double complex X_GC_child_CisAisCjuAjv_GeneralSpin_MPIsingle(
 							  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int off, j, num1;
-  int origin, ierr, isite, IniSpin;
+  int origin, isite, IniSpin;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
 
 
   if (GetOffCompGeneralSpin((unsigned long int)myrank,
@@ -1815,22 +1783,21 @@ double complex X_GC_child_CisAisCjuAjv_GeneralSpin_MPIsingle(
   
   origin = (int)off;
   
-  ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-		      v1buf, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-		      MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, NULL);
 
     dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V, isite, IniSpin) private(j, dmv, num1) shared (tmp_v0, tmp_v1, v1buf) 
-  for (j = 1; j <= X->Check.idim_max; j++) {
-    num1 = BitCheckGeneral(j-1, isite, IniSpin, X->Def.SiteToBit, X->Def.Tpow);
-    if (num1 !=0)
-      {
-        dmv = v1buf[j] * tmp_V;
-        if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-        dam_pr += conj(tmp_v1[j]) * dmv;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V, isite, IniSpin) private(j, dmv, num1) shared (tmp_v0, tmp_v1, v1buf_p) 
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      num1 = BitCheckGeneral(j-1, isite, IniSpin, X->Def.SiteToBit, X->Def.Tpow);
+      if (num1 !=0)
+        {
+          dmv = v1buf_p[j - ichunk] * tmp_V;
+          if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+          dam_pr += conj(tmp_v1[j]) * dmv;
+        }
       }
-    }
+  }
   
   return dam_pr;
 #endif
@@ -1894,10 +1861,11 @@ double complex X_GC_child_CisAitCjuAjv_GeneralSpin_MPIsingle(
 							  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int off, j;
-  int origin, ierr, isite, IniSpin, FinSpin;
+  int origin, isite, IniSpin, FinSpin;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
 
     if (GetOffCompGeneralSpin((unsigned long int)myrank,
       org_isite3+ 1, org_ispin3, org_ispin4, &off,
@@ -1922,21 +1890,20 @@ double complex X_GC_child_CisAitCjuAjv_GeneralSpin_MPIsingle(
 
     origin = (int)off;
 
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-      v1buf, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-      MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, NULL);
 
     dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V, isite, IniSpin, FinSpin) private(j, dmv, off) shared (tmp_v0, tmp_v1, v1buf) 
-    for (j = 1; j <= X->Check.idim_max; j++) {
-
-      if (GetOffCompGeneralSpin(j - 1, isite, IniSpin, FinSpin, &off,
-        X->Def.SiteToBit, X->Def.Tpow) == TRUE)
-      {
-        dmv = v1buf[j] * tmp_V;
-        if (X->Large.mode == M_MLTPLY) tmp_v0[off + 1] += dmv;
-        dam_pr += conj(tmp_v1[off + 1]) * dmv;
+    while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V, isite, IniSpin, FinSpin) private(j, dmv, off) shared (tmp_v0, tmp_v1, v1buf_p) 
+      for (j = ichunk; j < ichunk + nchunk; j++) {
+
+        if (GetOffCompGeneralSpin(j - 1, isite, IniSpin, FinSpin, &off,
+          X->Def.SiteToBit, X->Def.Tpow) == TRUE)
+        {
+          dmv = v1buf_p[j - ichunk] * tmp_V;
+          if (X->Large.mode == M_MLTPLY) tmp_v0[off + 1] += dmv;
+          dam_pr += conj(tmp_v1[off + 1]) * dmv;
+        }
       }
     }
     return dam_pr;
@@ -2019,10 +1986,12 @@ double complex X_child_CisAitCjuAjv_GeneralSpin_MPIdouble(
 							  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int tmp_off, off, j, idim_max_buf;
-  int origin, ierr;
+  int origin;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
   int ihermite=TRUE;
 
   if (GetOffCompGeneralSpin((unsigned long int)myrank, org_isite1 + 1, org_ispin1, org_ispin2, &tmp_off, X->Def.SiteToBit, X->Def.Tpow) == TRUE)
@@ -2057,26 +2026,20 @@ double complex X_child_CisAitCjuAjv_GeneralSpin_MPIdouble(
   
   origin = (int)off;
 
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+  list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
 
     dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V, idim_max_buf) private(j, dmv, off) shared (tmp_v0, tmp_v1, list_1buf, v1buf) 
-  for (j = 1; j <= idim_max_buf; j++) {
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V, idim_max_buf) private(j, dmv, off) shared (tmp_v0, tmp_v1, list_1buf_p, v1buf_p) 
+    for (j = ichunk; j < ichunk + nchunk; j++) {
 
-    ConvertToList1GeneralSpin(list_1buf[j], X->Check.sdim, &off);
+      ConvertToList1GeneralSpin(list_1buf_p[j], X->Check.sdim, &off);
 
-    dmv = v1buf[j] * tmp_V;
-    if (X->Large.mode == M_MLTPLY) tmp_v0[off] += dmv;
-    dam_pr += conj(tmp_v1[off]) * dmv;
+      dmv = v1buf_p[j - ichunk] * tmp_V;
+      if (X->Large.mode == M_MLTPLY) tmp_v0[off] += dmv;
+      dam_pr += conj(tmp_v1[off]) * dmv;
+    }
   }
   
   return dam_pr;
@@ -2210,10 +2173,12 @@ double complex X_child_CisAitCjuAjv_GeneralSpin_MPIsingle(
 							  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
   unsigned long int tmp_off, off, j, idim_max_buf;
-  int origin, ierr, isite, IniSpin, FinSpin;
+  int origin, isite, IniSpin, FinSpin;
   double complex tmp_V, dmv, dam_pr;
-  MPI_Status statusMPI;
   
   if (GetOffCompGeneralSpin((unsigned long int)myrank,
     org_isite3 + 1, org_ispin3, org_ispin4, &off,
@@ -2236,29 +2201,23 @@ double complex X_child_CisAitCjuAjv_GeneralSpin_MPIsingle(
 
   origin = (int)off;
   
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-    &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-    MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+  list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
 
   dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(X, tmp_V, idim_max_buf, IniSpin, FinSpin, isite) private(j, dmv, off, tmp_off) shared (tmp_v0, tmp_v1, list_1buf, v1buf) 
-  for (j = 1; j <= idim_max_buf; j++) {
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) firstprivate(ichunk, nchunk, X, tmp_V, idim_max_buf, IniSpin, FinSpin, isite) private(j, dmv, off, tmp_off) shared (tmp_v0, tmp_v1, list_1buf_p, v1buf_p) 
+    for (j = ichunk; j < ichunk + nchunk; j++) {
 
-    if (GetOffCompGeneralSpin(list_1buf[j], isite, IniSpin, FinSpin, &tmp_off,
-      X->Def.SiteToBit, X->Def.Tpow) == TRUE)
-    {
-      ConvertToList1GeneralSpin(tmp_off, X->Check.sdim, &off);
+      if (GetOffCompGeneralSpin(list_1buf_p[j], isite, IniSpin, FinSpin, &tmp_off,
+        X->Def.SiteToBit, X->Def.Tpow) == TRUE)
+      {
+        ConvertToList1GeneralSpin(tmp_off, X->Check.sdim, &off);
 
-      dmv = v1buf[j] * tmp_V;
-      if (X->Large.mode == M_MLTPLY) tmp_v0[off] += dmv;
-      dam_pr += conj(tmp_v1[off]) * dmv;
+        dmv = v1buf_p[j - ichunk] * tmp_V;
+        if (X->Large.mode == M_MLTPLY) tmp_v0[off] += dmv;
+        dam_pr += conj(tmp_v1[off]) * dmv;
+      }
     }
   }
   
@@ -2283,9 +2242,10 @@ double complex X_GC_child_CisAit_spin_MPIdouble(
 				       double complex *tmp_v1 /**< [in] v0 = H v1*/)
 {
 #ifdef MPI
-  int mask1, state1, ierr, origin;
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
+  int mask1, state1, origin;
   unsigned long int idim_max_buf, j;
-  MPI_Status statusMPI;
   double complex trans, dmv, dam_pr;
   
   mask1 = (int)X->Def.Tpow[org_isite1];
@@ -2305,19 +2265,16 @@ double complex X_GC_child_CisAit_spin_MPIdouble(
     return 0.0;
   }
   
-  ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-		      &idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-		      v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+  mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
 
     dam_pr = 0.0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(idim_max_buf, trans, X) shared(v1buf, tmp_v1, tmp_v0)
-  for (j = 1; j <= X->Check.idim_max ; j++) {
-    dmv = trans * v1buf[j];
-    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-    dam_pr += conj(tmp_v1[j]) * dmv;
+  while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(ichunk, nchunk, idim_max_buf, trans, X) shared(v1buf_p, tmp_v1, tmp_v0)
+    for (j = ichunk; j < ichunk + nchunk; j++) {
+      dmv = trans * v1buf_p[j - ichunk];
+      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+      dam_pr += conj(tmp_v1[j]) * dmv;
+    }
   }
   return (dam_pr);
   
@@ -2648,17 +2605,18 @@ double complex X_GC_child_CisAjtCkuAku_Hubbard_MPI
  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   double complex dam_pr=0.0;
   unsigned long int i_max = X->Check.idim_max;
   unsigned long int idim_max_buf;
-  int iCheck, ierr, Fsgn;
+  int iCheck, Fsgn;
   unsigned long int isite1, isite2, isite3;
   unsigned long int tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4;
   unsigned long int j, Asum, Adiff;
   double complex dmv;
   unsigned long int origin, tmp_off;
   unsigned long int org_rankbit;
-  MPI_Status statusMPI;
 
   iCheck=CheckBit_InterAllPE(org_isite1, org_ispin1, org_isite2, org_ispin2, org_isite3, org_ispin3, org_isite3, org_ispin3, X, (long unsigned int) myrank, &origin);
   isite1 = X->Def.Tpow[2 * org_isite1+ org_ispin1];
@@ -2712,12 +2670,7 @@ double complex X_GC_child_CisAjtCkuAku_Hubbard_MPI
       return dam_pr;
   }//myrank =origin
   else{
-    ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-			&idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-      if(ierr != 0) exitMPI(-1);
-      ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-			v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-      if(ierr != 0) exitMPI(-1);
+    mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
 
       if(org_isite1+1 > X->Def.Nsite && org_isite2+1 > X->Def.Nsite){
       if(isite2 > isite1) Adiff = isite2 - isite1*2;
@@ -2726,40 +2679,46 @@ double complex X_GC_child_CisAjtCkuAku_Hubbard_MPI
       tmp_V *= Fsgn;
       
       if(org_isite3+1 > X->Def.Nsite){
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(idim_max_buf, tmp_V, X) shared(v1buf, tmp_v1, tmp_v0)
-	for (j = 1; j <= idim_max_buf; j++) {
-	  dmv = tmp_V * v1buf[j];
-	  if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-	  dam_pr += conj(tmp_v1[j]) * dmv;
+	while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X) shared(v1buf_p, tmp_v1, tmp_v0)
+	  for (j = ichunk; j < ichunk + nchunk; j++) {
+	    dmv = tmp_V * v1buf_p[j - ichunk];
+	    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+	    dam_pr += conj(tmp_v1[j]) * dmv;
+	  }
 	}
       }
       else{ //org_isite3 <= X->Def.Nsite
 	
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off) firstprivate(idim_max_buf, tmp_V, X, isite3) shared(v1buf, tmp_v1, tmp_v0)
-	for (j = 1; j <= idim_max_buf; j++) {
-	  if(CheckBit_Ajt(isite3, j-1, &tmp_off) == TRUE){
-	    dmv = tmp_V * v1buf[j];
-	    if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-	    dam_pr += conj(tmp_v1[j]) * dmv;
+	while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X, isite3) shared(v1buf_p, tmp_v1, tmp_v0)
+	  for (j = ichunk; j < ichunk + nchunk; j++) {
+	    if(CheckBit_Ajt(isite3, j-1, &tmp_off) == TRUE){
+	      dmv = tmp_V * v1buf_p[j - ichunk];
+	      if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+	      dam_pr += conj(tmp_v1[j]) * dmv;
+	    }
 	  }
 	}
       }
     }
     else{
       org_rankbit=X->Def.OrgTpow[2*X->Def.Nsite]*origin;
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off, Fsgn) firstprivate(idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit) shared(v1buf, tmp_v1, tmp_v0)
-      for (j = 1; j <= idim_max_buf; j++) {
-	/*
-	if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, (j-1)+org_rankbit, &tmp_off)==TRUE){
-	*/
-	if(GetSgnInterAll(tmp_isite4, tmp_isite3, tmp_isite2, tmp_isite1, &Fsgn, X, (j-1)+org_rankbit, &tmp_off)==TRUE){
-	dmv = tmp_V * v1buf[j]*Fsgn;
-	if (X->Large.mode == M_MLTPLY) tmp_v0[tmp_off+1] += dmv;
-	dam_pr += conj(tmp_v1[tmp_off+1]) * dmv;
+      while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off, Fsgn) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit) shared(v1buf_p, tmp_v1, tmp_v0)
+        for (j = ichunk; j < ichunk + nchunk; j++) {
+	  /*
+	  if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, (j-1)+org_rankbit, &tmp_off)==TRUE){
+	  */
+	  if(GetSgnInterAll(tmp_isite4, tmp_isite3, tmp_isite2, tmp_isite1, &Fsgn, X, (j-1)+org_rankbit, &tmp_off)==TRUE){
+	  dmv = tmp_V * v1buf_p[j - ichunk]*Fsgn;
+	  if (X->Large.mode == M_MLTPLY) tmp_v0[tmp_off+1] += dmv;
+	  dam_pr += conj(tmp_v1[tmp_off+1]) * dmv;
 
-	}
-      }      
-    }
+	  }
+        }      
+      }
+      }
   }      
   return dam_pr;
 #endif
@@ -2810,10 +2769,12 @@ double complex X_GC_child_CisAjtCkuAlv_Hubbard_MPI
  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int ichunk, nchunk;
   double complex dam_pr=0;
   unsigned long int i_max = X->Check.idim_max;
   unsigned long int idim_max_buf;
-  int iCheck, ierr, Fsgn;
+  int iCheck, Fsgn;
   unsigned long int isite1, isite2, isite3, isite4;
   unsigned long int tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4;
   unsigned long int j, Adiff, Bdiff;
@@ -2821,7 +2782,6 @@ double complex X_GC_child_CisAjtCkuAlv_Hubbard_MPI
   unsigned long int origin, tmp_off, tmp_off2;
   unsigned long int org_rankbit;
   int iFlgHermite=FALSE;
-  MPI_Status statusMPI;
 
   iCheck=CheckBit_InterAllPE(org_isite1, org_ispin1, org_isite2, org_ispin2,
 			     org_isite3, org_ispin3, org_isite4, org_ispin4,
@@ -2897,12 +2857,7 @@ double complex X_GC_child_CisAjtCkuAlv_Hubbard_MPI
   }//myrank =origin
   else{
     
-    ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-			&idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-      if(ierr != 0) exitMPI(-1);
-      ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-			v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-      if(ierr != 0) exitMPI(-1);
+    mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
 
       if(org_isite1+1 > X->Def.Nsite && org_isite2+1 > X->Def.Nsite
       && org_isite3+1 > X->Def.Nsite && org_isite4+1 > X->Def.Nsite){
@@ -2922,23 +2877,27 @@ double complex X_GC_child_CisAjtCkuAlv_Hubbard_MPI
 	Fsgn *= X_GC_CisAjt(tmp_off2, X, isite1, isite2, (isite1+isite2), Adiff, &tmp_off);
 	tmp_V *=Fsgn;
       }
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(idim_max_buf, tmp_V, X) shared(v1buf, tmp_v1, tmp_v0)
-      for (j = 1; j <= idim_max_buf; j++) {
-	dmv = tmp_V * v1buf[j];
-	if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
-	dam_pr += conj(tmp_v1[j]) * dmv;
+      while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X) shared(v1buf_p, tmp_v1, tmp_v0)
+        for (j = ichunk; j < ichunk + nchunk; j++) {
+	  dmv = tmp_V * v1buf_p[j - ichunk];
+	  if (X->Large.mode == M_MLTPLY) tmp_v0[j] += dmv;
+	  dam_pr += conj(tmp_v1[j]) * dmv;
+        }
       }
     }
     else{
       org_rankbit=X->Def.OrgTpow[2*X->Def.Nsite]*origin;
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off, Fsgn) firstprivate(idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit) shared(v1buf, tmp_v1, tmp_v0)
-      for (j = 1; j <= idim_max_buf; j++) {
+      while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off, Fsgn) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit) shared(v1buf_p, tmp_v1, tmp_v0)
+        for (j = ichunk; j < ichunk + nchunk; j++) {
 	
-	if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, (j-1)+org_rankbit, &tmp_off)==TRUE){
-	dmv = tmp_V * v1buf[j]*Fsgn;
-	if (X->Large.mode == M_MLTPLY) tmp_v0[tmp_off+1] += dmv;
-	dam_pr += conj(tmp_v1[tmp_off+1]) * dmv;
-	}
+	  if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, (j-1)+org_rankbit, &tmp_off)==TRUE){
+	  dmv = tmp_V * v1buf_p[j - ichunk]*Fsgn;
+	  if (X->Large.mode == M_MLTPLY) tmp_v0[tmp_off+1] += dmv;
+	  dam_pr += conj(tmp_v1[tmp_off+1]) * dmv;
+	  }
+        }
       }
     }
   }
@@ -3099,10 +3058,13 @@ double complex X_child_CisAjtCkuAlv_Hubbard_MPI
  double complex *tmp_v1
  ){
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
   double complex dam_pr=0;
   unsigned long int i_max = X->Check.idim_max;
   unsigned long int idim_max_buf;
-  int iCheck, ierr, Fsgn;
+  int iCheck, Fsgn;
   unsigned long int isite1, isite2, isite3, isite4;
   unsigned long int tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4;
   unsigned long int j, Adiff, Bdiff;
@@ -3110,7 +3072,6 @@ double complex X_child_CisAjtCkuAlv_Hubbard_MPI
   unsigned long int origin, tmp_off, tmp_off2;
   unsigned long int org_rankbit, ioff;
   int iFlgHermite=FALSE;
-  MPI_Status statusMPI;
   
   iCheck=CheckBit_InterAllPE(org_isite1, org_ispin1, org_isite2, org_ispin2,
 			     org_isite3, org_ispin3, org_isite4, org_ispin4,
@@ -3187,17 +3148,10 @@ double complex X_child_CisAjtCkuAlv_Hubbard_MPI
   }//myrank =origin
   else{
     //printf("debug: myrank=%d, origin=%d\n", myrank, origin);
-    ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-			&idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+    mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
     
-    ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-			list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
+    list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
     
-    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-			v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-    if(ierr != 0) exitMPI(-1);
 
     if(org_isite1+1 > X->Def.Nsite && org_isite2+1 > X->Def.Nsite
       && org_isite3+1 > X->Def.Nsite && org_isite4+1 > X->Def.Nsite){
@@ -3218,14 +3172,16 @@ double complex X_child_CisAjtCkuAlv_Hubbard_MPI
 	tmp_V *=Fsgn;
       }
       dam_pr=0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, ioff) firstprivate(idim_max_buf, tmp_V, X) shared(v1buf, tmp_v1, tmp_v0, list_2_1, list_2_2, list_1buf)
-      for (j = 1; j <= idim_max_buf; j++) {
-	if(GetOffComp(list_2_1, list_2_2, list_1buf[j], 
-		      X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff)==TRUE){
-	  dmv = tmp_V * v1buf[j];
-	  if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-	  dam_pr += conj(tmp_v1[ioff]) * dmv;
-	}
+      while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, ioff) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X) shared(v1buf_p, tmp_v1, tmp_v0, list_2_1, list_2_2, list_1buf_p)
+        for (j = ichunk; j < ichunk + nchunk; j++) {
+	  if(GetOffComp(list_2_1, list_2_2, list_1buf_p[j], 
+			X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff)==TRUE){
+	    dmv = tmp_V * v1buf_p[j - ichunk];
+	    if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+	    dam_pr += conj(tmp_v1[ioff]) * dmv;
+	  }
+        }
       }
     }//org_isite1+1 > X->Def.Nsite && org_isite2+1 > X->Def.Nsite
      // && org_isite3+1 > X->Def.Nsite && org_isite4+1 > X->Def.Nsite
@@ -3233,18 +3189,20 @@ double complex X_child_CisAjtCkuAlv_Hubbard_MPI
       
       org_rankbit=X->Def.OrgTpow[2*X->Def.Nsite]*origin;
       dam_pr=0;
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off, Fsgn, ioff) firstprivate(idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit, org_isite1, org_ispin1, org_isite2, org_ispin2, org_isite3, org_ispin3, org_isite4, org_ispin4) shared(v1buf, tmp_v1, tmp_v0, list_1buf, list_2_1, list_2_2)
-      for (j = 1; j <= idim_max_buf; j++) {
-	if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, list_1buf[j]+org_rankbit, &tmp_off)==TRUE){
+      while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, tmp_off, Fsgn, ioff) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit, org_isite1, org_ispin1, org_isite2, org_ispin2, org_isite3, org_ispin3, org_isite4, org_ispin4) shared(v1buf_p, tmp_v1, tmp_v0, list_1buf_p, list_2_1, list_2_2)
+        for (j = ichunk; j < ichunk + nchunk; j++) {
+	  if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, list_1buf_p[j]+org_rankbit, &tmp_off)==TRUE){
 	  
-	  if(GetOffComp(list_2_1, list_2_2, tmp_off,
-			X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff)==TRUE){
-	    dmv = tmp_V * v1buf[j]*Fsgn;
-	    if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-	    dam_pr += conj(tmp_v1[ioff]) * dmv;
+	    if(GetOffComp(list_2_1, list_2_2, tmp_off,
+			  X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff)==TRUE){
+	      dmv = tmp_V * v1buf_p[j - ichunk]*Fsgn;
+	      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+	      dam_pr += conj(tmp_v1[ioff]) * dmv;
 	    
+	    }
 	  }
-	}
+        }
       }
       
     }
@@ -3270,17 +3228,19 @@ double complex X_child_CisAjtCkuAku_Hubbard_MPI
  )
 {
 #ifdef MPI
+  double complex *v1buf_p;
+  long unsigned int *list_1buf_p;
+  long unsigned int ichunk, nchunk;
   double complex dam_pr=0.0;
   unsigned long int i_max = X->Check.idim_max;
   unsigned long int idim_max_buf, ioff;
-  int iCheck, ierr, Fsgn;
+  int iCheck, Fsgn;
   unsigned long int isite1, isite2, isite3;
   unsigned long int tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4;
   unsigned long int j, Asum, Adiff;
   double complex dmv;
   unsigned long int origin, tmp_off;
   unsigned long int org_rankbit;
-  MPI_Status statusMPI;
 
   iCheck=CheckBit_InterAllPE(org_isite1, org_ispin1, org_isite2, org_ispin2, org_isite3, org_ispin3, org_isite3, org_ispin3, X, (long unsigned int) myrank, &origin);
   isite1 = X->Def.Tpow[2 * org_isite1+ org_ispin1];
@@ -3333,16 +3293,9 @@ double complex X_child_CisAjtCkuAku_Hubbard_MPI
       return dam_pr;
   }//myrank =origin
   else{
-    ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
-			&idim_max_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-      if(ierr != 0) exitMPI(-1);
-      ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
-    list_1buf, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
-      if(ierr != 0) exitMPI(-1);
+    mltply_plan_Open(X, origin, tmp_v1, &idim_max_buf);
+    list_1buf_p = mltply_plan_List(X, origin, idim_max_buf);
 
-      ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
-			v1buf, idim_max_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
-      if(ierr != 0) exitMPI(-1);
 
       if(org_isite1+1 > X->Def.Nsite && org_isite2+1 > X->Def.Nsite){
       if(isite2 > isite1) Adiff = isite2 - isite1*2;
@@ -3351,46 +3304,52 @@ double complex X_child_CisAjtCkuAku_Hubbard_MPI
       tmp_V *= Fsgn;
       
       if(org_isite3+1 > X->Def.Nsite){
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, ioff, dmv) firstprivate(idim_max_buf, tmp_V, X) shared(v1buf, tmp_v1, tmp_v0, list_1buf, list_2_1, list_2_2)
-	for (j = 1; j <= idim_max_buf; j++) {
-	  dmv = tmp_V * v1buf[j];
-	  GetOffComp(list_2_1, list_2_2, list_1buf[j], 
-		     X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
-	  if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-	  dam_pr += conj(tmp_v1[ioff]) * dmv;
+	while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, ioff, dmv) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X) shared(v1buf_p, tmp_v1, tmp_v0, list_1buf_p, list_2_1, list_2_2)
+	  for (j = ichunk; j < ichunk + nchunk; j++) {
+	    dmv = tmp_V * v1buf_p[j - ichunk];
+	    GetOffComp(list_2_1, list_2_2, list_1buf_p[j], 
+		       X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+	    if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+	    dam_pr += conj(tmp_v1[ioff]) * dmv;
+	  }
 	}
       }
       else{ //org_isite3 <= X->Def.Nsite
 	
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, ioff, dmv, tmp_off) firstprivate(idim_max_buf, tmp_V, X, isite3) shared(v1buf, tmp_v1, tmp_v0,list_1buf, list_2_1, list_2_2)
-	for (j = 1; j <= idim_max_buf; j++) {
-	  if(CheckBit_Ajt(isite3, list_1buf[j], &tmp_off) == TRUE){
-	    dmv = tmp_V * v1buf[j];
-	    GetOffComp(list_2_1, list_2_2, list_1buf[j], 
-		       X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
-	    if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-	    dam_pr += conj(tmp_v1[ioff]) * dmv;
+	while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, ioff, dmv, tmp_off) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X, isite3) shared(v1buf_p, tmp_v1, tmp_v0,list_1buf_p, list_2_1, list_2_2)
+	  for (j = ichunk; j < ichunk + nchunk; j++) {
+	    if(CheckBit_Ajt(isite3, list_1buf_p[j], &tmp_off) == TRUE){
+	      dmv = tmp_V * v1buf_p[j - ichunk];
+	      GetOffComp(list_2_1, list_2_2, list_1buf_p[j], 
+			 X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+	      if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+	      dam_pr += conj(tmp_v1[ioff]) * dmv;
+	    }
 	  }
 	}
       }
     }
     else{
       org_rankbit=X->Def.OrgTpow[2*X->Def.Nsite]*origin;
-#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, ioff, tmp_off, Fsgn) firstprivate(idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit) shared(v1buf, tmp_v1, tmp_v0, list_1buf, list_2_1, list_2_2)
-      for (j = 1; j <= idim_max_buf; j++) {
-	/*
-	if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, list_1buf[j]+org_rankbit, &tmp_off)==TRUE){
-	*/
-	if(GetSgnInterAll(tmp_isite4, tmp_isite3, tmp_isite2, tmp_isite1, &Fsgn, X, list_1buf[j]+org_rankbit, &tmp_off)==TRUE){
-	dmv = tmp_V * v1buf[j]*Fsgn;
-	 GetOffComp(list_2_1, list_2_2, tmp_off,
-        X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
-	if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
-	dam_pr += conj(tmp_v1[ioff]) * dmv;
+      while ((nchunk = mltply_plan_Recv(X, &v1buf_p, &ichunk)) > 0) {
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j, dmv, ioff, tmp_off, Fsgn) firstprivate(ichunk, nchunk, idim_max_buf, tmp_V, X, tmp_isite1, tmp_isite2, tmp_isite3, tmp_isite4, org_rankbit) shared(v1buf_p, tmp_v1, tmp_v0, list_1buf_p, list_2_1, list_2_2)
+        for (j = ichunk; j < ichunk + nchunk; j++) {
+	  /*
+	  if(GetSgnInterAll(tmp_isite3, tmp_isite4, tmp_isite1, tmp_isite2, &Fsgn, X, list_1buf_p[j]+org_rankbit, &tmp_off)==TRUE){
+	  */
+	  if(GetSgnInterAll(tmp_isite4, tmp_isite3, tmp_isite2, tmp_isite1, &Fsgn, X, list_1buf_p[j]+org_rankbit, &tmp_off)==TRUE){
+	  dmv = tmp_V * v1buf_p[j - ichunk]*Fsgn;
+	   GetOffComp(list_2_1, list_2_2, tmp_off,
+          X->Large.irght, X->Large.ilft, X->Large.ihfbit, &ioff);
+	  if (X->Large.mode == M_MLTPLY) tmp_v0[ioff] += dmv;
+	  dam_pr += conj(tmp_v1[ioff]) * dmv;
 
-	}
-      }      
-    }
+	  }
+        }      
+      }
+      }
   }      
   return dam_pr;
 #endif
@@ -0,0 +1,687 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+//
+// Exchange plan for the inter-process terms (mltplyMPI.c).
+// In the first H*v, every exchange of the input vector with another process
+// is recorded. From the next H*v, the vector is sent to each recorded partner
+// once with non-blocking MPI at the beginning of mltply, so that the
+// intra-process part runs while the messages are in flight, and all terms
+// with the same partner (origin = myrank ^ mask) share the received buffer.
+// Partners which do not fit in the memory are exchanged by the blocking
+// MPI_Sendrecv into v1buf as before, or, with ExchangeChunk in modpara,
+// streamed in chunks through a double buffer so that v1buf holds only two
+// chunks instead of a whole vector.
+// The basis of the partner (list_1) in the canonical ensembles does not
+// change during a run, so it is received once and kept for each partner
+// as far as the memory allows.
+// When several processes share a node, v1 is allocated in an MPI-3 shared
+// memory window, and the partners on the same node read it in place; only
+// the partners on the other nodes and the other input vectors go through the
+// exchange above. If all processes are on one node, v1buf holds only two
+// chunks of the pipelined exchange.
+
+#ifdef MPI
+#include "mpi.h"
+#endif
+#include "Common.h"
+#include "mfmemory.h"
+#include "mltplyCSR.h"
+#include "mltplyMPIPlan.h"
+#include "wrapperMPI.h"
+
+static int PlanState = MPIPLAN_RECORD; /**< MPIPLAN_RECORD or MPIPLAN_READY*/
+static int PlanActive = FALSE; /**< TRUE between mltply_plan_Start and mltply_plan_Finish*/
+static double complex *PlanVec = NULL; /**< Input vector of the current H*v*/
+static int NPartner = 0; /**< Number of recorded partners*/
+static int *PartnerIdx = NULL; /**< [nproc] Index of each process in the partner list, or -1*/
+static int *PartnerRank = NULL; /**< [nproc] Rank of the partners*/
+static long unsigned int *PartnerIdim = NULL; /**< [nproc] idim_max of the partners*/
+static long unsigned int *PartnerCount = NULL; /**< [nproc] Number of exchanges with the partners in one H*v*/
+static double complex **PartnerBuf = NULL; /**< [nproc] Received vector, or NULL if the partner is not buffered*/
+static int *PartnerDone = NULL; /**< [nproc] TRUE if the vector from the partner has arrived*/
+#ifdef MPI
+static MPI_Request *ReqSend = NULL; /**< [nproc] Requests of the non-blocking sends*/
+static MPI_Request *ReqRecv = NULL; /**< [nproc] Requests of the non-blocking receives*/
+#endif
+
+static int *ListState = NULL; /**< [nproc] MPIPLAN_LIST_UNKNOWN, MPIPLAN_LIST_CACHED or MPIPLAN_LIST_NOCACHE*/
+static long unsigned int **ListBuf = NULL; /**< [nproc] list_1 of the partners kept by mltply_plan_List*/
+static double ListMem = 0.0; /**< Memory [GB] of ListBuf*/
+static double PlanMem = 0.0; /**< Memory [GB] of PartnerBuf*/
+
+static int StreamOrigin; /**< Partner of the current exchange*/
+static int StreamPartner; /**< Index of the buffered partner of the current exchange, or -1*/
+static double complex *StreamVec; /**< Vector of this process sent to the partner*/
+static double complex *StreamWhole; /**< Whole vector of the partner, or NULL if it is pipelined*/
+static long unsigned int StreamChunk; /**< Number of the elements of a chunk*/
+static long unsigned int StreamIdimSend; /**< idim_max of this process*/
+static long unsigned int StreamIdimRecv; /**< idim_max of the partner*/
+static long unsigned int StreamNSend; /**< Number of the chunks to be sent*/
+static long unsigned int StreamNRecv; /**< Number of the pieces to be received*/
+static long unsigned int StreamISend; /**< Index of the next chunk to be sent*/
+static long unsigned int StreamIRecv; /**< Index of the next piece to be returned*/
+#ifdef MPI
+static MPI_Request StreamReqSend[2]; /**< Requests of the sends in the two slots*/
+static MPI_Request StreamReqRecv[2]; /**< Requests of the receives in the two slots*/
+#endif
+
+static int ShmState = MPIPLAN_SHM_UNKNOWN; /**< MPIPLAN_SHM_UNKNOWN, MPIPLAN_SHM_ON or MPIPLAN_SHM_OFF*/
+static double complex *ShmVec = NULL; /**< Segment of this process in the shared memory window*/
+static double complex **ShmBase = NULL; /**< [nproc] Segment of each process on the same node, or NULL*/
+static long unsigned int *ShmIdim = NULL; /**< [nproc] idim_max of each process on the same node*/
+static int ShmAllNode = FALSE; /**< TRUE if all processes are on the same node*/
+static int StreamShmSync = FALSE; /**< TRUE if the current in-place read needs a handshake at the end*/
+#ifdef MPI
+static MPI_Comm ShmComm; /**< Communicator of the processes on the same node*/
+static MPI_Win ShmWin; /**< Shared memory window holding the input vectors*/
+#endif
+
+/**
+ * @brief Select the partners which are buffered, allocate their buffers
+ * and switch the plan to MPIPLAN_READY. Called by all processes after the first H*v.
+ * A partner is buffered only if the partner buffers this process as well,
+ * i.e. the selection depends only on mask = origin ^ myrank, which is common
+ * to both sides, and on quantities reduced over all processes.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished
+ */
+static int mltply_plan_Build(struct BindStruct *X)
+{
+#ifdef MPI
+  int ipartner, imask, nmask, ibest, nbuf, iflg;
+  long unsigned int nsel, *score, *iselect;
+  double dbuf, davail, dmem;
+
+  /*
+    origin ^ myrank can exceed nproc when it is not a power of 2 (general spin)
+  */
+  nmask = 1;
+  while (nmask < nproc) nmask *= 2;
+  lui_malloc1(score, nmask);
+  lui_malloc1(iselect, nmask);
+  for (imask = 0; imask < nmask; imask++) {
+    score[imask] = 0;
+    iselect[imask] = FALSE;
+  }
+  dbuf = 0.0;
+  for (ipartner = 0; ipartner < NPartner; ipartner++) {
+    score[PartnerRank[ipartner] ^ myrank] = PartnerCount[ipartner];
+    if ((PartnerIdim[ipartner] + 1) * 16.0 / pow(10, 9) > dbuf)
+      dbuf = (PartnerIdim[ipartner] + 1) * 16.0 / pow(10, 9);
+  }
+  MPI_Allreduce(MPI_IN_PLACE, score, nmask, MPI_UNSIGNED_LONG, MPI_MAX, MPI_COMM_WORLD);
+  /*
+    Number of the buffers which fit in the memory of every process
+  */
+  dbuf = MaxMPI_d(dbuf);
+  dmem = X->Check.max_mem + ListMem;
+  if (X->Large.iFlgCSR == TRUE) dmem += X->Large.nnz_CSR * 20.0 / pow(10, 9);
+  davail = -MaxMPI_d(-(mltply_csr_MemBudget(X) - dmem));
+  if (dbuf > 0.0 && davail > 0.0) nsel = (long unsigned int)(davail / dbuf);
+  else nsel = 0;
+  /*
+    Masks with more exchanges first
+  */
+  for (; nsel > 0; nsel--) {
+    ibest = -1;
+    for (imask = 1; imask < nmask; imask++) {
+      if (iselect[imask] == FALSE && score[imask] > 0
+          && (ibest < 0 || score[imask] > score[ibest])) ibest = imask;
+    }
+    if (ibest < 0) break;
+    iselect[ibest] = TRUE;
+  }
+
+  nbuf = 0;
+  iflg = TRUE;
+  dmem = 0.0;
+  for (ipartner = 0; ipartner < NPartner; ipartner++) {
+    PartnerBuf[ipartner] = NULL;
+    if (iselect[PartnerRank[ipartner] ^ myrank] == FALSE) continue;
+    c_malloc1(PartnerBuf[ipartner], PartnerIdim[ipartner] + 1);
+    if (PartnerBuf[ipartner] == NULL) iflg = FALSE;
+    nbuf += 1;
+    dmem += (PartnerIdim[ipartner] + 1) * 16.0 / pow(10, 9);
+  }
+  if (MaxMPI_li(1 - iflg) != 0) {
+    /*Give up buffering on all processes to keep the plan symmetric*/
+    for (ipartner = 0; ipartner < NPartner; ipartner++) {
+      if (PartnerBuf[ipartner] != NULL) free(PartnerBuf[ipartner]);
+      PartnerBuf[ipartner] = NULL;
+    }
+    nbuf = 0;
+    dmem = 0.0;
+  }
+
+  PlanMem = dmem;
+  fprintf(stdoutMPI, "  MPI exchange plan: %lu partners, %lu buffered (%lf GB).\n",
+          MaxMPI_li(NPartner), MaxMPI_li(nbuf), MaxMPI_d(dmem));
+  free(score);
+  free(iselect);
+#endif
+  PlanState = MPIPLAN_READY;
+  return 0;
+}
+
+/**
+ * @brief Allocate the tables of the partners at the first use.
+ */
+static void mltply_plan_Init()
+{
+#ifdef MPI
+  int ipartner;
+
+  if (PartnerIdx != NULL) return;
+  i_malloc1(PartnerIdx, nproc);
+  i_malloc1(PartnerRank, nproc);
+  lui_malloc1(PartnerIdim, nproc);
+  lui_malloc1(PartnerCount, nproc);
+  i_malloc1(PartnerDone, nproc);
+  i_malloc1(ListState, nproc);
+  PartnerBuf = (double complex **)malloc(sizeof(double complex *) * nproc);
+  ListBuf = (long unsigned int **)malloc(sizeof(long unsigned int *) * nproc);
+  ReqSend = (MPI_Request *)malloc(sizeof(MPI_Request) * nproc);
+  ReqRecv = (MPI_Request *)malloc(sizeof(MPI_Request) * nproc);
+  for (ipartner = 0; ipartner < nproc; ipartner++) {
+    PartnerIdx[ipartner] = -1;
+    PartnerBuf[ipartner] = NULL;
+    ListState[ipartner] = MPIPLAN_LIST_UNKNOWN;
+    ListBuf[ipartner] = NULL;
+  }
+  NPartner = 0;
+#endif
+}
+
+/**
+ * @brief Allocate v1 as the segment of this process in the shared memory window
+ * of the processes on the same node. Called by all processes in setmem_large.
+ * The window replaces the usual allocation of v1, so that it takes no extra memory.
+ *
+ * @param X
+ *
+ * @return the segment (idim_max + 1 elements), or NULL if the window is not used
+ */
+double complex *mltply_plan_ShmAlloc(struct BindStruct *X)
+{
+  ShmState = MPIPLAN_SHM_OFF;
+#ifdef MPI
+#if MPI_VERSION >= 3
+  int inode, nnode, ileader, iproc, idisp, ierr;
+  int *inodeinfo;
+  MPI_Aint wsize;
+  MPI_Info info;
+  double complex *wbase;
+
+  if (nproc == 1) return NULL;
+  ierr = MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, myrank, MPI_INFO_NULL, &ShmComm);
+  if (ierr != 0) exitMPI(-1);
+  MPI_Comm_size(ShmComm, &nnode);
+  MPI_Comm_rank(ShmComm, &inode);
+  fprintf(stdoutMPI, "  MPI shared memory window: up to %lu processes per node.\n", MaxMPI_li(nnode));
+  if (MaxMPI_li(nnode) < 2) {
+    MPI_Comm_free(&ShmComm);
+    return NULL;
+  }
+  /*
+    Node of each process (rank of the first process on the node) and its rank on the node
+  */
+  ileader = myrank;
+  MPI_Bcast(&ileader, 1, MPI_INT, 0, ShmComm);
+  i_malloc1(inodeinfo, 2 * nproc);
+  inodeinfo[2 * myrank] = ileader;
+  inodeinfo[2 * myrank + 1] = inode;
+  MPI_Allgather(MPI_IN_PLACE, 2, MPI_INT, inodeinfo, 2, MPI_INT, MPI_COMM_WORLD);
+  /*
+    Each segment is placed by the first touch of its own process
+  */
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "alloc_shared_noncontig", "true");
+  wsize = (MPI_Aint)(sizeof(double complex) * (X->Check.idim_max + 1));
+  ierr = MPI_Win_allocate_shared(wsize, sizeof(double complex), info, ShmComm, &ShmVec, &ShmWin);
+  MPI_Info_free(&info);
+  if (ierr != 0) exitMPI(-1);
+  ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK, ShmWin);
+  if (ierr != 0) exitMPI(-1);
+  ShmBase = (double complex **)malloc(sizeof(double complex *) * nproc);
+  lui_malloc1(ShmIdim, nproc);
+  for (iproc = 0; iproc < nproc; iproc++) {
+    ShmBase[iproc] = NULL;
+    ShmIdim[iproc] = 0;
+    if (iproc == myrank || inodeinfo[2 * iproc] != ileader) continue;
+    ierr = MPI_Win_shared_query(ShmWin, inodeinfo[2 * iproc + 1], &wsize, &idisp, &wbase);
+    if (ierr != 0) exitMPI(-1);
+    ShmBase[iproc] = wbase;
+    ShmIdim[iproc] = wsize / sizeof(double complex) - 1;
+  }
+  free(inodeinfo);
+  ShmAllNode = (nnode == nproc) ? TRUE : FALSE;
+  ShmState = MPIPLAN_SHM_ON;
+  return ShmVec;
+#endif
+#endif
+  return NULL;
+}
+
+#ifdef MPI
+/**
+ * @brief Zero-byte exchange with the process @p origin. Outside mltply, it makes
+ * the segment of the partner complete before it is read in place, and keeps it
+ * unchanged until it has been read.
+ *
+ * @param origin rank of the partner
+ */
+static void mltply_plan_ShmHandshake(int origin)
+{
+#if MPI_VERSION >= 3
+  int ierr;
+  MPI_Status statusMPI;
+
+  MPI_Win_sync(ShmWin);
+  ierr = MPI_Sendrecv(NULL, 0, MPI_BYTE, origin, D_MPIShmTag,
+                      NULL, 0, MPI_BYTE, origin, D_MPIShmTag, MPI_COMM_WORLD, &statusMPI);
+  if (ierr != 0) exitMPI(-1);
+  MPI_Win_sync(ShmWin);
+#endif
+}
+#endif
+
+/**
+ * @brief Begin H*v. With a ready plan, the input vector is sent to all buffered
+ * partners and their vectors are received without blocking.
+ *
+ * @param X
+ * @param tmp_v1 [in] input vector of H*v
+ *
+ * @retval 0 normally finished
+ */
+int mltply_plan_Start(struct BindStruct *X, double complex *tmp_v1)
+{
+#ifdef MPI
+  int ipartner, ierr;
+
+  if (nproc == 1) return 0;
+  mltply_plan_Init();
+  PlanActive = TRUE;
+  PlanVec = tmp_v1;
+#if MPI_VERSION >= 3
+  if (ShmState == MPIPLAN_SHM_ON && tmp_v1 == ShmVec) {
+    /*
+      The partners on the same node read v1 in place until mltply_plan_Finish
+    */
+    MPI_Win_sync(ShmWin);
+    MPI_Barrier(ShmComm);
+    MPI_Win_sync(ShmWin);
+  }
+#endif
+  if (PlanState != MPIPLAN_READY) return 0;
+
+  for (ipartner = 0; ipartner < NPartner; ipartner++) {
+    PartnerDone[ipartner] = FALSE;
+    if (PartnerBuf[ipartner] == NULL) continue;
+    ierr = MPI_Irecv(PartnerBuf[ipartner], PartnerIdim[ipartner] + 1, MPI_DOUBLE_COMPLEX,
+                     PartnerRank[ipartner], D_MPIPlanTag, MPI_COMM_WORLD, &ReqRecv[ipartner]);
+    if (ierr != 0) exitMPI(-1);
+    ierr = MPI_Isend(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX,
+                     PartnerRank[ipartner], D_MPIPlanTag, MPI_COMM_WORLD, &ReqSend[ipartner]);
+    if (ierr != 0) exitMPI(-1);
+  }
+#endif
+  return 0;
+}
+
+/**
+ * @brief Number of the elements of a chunk in the pipelined exchange.
+ *
+ * @param X
+ *
+ * @return ExchangeChunk [MB] in modpara converted to the elements, or 0 if the
+ * vectors are exchanged at once
+ */
+long unsigned int mltply_plan_ChunkSize(struct BindStruct *X)
+{
+  long unsigned int nchunk;
+
+  if (X->Def.ExchangeChunk <= 0.0) {
+    /*
+      v1buf has only two chunks when all partners read v1 in place
+    */
+    if (ShmState == MPIPLAN_SHM_ON && ShmAllNode == TRUE) return D_MPIShmChunk;
+    return 0;
+  }
+  nchunk = (long unsigned int)(X->Def.ExchangeChunk * pow(10, 6) / sizeof(double complex));
+  if (nchunk < 1) nchunk = 1;
+  return nchunk;
+}
+
+#ifdef MPI
+/**
+ * @brief Send the chunk @p isend of the vector of this process.
+ * The send of the chunk @p isend - 2 in the same slot is completed first.
+ *
+ * @param isend index of the chunk
+ */
+static void mltply_plan_StreamSend(long unsigned int isend)
+{
+  int ierr, islot;
+  long unsigned int ioff, nsend;
+  MPI_Status statusMPI;
+
+  islot = isend % 2;
+  ierr = MPI_Wait(&StreamReqSend[islot], &statusMPI);
+  if (ierr != 0) exitMPI(-1);
+  ioff = isend * StreamChunk;
+  nsend = StreamIdimSend - ioff;
+  if (nsend > StreamChunk) nsend = StreamChunk;
+  ierr = MPI_Isend(StreamVec + 1 + ioff, nsend, MPI_DOUBLE_COMPLEX,
+                   StreamOrigin, D_MPIStreamTag, MPI_COMM_WORLD, &StreamReqSend[islot]);
+  if (ierr != 0) exitMPI(-1);
+  StreamISend = isend + 1;
+}
+
+/**
+ * @brief Post the receive of the chunk @p irecv of the partner into the slot @p irecv % 2 of v1buf.
+ *
+ * @param irecv index of the chunk
+ */
+static void mltply_plan_StreamPostRecv(long unsigned int irecv)
+{
+  int ierr, islot;
+  long unsigned int ioff, nrecv;
+
+  islot = irecv % 2;
+  ioff = irecv * StreamChunk;
+  nrecv = StreamIdimRecv - ioff;
+  if (nrecv > StreamChunk) nrecv = StreamChunk;
+  ierr = MPI_Irecv(v1buf + islot * StreamChunk, nrecv, MPI_DOUBLE_COMPLEX,
+                   StreamOrigin, D_MPIStreamTag, MPI_COMM_WORLD, &StreamReqRecv[islot]);
+  if (ierr != 0) exitMPI(-1);
+}
+#endif
+
+/**
+ * @brief Begin the exchange of the vectors with the process @p origin for an inter-process term.
+ * The vector of the partner is read piece by piece with mltply_plan_Recv.
+ * If the partner is on the same node and the vector is v1, it is read in place in the shared memory window.
+ * If the partner is buffered in the current H*v, its vector has been posted by mltply_plan_Start.
+ * Otherwise, the vectors are exchanged at once with MPI_Sendrecv into v1buf,
+ * or, if ExchangeChunk is given in modpara, pipelined in chunks through two slots of v1buf.
+ * Both processes must call this function for the same term.
+ *
+ * @param X
+ * @param origin rank of the partner
+ * @param tmp_v1 [in] vector of this process
+ * @param idim_max_buf [out] idim_max of the partner. If NULL, the partner has the same idim_max.
+ *
+ * @retval 0 normally finished
+ */
+int mltply_plan_Open(struct BindStruct *X, int origin,
+                     double complex *tmp_v1, long unsigned int *idim_max_buf)
+{
+#ifdef MPI
+  int ipartner, ierr;
+  long unsigned int idim_buf;
+  MPI_Status statusMPI;
+
+  ipartner = -1;
+  if (PlanActive == TRUE && tmp_v1 == PlanVec) ipartner = PartnerIdx[origin];
+
+  StreamOrigin = origin;
+  StreamVec = tmp_v1;
+  StreamIRecv = 0;
+  StreamISend = 0;
+  StreamNSend = 0;
+  StreamPartner = -1;
+  StreamShmSync = FALSE;
+  StreamReqSend[0] = StreamReqSend[1] = MPI_REQUEST_NULL;
+  StreamReqRecv[0] = StreamReqRecv[1] = MPI_REQUEST_NULL;
+
+  if (ShmState == MPIPLAN_SHM_ON && tmp_v1 == ShmVec && ShmBase[origin] != NULL) {
+    if (PlanActive == FALSE) {
+      mltply_plan_ShmHandshake(origin);
+      StreamShmSync = TRUE;
+    }
+    StreamWhole = ShmBase[origin];
+    StreamIdimRecv = ShmIdim[origin];
+    StreamNRecv = 1;
+    if (idim_max_buf != NULL) *idim_max_buf = StreamIdimRecv;
+    return 0;
+  }
+
+  if (PlanState == MPIPLAN_READY && ipartner >= 0 && PartnerBuf[ipartner] != NULL) {
+    StreamPartner = ipartner;
+    StreamWhole = PartnerBuf[ipartner];
+    StreamIdimRecv = PartnerIdim[ipartner];
+    StreamNRecv = 1;
+    if (idim_max_buf != NULL) *idim_max_buf = StreamIdimRecv;
+    return 0;
+  }
+
+  if (idim_max_buf != NULL) {
+    ierr = MPI_Sendrecv(&X->Check.idim_max, 1, MPI_UNSIGNED_LONG, origin, 0,
+                        &idim_buf, 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
+    if (ierr != 0) exitMPI(-1);
+    *idim_max_buf = idim_buf;
+  }
+  else idim_buf = X->Check.idim_max;
+  StreamIdimSend = X->Check.idim_max;
+  StreamIdimRecv = idim_buf;
+  /*
+    Record the partner in the first H*v
+  */
+  if (PlanActive == TRUE && PlanState == MPIPLAN_RECORD && tmp_v1 == PlanVec) {
+    if (PartnerIdx[origin] < 0) {
+      PartnerIdx[origin] = NPartner;
+      PartnerRank[NPartner] = origin;
+      PartnerIdim[NPartner] = idim_buf;
+      PartnerCount[NPartner] = 0;
+      NPartner += 1;
+    }
+    PartnerCount[PartnerIdx[origin]] += 1;
+  }
+
+  StreamChunk = mltply_plan_ChunkSize(X);
+  if (StreamChunk == 0) {
+    ierr = MPI_Sendrecv(tmp_v1, X->Check.idim_max + 1, MPI_DOUBLE_COMPLEX, origin, 0,
+                        v1buf, idim_buf + 1, MPI_DOUBLE_COMPLEX, origin, 0, MPI_COMM_WORLD, &statusMPI);
+    if (ierr != 0) exitMPI(-1);
+    StreamWhole = v1buf;
+    StreamNRecv = 1;
+    return 0;
+  }
+  /*
+    Pipelined exchange: two chunks are in flight in each direction
+  */
+  StreamWhole = NULL;
+  StreamNSend = (StreamIdimSend + StreamChunk - 1) / StreamChunk;
+  StreamNRecv = (StreamIdimRecv + StreamChunk - 1) / StreamChunk;
+  if (StreamNRecv > 0) mltply_plan_StreamPostRecv(0);
+  if (StreamNRecv > 1) mltply_plan_StreamPostRecv(1);
+  if (StreamNSend > 0) mltply_plan_StreamSend(0);
+  if (StreamNSend > 1) mltply_plan_StreamSend(1);
+#endif
+  return 0;
+}
+
+/**
+ * @brief Get the next piece of the vector of the partner opened by mltply_plan_Open.
+ * The previous piece must not be used after this call.
+ * When all pieces have been read, the remaining sends are completed and 0 is returned.
+ *
+ * @param X
+ * @param v1buf_p [out] the piece; v1buf_p[j - ichunk] is the component j of the partner
+ * @param ichunk [out] index of the first component in the piece
+ *
+ * @return number of the components in the piece, or 0 at the end
+ */
+long unsigned int mltply_plan_Recv(struct BindStruct *X, double complex **v1buf_p, long unsigned int *ichunk)
+{
+  long unsigned int nrecv = 0;
+#ifdef MPI
+  int ierr, islot;
+  long unsigned int irecv;
+  MPI_Status statusMPI;
+
+  irecv = StreamIRecv;
+  if (irecv >= StreamNRecv) {
+    /*
+      Complete the sends of this process
+    */
+    while (StreamISend < StreamNSend) mltply_plan_StreamSend(StreamISend);
+    for (islot = 0; islot < 2; islot++) {
+      ierr = MPI_Wait(&StreamReqSend[islot], &statusMPI);
+      if (ierr != 0) exitMPI(-1);
+    }
+    if (StreamShmSync == TRUE) {
+      mltply_plan_ShmHandshake(StreamOrigin);
+      StreamShmSync = FALSE;
+    }
+    return 0;
+  }
+  StreamIRecv = irecv + 1;
+
+  if (StreamWhole != NULL) {
+    if (StreamPartner >= 0 && PartnerDone[StreamPartner] == FALSE) {
+      ierr = MPI_Wait(&ReqRecv[StreamPartner], &statusMPI);
+      if (ierr != 0) exitMPI(-1);
+      PartnerDone[StreamPartner] = TRUE;
+    }
+    *v1buf_p = StreamWhole + 1;
+    *ichunk = 1;
+    return StreamIdimRecv;
+  }
+
+  if (irecv >= 1) {
+    /*
+      The slot of the chunk irecv - 1 is free
+    */
+    if (irecv + 1 < StreamNRecv) mltply_plan_StreamPostRecv(irecv + 1);
+    while (StreamISend <= irecv + 1 && StreamISend < StreamNSend) mltply_plan_StreamSend(StreamISend);
+  }
+  islot = irecv % 2;
+  ierr = MPI_Wait(&StreamReqRecv[islot], &statusMPI);
+  if (ierr != 0) exitMPI(-1);
+
+  *v1buf_p = v1buf + islot * StreamChunk;
+  *ichunk = 1 + irecv * StreamChunk;
+  nrecv = StreamIdimRecv - irecv * StreamChunk;
+  if (nrecv > StreamChunk) nrecv = StreamChunk;
+#endif
+  return nrecv;
+}
+
+/**
+ * @brief Get list_1 of the process @p origin for an inter-process term in the canonical ensembles.
+ * At the first call for each partner, both processes exchange their list_1
+ * and keep the received one if the memory allows on both sides.
+ * Otherwise it is exchanged into list_1buf at every call as before.
+ * Both processes must call this function for the same term.
+ *
+ * @param X
+ * @param origin rank of the partner
+ * @param idim_max_buf idim_max of the partner
+ *
+ * @return pointer to list_1 of the partner
+ */
+long unsigned int *mltply_plan_List(struct BindStruct *X, int origin, long unsigned int idim_max_buf)
+{
+#ifdef MPI
+  int ierr, iflg, iflg_buf;
+  long unsigned int *list_1_p;
+  double dmem;
+  MPI_Status statusMPI;
+
+  mltply_plan_Init();
+  if (ListState[origin] == MPIPLAN_LIST_CACHED) return ListBuf[origin];
+
+  list_1_p = list_1buf;
+  if (ListState[origin] == MPIPLAN_LIST_UNKNOWN) {
+    /*
+      Keep the list only if both processes can
+    */
+    dmem = X->Check.max_mem + ListMem + PlanMem + (idim_max_buf + 1) * 8.0 / pow(10, 9);
+    if (X->Large.iFlgCSR == TRUE) dmem += X->Large.nnz_CSR * 20.0 / pow(10, 9);
+    iflg = (dmem <= mltply_csr_MemBudget(X)) ? TRUE : FALSE;
+    if (iflg == TRUE) {
+      lui_malloc1(ListBuf[origin], idim_max_buf + 1);
+      if (ListBuf[origin] == NULL) iflg = FALSE;
+    }
+    ierr = MPI_Sendrecv(&iflg, 1, MPI_INT, origin, 0,
+                        &iflg_buf, 1, MPI_INT, origin, 0, MPI_COMM_WORLD, &statusMPI);
+    if (ierr != 0) exitMPI(-1);
+    if (iflg == TRUE && iflg_buf == TRUE) {
+      ListState[origin] = MPIPLAN_LIST_CACHED;
+      ListMem += (idim_max_buf + 1) * 8.0 / pow(10, 9);
+      list_1_p = ListBuf[origin];
+    }
+    else {
+      ListState[origin] = MPIPLAN_LIST_NOCACHE;
+      if (ListBuf[origin] != NULL) free(ListBuf[origin]);
+      ListBuf[origin] = NULL;
+    }
+  }
+  ierr = MPI_Sendrecv(list_1, X->Check.idim_max + 1, MPI_UNSIGNED_LONG, origin, 0,
+                      list_1_p, idim_max_buf + 1, MPI_UNSIGNED_LONG, origin, 0, MPI_COMM_WORLD, &statusMPI);
+  if (ierr != 0) exitMPI(-1);
+  return list_1_p;
+#else
+  return list_1buf;
+#endif
+}
+
+/**
+ * @brief End H*v. All non-blocking communications are completed.
+ * After the first H*v, the plan is built.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished
+ */
+int mltply_plan_Finish(struct BindStruct *X)
+{
+#ifdef MPI
+  int ipartner, ierr;
+  MPI_Status statusMPI;
+
+  if (PlanActive == FALSE) return 0;
+  PlanActive = FALSE;
+#if MPI_VERSION >= 3
+  /*
+    v1 of this process is overwritten after H*v
+    only when all partners on the node have read it.
+  */
+  if (ShmState == MPIPLAN_SHM_ON && PlanVec == ShmVec) MPI_Barrier(ShmComm);
+#endif
+  PlanVec = NULL;
+  if (PlanState == MPIPLAN_RECORD) return mltply_plan_Build(X);
+
+  for (ipartner = 0; ipartner < NPartner; ipartner++) {
+    if (PartnerBuf[ipartner] == NULL) continue;
+    if (PartnerDone[ipartner] == FALSE) {
+      ierr = MPI_Wait(&ReqRecv[ipartner], &statusMPI);
+      if (ierr != 0) exitMPI(-1);
+      PartnerDone[ipartner] = TRUE;
+    }
+    ierr = MPI_Wait(&ReqSend[ipartner], &statusMPI);
+    if (ierr != 0) exitMPI(-1);
+  }
+#endif
+  return 0;
+}
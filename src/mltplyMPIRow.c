@@ -0,0 +1,520 @@
+/* HPhi  -  Quantum Lattice Model Simulator */
+/* Copyright (C) 2015 The University of Tokyo */
+
+/* This program is free software: you can redistribute it and/or modify */
+/* it under the terms of the GNU General Public License as published by */
+/* the Free Software Foundation, either version 3 of the License, or */
+/* (at your option) any later version. */
+
+/* This program is distributed in the hope that it will be useful, */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+/* GNU General Public License for more details. */
+
+/* You should have received a copy of the GNU General Public License */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+//Define Mode for mltply
+// complex version
+//
+// Rows distributed over the processes (CheckMPI_Row).
+// When the number of processes does not match the inter-process sites, all
+// sites stay in each process and the sector is split into contiguous blocks
+// of rows with balanced idim_max. list_2_1 and list_2_2 give the index in the
+// whole sector, so that the stored Hamiltonian (mltplyCSR.c) is built with
+// the global column indices. mltply_row_Init keeps the columns of this
+// process in list_CSR_* with the local index, and moves the others into a
+// second CSR matrix over the components received from the other processes.
+// In each H*v, these components are exchanged by one MPI_Ialltoallv, which
+// is in flight while mltply_csr applies the local part.
+// The Green's functions gather the components of the other processes in the
+// same way for each operator (mltply_row_Expec).
+
+#include <stdlib.h>
+#ifdef MPI
+#include "mpi.h"
+#endif
+#include <bitcalc.h>
+#include "mfmemory.h"
+#include "mltplyMPIRow.h"
+#include "wrapperMPI.h"
+
+static long unsigned int *RowFirst = NULL; /**< [nproc+1] First row (index in the whole sector) of each process. RowFirst[nproc] is idim_maxMPI+1.*/
+static long unsigned int *RowGhostPtr = NULL; /**< [i_max+2] Elements of the row j on the other processes are [RowGhostPtr[j], RowGhostPtr[j+1]).*/
+static unsigned int *RowGhostIdx = NULL; /**< Position of the column of each element in RowRecvBuf.*/
+static double complex *RowGhostVal = NULL; /**< Matrix element of each element.*/
+static long unsigned int RowNRecv = 0; /**< Number of the components received in each H*v.*/
+static long unsigned int RowNSend = 0; /**< Number of the components sent in each H*v.*/
+static long unsigned int *RowSendIdx = NULL; /**< [RowNSend] Local index of the components sent.*/
+static int *RowCountRecv = NULL; /**< [nproc] Number of the components received from each process.*/
+static int *RowDisplRecv = NULL; /**< [nproc] Offset of them in RowRecvBuf.*/
+static int *RowCountSend = NULL; /**< [nproc] Number of the components sent to each process.*/
+static int *RowDisplSend = NULL; /**< [nproc] Offset of them in RowSendBuf.*/
+static double complex *RowSendBuf = NULL; /**< [RowNSend] Components sent.*/
+static double complex *RowRecvBuf = NULL; /**< [RowNRecv] Components received, in the ascending order of the index.*/
+#ifdef MPI
+static MPI_Request RowReq; /**< Request of the exchange in flight.*/
+#endif
+
+/**
+ * @brief Comparison of two indices for qsort.
+ */
+static int mltply_row_Compare(const void *a, const void *b)
+{
+  long unsigned int ia = *(const long unsigned int *)a, ib = *(const long unsigned int *)b;
+  return (ia > ib) - (ia < ib);
+}
+
+/**
+ * @brief Position of the index @p idx in the sorted list @p ireq.
+ *
+ * @param nreq number of the indices
+ * @param ireq [nreq] indices in the ascending order
+ * @param idx index in the list
+ *
+ * @return position of @p idx
+ */
+static long unsigned int mltply_row_Find(long unsigned int nreq, const long unsigned int *ireq, long unsigned int idx)
+{
+  long unsigned int ilow, ihigh, imid;
+
+  ilow = 0;
+  ihigh = nreq;
+  while (ihigh - ilow > 1) {
+    imid = (ilow + ihigh) / 2;
+    if (ireq[imid] <= idx) ilow = imid;
+    else ihigh = imid;
+  }
+  return ilow;
+}
+
+/**
+ * @brief Build the exchange of the components of a vector: this process receives
+ * the components @p ireq from their owners, and sends those requested by the others.
+ * Called by all processes.
+ *
+ * @param X
+ * @param nreq number of the requested components
+ * @param ireq [nreq] indices in the whole sector on the other processes, in the ascending order
+ * @param countrecv [out] [nproc] number of the components received from each process
+ * @param displrecv [out] [nproc] offset of them
+ * @param countsend [out] [nproc] number of the components sent to each process
+ * @param displsend [out] [nproc] offset of them
+ * @param isend [out] local index of the components sent (allocated here)
+ *
+ * @return number of the components sent
+ */
+static long unsigned int mltply_row_Connect(
+  struct BindStruct *X,
+  long unsigned int nreq,
+  long unsigned int *ireq,
+  int *countrecv, int *displrecv,
+  int *countsend, int *displsend,
+  long unsigned int **isend
+  )
+{
+  long unsigned int nsend, ireq_i;
+  int iproc;
+#ifdef MPI
+  int ierr;
+#endif
+
+  for (iproc = 0; iproc < nproc; iproc++) countrecv[iproc] = 0;
+  iproc = 0;
+  for (ireq_i = 0; ireq_i < nreq; ireq_i++) {
+    while (ireq[ireq_i] >= RowFirst[iproc + 1]) iproc++;
+    countrecv[iproc] += 1;
+  }
+#ifdef MPI
+  ierr = MPI_Alltoall(countrecv, 1, MPI_INT, countsend, 1, MPI_INT, MPI_COMM_WORLD);
+  if (ierr != 0) exitMPI(-1);
+#else
+  countsend[0] = countrecv[0];
+#endif
+  nsend = 0;
+  for (iproc = 0; iproc < nproc; iproc++) {
+    displrecv[iproc] = (iproc == 0) ? 0 : displrecv[iproc - 1] + countrecv[iproc - 1];
+    displsend[iproc] = (int)nsend;
+    nsend += countsend[iproc];
+  }
+  lui_malloc1(*isend, nsend + 1);
+  if (*isend == NULL) {
+    fprintf(stdoutMPI, "%s", cErrMPIRowMalloc);
+    exitMPI(-1);
+  }
+#ifdef MPI
+  ierr = MPI_Alltoallv(ireq, countrecv, displrecv, MPI_UNSIGNED_LONG,
+                       *isend, countsend, displsend, MPI_UNSIGNED_LONG, MPI_COMM_WORLD);
+  if (ierr != 0) exitMPI(-1);
+#endif
+  for (ireq_i = 0; ireq_i < nsend; ireq_i++) (*isend)[ireq_i] -= X->Large.RowOffset;
+  return nsend;
+}
+
+/**
+ * @brief Gather the components @p ireq of @p vec from the other processes.
+ * Called by all processes.
+ *
+ * @param X
+ * @param nreq number of the requested components
+ * @param ireq [nreq] indices in the whole sector on the other processes, in the ascending order
+ * @param vec [in] vector distributed by rows
+ * @param vrecv [out] [nreq] components
+ */
+static void mltply_row_Gather(
+  struct BindStruct *X,
+  long unsigned int nreq,
+  long unsigned int *ireq,
+  double complex *vec,
+  double complex *vrecv
+  )
+{
+  long unsigned int nsend, isend_i, *isend;
+  int *countrecv, *displrecv, *countsend, *displsend;
+  double complex *vsend;
+#ifdef MPI
+  int ierr;
+#endif
+
+  i_malloc1(countrecv, nproc);
+  i_malloc1(displrecv, nproc);
+  i_malloc1(countsend, nproc);
+  i_malloc1(displsend, nproc);
+  nsend = mltply_row_Connect(X, nreq, ireq, countrecv, displrecv, countsend, displsend, &isend);
+  c_malloc1(vsend, nsend + 1);
+  if (vsend == NULL) {
+    fprintf(stdoutMPI, "%s", cErrMPIRowMalloc);
+    exitMPI(-1);
+  }
+#pragma omp parallel for default(none) private(isend_i) firstprivate(nsend) shared(vsend, vec, isend)
+  for (isend_i = 0; isend_i < nsend; isend_i++) vsend[isend_i] = vec[isend[isend_i]];
+#ifdef MPI
+  ierr = MPI_Alltoallv(vsend, countsend, displsend, MPI_DOUBLE_COMPLEX,
+                       vrecv, countrecv, displrecv, MPI_DOUBLE_COMPLEX, MPI_COMM_WORLD);
+  if (ierr != 0) exitMPI(-1);
+#endif
+  free(vsend);
+  free(isend);
+  free(countrecv);
+  free(displrecv);
+  free(countsend);
+  free(displsend);
+}
+
+/**
+ * @brief Split the stored Hamiltonian into the columns of this process and those of the others,
+ * and build the exchange of H*v. Called by mltply_csr_Init after list_CSR_* are filled
+ * with the indices in the whole sector.
+ *
+ * @param X
+ *
+ * @retval 0 normally finished
+ * @retval -1 unnormally finished
+ */
+int mltply_row_Init(struct BindStruct *X)
+{
+  long unsigned int i_max, ifirst, ilast, j, ielem, jelem, iout, nout, nreq, ireq_i, nnz, *ireq;
+  int iReal, iflg;
+#ifdef MPI
+  int ierr;
+#endif
+
+  i_max = X->Check.idim_max;
+  ifirst = X->Large.RowOffset + 1;
+  ilast = X->Large.RowOffset + i_max;
+  iReal = (list_CSR_val_r != NULL);
+
+  lui_malloc1(RowFirst, nproc + 1);
+  RowFirst[myrank] = ifirst;
+#ifdef MPI
+  ierr = MPI_Allgather(MPI_IN_PLACE, 1, MPI_UNSIGNED_LONG, RowFirst, 1, MPI_UNSIGNED_LONG, MPI_COMM_WORLD);
+  if (ierr != 0) exitMPI(-1);
+#endif
+  RowFirst[nproc] = X->Check.idim_maxMPI + 1;
+
+  /*
+    Count the elements in the columns of the other processes
+  */
+  lui_malloc1(RowGhostPtr, i_max + 2);
+  RowGhostPtr[0] = 0;
+  RowGhostPtr[1] = 0;
+#pragma omp parallel for default(none) private(j, ielem, nout) firstprivate(i_max, ifirst, ilast) \
+shared(RowGhostPtr, list_CSR_ptr, list_CSR_idx)
+  for (j = 1; j <= i_max; j++) {
+    nout = 0;
+    for (ielem = list_CSR_ptr[j]; ielem < list_CSR_ptr[j + 1]; ielem++) {
+      if (list_CSR_idx[ielem] < ifirst || list_CSR_idx[ielem] > ilast) nout++;
+    }
+    RowGhostPtr[j + 1] = nout;
+  }
+  for (j = 1; j <= i_max; j++) RowGhostPtr[j + 1] += RowGhostPtr[j];
+  nout = RowGhostPtr[i_max + 1];
+
+  /*
+    Components received: their indices in the ascending order without duplicates
+  */
+  lui_malloc1(ireq, nout + 1);
+  ui_malloc1(RowGhostIdx, nout + 1);
+  c_malloc1(RowGhostVal, nout + 1);
+  iflg = (ireq != NULL && RowGhostIdx != NULL && RowGhostVal != NULL);
+  if (MaxMPI_li(1 - iflg) != 0) {
+    fprintf(stdoutMPI, "%s", cErrMPIRowMalloc);
+    return -1;
+  }
+#pragma omp parallel for default(none) private(j, ielem, iout) firstprivate(i_max, ifirst, ilast) \
+shared(RowGhostPtr, list_CSR_ptr, list_CSR_idx, ireq)
+  for (j = 1; j <= i_max; j++) {
+    iout = RowGhostPtr[j];
+    for (ielem = list_CSR_ptr[j]; ielem < list_CSR_ptr[j + 1]; ielem++) {
+      if (list_CSR_idx[ielem] < ifirst || list_CSR_idx[ielem] > ilast) ireq[iout++] = list_CSR_idx[ielem];
+    }
+  }
+  qsort(ireq, nout, sizeof(long unsigned int), mltply_row_Compare);
+  nreq = 0;
+  for (ireq_i = 0; ireq_i < nout; ireq_i++) {
+    if (nreq == 0 || ireq[ireq_i] != ireq[nreq - 1]) ireq[nreq++] = ireq[ireq_i];
+  }
+
+  /*
+    Move the elements in the columns of the other processes,
+    and renumber those of this process by the local index
+  */
+#pragma omp parallel for default(none) private(j, ielem, iout) firstprivate(i_max, ifirst, ilast, nreq, iReal) \
+shared(RowGhostPtr, RowGhostIdx, RowGhostVal, list_CSR_ptr, list_CSR_idx, list_CSR_val, list_CSR_val_r, ireq)
+  for (j = 1; j <= i_max; j++) {
+    iout = RowGhostPtr[j];
+    for (ielem = list_CSR_ptr[j]; ielem < list_CSR_ptr[j + 1]; ielem++) {
+      if (list_CSR_idx[ielem] >= ifirst && list_CSR_idx[ielem] <= ilast) continue;
+      RowGhostIdx[iout] = (unsigned int)mltply_row_Find(nreq, ireq, list_CSR_idx[ielem]);
+      RowGhostVal[iout] = (iReal == TRUE) ? list_CSR_val_r[ielem] : list_CSR_val[ielem];
+      iout++;
+    }
+  }
+  jelem = 0;
+  for (j = 1; j <= i_max; j++) {
+    ielem = list_CSR_ptr[j];
+    list_CSR_ptr[j] = jelem;
+    for (; ielem < list_CSR_ptr[j + 1]; ielem++) {
+      if (list_CSR_idx[ielem] < ifirst || list_CSR_idx[ielem] > ilast) continue;
+      list_CSR_idx[jelem] = list_CSR_idx[ielem] - X->Large.RowOffset;
+      if (iReal == TRUE) list_CSR_val_r[jelem] = list_CSR_val_r[ielem];
+      else list_CSR_val[jelem] = list_CSR_val[ielem];
+      jelem++;
+    }
+  }
+  list_CSR_ptr[i_max + 1] = jelem;
+  nnz = X->Large.nnz_CSR;
+  X->Large.nnz_CSR = jelem;
+
+  /*
+    Exchange of H*v
+  */
+  RowNRecv = nreq;
+  i_malloc1(RowCountRecv, nproc);
+  i_malloc1(RowDisplRecv, nproc);
+  i_malloc1(RowCountSend, nproc);
+  i_malloc1(RowDisplSend, nproc);
+  RowNSend = mltply_row_Connect(X, nreq, ireq, RowCountRecv, RowDisplRecv, RowCountSend, RowDisplSend, &RowSendIdx);
+  free(ireq);
+  c_malloc1(RowSendBuf, RowNSend + 1);
+  c_malloc1(RowRecvBuf, RowNRecv + 1);
+  iflg = (RowSendBuf != NULL && RowRecvBuf != NULL);
+  if (MaxMPI_li(1 - iflg) != 0) {
+    fprintf(stdoutMPI, "%s", cErrMPIRowMalloc);
+    return -1;
+  }
+
+  fprintf(stdoutMPI, cLogMPIRowCSR, SumMPI_li(nout), SumMPI_li(nnz), SumMPI_li(RowNRecv));
+  return 0;
+}
+
+/**
+ * @brief Send the components of @p tmp_v1 requested by the other processes.
+ * The exchange is completed by mltply_row_Finish.
+ *
+ * @param X
+ * @param tmp_v1 [in] input vector of H*v
+ *
+ * @retval 0 normally finished
+ */
+int mltply_row_Start(struct BindStruct *X, double complex *tmp_v1)
+{
+  long unsigned int nsend, isend_i;
+#ifdef MPI
+  int ierr;
+#endif
+
+  nsend = RowNSend;
+#pragma omp parallel for default(none) private(isend_i) firstprivate(nsend) shared(RowSendBuf, RowSendIdx, tmp_v1)
+  for (isend_i = 0; isend_i < nsend; isend_i++) RowSendBuf[isend_i] = tmp_v1[RowSendIdx[isend_i]];
+#ifdef MPI
+#if MPI_VERSION >= 3
+  ierr = MPI_Ialltoallv(RowSendBuf, RowCountSend, RowDisplSend, MPI_DOUBLE_COMPLEX,
+                        RowRecvBuf, RowCountRecv, RowDisplRecv, MPI_DOUBLE_COMPLEX, MPI_COMM_WORLD, &RowReq);
+#else
+  ierr = MPI_Alltoallv(RowSendBuf, RowCountSend, RowDisplSend, MPI_DOUBLE_COMPLEX,
+                       RowRecvBuf, RowCountRecv, RowDisplRecv, MPI_DOUBLE_COMPLEX, MPI_COMM_WORLD);
+#endif
+  if (ierr != 0) exitMPI(-1);
+#endif
+  return 0;
+}
+
+/**
+ * @brief Wait for the components started by mltply_row_Start and add the elements
+ * in the columns of the other processes: tmp_v0 += H_other tmp_v1.
+ * X->Large.prdct is incremented by their contribution to <tmp_v1|H|tmp_v1>.
+ *
+ * @param X
+ * @param tmp_v0 [in,out] result vector
+ * @param tmp_v1 [in] input vector
+ *
+ * @retval 0 normally finished
+ */
+int mltply_row_Finish(struct BindStruct *X, double complex *tmp_v0, double complex *tmp_v1)
+{
+  long unsigned int i_max, j, ielem;
+  double complex dam_pr, dmv;
+#ifdef MPI
+#if MPI_VERSION >= 3
+  int ierr;
+  MPI_Status statusMPI;
+
+  ierr = MPI_Wait(&RowReq, &statusMPI);
+  if (ierr != 0) exitMPI(-1);
+#endif
+#endif
+
+  i_max = X->Check.idim_max;
+  dam_pr = 0.0;
+#pragma omp parallel for default(none) reduction(+:dam_pr) schedule(static) private(j, ielem, dmv) \
+firstprivate(i_max) shared(tmp_v0, tmp_v1, RowGhostPtr, RowGhostIdx, RowGhostVal, RowRecvBuf)
+  for (j = 1; j <= i_max; j++) {
+    if (RowGhostPtr[j] == RowGhostPtr[j + 1]) continue;
+    dmv = 0.0;
+    for (ielem = RowGhostPtr[j]; ielem < RowGhostPtr[j + 1]; ielem++) {
+      dmv += RowGhostVal[ielem] * RowRecvBuf[RowGhostIdx[ielem]];
+    }
+    tmp_v0[j] += dmv;
+    dam_pr += conj(tmp_v1[j]) * dmv;
+  }
+
+  X->Large.prdct += dam_pr;
+  return 0;
+}
+
+/**
+ * @brief Contribution of the rows of this process to the expectation value of
+ * c^+_{1} c_{2} c^+_{3} c_{4}, where the image of a row may be on another process.
+ * When isite3 == 0, that of c^+_{1} c_{2} is calculated.
+ * Called by all processes; the sum over the processes is taken by the caller.
+ *
+ * @param X
+ * @param isite1 site indices (1 origin) and spins of the four operators
+ * @param vec state distributed by rows
+ *
+ * @return sum over the rows j of this process of conj(vec[k]) <k|c^+_{1} c_{2} c^+_{3} c_{4}|j> vec[j]
+ *
+ * @note In the Kondo model, the image with an empty or a doubly occupied local spin is not in the sector.
+ */
+double complex mltply_row_Expec(
+  struct BindStruct *X,
+  long unsigned int isite1, long unsigned int sigma1,
+  long unsigned int isite2, long unsigned int sigma2,
+  long unsigned int isite3, long unsigned int sigma3,
+  long unsigned int isite4, long unsigned int sigma4,
+  double complex *vec
+  )
+{
+  long unsigned int i_max, ifirst, ilast, idim, j, ibit, nout, iout, nreq;
+  long unsigned int irght, ilft, ihfbit, locmask, isite;
+  long unsigned int site[4], spin[4], *ioff, *ireq;
+  int nop, *isgn;
+  double complex dam_pr, *vrecv;
+
+  site[0] = isite1 - 1;
+  site[1] = isite2 - 1;
+  site[2] = isite3 - 1;
+  site[3] = isite4 - 1;
+  spin[0] = sigma1;
+  spin[1] = sigma2;
+  spin[2] = sigma3;
+  spin[3] = sigma4;
+  nop = (isite3 == 0) ? 2 : 4;
+  i_max = X->Check.idim_max;
+  ifirst = X->Large.RowOffset + 1;
+  ilast = X->Large.RowOffset + i_max;
+  idim = X->Check.idim_maxMPI;
+  if (GetSplitBitByModel(X->Def.Nsite, X->Def.iCalcModel, &irght, &ilft, &ihfbit) != 0) {
+    exitMPI(-1);
+  }
+  /*Up-spin bit of each local spin*/
+  locmask = 0;
+  if (X->Def.iCalcModel == Kondo) {
+    for (isite = 0; isite < X->Def.Nsite; isite++) {
+      if (X->Def.LocSpn[isite] != ITINERANT) locmask |= 1ul << (2 * isite);
+    }
+  }
+
+  /*
+    Image of each row and its index in the whole sector (0 if the image vanishes)
+  */
+  lui_malloc1(ioff, i_max + 1);
+  i_malloc1(isgn, i_max + 1);
+  if (MaxMPI_li(ioff == NULL || isgn == NULL) != 0) {
+    fprintf(stdoutMPI, "%s", cErrMPIRowMalloc);
+    exitMPI(-1);
+  }
+  nout = 0;
+#pragma omp parallel for default(none) reduction(+:nout) private(j, ibit) \
+firstprivate(i_max, ifirst, ilast, idim, irght, ilft, ihfbit, nop, site, spin, locmask, X) shared(list_1, list_2_1, list_2_2, ioff, isgn)
+  for (j = 1; j <= i_max; j++) {
+    ibit = list_1[j];
+    isgn[j] = OperatorBit(X, nop, site, spin, &ibit);
+    ioff[j] = 0;
+    if (isgn[j] == 0) continue;
+    if (((ibit ^ (ibit >> 1)) & locmask) != locmask) continue;
+    GetOffComp(list_2_1, list_2_2, ibit, irght, ilft, ihfbit, &ioff[j]);
+    if (ioff[j] > idim) ioff[j] = 0;
+    if (ioff[j] != 0 && (ioff[j] < ifirst || ioff[j] > ilast)) nout++;
+  }
+
+  /*
+    Components of the other processes
+  */
+  lui_malloc1(ireq, nout + 1);
+  c_malloc1(vrecv, nout + 1);
+  if (MaxMPI_li(ireq == NULL || vrecv == NULL) != 0) {
+    fprintf(stdoutMPI, "%s", cErrMPIRowMalloc);
+    exitMPI(-1);
+  }
+  iout = 0;
+  for (j = 1; j <= i_max; j++) {
+    if (ioff[j] != 0 && (ioff[j] < ifirst || ioff[j] > ilast)) ireq[iout++] = ioff[j];
+  }
+  qsort(ireq, nout, sizeof(long unsigned int), mltply_row_Compare);
+  nreq = 0;
+  for (iout = 0; iout < nout; iout++) {
+    if (nreq == 0 || ireq[iout] != ireq[nreq - 1]) ireq[nreq++] = ireq[iout];
+  }
+  mltply_row_Gather(X, nreq, ireq, vec, vrecv);
+
+  dam_pr = 0.0;
+#pragma omp parallel for default(none) reduction(+:dam_pr) private(j) \
+firstprivate(i_max, ifirst, ilast, nreq, X) shared(vec, vrecv, ioff, isgn, ireq)
+  for (j = 1; j <= i_max; j++) {
+    if (ioff[j] == 0) continue;
+    if (ioff[j] >= ifirst && ioff[j] <= ilast) {
+      dam_pr += conj(vec[ioff[j] - X->Large.RowOffset]) * (double)isgn[j] * vec[j];
+    }
+    else {
+      dam_pr += conj(vrecv[mltply_row_Find(nreq, ireq, ioff[j])]) * (double)isgn[j] * vec[j];
+    }
+  }
+
+  free(ioff);
+  free(isgn);
+  free(ireq);
+  free(vrecv);
+  return dam_pr;
+}
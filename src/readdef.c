@@ -59,7 +59,8 @@ static char cKWListOfFileNameList[][D_CharTmpReadDef]={
   "Ising",
   "Boost",
   "SingleExcitation",
-  "PairExcitation"
+  "PairExcitation",
+  "TransSym"
 };
 
 int D_iKWNumDef = sizeof(cKWListOfFileNameList)/sizeof(cKWListOfFileNameList[0]);
@@ -212,6 +213,11 @@ int ReadcalcmodFile(
   X->iOutputEigenVec=0;
   X->iInputEigenVec=0;
   X->iOutputHam=0;
+  X->iMltplyMode=MLTPLY_FUSED;
+  X->iTPQPrecision=TPQ_DOUBLE;
+  X->iSpinFlip=SPINFLIP_NONE;
+  X->iBasisCache=BASISCACHE_OFF;
+  X->iLanczosBasis=LANCZOSBASIS_RECOMPUTE;
   /*=======================================================================*/
   fp = fopenMPI(defname, "r");
   if(fp==NULL) return ReadDefFileError(defname);
@@ -248,6 +254,21 @@ int ReadcalcmodFile(
     else if(CheckWords(ctmp, "OutputHam")==0){
       X->iOutputHam=itmp;
     }
+    else if(CheckWords(ctmp, "MltplyMode")==0){
+      X->iMltplyMode=itmp;
+    }
+    else if(CheckWords(ctmp, "TPQPrecision")==0){
+      X->iTPQPrecision=itmp;
+    }
+    else if(CheckWords(ctmp, "SpinFlip")==0){
+      X->iSpinFlip=itmp;
+    }
+    else if(CheckWords(ctmp, "BasisCache")==0){
+      X->iBasisCache=itmp;
+    }
+    else if(CheckWords(ctmp, "LanczosBasis")==0){
+      X->iLanczosBasis=itmp;
+    }
     else{
       fprintf(stdoutMPI, cErrDefFileParam, defname, ctmp);
       return(-1);
@@ -282,6 +303,31 @@ int ReadcalcmodFile(
     return (-1);
   }
 
+  if(ValidateValue(X->iMltplyMode, 0, NUM_MLTPLYMODE-1)){
+    fprintf(stdoutMPI, cErrMltplyMode, defname);
+    return (-1);
+  }
+
+  if(ValidateValue(X->iTPQPrecision, 0, NUM_TPQPRECISION-1)){
+    fprintf(stdoutMPI, cErrTPQPrecision, defname);
+    return (-1);
+  }
+
+  if(ValidateValue(X->iSpinFlip, SPINFLIP_ODD, SPINFLIP_EVEN)){
+    fprintf(stdoutMPI, cErrSpinFlip, defname);
+    return (-1);
+  }
+
+  if(ValidateValue(X->iBasisCache, 0, NUM_BASISCACHE-1)){
+    fprintf(stdoutMPI, cErrBasisCache, defname);
+    return (-1);
+  }
+
+  if(ValidateValue(X->iLanczosBasis, 0, NUM_LANCZOSBASIS-1)){
+    fprintf(stdoutMPI, cErrLanczosBasis, defname);
+    return (-1);
+  }
+
   /* In the case of Full Diagonalization method(iCalcType=2)*/
   if(X->iCalcType==2 && ValidateValue(X->iFlgFiniteTemperature, 0, 1)){
     fprintf(stdoutMPI, cErrFiniteTemp, defname);
@@ -447,6 +493,12 @@ int ReadDefFileNInt(
       double dtmp;
       
       X->read_hacker=0;
+      X->MaxMem=0.0;
+      X->ExchangeChunk=0.0;
+      X->LOBPCGBlock=0;
+      X->ThickRestartBasis=0;
+      X->ThickRestartKeep=0;
+      X->NUMAReport=0;
       while(fgetsMPI(ctmp2, 256, fp)!=NULL){
         if(*ctmp2 == '\n') continue;
         sscanf(ctmp2,"%s %lf\n", ctmp, &dtmp);
@@ -498,6 +550,24 @@ int ReadDefFileNInt(
         else if(CheckWords(ctmp, "CalcHS")==0){
           X->read_hacker=(int)dtmp;
         }
+        else if(CheckWords(ctmp, "MaxMem")==0){
+          X->MaxMem=dtmp;
+        }
+        else if(CheckWords(ctmp, "ExchangeChunk")==0){
+          X->ExchangeChunk=dtmp;
+        }
+        else if(CheckWords(ctmp, "LOBPCGBlock")==0){
+          X->LOBPCGBlock=(int)dtmp;
+        }
+        else if(CheckWords(ctmp, "ThickRestartBasis")==0){
+          X->ThickRestartBasis=(int)dtmp;
+        }
+        else if(CheckWords(ctmp, "ThickRestartKeep")==0){
+          X->ThickRestartKeep=(int)dtmp;
+        }
+        else if(CheckWords(ctmp, "NUMAReport")==0){
+          X->NUMAReport=(int)dtmp;
+        }
         else{
           return(-1);
         }
@@ -599,6 +669,12 @@ int ReadDefFileNInt(
       sscanf(ctmp2,"%ld %ld %ld %ld\n", &(xBoost->W0), &(xBoost->R0), &(xBoost->num_pivot), &(xBoost->ishift_nspin));
 
       break;
+    case KWTransSym:
+      /* Read qptransidx.def------------------------------------*/
+      fgetsMPI(ctmp, sizeof(ctmp)/sizeof(char), fp);
+      fgetsMPI(ctmp2, 256, fp);
+      sscanf(ctmp2,"%s %d\n", ctmp, &(X->NTransSym));
+      break;
 
     default:
       fprintf(stdoutMPI, "%s", cErrIncorrectDef);
@@ -1320,6 +1396,42 @@ int ReadDefFileIdxPara(
 
       break;
 
+    case KWTransSym:
+      /*qptransidx.def--------------------------------*/
+      if(X->NTransSym>0){
+        //characters of the symmetry operations
+        for(idx=0; idx<X->NTransSym; idx++){
+          if(fgetsMPI(ctmp2, 256, fp) == NULL){
+            fclose(fp);
+            return ReadDefFileError(defname);
+          }
+          sscanf(ctmp2, "%d %lf %lf\n", &itmp, &dvalue_re, &dvalue_im);
+          if(itmp<0 || itmp>=X->NTransSym){
+            fclose(fp);
+            return ReadDefFileError(defname);
+          }
+          X->ParaTransSym[itmp]=dvalue_re+I*dvalue_im;
+        }
+        //site permutations
+        for(idx=0; idx<X->NTransSym; idx++){
+          for(itmp=0; itmp<X->Nsite; itmp++) X->TransSymSite[idx][itmp]=-1;
+        }
+        for(idx=0; idx<X->NTransSym*X->Nsite; idx++){
+          if(fgetsMPI(ctmp2, 256, fp) == NULL){
+            fclose(fp);
+            return ReadDefFileError(defname);
+          }
+          sscanf(ctmp2, "%d %d %d\n", &itmp, &isite1, &isite2);
+          if(itmp<0 || itmp>=X->NTransSym || isite1<0 || isite2<0
+             || CheckPairSite(isite1, isite2, X->Nsite) !=0){
+            fclose(fp);
+            return ReadDefFileError(defname);
+          }
+          X->TransSymSite[itmp][isite1]=isite2;
+        }
+      }
+      break;
+
     default:
       break;
     }
@@ -2111,6 +2223,7 @@ void InitializeInteractionNum
   X->NInterAll=0;
   X->NCisAjt=0;
   X->NCisAjtCkuAlvDC=0;
+  X->NTransSym=0;
 }
 
 /** 
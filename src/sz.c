@@ -18,6 +18,8 @@
 #include "mfmemory.h"
 #include "FileIO.h"
 #include "sz.h"
+#include "TransSym.h"
+#include "BasisCache.h"
 #include "wrapperMPI.h"
 
 /**
@@ -35,6 +37,290 @@
  * 
  */
 
+/*
+  The basis is built in three passes for the canonical models:
+  (1) the number of states in each block of the upper half bits ib is counted in parallel
+      from the binomial table, (2) list_jb is obtained by the prefix sum of the counts,
+  (3) each block is filled in parallel at list_jb[ib].
+  Therefore list_1 does not depend on the number of threads.
+*/
+
+/**
+ * @brief Store the state of the index @p icnt (1 origin) in the whole sector.
+ * When the rows are distributed over the processes (CheckMPI_Row),
+ * only the block of this process is kept, at icnt - RowOffset.
+ *
+ * @param X
+ * @param icnt index in the whole sector
+ * @param ibit state
+ */
+static inline void sz_Store(struct BindStruct *X, long unsigned int icnt, long unsigned int ibit){
+  if(icnt - 1 - X->Large.RowOffset < X->Check.idim_max) list_1[icnt - X->Large.RowOffset] = ibit;
+}
+
+/**
+ * @brief Wall clock time used for the startup report.
+ *
+ * @return time in seconds
+ */
+static double sz_WallTime(void){
+#ifdef _OPENMP
+  return omp_get_wtime();
+#else
+  return (double)clock()/CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * @brief Name of the model shown in the startup report.
+ *
+ * @param iCalcModel
+ *
+ * @return name of the model
+ */
+static const char *sz_ModelName(int iCalcModel){
+  switch(iCalcModel){
+  case Hubbard: return "Hubbard";
+  case HubbardNConserved: return "HubbardNConserved";
+  case HubbardGC: return "HubbardGC";
+  case Kondo: return "Kondo";
+  case KondoGC: return "KondoGC";
+  case Spin: return "Spin";
+  case SpinGC: return "SpinGC";
+  default: return "Unknown";
+  }
+}
+
+/**
+ * @brief Replace the counts in list_jb by their exclusive prefix sum.
+ *
+ * @param nib number of blocks
+ *
+ * @return total number of states
+ */
+static long unsigned int sz_PrefixSum(long unsigned int nib){
+  long unsigned int ib, jb, tmp;
+  jb = 0;
+  for(ib=0;ib<nib;ib++){
+    tmp = list_jb[ib];
+    list_jb[ib] = jb;
+    jb += tmp;
+  }
+  return jb;
+}
+
+/**
+ * @brief Number of bits of the lower half.
+ *
+ * @param ihfbit a half bit to split the state
+ *
+ * @return n such that 2^n = ihfbit
+ */
+static int sz_NumBit(long unsigned int ihfbit){
+  int n=0;
+  while((1ul<<n) < ihfbit) n++;
+  return n;
+}
+
+/**
+ * @brief Masks of the local spins in the lower half for the Kondo model.
+ *
+ * @param ib upper half bits
+ * @param ihfbit a half bit to split the state
+ * @param X
+ * @param locmask [out] up bits of the local spins which lie in the lower half
+ * @param midbit [out] lower bit of the local spin on the boundary (odd Nsite), or 0
+ */
+static void sz_KondoMask(
+  long unsigned int ib, long unsigned int ihfbit, struct BindStruct *X,
+  long unsigned int *locmask, long unsigned int *midbit)
+{
+  int j;
+  *locmask = 0;
+  *midbit  = 0;
+  for(j=0;j<(X->Def.Nsite+1)/2;j++){
+    if(X->Def.LocSpn[j] == ITINERANT) continue;
+    if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
+      *midbit = X->Def.Tpow[X->Def.Nsite-1];
+    }
+    else{
+      *locmask |= X->Def.Tpow[2*j];
+    }
+  }
+}
+
+/**
+ * @brief Number of states in the block ib for Hubbard and HubbardNConserved.
+ *
+ * @param ib upper half bits
+ * @param ihfbit a half bit to split the state
+ * @param N2 number of bits
+ * @param comb binomial table filled by Binomial(Nsite, 0, comb, Nsite)
+ * @param X
+ *
+ * @return number of states
+ */
+static long unsigned int sz_CountHubbard(
+  long unsigned int ib, long unsigned int ihfbit, int N2, long int **comb, struct BindStruct *X)
+{
+  long unsigned int i, j, div, num_up, num_down, jb;
+  int tmp_res, all_up, all_down, iSpnup, iMinup, iAllup;
+
+  i=ib*ihfbit;
+  num_up=0;
+  for(j=0;j<=N2-2;j+=2){
+    div=i & X->Def.Tpow[j];
+    div=div/X->Def.Tpow[j];
+    num_up+=div;
+  }
+  num_down=0;
+  for(j=1;j<=N2-1;j+=2){
+    div=i & X->Def.Tpow[j];
+    div=div/X->Def.Tpow[j];
+    num_down+=div;
+  }
+  tmp_res  = X->Def.Nsite%2; // even Ns-> 0, odd Ns -> 1
+  all_up   = (X->Def.Nsite+tmp_res)/2;
+  all_down = (X->Def.Nsite-tmp_res)/2;
+
+  if(X->Def.iCalcModel==Hubbard){
+    return BinomialTable(all_up, X->Def.Nup-(int)num_up, comb)
+      *BinomialTable(all_down, X->Def.Ndown-(int)num_down, comb);
+  }
+  iMinup=0;
+  iAllup=X->Def.Ne;
+  if(X->Def.Ne > X->Def.Nsite){
+    iMinup = X->Def.Ne-X->Def.Nsite;
+    iAllup = X->Def.Nsite;
+  }
+  jb=0;
+  for(iSpnup=iMinup; iSpnup<= iAllup; iSpnup++){
+    jb += BinomialTable(all_up, iSpnup-(int)num_up, comb)
+      *BinomialTable(all_down, X->Def.Ne-iSpnup-(int)num_down, comb);
+  }
+  return jb;
+}
+
+/**
+ * @brief Number of states in the block ib for the Kondo model.
+ *
+ * @param ib upper half bits
+ * @param ihfbit a half bit to split the state
+ * @param num_loc number of local spins in the upper half
+ * @param comb binomial table filled by Binomial(Nsite, 0, comb, Nsite)
+ * @param X
+ *
+ * @return number of states
+ */
+static long unsigned int sz_CountKondo(
+  long unsigned int ib, long unsigned int ihfbit, long unsigned int num_loc, long int **comb, struct BindStruct *X)
+{
+  long unsigned int i, j, div_up, div_down, num_up, num_down, jb;
+  int icheck_loc, tmp_res, all_loc, all_up, all_down, num_loc_up;
+
+  i=ib*ihfbit;
+  num_up=0;
+  num_down=0;
+  icheck_loc=1;
+  for(j=X->Def.Nsite/2; j< X->Def.Nsite ;j++){
+    div_up    = i & X->Def.Tpow[2*j];
+    div_up    = div_up/X->Def.Tpow[2*j];
+    div_down  = i & X->Def.Tpow[2*j+1];
+    div_down  = div_down/X->Def.Tpow[2*j+1];
+    num_up   += div_up;
+    num_down += div_down;
+    if(X->Def.LocSpn[j] != ITINERANT){
+      if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
+        if(div_down ==0){
+          num_up += 1;
+        }
+      }
+      else{
+        icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
+      }
+    }
+  }
+  if(icheck_loc != 1) return 0;
+
+  tmp_res  = X->Def.Nsite%2; // even Ns-> 0, odd Ns -> 1
+  all_loc =  X->Def.NLocSpn-num_loc;
+  all_up   = (X->Def.Nsite+tmp_res)/2-all_loc;
+  all_down = (X->Def.Nsite-tmp_res)/2-all_loc;
+  if(X->Def.Nsite%2==1 && X->Def.LocSpn[X->Def.Nsite/2] != ITINERANT){
+    all_up   = (X->Def.Nsite)/2-all_loc;
+    all_down = (X->Def.Nsite)/2-all_loc;
+  }
+  jb=0;
+  for(num_loc_up=0; num_loc_up <= all_loc; num_loc_up++){
+    jb += BinomialTable(all_loc, num_loc_up, comb)
+      *BinomialTable(all_up, X->Def.Nup-(int)num_up-num_loc_up, comb)
+      *BinomialTable(all_down, X->Def.Ndown-(int)num_down-(all_loc-num_loc_up), comb);
+  }
+  return jb;
+}
+
+/**
+ * @brief Number of states in the block ib for the KondoGC model.
+ *
+ * @param ib upper half bits
+ * @param ihfbit a half bit to split the state
+ * @param num_loc number of local spins in the upper half
+ * @param X
+ *
+ * @return number of states
+ */
+static long unsigned int sz_CountKondoGC(
+  long unsigned int ib, long unsigned int ihfbit, long unsigned int num_loc, struct BindStruct *X)
+{
+  long unsigned int i, j, div_up, div_down;
+  int icheck_loc;
+
+  i=ib*ihfbit;
+  icheck_loc=1;
+  for(j=(X->Def.Nsite+1)/2; j< X->Def.Nsite ;j++){
+    div_up    = i & X->Def.Tpow[2*j];
+    div_up    = div_up/X->Def.Tpow[2*j];
+    div_down  = i & X->Def.Tpow[2*j+1];
+    div_down  = div_down/X->Def.Tpow[2*j+1];
+    if(X->Def.LocSpn[j] != ITINERANT){
+      if(!(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2))){
+        icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
+      }
+    }
+  }
+  if(icheck_loc != 1) return 0;
+  if(X->Def.Nsite%2==1 && X->Def.LocSpn[X->Def.Nsite/2] != ITINERANT){
+    return X->Def.Tpow[X->Def.Nsite-1-(X->Def.NLocSpn-num_loc)];
+  }
+  return X->Def.Tpow[X->Def.Nsite-(X->Def.NLocSpn-num_loc)];
+}
+
+/**
+ * @brief Number of states in the block ib for the spin-1/2 Spin model.
+ *
+ * @param ib upper half bits
+ * @param ihfbit a half bit to split the state
+ * @param N number of bits
+ * @param comb binomial table filled by Binomial(Nsite, 0, comb, Nsite)
+ * @param X
+ *
+ * @return number of states
+ */
+static long unsigned int sz_CountSpin(
+  long unsigned int ib, long unsigned int ihfbit, int N, long int **comb, struct BindStruct *X)
+{
+  long unsigned int i, j, div_up, num_up;
+
+  i=ib*ihfbit;
+  num_up=0;
+  for(j=0;j<N; j++){
+    div_up = i & X->Def.Tpow[j];
+    div_up = div_up/X->Def.Tpow[j];
+    num_up +=div_up;
+  }
+  return BinomialTable((X->Def.Nsite+1)/2, X->Def.Ne-(int)num_up, comb);
+}
+
 /** 
  * 
  * 
@@ -52,33 +338,27 @@ int sz
   FILE *fp,*fp_err;
   char sdt[D_FileNameMax],sdt_err[D_FileNameMax];
     
-  long unsigned int i,icnt; 
+  long unsigned int icnt; 
   long unsigned int ib,jb;
     
   long unsigned int j;
-  long unsigned int div;
-  long unsigned int num_up,num_down;
   long unsigned int irght,ilft,ihfbit;
 
   //*[s] for omp parall
-  int  all_up,all_down,tmp_res,num_threads;
-  long unsigned int tmp_1,tmp_2,tmp_3;
+  int num_threads;
   int mfint[7];
   long int **comb;
   //*[e] for omp parall
 
   // [s] for Kondo
   int N_all_up, N_all_down;
-  int all_loc;
-  long unsigned int num_loc, div_down;
-  int num_loc_up;
-  int icheck_loc;
-  int ihfSpinDown=0;
+  long unsigned int num_loc;
   // [e] for Kondo
     
-  long unsigned int i_max;
+  long unsigned int i_max, idim_all;
   double idim=0.0;
-  long unsigned int div_up;
+  double time_sz;
+  int iCacheHit;
 
 // hacker
   int hacker;
@@ -87,12 +367,11 @@ int sz
   long unsigned int ibpatn=0;
 //hacker
 
-  int iSpnup, iMinup,iAllup;
-
   int N2=0;
   int N=0;
   fprintf(stdoutMPI, "%s", cProStartCalcSz);
   TimeKeeper(X, cFileNameSzTimeKeep, cInitalSz, "w");
+  iCacheHit = BasisCacheReadBasis(X);
 
   if(X->Check.idim_max!=0){
  
@@ -127,7 +406,10 @@ int sz
     break;
   }
   li_malloc2(comb, X->Def.Nsite+1,X->Def.Nsite+1);
+  Binomial(X->Def.Nsite, 0, comb, X->Def.Nsite);
   i_max=X->Check.idim_max;
+  //The whole sector is counted when the rows are distributed
+  idim_all=(X->Large.iFlgMPIRow==TRUE) ? X->Check.idim_maxMPI : X->Check.idim_max;
   
   switch(X->Def.iCalcModel){
   case HubbardNConserved:
@@ -158,6 +440,9 @@ int sz
       exitMPI(-1);
     }
   }
+  else if(iCacheHit==TRUE){
+    i_max=idim_all;
+  }
   else{ 
     sprintf(sdt, cFileNameSzTimeKeep, X->Def.CDataFileHead);
     #ifdef _OPENMP
@@ -172,6 +457,7 @@ int sz
     //*[s] omp parallel
 
     TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzStart, "a");
+    time_sz = sz_WallTime();
     
     switch(X->Def.iCalcModel){
     case HubbardGC:
@@ -188,46 +474,21 @@ int sz
       break;
       
     case KondoGC:
-   // this part can not be parallelized
-      jb = 0;
       num_loc=0;
       for(j=X->Def.Nsite/2; j< X->Def.Nsite ;j++){
 	if(X->Def.LocSpn[j] != ITINERANT){
 	  num_loc += 1;
 	}
       }
-
+#pragma omp parallel for default(none) private(ib) firstprivate(ihfbit, num_loc, X) shared(list_jb)
       for(ib=0;ib<X->Check.sdim;ib++){
-	list_jb[ib]=jb;
-	i=ib*ihfbit;
-	icheck_loc=1;
-	
-	for(j=(X->Def.Nsite+1)/2; j< X->Def.Nsite ;j++){
-	  div_up    = i & X->Def.Tpow[2*j];
-	  div_up    = div_up/X->Def.Tpow[2*j];
-	  div_down  = i & X->Def.Tpow[2*j+1];
-	  div_down  = div_down/X->Def.Tpow[2*j+1];
-
-	  if(X->Def.LocSpn[j] != ITINERANT){
-	     if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
-	      icheck_loc= icheck_loc;
-	    }
-	     else{
-	       icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
-	     }
-	  }
-	}
-	if(icheck_loc == 1){
-	  if(X->Def.Nsite%2==1 && X->Def.LocSpn[X->Def.Nsite/2] != ITINERANT){
-	    jb +=X->Def.Tpow[X->Def.Nsite-1-(X->Def.NLocSpn-num_loc)];
-	  }else{
-	    jb +=X->Def.Tpow[X->Def.Nsite-(X->Def.NLocSpn-num_loc)];
-	  }
-	}
+	list_jb[ib]=sz_CountKondoGC(ib,ihfbit,num_loc,X);
       }
+      sz_PrefixSum(X->Check.sdim);
+      TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzMid, "a");
 
       icnt = 0; 
-#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) shared(list_1)
+#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) shared(list_1) schedule(dynamic)
       for(ib=0;ib<X->Check.sdim;ib++){
 	icnt+=child_omp_sz_KondoGC(ib,ihfbit,N2,X);
       }      
@@ -236,79 +497,35 @@ int sz
  case Hubbard:
 
       hacker = X->Def.read_hacker;
-      if(hacker==0){
-        // this part can not be parallelized
-        jb = 0;
+      if(X->Large.NTransSymOp > 0){
+        //representatives of the symmetrized basis
+        icnt = TransSym_sz(X);
+        break;
+      }
+      else if(hacker==0){
+#pragma omp parallel for default(none) private(ib) firstprivate(ihfbit, N2, X, comb) shared(list_jb)
         for(ib=0;ib<X->Check.sdim;ib++){
-	  list_jb[ib]=jb;
-
-	  i=ib*ihfbit;
-	  num_up=0;
-	  for(j=0;j<=N2-2;j+=2){
-	    div=i & X->Def.Tpow[j];
-	    div=div/X->Def.Tpow[j];
-	    num_up+=div;
-	  }
-	  num_down=0;
-	  for(j=1;j<=N2-1;j+=2){
-	    div=i & X->Def.Tpow[j];
-	    div=div/X->Def.Tpow[j];
-	    num_down+=div;
-	  }
-	
-	  tmp_res  = X->Def.Nsite%2; // even Ns-> 0, odd Ns -> 1
-	  all_up   = (X->Def.Nsite+tmp_res)/2;
-	  all_down = (X->Def.Nsite-tmp_res)/2;
-
-	  tmp_1 = Binomial(all_up,X->Def.Nup-num_up,comb,all_up);
-	  tmp_2 = Binomial(all_down,X->Def.Ndown-num_down,comb,all_down);
-	  jb   += tmp_1*tmp_2;
+	  list_jb[ib]=sz_CountHubbard(ib,ihfbit,N2,comb,X);
         }
-
-        //#pragma omp barrier
-        TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzFinish, "a");
+        sz_PrefixSum(X->Check.sdim);
+        TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzMid, "a");
  
         icnt = 0;
-        //#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) 
+#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) schedule(dynamic)
         for(ib=0;ib<X->Check.sdim;ib++){
 	  icnt+=child_omp_sz(ib,ihfbit,N2,X);
         }
 	break;
       }else if(hacker==1){
-        // this part can not be parallelized
-        jb = 0;
-
+#pragma omp parallel for default(none) private(ib) firstprivate(ihfbit, N2, X, comb) shared(list_jb)
         for(ib=0;ib<X->Check.sdim;ib++){
-	  list_jb[ib]=jb;
-
-	  i=ib*ihfbit;
-	  num_up=0;
-	  for(j=0;j<=N2-2;j+=2){
-	    div=i & X->Def.Tpow[j];
-	    div=div/X->Def.Tpow[j];
-	    num_up+=div;
-	  }
-	  num_down=0;
-	  for(j=1;j<=N2-1;j+=2){
-	    div=i & X->Def.Tpow[j];
-	    div=div/X->Def.Tpow[j];
-	    num_down+=div;
-	  }
-	
-	  tmp_res  = X->Def.Nsite%2; // even Ns-> 0, odd Ns -> 1
-	  all_up   = (X->Def.Nsite+tmp_res)/2;
-	  all_down = (X->Def.Nsite-tmp_res)/2;
-
-	  tmp_1 = Binomial(all_up,X->Def.Nup-num_up,comb,all_up);
-	  tmp_2 = Binomial(all_down,X->Def.Ndown-num_down,comb,all_down);
-	  jb   += tmp_1*tmp_2;
+	  list_jb[ib]=sz_CountHubbard(ib,ihfbit,N2,comb,X);
         }
-
-        //#pragma omp barrier
-        TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzFinish, "a");
+        sz_PrefixSum(X->Check.sdim);
+        TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzMid, "a");
  
         icnt = 0;
-        //#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) 
+#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) schedule(dynamic)
         for(ib=0;ib<X->Check.sdim;ib++){
 	  icnt+=child_omp_sz_hacker(ib,ihfbit,N2,X);
           //printf("ib=%ld icnt=%ld \n",ib,icnt);
@@ -321,150 +538,56 @@ int sz
       }
 
     case HubbardNConserved:
-      // this part can not be parallelized
-      jb = 0;
-      iSpnup=0;
-      iMinup=0;
-      iAllup=X->Def.Ne;
-      if(X->Def.Ne > X->Def.Nsite){
-	iMinup = X->Def.Ne-X->Def.Nsite;
-	iAllup = X->Def.Nsite;
-      }
-      
+#pragma omp parallel for default(none) private(ib) firstprivate(ihfbit, N2, X, comb) shared(list_jb)
       for(ib=0;ib<X->Check.sdim;ib++){
-	list_jb[ib]=jb;
-
-	i=ib*ihfbit;
-	num_up=0;
-	for(j=0;j<=N2-2;j+=2){
-	  div=i & X->Def.Tpow[j];
-	  div=div/X->Def.Tpow[j];
-	  num_up+=div;
-	}
-	num_down=0;
-	for(j=1;j<=N2-1;j+=2){
-	  div=i & X->Def.Tpow[j];
-	  div=div/X->Def.Tpow[j];
-	  num_down+=div;
-	}
-	
-	tmp_res  = X->Def.Nsite%2; // even Ns-> 0, odd Ns -> 1
-	all_up   = (X->Def.Nsite+tmp_res)/2;
-	all_down = (X->Def.Nsite-tmp_res)/2;
-
-	for(iSpnup=iMinup; iSpnup<= iAllup; iSpnup++){
-	  tmp_1 = Binomial(all_up, iSpnup-num_up,comb,all_up);
-	  tmp_2 = Binomial(all_down, X->Def.Ne-iSpnup-num_down,comb,all_down);
-	  jb   += tmp_1*tmp_2;
-	}
+	list_jb[ib]=sz_CountHubbard(ib,ihfbit,N2,comb,X);
       }
-      //#pragma omp barrier
-      TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzFinish, "a");
+      sz_PrefixSum(X->Check.sdim);
+      TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzMid, "a");
 	
       icnt = 0;
-#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) 
+#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) schedule(dynamic)
       for(ib=0;ib<X->Check.sdim;ib++){
 	icnt+=child_omp_sz(ib,ihfbit,N2,X);
       }
       break;
             
     case Kondo:
-      // this part can not be parallelized
       N_all_up   = X->Def.Nup;
       N_all_down = X->Def.Ndown;
       fprintf(stdoutMPI, cStateNupNdown, N_all_up,N_all_down);
 
-      jb = 0;
       num_loc=0;
       for(j=X->Def.Nsite/2; j< X->Def.Nsite ;j++){
 	if(X->Def.LocSpn[j] != ITINERANT){
 	  num_loc += 1;
 	}
       }
-
+#pragma omp parallel for default(none) private(ib) firstprivate(ihfbit, num_loc, X, comb) shared(list_jb)
       for(ib=0;ib<X->Check.sdim;ib++){
-	list_jb[ib]=jb;
-	i=ib*ihfbit;
-	num_up=0;
-	num_down=0;	
-	icheck_loc=1;
-
-	for(j=X->Def.Nsite/2; j< X->Def.Nsite ;j++){
-	  div_up    = i & X->Def.Tpow[2*j];
-	  div_up    = div_up/X->Def.Tpow[2*j];
-	  div_down  = i & X->Def.Tpow[2*j+1];
-	  div_down  = div_down/X->Def.Tpow[2*j+1];
-	  if(X->Def.LocSpn[j] == ITINERANT){
-	    num_up   += div_up;        
-	    num_down += div_down;  
-	  }else{    
-	    num_up   += div_up;     
-	    num_down += div_down;
-	    if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
-	      icheck_loc= icheck_loc;
-	      ihfSpinDown=div_down;
-	      if(div_down ==0){
-		num_up += 1;
-	      }
-	    }
-	    else{
-	      icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
-	    }
-	  }
-	}
-
-	if(icheck_loc == 1){
-	  tmp_res  = X->Def.Nsite%2; // even Ns-> 0, odd Ns -> 1
-	  all_loc =  X->Def.NLocSpn-num_loc;
-	  all_up   = (X->Def.Nsite+tmp_res)/2-all_loc;
-	  all_down = (X->Def.Nsite-tmp_res)/2-all_loc;
-	  
-	  if(X->Def.Nsite%2==1 && X->Def.LocSpn[X->Def.Nsite/2] != ITINERANT){
-	    all_up   = (X->Def.Nsite)/2-all_loc;
-	    all_down = (X->Def.Nsite)/2-all_loc;
-	  }
-	  
-	  for(num_loc_up=0; num_loc_up <= all_loc; num_loc_up++){
-	    tmp_1 = Binomial(all_loc, num_loc_up, comb, all_loc);
-	    
-	    if( X->Def.Nsite%2==1 && X->Def.LocSpn[X->Def.Nsite/2] != ITINERANT){
-	      if(ihfSpinDown !=0){
-		tmp_2 = Binomial(all_up, X->Def.Nup-num_up-num_loc_up, comb, all_up);
-		tmp_3 = Binomial(all_down, X->Def.Ndown-num_down-(all_loc-num_loc_up), comb, all_down);
-		
-	      }
-	      else{
-		tmp_2 = Binomial(all_up, X->Def.Nup-num_up-num_loc_up, comb, all_up);
-		tmp_3 = Binomial(all_down, X->Def.Ndown-num_down-(all_loc-num_loc_up), comb, all_down);
-	      }
-	    }
-	    else{
-	      tmp_2 = Binomial(all_up, X->Def.Nup-num_up-num_loc_up, comb, all_up);
-	      tmp_3 = Binomial(all_down, X->Def.Ndown-num_down-(all_loc-num_loc_up), comb, all_down);
-	    }
-	    jb   += tmp_1*tmp_2*tmp_3;  
-	  }
-	}
-
+	list_jb[ib]=sz_CountKondo(ib,ihfbit,num_loc,comb,X);
       }
-      //#pragma omp barrier
+      sz_PrefixSum(X->Check.sdim);
       
       TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzMid, "a");
  
       icnt = 0;
-#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) 
+#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N2, X) schedule(dynamic)
       for(ib=0;ib<X->Check.sdim;ib++){
 	icnt+=child_omp_sz_Kondo(ib,ihfbit,N2,X);
       }
       break;
 
     case Spin:
-      // this part can not be parallelized
       if(X->Def.iFlgGeneralSpin==FALSE){
         hacker = X->Def.read_hacker;
         //printf(" rank=%d:Ne=%ld ihfbit=%ld sdim=%ld\n", myrank,X->Def.Ne,ihfbit,X->Check.sdim);
-// using hacker's delight only + no open mp 
-        if(hacker        ==  -1){
+        if(X->Large.NTransSymOp > 0){
+          //representatives of the symmetrized basis
+          icnt = TransSym_sz(X);
+        }
+// using hacker's delight only + no open mp (serial)
+        else if(hacker        ==  -1){
           icnt    = 1;
           tmp_pow = 1;
           tmp_i   = 0;
@@ -482,7 +605,7 @@ int sz
           }  
 	  while(tmp_i<max_tmp_i){
 	  //while(tmp_i<pow(2,X->Def.Nsite+1)-1){
-            list_1[icnt]=tmp_i;
+            sz_Store(X, icnt, tmp_i);
            
             ia= tmp_i & irght;
             ib= tmp_i & ilft;
@@ -504,50 +627,30 @@ int sz
           icnt = icnt-1;
 // old version + hacker's delight
         }else if(hacker  ==  1){
-	  jb = 0;
+#pragma omp parallel for default(none) private(ib) firstprivate(ihfbit, N, X, comb) shared(list_jb)
 	  for(ib=0;ib<X->Check.sdim;ib++){
-	    list_jb[ib]=jb;
-	    i=ib*ihfbit;
-	    num_up=0;
-	    for(j=0;j<N; j++){
-	      div_up = i & X->Def.Tpow[j];
-	      div_up = div_up/X->Def.Tpow[j];
-	      num_up +=div_up;
-	    }
-	    all_up   = (X->Def.Nsite+1)/2;
-	    tmp_1 = Binomial(all_up,X->Def.Ne-num_up,comb,all_up);
-	    jb   += tmp_1;
+	    list_jb[ib]=sz_CountSpin(ib,ihfbit,N,comb,X);
 	  }
-	  //#pragma omp barrier
+	  sz_PrefixSum(X->Check.sdim);
 	  TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzMid, "a");
  
 	  icnt = 0;
-#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N, X)
+#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N, X) schedule(dynamic)
           for(ib=0;ib<X->Check.sdim;ib++){
 	    icnt+=child_omp_sz_spin_hacker(ib,ihfbit,N,X);
 	  }
           //printf(" rank=%d ib=%ld:Ne=%d icnt=%ld :idim_max=%ld N=%d\n", myrank,ib,X->Def.Ne,icnt,X->Check.idim_max,N);
 // old version
         }else if(hacker  ==  0){
-	  jb = 0;
+#pragma omp parallel for default(none) private(ib) firstprivate(ihfbit, N, X, comb) shared(list_jb)
 	  for(ib=0;ib<X->Check.sdim;ib++){
-	    list_jb[ib]=jb;
-	    i=ib*ihfbit;
-	    num_up=0;
-	    for(j=0;j<N; j++){
-	      div_up = i & X->Def.Tpow[j];
-	      div_up = div_up/X->Def.Tpow[j];
-	      num_up +=div_up;
-	    }
-	    all_up   = (X->Def.Nsite+1)/2;
-	    tmp_1 = Binomial(all_up,X->Def.Ne-num_up,comb,all_up);
-	    jb   += tmp_1;
+	    list_jb[ib]=sz_CountSpin(ib,ihfbit,N,comb,X);
 	  }
-	  //#pragma omp barrier
+	  sz_PrefixSum(X->Check.sdim);
 	  TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzMid, "a");
  
 	  icnt = 0;
-#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N, X)
+#pragma omp parallel for default(none) reduction(+:icnt) private(ib) firstprivate(ihfbit, N, X) schedule(dynamic)
           for(ib=0;ib<X->Check.sdim;ib++){
 	    icnt+=child_omp_sz_spin(ib,ihfbit,N,X);
 	  }
@@ -618,6 +721,11 @@ int sz
     i_max=icnt;
     //fprintf(stdoutMPI, "Xicnt=%ld \n",icnt);
     TimeKeeper(X, cFileNameSzTimeKeep, cOMPSzFinish, "a");
+    time_sz = sz_WallTime()-time_sz;
+    fprintf(stdoutMPI, cStateSzTime, sz_ModelName(X->Def.iCalcModel), i_max, time_sz, num_threads);
+    childfopenMPI(sdt,"a", &fp);
+    fprintf(fp, cStateSzTime, sz_ModelName(X->Def.iCalcModel), i_max, time_sz, num_threads);
+    fclose(fp);
   }
 
   if(X->Def.iCalcModel==HubbardNConserved){
@@ -626,9 +734,9 @@ int sz
   
   //Error message
   //i_max=i_max+1;
-  if(i_max!=X->Check.idim_max){
+  if(i_max!=idim_all){
     fprintf(stderr, "%s", cErrSz);
-    fprintf(stderr, cErrSz_ShowDim, i_max, X->Check.idim_max);
+    fprintf(stderr, cErrSz_ShowDim, i_max, idim_all);
     strcpy(sdt_err,cFileNameErrorSz);
     if(childfopenMPI(sdt_err,"a",&fp_err)!=0){
       exitMPI(-1);
@@ -640,6 +748,9 @@ int sz
   
   i_free2(comb, X->Def.Nsite+1,X->Def.Nsite+1);
   }
+  if(iCacheHit==FALSE){
+    BasisCacheWriteBasis(X);
+  }
   fprintf(stdoutMPI, "%s", cProEndCalcSz);
   return 0;    
 }
@@ -690,6 +801,21 @@ long int Binomial(int n,int k,long int **comb,int Nsite){
   return comb[n][k];
 }
 
+/**
+ * @brief nCk from the table already filled by Binomial(Nsite, 0, comb, Nsite).
+ * Unlike Binomial, the table is not rewritten, so the function is thread safe.
+ *
+ * @param n
+ * @param k
+ * @param comb binomial table
+ *
+ * @return nCk (0 if k < 0 or k > n)
+ */
+long int BinomialTable(int n,int k,long int **comb){
+  if(n<0 || k<0 || n<k) return 0;
+  return comb[n][k];
+}
+
 /** 
  * 
  * 
@@ -703,12 +829,12 @@ long int Binomial(int n,int k,long int **comb,int Nsite){
  * @author Kazuyoshi Yoshimi (The University of Tokyo)
  */
 int child_omp_sz(long unsigned int ib, long unsigned int ihfbit,int N2,struct BindStruct *X){
-
   long unsigned int i,j; 
   long unsigned int ia,ja,jb;
   long unsigned int div_down, div_up;
   long unsigned int num_up,num_down;
-  long unsigned int tmp_num_up,tmp_num_down;
+  long unsigned int mask[2];
+  int num[2], nclass, nbit;
     
   jb = list_jb[ib];
   i  = ib*ihfbit;
@@ -723,54 +849,30 @@ int child_omp_sz(long unsigned int ib, long unsigned int ihfbit,int N2,struct Bi
     num_up += div_up;
     num_down += div_down;
   }
-  
-  ja=1;
-  tmp_num_up   = num_up;
-  tmp_num_down = num_down;
 
+  //walk only the patterns of the lower half with the remaining electrons
+  nbit = sz_NumBit(X->Check.sdim);
   if(X->Def.iCalcModel==Hubbard){
-    for(ia=0;ia<X->Check.sdim;ia++){
-      i=ia;
-      num_up =  tmp_num_up;
-      num_down =  tmp_num_down;
-      
-      for(j=0;j<X->Def.Nsite;j++){
-	div_up    = i & X->Def.Tpow[2*j];
-	div_up    = div_up/X->Def.Tpow[2*j];
-	div_down  = i & X->Def.Tpow[2*j+1];
-	div_down  = div_down/X->Def.Tpow[2*j+1];
-	num_up += div_up;
-	num_down += div_down;
-      }
-      if(num_up == X->Def.Nup && num_down == X->Def.Ndown){
-	list_1[ja+jb]=ia+ib*ihfbit;
+    mask[0] = (X->Check.sdim-1) & 0x5555555555555555ul;
+    mask[1] = (X->Check.sdim-1) & 0xaaaaaaaaaaaaaaaaul;
+    num[0]  = X->Def.Nup-(int)num_up;
+    num[1]  = X->Def.Ndown-(int)num_down;
+    nclass  = 2;
+  }
+  else{
+    mask[0] = X->Check.sdim-1;
+    num[0]  = X->Def.Ne-(int)(num_up+num_down);
+    nclass  = 1;
+  }
+
+  ja=1;
+  if(SectorWalkFirst(mask, num, nclass, &ia)==0){
+    do{
+      sz_Store(X, ja+jb, ia+ib*ihfbit);
       list_2_1[ia]=ja;
       list_2_2[ib]=jb;
       ja+=1;
-      } 
-    }
-  }
-  else if(X->Def.iCalcModel==HubbardNConserved){
-    for(ia=0;ia<X->Check.sdim;ia++){
-      i=ia;
-      num_up =  tmp_num_up;
-      num_down =  tmp_num_down;
-      
-      for(j=0;j<X->Def.Nsite;j++){
-	div_up    = i & X->Def.Tpow[2*j];
-	div_up    = div_up/X->Def.Tpow[2*j];
-	div_down  = i & X->Def.Tpow[2*j+1];
-	div_down  = div_down/X->Def.Tpow[2*j+1];
-	num_up += div_up;
-	num_down += div_down;
-      }
-      if( (num_up+num_down) == X->Def.Ne){
-	list_1[ja+jb]=ia+ib*ihfbit;
-	list_2_1[ia]=ja;
-	list_2_2[ib]=jb;
-	ja+=1;
-      } 
-    }  
+    }while(SectorWalkNext(mask, num, nclass, nbit, &ia)==0);
   }
   ja=ja-1;    
   return ja; 
@@ -817,7 +919,7 @@ int child_omp_sz_hacker(long unsigned int ib, long unsigned int ihfbit,int N2,st
           num_down += div_down;
         }
         if(num_up == X->Def.Nup && num_down == X->Def.Ndown){
-          list_1[ja+jb]=ia+ib*ihfbit;
+          sz_Store(X, ja+jb, ia+ib*ihfbit);
           list_2_1[ia]=ja;
           list_2_2[ib]=jb;
           ja+=1;
@@ -836,7 +938,7 @@ int child_omp_sz_hacker(long unsigned int ib, long unsigned int ihfbit,int N2,st
 	      num_down += div_down;
             }
             if(num_up == X->Def.Nup && num_down == X->Def.Ndown){
-	      list_1[ja+jb]=ia+ib*ihfbit;
+	      sz_Store(X, ja+jb, ia+ib*ihfbit);
               list_2_1[ia]=ja;
               list_2_2[ib]=jb;
               ja+=1;
@@ -851,14 +953,14 @@ int child_omp_sz_hacker(long unsigned int ib, long unsigned int ihfbit,int N2,st
     if(tmp_num_up+tmp_num_down <= X->Def.Ne){ //do not exceed Ne
       ia = X->Def.Tpow[X->Def.Ne-tmp_num_up-tmp_num_down]-1;
       if(ia < X->Check.sdim){
-	list_1[ja+jb]=ia+ib*ihfbit;
+	sz_Store(X, ja+jb, ia+ib*ihfbit);
         list_2_1[ia]=ja;
         list_2_2[ib]=jb;
         ja+=1;
         if(ia!=0){
           ia = snoob(ia);
           while(ia < X->Check.sdim){
-	    list_1[ja+jb]=ia+ib*ihfbit;
+	    sz_Store(X, ja+jb, ia+ib*ihfbit);
             list_2_1[ia]=ja;
             list_2_2[ib]=jb;
             ja+=1;
@@ -886,12 +988,12 @@ int child_omp_sz_hacker(long unsigned int ib, long unsigned int ihfbit,int N2,st
  * @author Kazuyoshi Yoshimi (The University of Tokyo)
  */
 int child_omp_sz_Kondo(long unsigned int ib, long unsigned int ihfbit,int N2,struct BindStruct *X){
-
   long unsigned int i,j; 
   long unsigned int ia,ja,jb;
   long unsigned int div_down, div_up;
   long unsigned int num_up,num_down;
-  long unsigned int tmp_num_up,tmp_num_down;
+  long unsigned int mask[2], locmask, midbit;
+  int num[2], nbit;
   int icheck_loc;
     
   jb = list_jb[ib];
@@ -906,65 +1008,33 @@ int child_omp_sz_Kondo(long unsigned int ib, long unsigned int ihfbit,int N2,str
     div_down  = i & X->Def.Tpow[2*j+1];
     div_down  = div_down/X->Def.Tpow[2*j+1];
 
-    if(X->Def.LocSpn[j] == ITINERANT){
-      num_up   += div_up;        
-      num_down += div_down;  
-    }else{    
-      num_up   += div_up;        
-      num_down += div_down;
-      if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
-	icheck_loc= icheck_loc;
-      }
-      else{
+    num_up   += div_up;        
+    num_down += div_down;
+    if(X->Def.LocSpn[j] != ITINERANT){
+      if(!(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2))){
 	icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
       }
     }
   }
   
   ja=1;
-  tmp_num_up   = num_up;
-  tmp_num_down = num_down;
   if(icheck_loc ==1){
-    for(ia=0;ia<X->Check.sdim;ia++){
-      i=ia;
-      num_up =  tmp_num_up;
-      num_down =  tmp_num_down;
-      icheck_loc=1;
-      for(j=0;j<(X->Def.Nsite+1)/2;j++){
-	div_up    = i & X->Def.Tpow[2*j];
-	div_up    = div_up/X->Def.Tpow[2*j];
-	div_down  = i & X->Def.Tpow[2*j+1];
-	div_down  = div_down/X->Def.Tpow[2*j+1];
-	
-	if(X->Def.LocSpn[j] ==  ITINERANT){
-	  num_up   += div_up;        
-	  num_down += div_down;  
-	}else{    
-	  num_up   += div_up;        
-	  num_down += div_down;  
-	  if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
-	    icheck_loc= icheck_loc;
-	  }
-	  else{
-	    icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
-	  }
+    sz_KondoMask(ib, ihfbit, X, &locmask, &midbit);
+    nbit    = sz_NumBit(X->Check.sdim);
+    mask[0] = (X->Check.sdim-1) & 0x5555555555555555ul;
+    mask[1] = (X->Check.sdim-1) & 0xaaaaaaaaaaaaaaaaul;
+    num[0]  = X->Def.Nup-(int)num_up;
+    num[1]  = X->Def.Ndown-(int)num_down;
+    //walk the patterns with the remaining electrons and keep singly occupied local spins
+    if(SectorWalkFirst(mask, num, 2, &ia)==0){
+      do{
+	if((((ia^(ia>>1)) & locmask) == locmask) && (ia & midbit) == (~(ib*ihfbit)>>1 & midbit)){
+	  sz_Store(X, ja+jb, ia+ib*ihfbit);
+	  list_2_1[ia]=ja;
+	  list_2_2[ib]=jb;
+	  ja+=1;
 	}
-      }
-      
-      if(icheck_loc == 1 && X->Def.LocSpn[X->Def.Nsite/2] != ITINERANT && X->Def.Nsite%2==1){
-	div_up    = ia & X->Def.Tpow[X->Def.Nsite-1];
-	div_up    = div_up/X->Def.Tpow[X->Def.Nsite-1];
-	div_down  = (ib*ihfbit) & X->Def.Tpow[X->Def.Nsite];
-	div_down  = div_down/X->Def.Tpow[X->Def.Nsite];
-	icheck_loc= icheck_loc*(div_up^div_down);
-      }
-      
-      if(num_up == X->Def.Nup && num_down == X->Def.Ndown && icheck_loc==1){
-	list_1[ja+jb]=ia+ib*ihfbit;
-	list_2_1[ia]=ja;
-	list_2_2[ib]=jb;
-	ja+=1;
-      }
+      }while(SectorWalkNext(mask, num, 2, nbit, &ia)==0);
     }
   }
   ja=ja-1;    
@@ -984,10 +1054,10 @@ int child_omp_sz_Kondo(long unsigned int ib, long unsigned int ihfbit,int N2,str
  * @author Kazuyoshi Yoshimi (The University of Tokyo)
  */
 int child_omp_sz_KondoGC(long unsigned int ib, long unsigned int ihfbit,int N2,struct BindStruct *X){
-
   long unsigned int i,j; 
   long unsigned int ia,ja,jb;
   long unsigned int div_down, div_up;
+  long unsigned int locmask, midbit, ifree, ifix, iy;
   int icheck_loc;
     
   jb = list_jb[ib];
@@ -999,10 +1069,7 @@ int child_omp_sz_KondoGC(long unsigned int ib, long unsigned int ihfbit,int N2,s
     div_down  = i & X->Def.Tpow[2*j+1];
     div_down  = div_down/X->Def.Tpow[2*j+1];
     if(X->Def.LocSpn[j] !=  ITINERANT){
-      if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
-	icheck_loc= icheck_loc;
-      }
-      else{
+      if(!(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2))){
 	icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
       }
     }
@@ -1010,39 +1077,23 @@ int child_omp_sz_KondoGC(long unsigned int ib, long unsigned int ihfbit,int N2,s
 
   ja=1;
   if(icheck_loc ==1){
-    for(ia=0;ia<X->Check.sdim;ia++){
-      i=ia;
-      icheck_loc =1;
-      for(j=0;j<(X->Def.Nsite+1)/2;j++){
-	div_up    = i & X->Def.Tpow[2*j];
-	div_up    = div_up/X->Def.Tpow[2*j];
-	div_down  = i & X->Def.Tpow[2*j+1];
-	div_down  = div_down/X->Def.Tpow[2*j+1];	
-	if(X->Def.LocSpn[j] !=  ITINERANT){
-	  if(X->Def.Nsite%2==1 && j==(X->Def.Nsite/2)){
-	    icheck_loc= icheck_loc;
-	  }
-	  else{
-	    icheck_loc   = icheck_loc*(div_up^div_down);// exclude doubllly ocupited site
-	  }
-	}
-      }
-
-      if(icheck_loc == 1 && X->Def.LocSpn[X->Def.Nsite/2] != ITINERANT && X->Def.Nsite%2==1){
-	div_up    = ia & X->Def.Tpow[X->Def.Nsite-1];
-	div_up    = div_up/X->Def.Tpow[X->Def.Nsite-1];
-	div_down  = (ib*ihfbit) & X->Def.Tpow[X->Def.Nsite];
-	div_down  = div_down/X->Def.Tpow[X->Def.Nsite];
-	icheck_loc= icheck_loc*(div_up^div_down);
-      }
-      
-      if(icheck_loc==1){
-	list_1[ja+jb]=ia+ib*ihfbit;
-	list_2_1[ia]=ja;
-	list_2_2[ib]=jb;
-	ja+=1;
-      }
-    }
+    /*
+      The up bit of a local spin is the complement of its down bit and
+      the lower bit of the local spin on the boundary is fixed by the upper half.
+      The other bits run over all subsets of the free mask in ascending order.
+    */
+    sz_KondoMask(ib, ihfbit, X, &locmask, &midbit);
+    ifree = (X->Check.sdim-1) & ~locmask & ~midbit;
+    ifix = ~(ib*ihfbit)>>1 & midbit;
+    iy   = 0;
+    do{
+      ia = iy | (~(iy>>1) & locmask) | ifix;
+      sz_Store(X, ja+jb, ia+ib*ihfbit);
+      list_2_1[ia]=ja;
+      list_2_2[ib]=jb;
+      ja+=1;
+      iy = ((iy | ~ifree) + 1) & ifree;
+    }while(iy!=0);
   }
   ja=ja-1;
     
@@ -1071,7 +1122,8 @@ int child_omp_sz_spin(
   long unsigned int i,j,div; 
   long unsigned int ia,ja,jb;
   long unsigned int num_up;
-  int tmp_num_up;
+  long unsigned int mask;
+  int num, nbit;
   
   jb = list_jb[ib];
   i  = ib*ihfbit;
@@ -1081,24 +1133,19 @@ int child_omp_sz_spin(
     div=div/X->Def.Tpow[j];
     num_up+=div;
   }
-  ja=1;
-  tmp_num_up   = num_up;
-  
-  for(ia=0;ia<ihfbit;ia++){
-    i=ia;
-    num_up =  tmp_num_up;
-    for(j=0;j<N;j++){
-      div=i & X->Def.Tpow[j];
-      div=div/X->Def.Tpow[j];
-      num_up+=div;
-    }
 
-    if(num_up == X->Def.Ne){
-      list_1[ja+jb]=ia+ib*ihfbit;
+  //snoob over the patterns of the lower half with Ne-num_up up spins
+  nbit = sz_NumBit(ihfbit);
+  mask = ihfbit-1;
+  num  = X->Def.Ne-(int)num_up;
+  ja=1;
+  if(SectorWalkFirst(&mask, &num, 1, &ia)==0){
+    do{
+      sz_Store(X, ja+jb, ia+ib*ihfbit);
       list_2_1[ia]=ja;
       list_2_2[ib]=jb;
       ja+=1;
-    } 
+    }while(SectorWalkNext(&mask, &num, 1, nbit, &ia)==0);
   }
   ja=ja-1;
   return ja; 
@@ -1131,7 +1178,7 @@ int child_omp_sz_spin_hacker(
   if(tmp_num_up<=X->Def.Ne){ // do not exceed Ne
     ia = X->Def.Tpow[X->Def.Ne-tmp_num_up]-1;
     if(ia<ihfbit ){          // do not exceed Ne
-      list_1[ja+jb] = ia+ib*ihfbit;
+      sz_Store(X, ja+jb, ia+ib*ihfbit);
       list_2_1[ia]  = ja;
       list_2_2[ib]  = jb;
       ja           += 1;
@@ -1140,7 +1187,7 @@ int child_omp_sz_spin_hacker(
         ia = snoob(ia);
         while(ia < ihfbit){
           //fprintf(stdoutMPI, " X: ia= %ld ia=%ld \n", ia,ia);
-          list_1[ja+jb]    = ia+ib*ihfbit;
+          sz_Store(X, ja+jb, ia+ib*ihfbit);
           list_2_1[ia]     = ja;
           list_2_2[ib]     = jb;
           ja+=1;
@@ -1182,7 +1229,7 @@ int child_omp_sz_GeneralSpin(
   for(ia=0;ia<ihfbit;ia++){
     tmp_2Sz=list_2_1_Sz[ia]+list_2_2_Sz_ib;
     if(tmp_2Sz == X->Def.Total2Sz){
-      list_1[ja+jb]=ia+ib*ihfbit;
+      sz_Store(X, ja+jb, ia+ib*ihfbit);
       list_2_1[ia]=ja;
       list_2_2[ib]=jb;
       ja+=1;
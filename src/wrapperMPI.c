@@ -195,6 +195,16 @@ double complex SumMPI_dc(double complex norm)
   return(norm);
 }
 
+void SumMPI_cv(int n, double complex *norm)
+{
+#ifdef MPI
+  int ierr;
+  ierr = MPI_Allreduce(MPI_IN_PLACE, norm, n,
+    MPI_DOUBLE_COMPLEX, MPI_SUM, MPI_COMM_WORLD);
+  if(ierr != 0) exitMPI(-1);
+#endif
+}
+
 double SumMPI_d(double norm)
 {
 #ifdef MPI
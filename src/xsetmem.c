@@ -14,10 +14,177 @@
 /* You should have received a copy of the GNU General Public License */
 /* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
 
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 #include "Common.h"
 #include "mfmemory.h"
 #include "xsetmem.h"
 #include "wrapperMPI.h"
+#include "mltplyMPIPlan.h"
+
+#ifndef MPOL_F_NODE
+#define MPOL_F_NODE (1<<0)
+#endif
+#ifndef MPOL_F_ADDR
+#define MPOL_F_ADDR (1<<1)
+#endif
+
+/*
+  First touch: a page is placed on the NUMA node of the thread that writes it first.
+  The large arrays are therefore zeroed with the same static schedule as the
+  loops over j=1,...,i_max in mltply, so that each thread later sweeps local memory.
+*/
+static void setmem_FirstTouch_c(double complex *vec, long unsigned int N)
+{
+  long unsigned int j;
+#pragma omp parallel for default(none) schedule(static) private(j) firstprivate(N) shared(vec)
+  for (j = 0; j < N; j++) vec[j] = 0.0;
+}
+
+static void setmem_FirstTouch_d(double *vec, long unsigned int N)
+{
+  long unsigned int j;
+#pragma omp parallel for default(none) schedule(static) private(j) firstprivate(N) shared(vec)
+  for (j = 0; j < N; j++) vec[j] = 0.0;
+}
+
+static void setmem_FirstTouch_lui(long unsigned int *vec, long unsigned int N)
+{
+  long unsigned int j;
+#pragma omp parallel for default(none) schedule(static) private(j) firstprivate(N) shared(vec)
+  for (j = 0; j < N; j++) vec[j] = 0;
+}
+
+static void setmem_FirstTouch_i(int *vec, long unsigned int N)
+{
+  long unsigned int j;
+#pragma omp parallel for default(none) schedule(static) private(j) firstprivate(N) shared(vec)
+  for (j = 0; j < N; j++) vec[j] = 0;
+}
+
+/**
+ * @brief NUMA node of the calling thread.
+ *
+ * @return node index, or -1 if it is not available
+ */
+static int setmem_ThreadNode()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned int cpu, node;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) return (int)node;
+#endif
+  return -1;
+}
+
+/**
+ * @brief NUMA node of the page containing @p addr.
+ *
+ * @return node index, or -1 if it is not available
+ */
+static int setmem_PageNode(void *addr)
+{
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+  int node;
+  if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr, MPOL_F_NODE | MPOL_F_ADDR) == 0) return node;
+#endif
+  return -1;
+}
+
+/**
+ * @brief Print where the pages of an array were placed.
+ * At most D_NUMASample pages are checked. Since the sampled pages are visited with
+ * the same static schedule as the first touch, a page is "local" if it sits
+ * on the node where the thread sweeping it runs now.
+ *
+ * @param cName name of the array
+ * @param vec array
+ * @param N number of elements
+ * @param size size of an element [byte]
+ */
+static void setmem_NUMAReportArray(const char *cName, void *vec, long unsigned int N, size_t size)
+{
+  long int k, nsample, nlocal, nfound, nmask, imask;
+  int inode, ithread;
+  long unsigned int node_mask;
+
+  if (vec == NULL) return;
+  nsample = (N * size) / sysconf(_SC_PAGESIZE) + 1;
+  if (nsample > D_NUMASample) nsample = D_NUMASample;
+  nlocal = 0;
+  nfound = 0;
+  node_mask = 0;
+#pragma omp parallel default(none) private(k, inode, ithread) firstprivate(nsample, N, size) \
+shared(vec) reduction(+:nlocal, nfound) reduction(|:node_mask)
+  {
+    ithread = setmem_ThreadNode();
+#pragma omp for schedule(static)
+    for (k = 0; k < nsample; k++) {
+      inode = setmem_PageNode((char *)vec + (N * k / nsample) * size);
+      if (inode < 0) continue;
+      nfound += 1;
+      if (inode == ithread) nlocal += 1;
+      if (inode < 64) node_mask |= 1lu << inode;
+    }
+  }
+  nlocal = SumMPI_li(nlocal);
+  nfound = SumMPI_li(nfound);
+  if (nfound == 0) {
+    fprintf(stdoutMPI, "    %-14s : page placement is not available.\n", cName);
+    return;
+  }
+  nmask = 0;
+  for (imask = 0; imask < 64; imask++) nmask += (node_mask >> imask) & 1;
+  nmask = MaxMPI_li(nmask);
+  fprintf(stdoutMPI, "    %-14s : %5.1f %% of %ld sampled pages are local (spread over %ld node(s)).\n",
+          cName, 100.0 * (double)nlocal / (double)nfound, nfound, nmask);
+}
+
+/**
+ * @brief Report the NUMA placement of the large arrays allocated in setmem_large.
+ *
+ * @param X
+ */
+static void setmem_NUMAReport(struct BindStruct *X)
+{
+  long unsigned int i_max;
+  int ithread, mythread;
+  int *thread_node;
+
+  i_max = X->Check.idim_max;
+  i_malloc1(thread_node, nthreads);
+#pragma omp parallel default(none) private(mythread) shared(thread_node)
+  {
+#ifdef _OPENMP
+    mythread = omp_get_thread_num();
+#else
+    mythread = 0;
+#endif
+    thread_node[mythread] = setmem_ThreadNode();
+  }
+  fprintf(stdoutMPI, "  NUMA placement by first touch (node of each thread on rank 0:");
+  for (ithread = 0; ithread < nthreads; ithread++) fprintf(stdoutMPI, " %d", thread_node[ithread]);
+  fprintf(stdoutMPI, ")\n");
+  free(thread_node);
+  setmem_NUMAReportArray("v0", v0, i_max + 1, sizeof(double complex));
+  setmem_NUMAReportArray("v1", v1, i_max + 1, sizeof(double complex));
+  setmem_NUMAReportArray("vg", vg, i_max + 1, sizeof(double complex));
+  setmem_NUMAReportArray("list_Diagonal", list_Diagonal, i_max + 1, sizeof(double));
+  switch (X->Def.iCalcModel) {
+  case Spin:
+  case Hubbard:
+  case HubbardNConserved:
+  case Kondo:
+  case KondoGC:
+    setmem_NUMAReportArray("list_1", list_1, i_max + 1, sizeof(long unsigned int));
+    setmem_NUMAReportArray("list_2_1", list_2_1, X->Check.sdim + 2, sizeof(long unsigned int));
+    setmem_NUMAReportArray("list_2_2", list_2_2, X->Check.sdim + 2, sizeof(long unsigned int));
+    break;
+  default:
+    break;
+  }
+}
 
 void setmem_HEAD
 (
@@ -69,6 +236,8 @@ void setmem_def
     
   i_malloc2(X->Def.CisAjt, X->Def.NCisAjt, 4);
   i_malloc2(X->Def.CisAjtCkuAlvDC, X->Def.NCisAjtCkuAlvDC, 8);
+  i_malloc2(X->Def.TransSymSite, X->Def.NTransSym, X->Def.Nsite);
+  c_malloc1(X->Def.ParaTransSym, X->Def.NTransSym);
 
   int ipivot,iarrayJ,i,ispin;
   xBoost->list_6spin_star = (int **)malloc(sizeof(int*) * xBoost->R0 * xBoost->num_pivot);
@@ -103,8 +272,20 @@ int setmem_large
 
   int j=0;
   int idim_maxMPI;
+  long unsigned int nv1buf;
+  double complex *v1shm=NULL;
   
   idim_maxMPI = MaxMPI_li(X->Check.idim_max);
+#ifdef MPI
+  /*v1 is read in place by the partners on the same node*/
+  if(!(X->Def.iCalcType == TPQCalc && X->Def.iTPQPrecision == TPQ_MIXED)){
+    v1shm = mltply_plan_ShmAlloc(X);
+  }
+  /*Only two chunks of the partner vector are kept in the pipelined exchange*/
+  nv1buf = idim_maxMPI + 1;
+  if (mltply_plan_ChunkSize(X) > 0 && 2 * mltply_plan_ChunkSize(X) < nv1buf)
+    nv1buf = 2 * mltply_plan_ChunkSize(X);
+#endif // MPI
 
   switch(X->Def.iCalcModel){
   case Spin:
@@ -119,18 +300,12 @@ int setmem_large
     if(X->Def.iFlgGeneralSpin==FALSE){
       if(X->Def.iCalcModel==Spin &&X->Def.Nsite%2==1){
 	lui_malloc1(list_2_1, X->Check.sdim*2+2);
-	for(j=0; j<X->Check.sdim*2+2;j++) list_2_1[j]=0;
       }
       else{
 	lui_malloc1(list_2_1, X->Check.sdim+2);
-	for(j=0; j<X->Check.sdim+2;j++) list_2_1[j]=0;
       }
       lui_malloc1(list_2_2, X->Check.sdim+2);
       lui_malloc1(list_jb, X->Check.sdim+2);
-      for(j=0; j<X->Check.sdim+2;j++){
-	list_2_2[j]=0;
-	list_jb[j]=0;
-      }
     }
     else{//for spin-canonical general spin
       lui_malloc1(list_2_1, X->Check.sdim+2);
@@ -138,17 +313,6 @@ int setmem_large
       lui_malloc1(list_2_2, (X->Def.Tpow[X->Def.Nsite-1]*X->Def.SiteToBit[X->Def.Nsite-1]/X->Check.sdim)+2);
       i_malloc1(list_2_2_Sz,(X->Def.Tpow[X->Def.Nsite-1]*X->Def.SiteToBit[X->Def.Nsite-1]/X->Check.sdim)+2);
       lui_malloc1(list_jb, (X->Def.Tpow[X->Def.Nsite-1]*X->Def.SiteToBit[X->Def.Nsite-1]/X->Check.sdim)+2);
-
-      for(j=0; j<X->Check.sdim+2;j++){
-	list_2_1[j]=0;
-	list_2_1_Sz[j]=0;
-      }
-      for(j=0; j< (X->Def.Tpow[X->Def.Nsite-1]*X->Def.SiteToBit[X->Def.Nsite-1]/X->Check.sdim)+2; j++){
-	list_2_2[j]=0;
-	list_2_2_Sz[j]=0;
-	list_jb[j]=0;
-      }
-      
     }
       if(list_1==NULL
 	 || list_2_1==NULL
@@ -158,31 +322,80 @@ int setmem_large
 	{
 	  return -1;
 	}
+    /*
+      list_2_1 and list_2_2 are read at random in mltply,
+      so the static first touch just spreads them over the nodes.
+    */
+    setmem_FirstTouch_lui(list_1, X->Check.idim_max+1);
+#ifdef MPI
+    setmem_FirstTouch_lui(list_1buf, idim_maxMPI + 1);
+#endif // MPI
+    if(X->Def.iFlgGeneralSpin==FALSE){
+      if(X->Def.iCalcModel==Spin &&X->Def.Nsite%2==1){
+        setmem_FirstTouch_lui(list_2_1, X->Check.sdim*2+2);
+      }
+      else{
+        setmem_FirstTouch_lui(list_2_1, X->Check.sdim+2);
+      }
+      setmem_FirstTouch_lui(list_2_2, X->Check.sdim+2);
+      setmem_FirstTouch_lui(list_jb, X->Check.sdim+2);
+    }
+    else{
+      setmem_FirstTouch_lui(list_2_1, X->Check.sdim+2);
+      setmem_FirstTouch_i(list_2_1_Sz, X->Check.sdim+2);
+      setmem_FirstTouch_lui(list_2_2, (X->Def.Tpow[X->Def.Nsite-1]*X->Def.SiteToBit[X->Def.Nsite-1]/X->Check.sdim)+2);
+      setmem_FirstTouch_i(list_2_2_Sz, (X->Def.Tpow[X->Def.Nsite-1]*X->Def.SiteToBit[X->Def.Nsite-1]/X->Check.sdim)+2);
+      setmem_FirstTouch_lui(list_jb, (X->Def.Tpow[X->Def.Nsite-1]*X->Def.SiteToBit[X->Def.Nsite-1]/X->Check.sdim)+2);
+    }
     break;
   default:
     break;
   }
 
   d_malloc1(list_Diagonal, X->Check.idim_max+1);
-  c_malloc1(v0, X->Check.idim_max+1);
-  c_malloc1(v1, X->Check.idim_max+1);
 #ifdef MPI
-  c_malloc1(v1buf, idim_maxMPI + 1);
+  c_malloc1(v1buf, nv1buf);
 #endif // MPI
-  c_malloc1(vg, X->Check.idim_max+1);
   d_malloc1(alpha, X->Def.Lanczos_max+1);
   d_malloc1(beta, X->Def.Lanczos_max+1);
-
   if(
      list_Diagonal==NULL
-     || v0==NULL
-     || v1==NULL
      || alpha==NULL
      || beta==NULL
-     || vg==NULL
      ){
     return -1;
   }
+  setmem_FirstTouch_d(list_Diagonal, X->Check.idim_max+1);
+#ifdef MPI
+  setmem_FirstTouch_c(v1buf, nv1buf);
+#endif // MPI
+  /*
+    Single-precision TPQ vectors, and real TPQ vectors if the couplings
+    turn out to be real (mltply_real_Check), are allocated in CalcBySSM;
+    the complex ones are allocated there otherwise
+  */
+  if(X->Def.iCalcType == TPQCalc
+     && (X->Def.iTPQPrecision == TPQ_MIXED || (X->Def.iInitialVecType != 0 && nproc == 1))){
+    v0=NULL;
+    v1=NULL;
+    vg=NULL;
+  }
+  else{
+    c_malloc1(v0, X->Check.idim_max+1);
+    if(v1shm != NULL) v1 = v1shm;
+    else c_malloc1(v1, X->Check.idim_max+1);
+    c_malloc1(vg, X->Check.idim_max+1);
+    if(
+       v0==NULL
+       || v1==NULL
+       || vg==NULL
+       ){
+      return -1;
+    }
+    setmem_FirstTouch_c(v0, X->Check.idim_max+1);
+    setmem_FirstTouch_c(v1, X->Check.idim_max+1);
+    setmem_FirstTouch_c(vg, X->Check.idim_max+1);
+  }
   c_malloc2(vec,X->Def.nvec+1, X->Def.Lanczos_max+1);
   for(j=0; j<X->Def.nvec+1; j++){
     if(vec[j]==NULL){
@@ -216,6 +429,7 @@ int setmem_large
     }
   }
   
+  if (X->Def.NUMAReport != 0) setmem_NUMAReport(X);
   fprintf(stdoutMPI, "%s", cProFinishAlloc);
   return 0;
   }
@@ -0,0 +1,174 @@
+#!/bin/sh
+#
+# Regression test: run a Standard-mode sample with extra keywords and
+# compare the result with the reference outputs.
+#
+# usage: regression.sh [options] HPhi sample
+#   HPhi    : path to the executable
+#   sample  : directory with StdFace.def and the reference outputs of the sample
+# options:
+#   -n np      : number of MPI processes (default 1: run without mpiexec)
+#   -r nrun    : number of runs in the same directory (2 checks the files reused by the second run)
+#   -c calcmod : lines appended to calcmod.def, separated by ";"
+#   -m modpara : lines appended to modpara.def, separated by ";"
+#   -s stdface : lines of StdFace.def, separated by ";"; they replace the lines of the sample
+#                with the same keyword
+#   -e energy  : reference ground-state energy
+#                (default: the first Energy in output_Lanczos/zvo_energy.dat of the sample)
+#   -f nstate  : compare the lowest nstate energies (zvo_energy.dat, or Eigenvalue.dat of FullDiag)
+#                with output_FullDiag/Eigenvalue.dat of the sample
+#   -t refdir  : compare inv_tmp, energy, phys_var, phys_doublon and phys_num in output/SS_rand*.dat of TPQ
+#                with the files of the same names in refdir (relative difference)
+#   -u sectors : run each sector (lines separated by ";", sectors separated by "|") and compare
+#                the sorted union of output/Eigenvalue.dat with output_FullDiag/Eigenvalue.dat
+#                of the sample (all the eigenvalues)
+#   -g pattern : the standard output of the last run must contain pattern
+#   -T tol     : tolerance (default 1.0e-8)
+# The environment variable MPIEXEC overrides the launcher used when np > 1.
+#
+NP=1
+NRUN=1
+CALCMOD=""
+MODPARA=""
+STDFACE=""
+EREF=""
+NSTATE=0
+TPQREF=""
+SECTORS=""
+PATTERN=""
+TOL=1.0e-8
+while getopts n:r:c:m:s:e:f:t:u:g:T: opt; do
+  case $opt in
+    n) NP=$OPTARG ;;
+    r) NRUN=$OPTARG ;;
+    c) CALCMOD=$OPTARG ;;
+    m) MODPARA=$OPTARG ;;
+    s) STDFACE=$OPTARG ;;
+    e) EREF=$OPTARG ;;
+    f) NSTATE=$OPTARG ;;
+    t) TPQREF=$OPTARG ;;
+    u) SECTORS=$OPTARG ;;
+    g) PATTERN=$OPTARG ;;
+    T) TOL=$OPTARG ;;
+    *) exit 1 ;;
+  esac
+done
+shift `expr $OPTIND - 1`
+HPHI=$1
+SAMPLE=$2
+
+if [ "$NP" -gt 1 ]; then
+  RUN="${MPIEXEC:-mpiexec} -np $NP $HPHI"
+else
+  RUN=$HPHI
+fi
+
+# make_input lines: StdFace.in from the sample and the lines, then the input files
+make_input() {
+  rm -rf output *.def StdFace.in
+  echo "$1" | tr ';' '\n' > stdface.add
+  awk 'function key(s) { sub(/=.*/, "", s); gsub(/[ \t]/, "", s); return tolower(s) }
+    FNR == NR { if ($0 ~ /=/) skip[key($0)] = 1; next }
+    $0 !~ /^ *\/\// && !(key($0) in skip)' stdface.add $SAMPLE/StdFace.def > StdFace.in
+  cat stdface.add >> StdFace.in
+  $HPHI -sdry StdFace.in > stdface.log 2>&1 || { echo "StdFace failed (see stdface.log)"; exit 1; }
+  echo "$CALCMOD" | tr ';' '\n' >> calcmod.def
+  echo "$MODPARA" | tr ';' '\n' >> modpara.def
+}
+
+# run_hphi log: run HPhi and check that it ends normally
+run_hphi() {
+  $RUN -e namelist.def > $1 2>&1 || { echo "HPhi failed (see $1)"; exit 1; }
+}
+
+# compare_list label file reference n: compare the first n numbers of two files (one per line)
+compare_list() {
+  awk -v tol=$TOL -v label="$1" -v n=$4 '
+    FNR == NR { e[FNR] = $1; ne = FNR; next }
+    { r[FNR] = $1; nr = FNR }
+    END {
+      if (n <= 0) { n = nr; if (ne != nr) { printf("%s: %d values, reference %d\n", label, ne, nr); exit 1 } }
+      if (ne < n || nr < n) { printf("%s: %d values, reference %d, %d needed\n", label, ne, nr, n); exit 1 }
+      for (i = 1; i <= n; i++) {
+        d = e[i] - r[i]; if (d < 0) d = -d
+        if (d > tol) { printf("%s: state %d: %s reference %s\n", label, i - 1, e[i], r[i]); exit 1 }
+      }
+      printf("%s: %d values agree with the reference (%s)\n", label, n, tol)
+    }' $2 $3
+}
+
+# Sectors: the union of the spectra is compared with the whole spectrum of the sample.
+if [ -n "$SECTORS" ]; then
+  rm -f union.dat
+  isec=0
+  echo "$SECTORS" | tr '|' '\n' > sectors.list
+  while read sector; do
+    make_input "$STDFACE;$sector"
+    run_hphi hphi_sector$isec.log
+    if [ ! -f output/Eigenvalue.dat ]; then
+      echo "sector $sector: output/Eigenvalue.dat is not written (see hphi_sector$isec.log)"
+      exit 1
+    fi
+    awk '{print $2}' output/Eigenvalue.dat >> union.dat
+    isec=`expr $isec + 1`
+  done < sectors.list
+  sort -g union.dat > union_sorted.dat
+  awk '{print $2}' $SAMPLE/output_FullDiag/Eigenvalue.dat | sort -g > reference.dat
+  compare_list "union of $isec sectors" union_sorted.dat reference.dat 0 || exit 1
+  exit 0
+fi
+
+make_input "$STDFACE"
+if [ -z "$EREF" ] && [ "$NSTATE" -eq 0 ] && [ -z "$TPQREF" ]; then
+  EREF=`awk '$1 == "Energy" {print $2; exit}' $SAMPLE/output_Lanczos/zvo_energy.dat`
+fi
+
+irun=1
+while [ $irun -le $NRUN ]; do
+  rm -f output/zvo_energy.dat output/Eigenvalue.dat output/SS_rand*.dat
+  run_hphi hphi$irun.log
+  if [ -n "$TPQREF" ]; then
+    for ref in $TPQREF/SS_rand*.dat; do
+      [ -f "$ref" ] || { echo "no reference in $TPQREF"; exit 1; }
+      out=output/`basename $ref`
+      if [ ! -f $out ]; then
+        echo "run $irun: $out is not written (see hphi$irun.log)"
+        exit 1
+      fi
+      awk -v tol=$TOL -v label="run $irun: $out" '
+        $1 == "#" { next }
+        FNR == NR { ne++; for (k = 1; k <= 5; k++) e[ne, k] = $k; next }
+        { nr++
+          for (k = 1; k <= 5; k++) {
+            d = e[nr, k] - $k; if (d < 0) d = -d
+            s = $k; if (s < 0) s = -s; if (s < 1) s = 1
+            if (d > tol * s) { printf("%s: step %d, column %d: %s reference %s\n", label, $6, k, e[nr, k], $k); bad = 1; exit 1 }
+          }
+        }
+        END { if (bad) exit 1
+              if (ne != nr) { printf("%s: %d steps, reference %d\n", label, ne, nr); exit 1 }
+              printf("%s: %d steps agree with the reference (%s)\n", label, nr, tol) }' $out $ref || exit 1
+    done
+  else
+    if [ -f output/Eigenvalue.dat ]; then
+      awk '{print $2}' output/Eigenvalue.dat > energy.dat
+    elif [ -f output/zvo_energy.dat ]; then
+      awk '$1 == "Energy" {print $2}' output/zvo_energy.dat > energy.dat
+    else
+      echo "run $irun: no energy is written (see hphi$irun.log)"
+      exit 1
+    fi
+    if [ "$NSTATE" -gt 0 ]; then
+      awk '{print $2}' $SAMPLE/output_FullDiag/Eigenvalue.dat | sort -g > reference.dat
+      compare_list "run $irun" energy.dat reference.dat $NSTATE || exit 1
+    else
+      echo $EREF > reference.dat
+      compare_list "run $irun" energy.dat reference.dat 1 || exit 1
+    fi
+  fi
+  irun=`expr $irun + 1`
+done
+if [ -n "$PATTERN" ]; then
+  grep "$PATTERN" hphi$NRUN.log || { echo "\"$PATTERN\" is not in hphi$NRUN.log"; exit 1; }
+fi
+exit 0